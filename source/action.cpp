@@ -18,11 +18,202 @@
 #include "main.h"
 
 #include "action.h"
+#include "action_journal.h"
 #include "settings.h"
 #include "map.h"
 #include "editor.h"
 #include "gui.h"
 
+namespace {
+	// Still linear in the existing tiles of the area: the selected flags live on every item,
+	// and the selection keeps its set of tiles for the code that iterates it. The area only
+	// saves the tile copies and the positions without a tile.
+	void commitSelectionArea(SelectionAreaData* data, Map &map, Selection &selection) {
+		data->previous.clear();
+		if (data->select) {
+			// Avoids rehashing the selected tiles over and over on large boxes
+			selection.reserveInternal(std::min<uint64_t>(data->area.count(), map.getTileCount()));
+		}
+		data->area.forEachTile(map, [&](Tile* tile) {
+			if (tile->isSelected()) {
+				data->previous.emplace_back(tile);
+			}
+			if (data->select) {
+				tile->select();
+				if (tile->isSelected()) {
+					selection.addInternal(tile);
+				}
+			} else {
+				tile->deselect();
+				selection.removeInternal(tile);
+			}
+		});
+	}
+
+	void undoSelectionArea(SelectionAreaData* data, Map &map, Selection &selection) {
+		data->area.forEachTile(map, [&](Tile* tile) {
+			tile->deselect();
+			selection.removeInternal(tile);
+		});
+		for (const TileSelectionState &state : data->previous) {
+			Tile* tile = map.getTile(state.getPosition());
+			if (tile) {
+				state.restore(tile);
+				if (tile->isSelected()) {
+					selection.addInternal(tile);
+				}
+			}
+		}
+	}
+
+	// Positions each house loses, and where its moved tiles go, while tiles are moved
+	struct HouseTileMoves {
+		std::set<Position> removed;
+		std::map<Position, Position> moved;
+	};
+	using HouseTileChanges = std::map<uint32_t, HouseTileMoves>;
+
+	void unlinkMovedTile(Map &map, Tile* tile) {
+		map.removeSpawnMonster(tile);
+		map.removeSpawnNpc(tile);
+	}
+
+	void linkMovedTile(Map &map, Tile* tile) {
+		if (tile->spawnMonster) {
+			map.addSpawnMonster(tile);
+		}
+		if (tile->spawnNpc) {
+			map.addSpawnNpc(tile);
+		}
+	}
+
+	// Leaves the map as a copying move would: the moved tiles are marked as modified and
+	// the sources are left with an empty tile
+	void commitTileMove(TileMoveData* data, Map &map) {
+		std::vector<Tile*> moved;
+		moved.reserve(data->area.count());
+		data->area.forEachPosition([&](const Position &position) {
+			Tile* tile = map.getTile(position);
+			if (tile) {
+				moved.push_back(tile);
+			}
+		});
+
+		// Take every tile out first, sources and destinations may overlap
+		for (Tile* tile : moved) {
+			unlinkMovedTile(map, tile);
+			map.swapTile(tile->getPosition(), nullptr);
+		}
+
+		HouseTileChanges houses;
+		data->unmodified.clear();
+		for (Tile* tile : moved) {
+			const Position source = tile->getPosition();
+			const Position destination = source + data->offset;
+			tile->setLocation(map.createTileL(destination));
+			Tile* previous = map.swapTile(destination, tile);
+			if (previous) {
+				unlinkMovedTile(map, previous);
+				if (previous->getHouseID() != 0) {
+					houses[previous->getHouseID()].removed.insert(destination);
+				}
+				data->replaced.push_back(previous);
+			}
+			linkMovedTile(map, tile);
+			if (tile->getHouseID() != 0) {
+				houses[tile->getHouseID()].moved.emplace(source, destination);
+			}
+
+			if (!tile->isModified()) {
+				data->unmodified.push_back(source);
+			}
+			tile->modify();
+		}
+
+		data->area.forEachPosition([&](const Position &position) {
+			TileLocation* location = map.createTileL(position);
+			if (!location->get()) {
+				Tile* empty_tile = map.allocator(location);
+				empty_tile->modify();
+				map.swapTile(position, empty_tile);
+			}
+		});
+
+		data->houses.clear();
+		for (const auto &[id, changes] : houses) {
+			House* house = map.houses.getHouse(id);
+			if (house) {
+				data->houses.emplace_back(id, house->getTiles());
+				house->moveTiles(changes.removed, changes.moved);
+			}
+		}
+	}
+
+	// Puts back the tiles, their modified state and the house tile lists, and like undoing
+	// a copying move leaves an empty tile at the destinations that had none
+	void undoTileMove(TileMoveData* data, Map &map) {
+		std::vector<Tile*> moved;
+		moved.reserve(data->area.count());
+		data->area.forEachPosition([&](const Position &position) {
+			Tile* tile = map.getTile(position + data->offset);
+			if (tile) {
+				moved.push_back(tile);
+			}
+		});
+
+		for (Tile* tile : moved) {
+			unlinkMovedTile(map, tile);
+			map.swapTile(tile->getPosition(), nullptr);
+		}
+
+		for (Tile* tile : data->replaced) {
+			map.swapTile(tile->getPosition(), tile);
+			linkMovedTile(map, tile);
+		}
+		data->replaced.clear();
+
+		for (Tile* tile : moved) {
+			const Position source = tile->getPosition() - data->offset;
+			tile->setLocation(map.createTileL(source));
+			// The empty tile the move left, unless another moved tile was here
+			delete map.swapTile(source, tile);
+			linkMovedTile(map, tile);
+		}
+
+		for (const Position &position : data->unmodified) {
+			map.getTile(position)->unmodify();
+		}
+		data->unmodified.clear();
+
+		data->area.forEachPosition([&](const Position &position) {
+			const Position destination = position + data->offset;
+			TileLocation* location = map.createTileL(destination);
+			if (!location->get()) {
+				map.swapTile(destination, map.allocator(location));
+			}
+		});
+
+		for (auto &[id, tiles] : data->houses) {
+			House* house = map.houses.getHouse(id);
+			if (house) {
+				house->setTiles(std::move(tiles));
+			}
+		}
+		data->houses.clear();
+	}
+}
+
+TileMoveData::TileMoveData(SelectionArea area, const Position &offset) :
+	area(std::move(area)), offset(offset) {
+	////
+}
+
+TileMoveData::~TileMoveData() {
+	for (Tile* tile : replaced) {
+		delete tile;
+	}
+}
+
 Change::Change() :
 	type(CHANGE_NONE), data(nullptr) {
 	////
@@ -48,6 +239,20 @@ Change* Change::Create(Waypoint* waypoint, const Position &position) {
 	return change;
 }
 
+Change* Change::Create(const SelectionArea &area, bool select) {
+	Change* change = new Change();
+	change->type = CHANGE_SELECT_AREA;
+	change->data = new SelectionAreaData { area, select, {} };
+	return change;
+}
+
+Change* Change::Create(const SelectionArea &area, const Position &offset) {
+	Change* change = new Change();
+	change->type = CHANGE_MOVE_TILES;
+	change->data = new TileMoveData(area, offset);
+	return change;
+}
+
 Change::~Change() {
 	clear();
 }
@@ -66,6 +271,14 @@ void Change::clear() {
 			ASSERT(data);
 			delete reinterpret_cast<WaypointData*>(data);
 			break;
+		case CHANGE_SELECT_AREA:
+			ASSERT(data);
+			delete reinterpret_cast<SelectionAreaData*>(data);
+			break;
+		case CHANGE_MOVE_TILES:
+			ASSERT(data);
+			delete reinterpret_cast<TileMoveData*>(data);
+			break;
 		case CHANGE_NONE:
 			break;
 		default:
@@ -85,6 +298,20 @@ uint32_t Change::memsize() const {
 	uint32_t mem = sizeof(*this);
 	if (type == CHANGE_TILE) {
 		mem += reinterpret_cast<Tile*>(data)->memsize();
+	} else if (type == CHANGE_SELECT_AREA) {
+		const SelectionAreaData* area_data = reinterpret_cast<SelectionAreaData*>(data);
+		mem += sizeof(SelectionAreaData) + area_data->area.getRects().size() * sizeof(SelectionRect);
+		mem += area_data->previous.size() * (sizeof(TileSelectionState) + sizeof(uint64_t));
+	} else if (type == CHANGE_MOVE_TILES) {
+		const TileMoveData* move_data = reinterpret_cast<TileMoveData*>(data);
+		mem += sizeof(TileMoveData) + move_data->area.getRects().size() * sizeof(SelectionRect);
+		for (const Tile* tile : move_data->replaced) {
+			mem += sizeof(Tile*) + tile->memsize();
+		}
+		mem += move_data->unmodified.size() * sizeof(Position);
+		for (const auto &[id, tiles] : move_data->houses) {
+			mem += sizeof(uint32_t) + tiles.size() * sizeof(Position);
+		}
 	}
 	return mem;
 }
@@ -115,6 +342,8 @@ size_t Action::memsize() const {
 	for (const Change* change : changes) {
 		if (change && change->getType() == CHANGE_TILE) {
 			mem += reinterpret_cast<Tile*>(change->getData())->memsize();
+		} else if (change && (change->getType() == CHANGE_SELECT_AREA || change->getType() == CHANGE_MOVE_TILES)) {
+			mem += change->memsize();
 		}
 	}
 
@@ -266,6 +495,20 @@ void Action::commit(DirtyList* dirty_list) {
 				break;
 			}
 
+			case CHANGE_SELECT_AREA: {
+				SelectionAreaData* data = reinterpret_cast<SelectionAreaData*>(change->data);
+				ASSERT(data);
+				commitSelectionArea(data, map, selection);
+				break;
+			}
+
+			case CHANGE_MOVE_TILES: {
+				TileMoveData* data = reinterpret_cast<TileMoveData*>(change->data);
+				ASSERT(data);
+				commitTileMove(data, map);
+				break;
+			}
+
 			default:
 				break;
 		}
@@ -398,6 +641,20 @@ void Action::undo(DirtyList* dirty_list) {
 				break;
 			}
 
+			case CHANGE_SELECT_AREA: {
+				SelectionAreaData* data = reinterpret_cast<SelectionAreaData*>(change->data);
+				ASSERT(data);
+				undoSelectionArea(data, map, selection);
+				break;
+			}
+
+			case CHANGE_MOVE_TILES: {
+				TileMoveData* data = reinterpret_cast<TileMoveData*>(change->data);
+				ASSERT(data);
+				undoTileMove(data, map);
+				break;
+			}
+
 			default:
 				break;
 		}
@@ -411,7 +668,8 @@ BatchAction::BatchAction(Editor &editor, ActionIdentifier ident) :
 	editor(editor),
 	timestamp(0),
 	memory_size(0),
-	type(ident) {
+	type(ident),
+	journal_offset(-1) {
 	////
 }
 
@@ -505,7 +763,7 @@ void BatchAction::merge(BatchAction* other) {
 }
 
 ActionQueue::ActionQueue(Editor &editor) :
-	current(0), memory_size(0), editor(editor) {
+	current(0), memory_size(0), editor(editor), journal(nullptr) {
 	////
 }
 
@@ -514,6 +772,7 @@ ActionQueue::~ActionQueue() {
 		delete batch;
 	}
 	actions.clear();
+	delete journal;
 }
 
 Action* ActionQueue::createAction(ActionIdentifier identifier) const {
@@ -563,11 +822,14 @@ void ActionQueue::addBatch(BatchAction* batch, int stacking_delay) {
 		delete todelete;
 	}
 
-	while (memory_size > size_t(1024 * 1024 * g_settings.getInteger(Config::UNDO_MEM_SIZE)) && !actions.empty()) {
-		memory_size -= actions.front()->memsize();
-		delete actions.front();
-		actions.pop_front();
-		current--;
+	const size_t memory_limit = size_t(1024 * 1024 * g_settings.getInteger(Config::UNDO_MEM_SIZE));
+	if (memory_size > memory_limit && !spillActions(memory_limit)) {
+		while (memory_size > memory_limit && !actions.empty()) {
+			memory_size -= actions.front()->memsize();
+			delete actions.front();
+			actions.pop_front();
+			current--;
+		}
 	}
 
 	if (actions.size() > size_t(g_settings.getInteger(Config::UNDO_SIZE)) && !actions.empty()) {
@@ -581,7 +843,7 @@ void ActionQueue::addBatch(BatchAction* batch, int stacking_delay) {
 	do {
 		if (!actions.empty()) {
 			BatchAction* lastAction = actions.back();
-			if (lastAction->type == batch->type && g_settings.getInteger(Config::GROUP_ACTIONS) && time(nullptr) - stacking_delay < lastAction->timestamp) {
+			if (lastAction->type == batch->type && !lastAction->isSpilled() && g_settings.getInteger(Config::GROUP_ACTIONS) && time(nullptr) - stacking_delay < lastAction->timestamp) {
 				lastAction->merge(batch);
 				lastAction->timestamp = time(nullptr);
 				memory_size -= lastAction->memsize();
@@ -616,21 +878,130 @@ const BatchAction* ActionQueue::getAction(size_t index) const {
 }
 
 void ActionQueue::generateLabels() {
-	for (BatchAction* batch : actions) {
-		if (batch && batch->label.IsEmpty()) {
-			batch->label = createLabel(batch->getType());
+	// Only the newest batches can be unlabeled, stop at the first labeled one
+	for (BatchAction* batch : std::views::reverse(actions)) {
+		if (!batch || !batch->label.IsEmpty()) {
+			break;
 		}
+		batch->label = createLabel(batch->getType());
 	}
 }
 
+bool ActionQueue::spillActions(size_t memory_limit) {
+	if (!g_settings.getBoolean(Config::UNDO_SPILL_TO_DISK) || editor.IsLiveClient()) {
+		return false;
+	}
+
+	if (!journal) {
+		journal = newd ActionJournal(createJournalFilename());
+	}
+	if (!journal->isOk()) {
+		return false;
+	}
+
+	// Evict from whichever end is furthest away from the current index,
+	// the batches right next to it are the next ones to be undone/redone.
+	size_t front = 0;
+	size_t back = actions.size();
+	while (memory_size > memory_limit && front < back) {
+		size_t index;
+		if (current - front >= back - current) {
+			index = front++;
+		} else {
+			index = --back;
+		}
+
+		if (index + 1 == current || index == current) {
+			continue;
+		}
+
+		BatchAction* batch = actions[index];
+		if (!batch || batch->isSpilled()) {
+			continue;
+		}
+
+		memory_size -= batch->memsize();
+		if (!journal->spill(batch)) {
+			memory_size += batch->memsize();
+			return false;
+		}
+		memory_size += batch->memsize(true);
+	}
+	return true;
+}
+
+bool ActionQueue::restoreAction(BatchAction* batch) {
+	if (!batch->isSpilled()) {
+		return true;
+	}
+
+	if (!journal || !journal->restore(*this, editor.getMap(), batch)) {
+		return false;
+	}
+
+	memory_size -= batch->memsize();
+	memory_size += batch->memsize(true);
+	return true;
+}
+
+void ActionQueue::discardActions(size_t first, size_t last) {
+	for (size_t index = first; index < last; ++index) {
+		BatchAction* batch = actions[index];
+		if (batch) {
+			memory_size -= batch->memsize();
+			delete batch;
+		}
+	}
+	actions.erase(actions.begin() + first, actions.begin() + last);
+	if (current > first) {
+		current = current > last ? current - (last - first) : first;
+	}
+
+	// The journal is append-only, it can only be emptied once nothing refers to it anymore
+	if (journal && std::ranges::none_of(actions, [](const BatchAction* batch) { return batch && batch->isSpilled(); })) {
+		journal->clear();
+	}
+}
+
+std::string ActionQueue::createJournalFilename() const {
+	const Map &map = editor.getMap();
+
+	std::string backup_path;
+	std::string name;
+	if (map.hasFile()) {
+		FileName filename(wxstr(map.getFilename()));
+		backup_path = nstr(filename.GetPath(wxPATH_GET_SEPARATOR | wxPATH_GET_VOLUME)) + "backups/";
+		name = nstr(filename.GetName());
+	} else {
+		backup_path = nstr(g_gui.GetLocalDataDirectory()) + "backups/";
+		name = map.getName();
+	}
+	editor.ensureBackupDirectoryExists(backup_path);
+
+	return fmt::format("{}{}.{}-{:x}.undo", backup_path, name, time(nullptr), reinterpret_cast<uintptr_t>(this));
+}
+
 bool ActionQueue::undo() {
 	if (current > 0) {
+		BatchAction* batch = actions.at(current - 1);
+		if (batch && !restoreAction(batch)) {
+			// Everything before it is only reachable through it
+			spdlog::error("Could not restore \"{}\" from the undo journal, dropping {} undo steps", nstr(batch->getLabel()), current);
+			discardActions(0, current);
+			g_gui.PopupDialog("Error", "The undo history could not be read back from disk and has been cleared.\nThe map itself is unchanged, see the log for details.", wxOK);
+			return false;
+		}
+
 		current--;
-		BatchAction* batch = actions.at(current);
 		if (batch) {
 			batch->undo();
 		}
 
+		const size_t memory_limit = size_t(1024 * 1024 * g_settings.getInteger(Config::UNDO_MEM_SIZE));
+		if (memory_size > memory_limit) {
+			spillActions(memory_limit);
+		}
+
 		// Update title
 		if (batch && batch->isNoSelection() && editor.getMap().doChange()) {
 			g_gui.UpdateTitle();
@@ -643,11 +1014,23 @@ bool ActionQueue::undo() {
 bool ActionQueue::redo() {
 	if (current < actions.size()) {
 		BatchAction* batch = actions.at(current);
+		if (batch && !restoreAction(batch)) {
+			spdlog::error("Could not restore \"{}\" from the undo journal, dropping {} redo steps", nstr(batch->getLabel()), actions.size() - current);
+			discardActions(current, actions.size());
+			g_gui.PopupDialog("Error", "The redo history could not be read back from disk and has been cleared.\nThe map itself is unchanged, see the log for details.", wxOK);
+			return false;
+		}
+
 		if (batch) {
 			batch->redo();
 		}
 		current++;
 
+		const size_t memory_limit = size_t(1024 * 1024 * g_settings.getInteger(Config::UNDO_MEM_SIZE));
+		if (memory_size > memory_limit) {
+			spillActions(memory_limit);
+		}
+
 		// Update title
 		if (batch && batch->isNoSelection() && editor.getMap().doChange()) {
 			g_gui.UpdateTitle();
@@ -672,6 +1055,10 @@ void ActionQueue::clear() {
 	}
 	actions.clear();
 	current = 0;
+	memory_size = 0;
+	if (journal) {
+		journal->clear();
+	}
 }
 
 wxString ActionQueue::createLabel(ActionIdentifier type) {
@@ -19,6 +19,7 @@
 #define RME_ACTION_H_
 
 #include "position.h"
+#include "selection_area.h"
 
 class Editor;
 class Tile;
@@ -28,6 +29,7 @@ class Change;
 class Action;
 class BatchAction;
 class ActionQueue;
+class ActionJournal;
 
 enum ActionIdentifier {
 	ACTION_MOVE,
@@ -52,6 +54,8 @@ enum ChangeType {
 	CHANGE_TILE,
 	CHANGE_MOVE_HOUSE_EXIT,
 	CHANGE_MOVE_WAYPOINT,
+	CHANGE_SELECT_AREA,
+	CHANGE_MOVE_TILES,
 };
 
 struct HouseData {
@@ -64,6 +68,31 @@ struct WaypointData {
 	Position position;
 };
 
+// Selects or deselects the tiles of an area in place, without copying them
+struct SelectionAreaData {
+	SelectionArea area;
+	bool select;
+	// Tiles of the area that had something selected before the change was committed
+	std::vector<TileSelectionState> previous;
+};
+
+// Moves whole tiles by relinking them to their destinations instead of copying them
+struct TileMoveData {
+	TileMoveData(SelectionArea area, const Position &offset);
+	~TileMoveData();
+
+	// Source positions of the moved tiles
+	SelectionArea area;
+	// From the source to the destination
+	Position offset;
+	// Tiles that were at the destinations, owned by the change while it is committed
+	std::vector<Tile*> replaced;
+	// Source positions of the moved tiles that were not modified before the move
+	PositionVector unmodified;
+	// Tile lists of the houses the move changed, as they were before it
+	std::vector<std::pair<uint32_t, PositionList>> houses;
+};
+
 class Change {
 public:
 	Change(Tile* tile);
@@ -71,6 +100,8 @@ public:
 
 	static Change* Create(House* house, const Position &position);
 	static Change* Create(Waypoint* waypoint, const Position &position);
+	static Change* Create(const SelectionArea &area, bool select);
+	static Change* Create(const SelectionArea &area, const Position &offset);
 
 	void clear();
 
@@ -89,6 +120,7 @@ private:
 	void* data;
 
 	friend class Action;
+	friend class ActionJournal;
 };
 
 typedef std::vector<Change*> ChangeList;
@@ -165,6 +197,7 @@ protected:
 	ActionIdentifier type;
 
 	friend class ActionQueue;
+	friend class ActionJournal;
 };
 
 typedef std::vector<Action*> ActionVector;
@@ -183,7 +216,11 @@ public:
 		return batch.size();
 	}
 	bool empty() const noexcept {
-		return batch.empty();
+		return batch.empty() && !isSpilled();
+	}
+	// Spilled batches have their actions stored in the undo journal
+	bool isSpilled() const noexcept {
+		return journal_offset >= 0;
 	}
 	ActionIdentifier getType() const noexcept {
 		return type;
@@ -211,8 +248,10 @@ protected:
 	ActionIdentifier type;
 	ActionVector batch;
 	wxString label;
+	int64_t journal_offset;
 
 	friend class ActionQueue;
+	friend class ActionJournal;
 };
 
 class ActionQueue {
@@ -262,10 +301,19 @@ public:
 protected:
 	static wxString createLabel(ActionIdentifier type);
 
+	// Moves batches far from the current index to the undo journal until memory usage is below the limit
+	// Returns false if the journal is disabled or unusable
+	bool spillActions(size_t memory_limit);
+	bool restoreAction(BatchAction* batch);
+	// Deletes the batches in [first, last), used when history can no longer be restored
+	void discardActions(size_t first, size_t last);
+	std::string createJournalFilename() const;
+
 	size_t current;
 	size_t memory_size;
 	Editor &editor;
 	ActionList actions;
+	ActionJournal* journal;
 };
 
 #endif
@@ -0,0 +1,703 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "action_journal.h"
+#include "iomap_otbm.h"
+#include "map.h"
+#include "tile.h"
+#include "item.h"
+#include "monster.h"
+#include "npc.h"
+#include "spawn_monster.h"
+#include "spawn_npc.h"
+
+#include <zlib.h>
+
+namespace {
+	enum JournalNodeType : uint8_t {
+		JOURNAL_BATCH = 0x40,
+		JOURNAL_ACTION,
+		JOURNAL_TILE,
+		JOURNAL_MONSTER,
+		JOURNAL_NPC,
+		JOURNAL_HOUSE_EXIT,
+		JOURNAL_WAYPOINT,
+		JOURNAL_SELECTION_AREA,
+		JOURNAL_MOVE_TILES,
+	};
+
+	struct JournalRecordHeader {
+		uint32_t raw_size;
+		uint32_t compressed_size;
+	};
+
+	MapVersion journalMapVersion() {
+		MapVersion version;
+		version.otbm = MAP_OTBM_LAST_VERSION;
+		return version;
+	}
+
+	bool readPosition(BinaryNode* node, Position &position) {
+		uint16_t x, y;
+		uint8_t z;
+		if (!node->getU16(x) || !node->getU16(y) || !node->getU8(z)) {
+			return false;
+		}
+		position = Position(x, y, z);
+		return true;
+	}
+}
+
+ActionJournal::ActionJournal(const std::string &filename) :
+	filename(filename),
+	file_size(0),
+	mapVersion(journalMapVersion()) {
+	stream.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+}
+
+ActionJournal::~ActionJournal() {
+	if (stream.is_open()) {
+		stream.close();
+	}
+	std::remove(filename.c_str());
+}
+
+void ActionJournal::clear() {
+	if (stream.is_open()) {
+		stream.close();
+	}
+	stream.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	file_size = 0;
+}
+
+bool ActionJournal::spill(BatchAction* batch) {
+	if (!isOk()) {
+		return false;
+	}
+	if (batch->isSpilled()) {
+		return true;
+	}
+
+	writer.reset();
+	writer.addNode(JOURNAL_BATCH);
+	for (const Action* action : batch->batch) {
+		writer.addNode(JOURNAL_ACTION);
+		writer.addU8(action->commited ? 1 : 0);
+		for (const Change* change : action->changes) {
+			switch (change->getType()) {
+				case CHANGE_TILE:
+					writeTile(reinterpret_cast<const Tile*>(change->getData()));
+					break;
+				case CHANGE_MOVE_HOUSE_EXIT: {
+					const HouseData* data = reinterpret_cast<const HouseData*>(change->getData());
+					writer.addNode(JOURNAL_HOUSE_EXIT);
+					writer.addU32(data->id);
+					writer.addU16(data->position.x);
+					writer.addU16(data->position.y);
+					writer.addU8(data->position.z);
+					writer.endNode();
+					break;
+				}
+				case CHANGE_MOVE_WAYPOINT: {
+					const WaypointData* data = reinterpret_cast<const WaypointData*>(change->getData());
+					writer.addNode(JOURNAL_WAYPOINT);
+					writer.addString(data->id);
+					writer.addU16(data->position.x);
+					writer.addU16(data->position.y);
+					writer.addU8(data->position.z);
+					writer.endNode();
+					break;
+				}
+				case CHANGE_SELECT_AREA:
+					writeSelectionArea(reinterpret_cast<const SelectionAreaData*>(change->getData()));
+					break;
+				case CHANGE_MOVE_TILES:
+					writeTileMove(reinterpret_cast<const TileMoveData*>(change->getData()));
+					break;
+				default:
+					// Cleared changes (tiles outside of a live client's view) carry nothing
+					break;
+			}
+		}
+		writer.endNode();
+	}
+	writer.endNode();
+
+	uLongf compressed_size = compressBound(writer.getSize());
+	buffer.resize(compressed_size);
+	if (compress2(buffer.data(), &compressed_size, writer.getMemory(), writer.getSize(), Z_BEST_SPEED) != Z_OK) {
+		return false;
+	}
+
+	JournalRecordHeader header { static_cast<uint32_t>(writer.getSize()), static_cast<uint32_t>(compressed_size) };
+	stream.seekp(file_size);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(buffer.data()), compressed_size);
+	stream.flush();
+	if (!stream.good()) {
+		spdlog::error("Could not write undo journal {}", filename);
+		return false;
+	}
+
+	batch->journal_offset = file_size;
+	file_size += sizeof(header) + compressed_size;
+
+	for (Action* action : batch->batch) {
+		delete action;
+	}
+	batch->batch.clear();
+	batch->batch.shrink_to_fit();
+	return true;
+}
+
+bool ActionJournal::restore(const ActionQueue &queue, Map &map, BatchAction* batch) {
+	if (!batch->isSpilled()) {
+		return true;
+	}
+	if (!isOk()) {
+		return false;
+	}
+
+	JournalRecordHeader header;
+	stream.seekg(batch->journal_offset);
+	stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+	buffer.resize(header.compressed_size);
+	stream.read(reinterpret_cast<char*>(buffer.data()), header.compressed_size);
+	if (!stream.good()) {
+		spdlog::error("Could not read undo journal {}", filename);
+		stream.clear();
+		return false;
+	}
+
+	std::vector<uint8_t> raw(header.raw_size);
+	uLongf raw_size = header.raw_size;
+	if (uncompress(raw.data(), &raw_size, buffer.data(), header.compressed_size) != Z_OK || raw_size != header.raw_size) {
+		spdlog::error("Corrupted record in undo journal {}", filename);
+		return false;
+	}
+
+	MemoryNodeFileReadHandle reader(raw.data(), raw.size());
+	BinaryNode* root = reader.getRootNode();
+	uint8_t node_type;
+	if (!root || !root->getByte(node_type) || node_type != JOURNAL_BATCH) {
+		spdlog::error("Corrupted record in undo journal {}", filename);
+		return false;
+	}
+
+	ActionVector restored;
+	bool success = true;
+	BinaryNode* action_node = root->getChild();
+	if (action_node) {
+		do {
+			uint8_t commited;
+			if (!action_node->getByte(node_type) || node_type != JOURNAL_ACTION || !action_node->getU8(commited)) {
+				success = false;
+				break;
+			}
+
+			Action* action = queue.createAction(batch);
+			action->commited = commited != 0;
+			restored.push_back(action);
+
+			BinaryNode* change_node = action_node->getChild();
+			if (!change_node) {
+				continue;
+			}
+
+			do {
+				if (!change_node->getByte(node_type)) {
+					success = false;
+					break;
+				}
+
+				switch (node_type) {
+					case JOURNAL_TILE: {
+						Tile* tile = readTile(map, change_node);
+						if (!tile) {
+							success = false;
+							break;
+						}
+						action->addChange(newd Change(tile));
+						break;
+					}
+					case JOURNAL_HOUSE_EXIT: {
+						uint32_t id;
+						Position position;
+						if (!change_node->getU32(id) || !readPosition(change_node, position)) {
+							success = false;
+							break;
+						}
+						Change* change = newd Change();
+						change->type = CHANGE_MOVE_HOUSE_EXIT;
+						change->data = newd HouseData { id, position };
+						action->addChange(change);
+						break;
+					}
+					case JOURNAL_WAYPOINT: {
+						std::string name;
+						Position position;
+						if (!change_node->getString(name) || !readPosition(change_node, position)) {
+							success = false;
+							break;
+						}
+						Change* change = newd Change();
+						change->type = CHANGE_MOVE_WAYPOINT;
+						change->data = newd WaypointData { name, position };
+						action->addChange(change);
+						break;
+					}
+					case JOURNAL_SELECTION_AREA: {
+						SelectionAreaData* data = readSelectionArea(change_node);
+						if (!data) {
+							success = false;
+							break;
+						}
+						Change* change = newd Change();
+						change->type = CHANGE_SELECT_AREA;
+						change->data = data;
+						action->addChange(change);
+						break;
+					}
+					case JOURNAL_MOVE_TILES: {
+						TileMoveData* data = readTileMove(map, change_node);
+						if (!data) {
+							success = false;
+							break;
+						}
+						Change* change = newd Change();
+						change->type = CHANGE_MOVE_TILES;
+						change->data = data;
+						action->addChange(change);
+						break;
+					}
+					default:
+						success = false;
+						break;
+				}
+			} while (success && change_node->advance());
+		} while (success && action_node->advance());
+	}
+
+	if (!success) {
+		spdlog::error("Corrupted record in undo journal {}", filename);
+		for (Action* action : restored) {
+			delete action;
+		}
+		return false;
+	}
+
+	batch->batch.swap(restored);
+	batch->journal_offset = -1;
+	return true;
+}
+
+void ActionJournal::writeTile(const Tile* tile) {
+	const Position &position = tile->getPosition();
+
+	writer.addNode(JOURNAL_TILE);
+	writer.addU16(position.x);
+	writer.addU16(position.y);
+	writer.addU8(position.z);
+	writer.addU16(tile->getMapFlags());
+	writer.addU16(tile->getStatFlags());
+	writer.addU32(tile->getHouseID());
+
+	// Selection is not part of the OTBM item node, keep it alongside
+	writer.addU8(tile->ground ? 1 : 0);
+	writer.addU32(tile->items.size());
+	if (tile->ground) {
+		writer.addU8(tile->ground->isSelected() ? 1 : 0);
+	}
+	for (const Item* item : tile->items) {
+		writer.addU8(item->isSelected() ? 1 : 0);
+	}
+
+	writer.addU8(tile->spawnMonster ? 1 : 0);
+	if (tile->spawnMonster) {
+		writer.addU32(tile->spawnMonster->getSize());
+		writer.addU8(tile->spawnMonster->isSelected() ? 1 : 0);
+	}
+	writer.addU8(tile->spawnNpc ? 1 : 0);
+	if (tile->spawnNpc) {
+		writer.addU32(tile->spawnNpc->getSize());
+		writer.addU8(tile->spawnNpc->isSelected() ? 1 : 0);
+	}
+
+	writer.addU16(tile->zones.size());
+	for (unsigned int zone : tile->zones) {
+		writer.addU32(zone);
+	}
+
+	if (tile->ground) {
+		tile->ground->serializeItemNode_OTBM(mapVersion, writer);
+	}
+	for (const Item* item : tile->items) {
+		item->serializeItemNode_OTBM(mapVersion, writer);
+	}
+
+	for (const Monster* monster : tile->monsters) {
+		writer.addNode(JOURNAL_MONSTER);
+		writer.addString(monster->getTypeName());
+		writer.addString(monster->getMapName());
+		writer.addU8(monster->getDirection());
+		writer.addU8(monster->getWeight());
+		writer.addU16(monster->getSpawnMonsterTime());
+		writer.addU8(monster->isSelected() ? 1 : 0);
+		writer.endNode();
+	}
+
+	if (tile->npc) {
+		writer.addNode(JOURNAL_NPC);
+		writer.addString(tile->npc->getTypeName());
+		writer.addString(tile->npc->getMapName());
+		writer.addU8(tile->npc->getDirection());
+		writer.addU32(tile->npc->getSpawnNpcTime());
+		writer.addU8(tile->npc->isSelected() ? 1 : 0);
+		writer.endNode();
+	}
+
+	writer.endNode();
+}
+
+Tile* ActionJournal::readTile(Map &map, BinaryNode* node) {
+	Position position;
+	uint16_t mapflags, statflags;
+	uint32_t house_id;
+	if (!readPosition(node, position) || !node->getU16(mapflags) || !node->getU16(statflags) || !node->getU32(house_id)) {
+		return nullptr;
+	}
+
+	uint8_t has_ground;
+	uint32_t item_count;
+	if (!node->getU8(has_ground) || !node->getU32(item_count)) {
+		return nullptr;
+	}
+
+	std::vector<uint8_t> selected(item_count + has_ground);
+	for (uint8_t &value : selected) {
+		if (!node->getU8(value)) {
+			return nullptr;
+		}
+	}
+
+	Tile* tile = map.allocator(map.createTileL(position));
+	tile->setMapFlags(mapflags);
+	tile->setStatFlags(statflags);
+	tile->house_id = house_id;
+
+	uint8_t present, is_selected;
+	uint32_t size;
+	if (!node->getU8(present)) {
+		delete tile;
+		return nullptr;
+	}
+	if (present) {
+		if (!node->getU32(size) || !node->getU8(is_selected)) {
+			delete tile;
+			return nullptr;
+		}
+		tile->spawnMonster = newd SpawnMonster(size);
+		if (is_selected) {
+			tile->spawnMonster->select();
+		}
+	}
+	if (!node->getU8(present)) {
+		delete tile;
+		return nullptr;
+	}
+	if (present) {
+		if (!node->getU32(size) || !node->getU8(is_selected)) {
+			delete tile;
+			return nullptr;
+		}
+		tile->spawnNpc = newd SpawnNpc(size);
+		if (is_selected) {
+			tile->spawnNpc->select();
+		}
+	}
+
+	uint16_t zone_count;
+	if (!node->getU16(zone_count)) {
+		delete tile;
+		return nullptr;
+	}
+	while (zone_count--) {
+		uint32_t zone;
+		if (!node->getU32(zone)) {
+			delete tile;
+			return nullptr;
+		}
+		tile->zones.insert(zone);
+	}
+
+	size_t item_index = 0;
+	BinaryNode* child = node->getChild();
+	if (child) {
+		do {
+			uint8_t child_type;
+			if (!child->getByte(child_type)) {
+				delete tile;
+				return nullptr;
+			}
+
+			if (child_type == OTBM_ITEM) {
+				Item* item = Item::Create_OTBM(mapVersion, child);
+				if (item) {
+					item->unserializeItemNode_OTBM(mapVersion, child);
+					if (item_index < selected.size() && selected[item_index]) {
+						item->select();
+					}
+					if (has_ground && item_index == 0) {
+						tile->ground = item;
+					} else {
+						tile->items.push_back(item);
+					}
+				}
+				++item_index;
+			} else if (child_type == JOURNAL_MONSTER) {
+				std::string type_name, map_name;
+				uint8_t direction, weight;
+				uint16_t spawntime;
+				if (!child->getString(type_name) || !child->getString(map_name) || !child->getU8(direction) || !child->getU8(weight) || !child->getU16(spawntime) || !child->getU8(is_selected)) {
+					delete tile;
+					return nullptr;
+				}
+				Monster* monster = newd Monster(type_name, weight);
+				monster->setMapName(map_name);
+				monster->setDirection(static_cast<Direction>(direction));
+				monster->setSpawnMonsterTime(spawntime);
+				if (is_selected) {
+					monster->select();
+				}
+				tile->monsters.push_back(monster);
+			} else if (child_type == JOURNAL_NPC) {
+				std::string type_name, map_name;
+				uint8_t direction;
+				uint32_t spawntime;
+				if (!child->getString(type_name) || !child->getString(map_name) || !child->getU8(direction) || !child->getU32(spawntime) || !child->getU8(is_selected)) {
+					delete tile;
+					return nullptr;
+				}
+				Npc* npc = newd Npc(type_name);
+				npc->setMapName(map_name);
+				npc->setDirection(static_cast<Direction>(direction));
+				npc->setSpawnNpcTime(spawntime);
+				if (is_selected) {
+					npc->select();
+				}
+				delete tile->npc;
+				tile->npc = npc;
+			}
+		} while (child->advance());
+	}
+
+	return tile;
+}
+
+void ActionJournal::writeSelectionArea(const SelectionAreaData* data) {
+	writer.addNode(JOURNAL_SELECTION_AREA);
+	writer.addU8(data->select ? 1 : 0);
+
+	const std::vector<SelectionRect> &rects = data->area.getRects();
+	writer.addU32(rects.size());
+	for (const SelectionRect &rect : rects) {
+		writer.addU16(rect.start_x);
+		writer.addU16(rect.start_y);
+		writer.addU16(rect.end_x);
+		writer.addU16(rect.end_y);
+		writer.addU8(rect.z);
+	}
+
+	writer.addU32(data->previous.size());
+	for (const TileSelectionState &state : data->previous) {
+		const Position &position = state.getPosition();
+		writer.addU16(position.x);
+		writer.addU16(position.y);
+		writer.addU8(position.z);
+
+		const std::vector<bool> &flags = state.getFlags();
+		writer.addU32(flags.size());
+		for (bool flag : flags) {
+			writer.addU8(flag ? 1 : 0);
+		}
+	}
+	writer.endNode();
+}
+
+SelectionAreaData* ActionJournal::readSelectionArea(BinaryNode* node) {
+	uint8_t select;
+	uint32_t rect_count;
+	if (!node->getU8(select) || !node->getU32(rect_count)) {
+		return nullptr;
+	}
+
+	std::vector<SelectionRect> rects;
+	rects.reserve(rect_count);
+	for (uint32_t index = 0; index < rect_count; ++index) {
+		uint16_t start_x, start_y, end_x, end_y;
+		uint8_t z;
+		if (!node->getU16(start_x) || !node->getU16(start_y) || !node->getU16(end_x) || !node->getU16(end_y) || !node->getU8(z)) {
+			return nullptr;
+		}
+		rects.push_back({ start_x, start_y, end_x, end_y, z });
+	}
+
+	uint32_t state_count;
+	if (!node->getU32(state_count)) {
+		return nullptr;
+	}
+
+	std::vector<TileSelectionState> previous;
+	previous.reserve(state_count);
+	for (uint32_t index = 0; index < state_count; ++index) {
+		Position position;
+		uint32_t flag_count;
+		if (!readPosition(node, position) || !node->getU32(flag_count)) {
+			return nullptr;
+		}
+
+		std::vector<bool> flags(flag_count);
+		for (uint32_t flag = 0; flag < flag_count; ++flag) {
+			uint8_t value;
+			if (!node->getU8(value)) {
+				return nullptr;
+			}
+			flags[flag] = value != 0;
+		}
+		previous.emplace_back(position, std::move(flags));
+	}
+
+	return newd SelectionAreaData { SelectionArea::fromDisjointRects(std::move(rects)), select != 0, std::move(previous) };
+}
+
+void ActionJournal::writeTileMove(const TileMoveData* data) {
+	writer.addNode(JOURNAL_MOVE_TILES);
+	writer.addU32(static_cast<uint32_t>(data->offset.x));
+	writer.addU32(static_cast<uint32_t>(data->offset.y));
+	writer.addU32(static_cast<uint32_t>(data->offset.z));
+
+	const std::vector<SelectionRect> &rects = data->area.getRects();
+	writer.addU32(rects.size());
+	for (const SelectionRect &rect : rects) {
+		writer.addU16(rect.start_x);
+		writer.addU16(rect.start_y);
+		writer.addU16(rect.end_x);
+		writer.addU16(rect.end_y);
+		writer.addU8(rect.z);
+	}
+
+	writer.addU32(data->unmodified.size());
+	for (const Position &position : data->unmodified) {
+		writer.addU16(position.x);
+		writer.addU16(position.y);
+		writer.addU8(position.z);
+	}
+
+	writer.addU32(data->houses.size());
+	for (const auto &[id, tiles] : data->houses) {
+		writer.addU32(id);
+		writer.addU32(tiles.size());
+		for (const Position &position : tiles) {
+			writer.addU16(position.x);
+			writer.addU16(position.y);
+			writer.addU8(position.z);
+		}
+	}
+
+	// The replaced tiles follow as child nodes
+	for (const Tile* tile : data->replaced) {
+		writeTile(tile);
+	}
+	writer.endNode();
+}
+
+TileMoveData* ActionJournal::readTileMove(Map &map, BinaryNode* node) {
+	uint32_t offset_x, offset_y, offset_z, rect_count;
+	if (!node->getU32(offset_x) || !node->getU32(offset_y) || !node->getU32(offset_z) || !node->getU32(rect_count)) {
+		return nullptr;
+	}
+
+	std::vector<SelectionRect> rects;
+	rects.reserve(rect_count);
+	for (uint32_t index = 0; index < rect_count; ++index) {
+		uint16_t start_x, start_y, end_x, end_y;
+		uint8_t z;
+		if (!node->getU16(start_x) || !node->getU16(start_y) || !node->getU16(end_x) || !node->getU16(end_y) || !node->getU8(z)) {
+			return nullptr;
+		}
+		rects.push_back({ start_x, start_y, end_x, end_y, z });
+	}
+
+	const Position offset(static_cast<int32_t>(offset_x), static_cast<int32_t>(offset_y), static_cast<int32_t>(offset_z));
+	TileMoveData* data = newd TileMoveData(SelectionArea::fromDisjointRects(std::move(rects)), offset);
+
+	uint32_t unmodified_count;
+	if (!node->getU32(unmodified_count)) {
+		delete data;
+		return nullptr;
+	}
+	data->unmodified.resize(unmodified_count);
+	for (Position &position : data->unmodified) {
+		if (!readPosition(node, position)) {
+			delete data;
+			return nullptr;
+		}
+	}
+
+	uint32_t house_count;
+	if (!node->getU32(house_count)) {
+		delete data;
+		return nullptr;
+	}
+	for (uint32_t index = 0; index < house_count; ++index) {
+		uint32_t id, tile_count;
+		if (!node->getU32(id) || !node->getU32(tile_count)) {
+			delete data;
+			return nullptr;
+		}
+
+		PositionList tiles;
+		for (uint32_t tile = 0; tile < tile_count; ++tile) {
+			Position position;
+			if (!readPosition(node, position)) {
+				delete data;
+				return nullptr;
+			}
+			tiles.push_back(position);
+		}
+		data->houses.emplace_back(id, std::move(tiles));
+	}
+
+	BinaryNode* child = node->getChild();
+	if (child) {
+		do {
+			uint8_t child_type;
+			Tile* tile = nullptr;
+			if (child->getByte(child_type) && child_type == JOURNAL_TILE) {
+				tile = readTile(map, child);
+			}
+			if (!tile) {
+				delete data;
+				return nullptr;
+			}
+			data->replaced.push_back(tile);
+		} while (child->advance());
+	}
+	return data;
+}
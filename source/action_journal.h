@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_ACTION_JOURNAL_H_
+#define RME_ACTION_JOURNAL_H_
+
+#include "action.h"
+#include "filehandle.h"
+#include "iomap.h"
+
+class Map;
+
+// Append-only, compressed store for undo history that no longer fits in memory.
+// A spilled batch keeps its type and label in memory, its actions are paged back
+// in from disk the first time they are needed again.
+class ActionJournal {
+public:
+	ActionJournal(const std::string &filename);
+	~ActionJournal();
+
+	ActionJournal(const ActionJournal &) = delete;
+	ActionJournal &operator=(const ActionJournal &) = delete;
+
+	bool isOk() const noexcept {
+		return stream.is_open() && stream.good();
+	}
+	const std::string &getFilename() const noexcept {
+		return filename;
+	}
+	uint64_t getSize() const noexcept {
+		return file_size;
+	}
+
+	// Writes all actions of the batch to disk and frees them
+	bool spill(BatchAction* batch);
+	// Reads the actions of a spilled batch back, creating them through the queue
+	bool restore(const ActionQueue &queue, Map &map, BatchAction* batch);
+	// Drops every record
+	void clear();
+
+protected:
+	void writeTile(const Tile* tile);
+	Tile* readTile(Map &map, BinaryNode* node);
+	void writeSelectionArea(const SelectionAreaData* data);
+	SelectionAreaData* readSelectionArea(BinaryNode* node);
+	void writeTileMove(const TileMoveData* data);
+	TileMoveData* readTileMove(Map &map, BinaryNode* node);
+
+	std::string filename;
+	std::fstream stream;
+	uint64_t file_size;
+
+	MemoryNodeFileWriteHandle writer;
+	VirtualIOMap mapVersion;
+	std::vector<uint8_t> buffer;
+};
+
+#endif
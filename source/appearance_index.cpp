@@ -0,0 +1,173 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "appearance_index.h"
+
+#include <appearances.pb.h>
+
+namespace {
+	enum WireType : uint8_t {
+		WIRE_VARINT = 0,
+		WIRE_FIXED64 = 1,
+		WIRE_LENGTH_DELIMITED = 2,
+		WIRE_FIXED32 = 5,
+	};
+
+	// Field numbers of the Appearances and Appearance messages
+	enum AppearanceField : uint32_t {
+		APPEARANCES_OBJECT = 1,
+		APPEARANCES_OUTFIT = 2,
+		APPEARANCES_EFFECT = 3,
+		APPEARANCES_MISSILE = 4,
+		APPEARANCE_ID = 1,
+	};
+
+	bool readVarint(const std::string &data, size_t &pos, size_t end, uint64_t &value) {
+		value = 0;
+		for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+			const uint8_t byte = static_cast<uint8_t>(data[pos++]);
+			value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Moves pos past the value of a field, for length delimited fields size gets its length
+	bool skipField(const std::string &data, size_t &pos, size_t end, uint8_t wireType, uint64_t &size) {
+		size = 0;
+		switch (wireType) {
+			case WIRE_VARINT: {
+				uint64_t value;
+				return readVarint(data, pos, end, value);
+			}
+			case WIRE_FIXED64:
+				pos += 8;
+				return pos <= end;
+			case WIRE_LENGTH_DELIMITED:
+				if (!readVarint(data, pos, end, size) || size > end - pos) {
+					return false;
+				}
+				pos += size;
+				return true;
+			case WIRE_FIXED32:
+				pos += 4;
+				return pos <= end;
+			default:
+				return false;
+		}
+	}
+
+	// Reads the id of an encoded Appearance without decoding the rest of it
+	bool readAppearanceId(const std::string &data, size_t pos, size_t end, uint32_t &id) {
+		id = 0;
+		while (pos < end) {
+			uint64_t tag;
+			if (!readVarint(data, pos, end, tag)) {
+				return false;
+			}
+
+			const uint8_t wireType = tag & 7;
+			if ((tag >> 3) == APPEARANCE_ID && wireType == WIRE_VARINT) {
+				uint64_t value;
+				if (!readVarint(data, pos, end, value)) {
+					return false;
+				}
+				// Like protobuf, the last occurrence wins
+				id = static_cast<uint32_t>(value);
+				continue;
+			}
+
+			uint64_t size;
+			if (!skipField(data, pos, end, wireType, size)) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+bool AppearanceIndex::load(std::string newData) {
+	clear();
+	if (newData.size() > UINT32_MAX) {
+		return false;
+	}
+	data = std::move(newData);
+
+	size_t pos = 0;
+	while (pos < data.size()) {
+		uint64_t tag;
+		if (!readVarint(data, pos, data.size(), tag)) {
+			clear();
+			return false;
+		}
+
+		uint64_t size;
+		const uint8_t wireType = tag & 7;
+		if (!skipField(data, pos, data.size(), wireType, size)) {
+			clear();
+			return false;
+		}
+
+		std::vector<Entry>* entries = nullptr;
+		switch (tag >> 3) {
+			case APPEARANCES_OBJECT:
+				entries = &objects;
+				break;
+			case APPEARANCES_OUTFIT:
+				entries = &outfits;
+				break;
+			case APPEARANCES_EFFECT:
+				entries = &effects;
+				break;
+			case APPEARANCES_MISSILE:
+				entries = &missiles;
+				break;
+			default:
+				break;
+		}
+		if (!entries || wireType != WIRE_LENGTH_DELIMITED) {
+			continue;
+		}
+
+		Entry entry;
+		entry.offset = static_cast<uint32_t>(pos - size);
+		entry.size = static_cast<uint32_t>(size);
+		if (!readAppearanceId(data, entry.offset, pos, entry.id)) {
+			clear();
+			return false;
+		}
+		entries->push_back(entry);
+	}
+	return true;
+}
+
+void AppearanceIndex::clear() {
+	std::string().swap(data);
+	std::vector<Entry>().swap(objects);
+	std::vector<Entry>().swap(outfits);
+	std::vector<Entry>().swap(effects);
+	std::vector<Entry>().swap(missiles);
+}
+
+bool AppearanceIndex::decode(const Entry &entry, rme::protobuf::appearances::Appearance &appearance) const {
+	if (static_cast<size_t>(entry.offset) + entry.size > data.size()) {
+		return false;
+	}
+	return appearance.ParseFromArray(data.data() + entry.offset, static_cast<int>(entry.size));
+}
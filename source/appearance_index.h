@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_APPEARANCE_INDEX_H_
+#define RME_APPEARANCE_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rme {
+	namespace protobuf {
+		namespace appearances {
+			class Appearance;
+		}
+	}
+}
+
+// Keeps the raw appearances file in memory along with where each appearance
+// starts and ends in it. Building the index only walks the protobuf wire format,
+// the appearances themselves are decoded one at a time when they are needed.
+class AppearanceIndex {
+public:
+	struct Entry {
+		uint32_t id = 0;
+		uint32_t offset = 0;
+		uint32_t size = 0;
+	};
+
+	// Takes the contents of the appearances file, returns false if it is malformed
+	bool load(std::string data);
+	void clear();
+
+	bool isLoaded() const noexcept {
+		return !data.empty();
+	}
+
+	const std::vector<Entry> &getObjects() const noexcept {
+		return objects;
+	}
+	const std::vector<Entry> &getOutfits() const noexcept {
+		return outfits;
+	}
+	const std::vector<Entry> &getEffects() const noexcept {
+		return effects;
+	}
+	const std::vector<Entry> &getMissiles() const noexcept {
+		return missiles;
+	}
+
+	bool decode(const Entry &entry, rme::protobuf::appearances::Appearance &appearance) const;
+
+protected:
+	std::string data;
+	std::vector<Entry> objects;
+	std::vector<Entry> outfits;
+	std::vector<Entry> effects;
+	std::vector<Entry> missiles;
+};
+
+#endif
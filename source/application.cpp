@@ -29,6 +29,9 @@
 #include "main_menubar.h"
 #include "updater.h"
 #include "artprovider.h"
+#include "benchmarks.h"
+#include "editor_tests.h"
+#include "map_image_renderer.h"
 
 #include "materials.h"
 #include "map.h"
@@ -151,7 +154,9 @@ bool Application::OnInit() {
 #endif
 
 	m_file_to_open = wxEmptyString;
-	ParseCommandLineMap(m_file_to_open);
+	if (!ParseCommandLineBenchmark() && !ParseCommandLineSelfTest() && !ParseCommandLineRenderMap()) {
+		ParseCommandLineMap(m_file_to_open);
+	}
 
 	g_gui.root = newd MainFrame(__W_RME_APPLICATION_NAME__, wxDefaultPosition, wxSize(700, 500));
 	SetTopWindow(g_gui.root);
@@ -165,7 +170,7 @@ bool Application::OnInit() {
 	wxIcon icon(rme_icon);
 	g_gui.root->SetIcon(icon);
 
-	if (g_settings.getInteger(Config::WELCOME_DIALOG) == 1 && m_file_to_open == wxEmptyString) {
+	if (g_settings.getInteger(Config::WELCOME_DIALOG) == 1 && m_file_to_open == wxEmptyString && m_benchmark_size == 0 && !m_selftest && m_render_map.empty()) {
 		g_gui.ShowWelcomeDialog(icon);
 	} else {
 		g_gui.root->Show();
@@ -270,6 +275,21 @@ void Application::OnEventLoopEnter(wxEventLoopBase* loop) {
 	}
 	m_startup = false;
 
+	if (m_benchmark_size > 0) {
+		RunBenchmarks();
+		return;
+	}
+
+	if (m_selftest) {
+		RunSelfTests();
+		return;
+	}
+
+	if (!m_render_map.empty()) {
+		RunRenderMap();
+		return;
+	}
+
 	// Open a map.
 	if (m_file_to_open != wxEmptyString) {
 		g_gui.LoadMap(FileName(m_file_to_open));
@@ -302,6 +322,12 @@ void Application::ShutdownServices() {
 #endif
 }
 
+int Application::OnRun() {
+	const int exitCode = wxApp::OnRun();
+	// CTest and scripts read the self test and render results from the exit code
+	return m_selftest_failed || m_render_failed ? EXIT_FAILURE : exitCode;
+}
+
 int Application::OnExit() {
 #ifdef _USE_PROCESS_COM
 	wxDELETE(m_proc_server);
@@ -322,6 +348,135 @@ bool Application::ParseCommandLineMap(wxString &fileName) {
 	return false;
 }
 
+bool Application::ParseCommandLineBenchmark() {
+	// --benchmark[=<map size>] [--benchmark-output=<file>]
+	for (int i = 1; i < argc; ++i) {
+		const wxString argument = argv[i];
+		wxString value;
+		if (argument == "--benchmark") {
+			m_benchmark_size = EditorBenchmarks::DefaultMapSize;
+		} else if (argument.StartsWith("--benchmark=", &value)) {
+			long size = 0;
+			m_benchmark_size = value.ToLong(&size) && size > 0 ? static_cast<int>(size) : EditorBenchmarks::DefaultMapSize;
+		} else if (argument.StartsWith("--benchmark-output=", &value)) {
+			m_benchmark_output = value;
+		}
+	}
+
+	if (m_benchmark_size > 0 && m_benchmark_output.empty()) {
+		m_benchmark_output = "benchmarks.json";
+	}
+	return m_benchmark_size > 0;
+}
+
+void Application::RunBenchmarks() {
+	bool success = false;
+	if (g_gui.NewMap()) {
+		Editor* editor = g_gui.GetCurrentEditor();
+		EditorBenchmarks benchmarks(m_benchmark_size);
+		success = benchmarks.run(*editor, m_benchmark_output);
+		// Nothing to save, close without asking
+		editor->clearChanges();
+		editor->clearActions();
+	}
+
+	spdlog::info("Benchmarks {}, results in {}", success ? "finished" : "failed", nstr(m_benchmark_output));
+	g_gui.root->Close(true);
+}
+
+bool Application::ParseCommandLineSelfTest() {
+	// --selftest[=<test name prefix>] [--selftest-output=<file>]
+	for (int i = 1; i < argc; ++i) {
+		const wxString argument = argv[i];
+		wxString value;
+		if (argument == "--selftest") {
+			m_selftest = true;
+		} else if (argument.StartsWith("--selftest=", &value)) {
+			m_selftest = true;
+			m_selftest_filter = value;
+		} else if (argument.StartsWith("--selftest-output=", &value)) {
+			m_selftest_output = value;
+		}
+	}
+
+	if (m_selftest && m_selftest_output.empty()) {
+		m_selftest_output = "selftest.json";
+	}
+	return m_selftest;
+}
+
+void Application::RunSelfTests() {
+	EditorTests tests(m_selftest_filter);
+	m_selftest_failed = !tests.run(m_selftest_output);
+
+	spdlog::info("Self tests {}, results in {}", m_selftest_failed ? "failed" : "passed", nstr(m_selftest_output));
+	g_gui.root->Close(true);
+}
+
+bool Application::ParseCommandLineRenderMap() {
+	// --render-map=<map file> [--render-floor=<floor>] [--render-area=<x1>,<y1>,<x2>,<y2>] [--render-output=<file>]
+	for (int i = 1; i < argc; ++i) {
+		const wxString argument = argv[i];
+		wxString value;
+		if (argument.StartsWith("--render-map=", &value)) {
+			m_render_map = value;
+		} else if (argument.StartsWith("--render-floor=", &value)) {
+			long floor = 0;
+			if (value.ToLong(&floor) && floor >= rme::MapMinLayer && floor <= rme::MapMaxLayer) {
+				m_render_floor = static_cast<int>(floor);
+			}
+		} else if (argument.StartsWith("--render-area=", &value)) {
+			m_render_area = value;
+		} else if (argument.StartsWith("--render-output=", &value)) {
+			m_render_output = value;
+		}
+	}
+
+	if (!m_render_map.empty() && m_render_output.empty()) {
+		m_render_output = "map.png";
+	}
+	return !m_render_map.empty();
+}
+
+void Application::RunRenderMap() {
+	bool success = false;
+	if (g_gui.LoadMap(FileName(m_render_map))) {
+		Editor* editor = g_gui.GetCurrentEditor();
+		Map &map = editor->getMap();
+
+		// The given area, or the whole floor without one
+		Position from(0, 0, m_render_floor);
+		Position to(0, 0, m_render_floor);
+		bool hasArea = false;
+		if (m_render_area.empty()) {
+			hasArea = MapImageRenderer::getFloorBounds(map, m_render_floor, from, to);
+		} else {
+			const wxArrayString values = wxSplit(m_render_area, ',');
+			long x1, y1, x2, y2;
+			hasArea = values.size() == 4 && values[0].ToLong(&x1) && values[1].ToLong(&y1) && values[2].ToLong(&x2) && values[3].ToLong(&y2);
+			if (hasArea) {
+				from = Position(std::min(x1, x2), std::min(y1, y2), m_render_floor);
+				to = Position(std::max(x1, x2), std::max(y1, y2), m_render_floor);
+			}
+		}
+
+		if (!hasArea) {
+			spdlog::error("Nothing to render, the area '{}' is invalid or floor {} is empty", nstr(m_render_area), m_render_floor);
+		} else {
+			MapImageRenderer renderer(map, false);
+			success = renderer.render(from, to, nstr(m_render_output));
+			if (!success) {
+				spdlog::error("Rendering the map failed: {}", renderer.getError());
+			}
+		}
+		editor->clearChanges();
+	}
+	m_render_failed = !success;
+
+	spdlog::info("Map image {}, written to {}", success ? "rendered" : "not rendered", nstr(m_render_output));
+	g_gui.root->Close(true);
+}
+
 MainFrame::MainFrame(const wxString &title, const wxPoint &pos, const wxSize &size) :
 	wxFrame((wxFrame*)nullptr, -1, title, pos, size, wxDEFAULT_FRAME_STYLE) {
 	// Receive idle events
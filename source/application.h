@@ -40,6 +40,7 @@ class Application : public wxApp {
 public:
 	~Application();
 	virtual bool OnInit();
+	virtual int OnRun();
 	virtual void OnEventLoopEnter(wxEventLoopBase* loop);
 	virtual void MacOpenFiles(const wxArrayString &fileNames);
 	virtual int OnExit();
@@ -49,7 +50,24 @@ public:
 private:
 	bool m_startup;
 	wxString m_file_to_open;
+	int m_benchmark_size = 0;
+	wxString m_benchmark_output;
+	bool m_selftest = false;
+	bool m_selftest_failed = false;
+	wxString m_selftest_filter;
+	wxString m_selftest_output;
+	wxString m_render_map;
+	wxString m_render_area;
+	wxString m_render_output;
+	int m_render_floor = rme::MapGroundLayer;
+	bool m_render_failed = false;
 	bool ParseCommandLineMap(wxString &fileName);
+	bool ParseCommandLineBenchmark();
+	bool ParseCommandLineSelfTest();
+	bool ParseCommandLineRenderMap();
+	void RunBenchmarks();
+	void RunSelfTests();
+	void RunRenderMap();
 
 	virtual void OnFatalException();
 
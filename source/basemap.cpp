@@ -23,6 +23,7 @@
 BaseMap::BaseMap() :
 	allocator(),
 	tilecount(0),
+	floor_tilecount {},
 	root(*this) {
 	////
 }
@@ -32,14 +33,45 @@ BaseMap::~BaseMap() {
 }
 
 void BaseMap::clear(bool del) {
-	PositionVector pos_vec;
-	for (MapIterator map_iter = begin(); map_iter != end(); ++map_iter) {
-		Tile* t = (*map_iter)->get();
-		pos_vec.push_back(t->getPosition());
-	}
-	for (PositionVector::iterator pos_iter = pos_vec.begin(); pos_iter != pos_vec.end(); ++pos_iter) {
-		setTile(*pos_iter, nullptr, del);
+	// Clearing a location doesn't change the tree structure, so it's safe to do while walking it
+	const auto clearLeaf = [this, del](QTreeNode* leaf) {
+		for (Floor* floor : leaf->array) {
+			if (!floor) {
+				continue;
+			}
+			for (TileLocation &location : floor->locs) {
+				if (!location.get()) {
+					continue;
+				}
+
+				const Position &position = location.getPosition();
+				Tile* old_tile = leaf->setTile(position.x, position.y, position.z, nullptr);
+				if (del) {
+					updateUniqueIds(old_tile, nullptr);
+					delete old_tile;
+				}
+			}
+		}
+	};
+	forEachLeaf(clearLeaf, 0, 0, 0xFFFF, 0xFFFF);
+}
+
+std::vector<MapPartition> BaseMap::getPartitions(size_t count) {
+	std::vector<QTreeNode*> leaves;
+	forEachLeaf([&leaves](QTreeNode* leaf) { leaves.push_back(leaf); }, 0, 0, 0xFFFF, 0xFFFF);
+
+	std::vector<MapPartition> partitions;
+	count = std::max<size_t>(1, std::min(count, leaves.size()));
+	partitions.reserve(count);
+
+	size_t first = 0;
+	for (size_t index = 0; index < count; ++index) {
+		const size_t last = leaves.size() * (index + 1) / count;
+		MapPartition &partition = partitions.emplace_back(index);
+		partition.leaves.assign(leaves.begin() + first, leaves.begin() + last);
+		first = last;
 	}
+	return partitions;
 }
 
 void BaseMap::clearVisible(uint32_t mask) {
@@ -107,8 +139,8 @@ void BaseMap::setTile(int x, int y, int z, Tile* new_tile, bool remove) {
 	QTreeNode* leaf = root.getLeafForce(x, y);
 	Tile* old_tile = leaf->setTile(x, y, z, new_tile);
 
-	if ((remove && old_tile) || new_tile) {
-		updateUniqueIds(remove ? old_tile : nullptr, new_tile);
+	if (old_tile || new_tile) {
+		updateUniqueIds(old_tile, new_tile);
 	}
 
 	if (remove) {
@@ -150,8 +182,9 @@ Tile* BaseMap::swapTile(const Position &position, Tile* new_tile) {
 // Iterators
 
 MapIterator::MapIterator(BaseMap* _map) :
-	local_i(0),
-	local_z(0),
+	leaf(nullptr),
+	local_i(-1),
+	local_z(-1),
 	current_tile(nullptr),
 	map(_map) {
 	////
@@ -161,73 +194,28 @@ MapIterator::~MapIterator() {
 	////
 }
 
-MapIterator::MapIterator(const MapIterator &other) {
-	for (std::vector<MapIterator::NodeIndex>::const_iterator it = other.nodestack.begin(); it != other.nodestack.end(); it++) {
-		nodestack.push_back(MapIterator::NodeIndex(*it));
-	}
-	local_i = other.local_i;
-	local_z = other.local_z;
-	map = other.map;
-	current_tile = other.current_tile;
+MapIterator::MapIterator(const MapIterator &other) :
+	nodestack(other.nodestack),
+	leaf(other.leaf),
+	local_i(other.local_i),
+	local_z(other.local_z),
+	current_tile(other.current_tile),
+	map(other.map) {
+	////
 }
 
 MapIterator BaseMap::begin() {
 	MapIterator it(this);
 	it.nodestack.push_back(MapIterator::NodeIndex(&root));
-
-	while (true) {
-		MapIterator::NodeIndex &current = it.nodestack.back();
-		QTreeNode* node = current.node;
-		int &index = current.index;
-		// printf("Contemplating %p of %p (stack size %d)\n", node, this, it.nodestack.size());
-
-		bool unwind = false;
-		for (; index < 16; ++index) {
-			// printf("\tChecking index %d of %p\n", index, node);
-			if (QTreeNode* child = node->child[index]) {
-				if (child->isLeaf) {
-					QTreeNode* leaf = child;
-					// printf("\t%p is leaf\n", child);
-					for (it.local_z = 0; it.local_z < rme::MapLayers; ++it.local_z) {
-						if (Floor* floor = leaf->array[it.local_z]) {
-							for (it.local_i = 0; it.local_i < 16; ++it.local_i) {
-								// printf("\tit(%d;%d;%d)\n", it.local_x, it.local_y, it.local_z);
-								TileLocation &t = floor->locs[it.local_i];
-								if (t.get()) {
-									// printf("return it\n");
-									it.current_tile = &t;
-									return it;
-								}
-							}
-						}
-					}
-				} else {
-					// printf("\tAdding %p\n", child);
-					++index;
-					it.nodestack.push_back(MapIterator::NodeIndex(child));
-					unwind = true;
-					break;
-				}
-			}
-		}
-		if (unwind) {
-			continue;
-		}
-
-		// printf("Discarding dead node %p\n", node);
-		it.nodestack.pop_back();
-		if (it.nodestack.empty()) {
-			break;
-		}
-	}
-	return end();
+	it.leaf = it.nextLeaf();
+	it.local_z = 0;
+	it.local_i = 0;
+	it.seek();
+	return it;
 }
 
 MapIterator BaseMap::end() {
-	MapIterator it(this);
-	it.local_i = -1;
-	it.local_z = -1;
-	return it;
+	return MapIterator(this);
 }
 
 TileLocation* MapIterator::operator*() {
@@ -238,78 +226,60 @@ TileLocation* MapIterator::operator->() {
 	return current_tile;
 }
 
-MapIterator &MapIterator::operator++() {
-	// printf("MapIterator::operator++");
-	bool increased = false;
-	bool first = true;
-	while (true) {
-		MapIterator::NodeIndex &current = nodestack.back();
-		QTreeNode* node = current.node;
-		int &index = current.index;
-		// printf("Contemplating %p (stack size %d)\n", node, nodestack.size());
-
-		bool unwind = false;
-		for (; index < rme::MapLayers; ++index) {
-			// printf("\tChecking index %d of %p\n", index, node);
-			if (QTreeNode* child = node->child[index]) {
-				if (child->isLeaf) {
-					QTreeNode* leaf = child;
-					// printf("\t%p is leaf\n", child);
-					for (; local_z < rme::MapLayers; ++local_z) {
-						// printf("\t\tIterating over Z:%d of %p", local_z, child);
-						if (Floor* floor = leaf->array[local_z]) {
-							// printf("\n");
-							for (; local_i < rme::MapLayers; ++local_i) {
-								// printf("\t\tIterating over Y:%d of %p\n", local_y, child);
-								TileLocation &t = floor->locs[local_i];
-								if (t.get()) {
-									if (increased) {
-										// printf("Modified %p to %p\n", current_tile, t);
-										current_tile = &t;
-										return *this;
-									} else {
-										increased = true;
-									}
-								} else if (first) {
-									increased = true;
-									first = false;
-								}
-							}
-
-							if (local_i > rme::MapMaxLayer) {
-								// printf("\t\tReset local_x\n");
-								local_i = 0;
-							}
-						} else {
-							// printf(":dead floor\n");
-						}
-					}
-					if (local_z == rme::MapLayers) {
-						// printf("\t\tReset local_z\n");
-						local_z = 0;
-					}
-				} else {
-					// printf("\tAdding %p\n", child);
-					++index;
-					nodestack.push_back(MapIterator::NodeIndex(child));
-					unwind = true;
-					break;
-				}
-			}
+QTreeNode* MapIterator::nextLeaf() {
+	while (!nodestack.empty()) {
+		NodeIndex &current = nodestack.back();
+		if (current.index >= rme::MapLayers) {
+			nodestack.pop_back();
+			continue;
 		}
-		if (unwind) {
+
+		QTreeNode* child = current.node->child[current.index++];
+		if (!child) {
 			continue;
 		}
 
-		// printf("Discarding dead node %p\n", node);
-		nodestack.pop_back();
-		if (nodestack.size() == 0) {
-			// Set all values to "end"
-			// printf("END\n");
-			local_z = -1;
-			local_i = -1;
-			return *this;
+		if (child->isLeaf) {
+			return child;
 		}
+		nodestack.push_back(NodeIndex(child));
+	}
+	return nullptr;
+}
+
+void MapIterator::seek() {
+	while (leaf) {
+		// Stay inside the floors of the current leaf as long as possible, the tree is only walked again once it's exhausted
+		for (; local_z < rme::MapLayers; ++local_z, local_i = 0) {
+			Floor* floor = leaf->array[local_z];
+			if (!floor) {
+				continue;
+			}
+
+			for (; local_i < rme::MapLayers; ++local_i) {
+				TileLocation &location = floor->locs[local_i];
+				if (location.get()) {
+					current_tile = &location;
+					return;
+				}
+			}
+		}
+
+		leaf = nextLeaf();
+		local_z = 0;
+		local_i = 0;
+	}
+
+	// Reached the end
+	local_z = -1;
+	local_i = -1;
+	current_tile = nullptr;
+}
+
+MapIterator &MapIterator::operator++() {
+	if (current_tile) {
+		++local_i;
+		seek();
 	}
 	return *this;
 }
@@ -31,6 +31,10 @@ class MapIterator;
 class Floor;
 class QTreeNode;
 class TileLocation;
+class MapPartition;
+
+// Tile locations of one floor of a quad tree leaf, indexed by (x & 3) * 4 + (y & 3)
+using FloorSpan = std::span<TileLocation, rme::MapLayers>;
 
 class MapIterator {
 public:
@@ -43,19 +47,7 @@ public:
 	MapIterator &operator++();
 	MapIterator operator++(int);
 	bool operator==(const MapIterator &other) const {
-		if (other.local_z != local_z) {
-			return false;
-		}
-		if (other.local_i != local_i) {
-			return false;
-		}
-		if (other.nodestack == nodestack) {
-			return true;
-		}
-		if (other.current_tile == current_tile) {
-			return true;
-		}
-		return false;
+		return other.current_tile == current_tile;
 	}
 	bool operator!=(const MapIterator &other) const {
 		return !(other == *this);
@@ -75,7 +67,13 @@ public:
 	};
 
 private:
+	// Advances to the next leaf of the tree, nullptr when there are no more
+	QTreeNode* nextLeaf();
+	// Moves to the first tile at or after the current leaf/floor/location
+	void seek();
+
 	std::vector<NodeIndex> nodestack;
+	QTreeNode* leaf;
 	int local_i, local_z;
 	TileLocation* current_tile;
 	BaseMap* map;
@@ -83,6 +81,32 @@ private:
 	friend class BaseMap;
 };
 
+// A contiguous run of quad tree leaves, visited by a single worker during a
+// parallel traversal. Partitions are created in MapIterator order, so merging
+// per-partition results by index gives the same order as a serial walk.
+class MapPartition {
+public:
+	MapPartition(size_t index) :
+		index(index) { }
+
+	size_t getIndex() const noexcept {
+		return index;
+	}
+	size_t getLeafCount() const noexcept {
+		return leaves.size();
+	}
+
+	// Calls foreach(Tile*) for every tile in the partition
+	template <typename ForeachType>
+	void forEachTile(ForeachType &&foreach) const;
+
+private:
+	size_t index;
+	std::vector<QTreeNode*> leaves;
+
+	friend class BaseMap;
+};
+
 class BaseMap {
 public:
 	BaseMap();
@@ -92,6 +116,17 @@ public:
 	void clear(bool del = true);
 	MapIterator begin();
 	MapIterator end();
+	// Splits the map into at most 'count' partitions of roughly equal leaf count
+	std::vector<MapPartition> getPartitions(size_t count);
+
+	// Calls foreach(FloorSpan) for every allocated floor with min_z <= z <= max_z, in MapIterator order.
+	// This is the fastest way to walk the map, spans may contain empty locations.
+	template <typename ForeachType>
+	void forEachFloor(ForeachType &&foreach, int min_z = 0, int max_z = rme::MapMaxLayer);
+	// Same as above, limited to the leaves intersecting the inclusive box [from, to]
+	// Leaves are 4x4 tiles, so locations just outside of the box may be visited, check positions if it matters.
+	template <typename ForeachType>
+	void forEachFloor(ForeachType &&foreach, const Position &from, const Position &to);
 	uint64_t size() const noexcept {
 		return tilecount;
 	}
@@ -131,6 +166,9 @@ public:
 	uint64_t getTileCount() const noexcept {
 		return tilecount;
 	}
+	uint64_t getTileCount(int z) const noexcept {
+		return floor_tilecount[z];
+	}
 
 public:
 	MapAllocator allocator;
@@ -138,13 +176,94 @@ public:
 protected:
 	virtual void updateUniqueIds(Tile* old_tile, Tile* new_tile) { }
 
+	// Calls foreach(QTreeNode*) for every leaf intersecting the inclusive x/y box, in MapIterator order
+	template <typename ForeachType>
+	void forEachLeaf(ForeachType &&foreach, int min_x, int min_y, int max_x, int max_y);
+
 	uint64_t tilecount;
+	uint64_t floor_tilecount[rme::MapLayers];
 
 	QTreeNode root; // The Quad Tree root
 
 	friend class QTreeNode;
 };
 
+template <typename ForeachType>
+inline void BaseMap::forEachLeaf(ForeachType &&foreach, int min_x, int min_y, int max_x, int max_y) {
+	struct Level {
+		QTreeNode* node;
+		int index;
+		int x, y;
+	};
+
+	// The root covers the whole 65536x65536 plane, every level splits it in 4x4 and leaves are 4x4 tiles
+	Level stack[8];
+	int depth = 0;
+	stack[0] = { &root, 0, 0, 0 };
+	while (depth >= 0) {
+		Level &level = stack[depth];
+		if (level.index == rme::MapLayers) {
+			--depth;
+			continue;
+		}
+
+		const int index = level.index++;
+		QTreeNode* child = level.node->child[index];
+		if (!child) {
+			continue;
+		}
+
+		const int size = 0x4000 >> (depth * 2);
+		const int x = level.x + (index & 3) * size;
+		const int y = level.y + (index >> 2) * size;
+		if (x > max_x || y > max_y || x + size <= min_x || y + size <= min_y) {
+			continue;
+		}
+
+		if (child->isLeaf) {
+			foreach(child);
+		} else {
+			stack[++depth] = { child, 0, x, y };
+		}
+	}
+}
+
+template <typename ForeachType>
+inline void BaseMap::forEachFloor(ForeachType &&foreach, int min_z, int max_z) {
+	forEachFloor(std::forward<ForeachType>(foreach), Position(0, 0, min_z), Position(0xFFFF, 0xFFFF, max_z));
+}
+
+template <typename ForeachType>
+inline void BaseMap::forEachFloor(ForeachType &&foreach, const Position &from, const Position &to) {
+	const int min_z = std::max(from.z, 0);
+	const int max_z = std::min(to.z, rme::MapMaxLayer);
+	const auto visitLeaf = [&](QTreeNode* leaf) {
+		for (int z = min_z; z <= max_z; ++z) {
+			if (Floor* floor = leaf->array[z]) {
+				foreach(FloorSpan(floor->locs));
+			}
+		}
+	};
+	forEachLeaf(visitLeaf, from.x, from.y, to.x, to.y);
+}
+
+template <typename ForeachType>
+inline void MapPartition::forEachTile(ForeachType &&foreach) const {
+	for (QTreeNode* leaf : leaves) {
+		for (int z = 0; z < rme::MapLayers; ++z) {
+			Floor* floor = leaf->getFloor(z);
+			if (!floor) {
+				continue;
+			}
+			for (TileLocation &location : floor->locs) {
+				if (Tile* tile = location.get()) {
+					foreach(tile);
+				}
+			}
+		}
+	}
+}
+
 inline Tile* BaseMap::getTile(int x, int y, int z) {
 	TileLocation* l = getTileL(x, y, z);
 	return l ? l->get() : nullptr;
@@ -0,0 +1,301 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "benchmarks.h"
+#include "brush.h"
+#include "copybuffer.h"
+#include "editor.h"
+#include "ground_brush.h"
+#include "gui.h"
+#include "iomap_otbm.h"
+#include "map.h"
+#include "selection.h"
+#include "tile.h"
+
+#include <wx/stdpaths.h>
+
+#ifdef __WINDOWS__
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+#include <chrono>
+#include <fstream>
+
+namespace {
+	constexpr int BenchmarkFloor = rme::MapGroundLayer;
+	constexpr int BenchmarkPatchSize = 16;
+	constexpr int BenchmarkStrokeRadius = 3;
+
+	// Highest resident memory of the process so far, in megabytes
+	double getPeakResidentMemory() {
+#ifdef __WINDOWS__
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+			return pmc.PeakWorkingSetSize / (1024.0 * 1024.0);
+		}
+		return 0.0;
+#else
+		rusage usage {};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return 0.0;
+		}
+	#ifdef __APPLE__
+		return usage.ru_maxrss / (1024.0 * 1024.0);
+	#else
+		return usage.ru_maxrss / 1024.0;
+	#endif
+#endif
+	}
+}
+
+EditorBenchmarks::EditorBenchmarks(int mapSize) :
+	mapSize(std::max(mapSize, 64)) {
+	////
+}
+
+template <typename Function>
+void EditorBenchmarks::measure(const std::string &name, size_t count, Function &&function) {
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	// The peak only grows, so a step that raises it shows how much memory it needed
+	const double peakMemory = getPeakResidentMemory();
+	spdlog::info("[EditorBenchmarks] {}: {:.2f} ms ({} items, peak {:.1f} MB)", name, elapsed.count(), count, peakMemory);
+	results.push_back({ { "name", name }, { "ms", elapsed.count() }, { "count", count }, { "peak_rss_mb", peakMemory } });
+}
+
+bool EditorBenchmarks::run(Editor &editor, const wxString &outputPath) {
+	// Same random choices on every run
+	mt_seed(0);
+	base = 1024;
+	results = nlohmann::json::array();
+
+	bool success = findGroundBrushes();
+	if (success) {
+		generateMap(editor);
+		borderizeMap(editor);
+		traverseMap(editor);
+		success = saveAndLoadMap(editor, wxStandardPaths::Get().GetTempDir());
+		drawGroundStroke(editor);
+		copyAndPaste(editor);
+	}
+
+	nlohmann::json document;
+	document["version"] = __RME_VERSION__;
+	document["map_size"] = mapSize;
+	document["success"] = success;
+	if (!error.empty()) {
+		document["error"] = error;
+	}
+	document["results"] = results;
+
+	std::ofstream file(nstr(outputPath), std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		spdlog::error("[EditorBenchmarks] Unable to write {}", nstr(outputPath));
+		return false;
+	}
+	file << document.dump(4) << std::endl;
+	return success;
+}
+
+bool EditorBenchmarks::findGroundBrushes() {
+	for (const auto &[name, brush] : g_brushes.getMap()) {
+		if (!brush->isGround() || !brush->asGround()->hasOuterBorder()) {
+			continue;
+		}
+		if (!groundBrush) {
+			groundBrush = brush->asGround();
+		} else if (!patchBrush) {
+			patchBrush = brush->asGround();
+			return true;
+		}
+	}
+	error = "The loaded version needs two bordered ground brushes";
+	return false;
+}
+
+void EditorBenchmarks::generateMap(Editor &editor) {
+	Map &map = editor.getMap();
+	measure("generate", static_cast<size_t>(mapSize) * mapSize, [&]() {
+		for (int x = base; x < base + mapSize; ++x) {
+			for (int y = base; y < base + mapSize; ++y) {
+				// Scattered patches of a second ground give the borders something to do
+				const int patchX = (x - base) / BenchmarkPatchSize;
+				const int patchY = (y - base) / BenchmarkPatchSize;
+				const bool patch = ((patchX * 7 + patchY * 13) % 5) == 0;
+
+				Tile* tile = map.createTile(x, y, BenchmarkFloor);
+				(patch ? patchBrush : groundBrush)->draw(&map, tile, nullptr);
+				tile->update();
+			}
+		}
+	});
+	map.invalidateIndexes();
+	map.doChange();
+}
+
+void EditorBenchmarks::borderizeMap(Editor &editor) {
+	Map &map = editor.getMap();
+	measure("borderize", static_cast<size_t>(mapSize) * mapSize, [&]() {
+		for (int x = base; x < base + mapSize; ++x) {
+			for (int y = base; y < base + mapSize; ++y) {
+				if (Tile* tile = map.getTile(x, y, BenchmarkFloor)) {
+					tile->borderize(&map);
+				}
+			}
+		}
+	});
+	map.invalidateIndexes();
+}
+
+void EditorBenchmarks::traverseMap(Editor &editor) {
+	size_t items = 0;
+	auto countItems = [&items](Map &, Tile* tile, long long) {
+		items += tile->size();
+	};
+
+	Map &map = editor.getMap();
+	measure("foreach_tile", map.getTileCount(), [&]() {
+		foreach_TileOnMap(map, countItems);
+	});
+
+	// The same walk through MapIterator and through forEachFloor, which goes over whole floors of a leaf
+	size_t iteratorItems = 0;
+	measure("map_iterator", map.getTileCount(), [&]() {
+		for (MapIterator it = map.begin(); it != map.end(); ++it) {
+			iteratorItems += (*it)->get()->size();
+		}
+	});
+
+	size_t floorItems = 0;
+	measure("for_each_floor", map.getTileCount(), [&]() {
+		map.forEachFloor([&floorItems](FloorSpan span) {
+			for (TileLocation &location : span) {
+				if (Tile* tile = location.get()) {
+					floorItems += tile->size();
+				}
+			}
+		});
+	});
+
+	if (iteratorItems != items || floorItems != items) {
+		error = fmt::format("The traversals counted {}, {} and {} items", items, iteratorItems, floorItems);
+		spdlog::error("[EditorBenchmarks] {}", error);
+	}
+}
+
+bool EditorBenchmarks::saveAndLoadMap(Editor &editor, const wxString &directory) {
+	Map &map = editor.getMap();
+	FileName file(directory, "rme-benchmark.otbm");
+
+	bool saved = false;
+	measure("otbm_save", map.getTileCount(), [&]() {
+		IOMapOTBM saver(map.getVersion());
+		saved = saver.saveMap(map, file);
+	});
+	if (!saved) {
+		error = "Could not save " + nstr(file.GetFullPath());
+		return false;
+	}
+
+	Map loaded;
+	bool success = false;
+	measure("otbm_load", map.getTileCount(), [&]() {
+		IOMapOTBM loader(map.getVersion());
+		success = loader.loadMap(loaded, file);
+	});
+	if (!success) {
+		error = "Could not load " + nstr(file.GetFullPath());
+	}
+
+	// A floor up, so the imported tiles land beside the generated ones instead of replacing them
+	const size_t tileCount = map.getTileCount();
+	if (success) {
+		measure("otbm_import", tileCount, [&]() {
+			success = editor.importMap(file, 0, 0, -1, IMPORT_INSERT, IMPORT_MERGE, IMPORT_MERGE, false);
+		});
+		if (!success) {
+			error = "Could not import " + nstr(file.GetFullPath());
+		}
+	}
+
+	wxRemoveFile(file.GetFullPath());
+	return success;
+}
+
+void EditorBenchmarks::drawGroundStroke(Editor &editor) {
+	// A brush stroke across the middle of the map, the way MapCanvas builds one
+	const int centerY = base + mapSize / 2;
+	PositionVector todraw;
+	PositionVector toborder;
+	for (int x = base; x < base + mapSize; ++x) {
+		for (int y = centerY - BenchmarkStrokeRadius - 1; y <= centerY + BenchmarkStrokeRadius + 1; ++y) {
+			toborder.emplace_back(x, y, BenchmarkFloor);
+			if (std::abs(y - centerY) <= BenchmarkStrokeRadius) {
+				todraw.emplace_back(x, y, BenchmarkFloor);
+			}
+		}
+	}
+
+	Brush* previousBrush = g_gui.GetCurrentBrush();
+	g_gui.SelectBrushInternal(patchBrush);
+	measure("ground_stroke", todraw.size(), [&]() {
+		editor.draw(todraw, toborder, false);
+	});
+	g_gui.SelectBrushInternal(previousBrush);
+
+	measure("undo_stroke", todraw.size(), [&]() {
+		editor.undo();
+	});
+	measure("redo_stroke", todraw.size(), [&]() {
+		editor.redo();
+	});
+}
+
+void EditorBenchmarks::copyAndPaste(Editor &editor) {
+	Selection &selection = editor.getSelection();
+	const int areaSize = mapSize / 2;
+
+	measure("select", static_cast<size_t>(areaSize) * areaSize, [&]() {
+		SelectionArea area;
+		area.add({ base, base, base + areaSize - 1, base + areaSize - 1, BenchmarkFloor });
+		selection.start();
+		selection.add(area);
+		selection.finish();
+	});
+
+	const size_t selected = selection.size();
+	measure("copy", selected, [&]() {
+		g_gui.copybuffer.copy(editor, BenchmarkFloor);
+	});
+	// Paste beside the generated map, so the batch creates every tile it touches
+	measure("paste", selected, [&]() {
+		g_gui.copybuffer.paste(editor, Position(base + mapSize + BenchmarkPatchSize, base, BenchmarkFloor));
+	});
+	measure("undo_paste", selected, [&]() {
+		editor.undo();
+	});
+	measure("redo_paste", selected, [&]() {
+		editor.redo();
+	});
+}
@@ -0,0 +1,57 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_BENCHMARKS_H_
+#define RME_BENCHMARKS_H_
+
+#include "main.h"
+
+class Editor;
+class GroundBrush;
+
+// Times the editor hot paths on a procedurally generated map and writes the
+// results as JSON. Started from the command line with --benchmark, see Application.
+class EditorBenchmarks {
+public:
+	EditorBenchmarks(int mapSize);
+
+	// Runs every benchmark on the current editor; false if one could not run
+	bool run(Editor &editor, const wxString &outputPath);
+
+	static constexpr int DefaultMapSize = 1024;
+
+protected:
+	template <typename Function>
+	void measure(const std::string &name, size_t count, Function &&function);
+
+	bool findGroundBrushes();
+	void generateMap(Editor &editor);
+	void borderizeMap(Editor &editor);
+	void traverseMap(Editor &editor);
+	bool saveAndLoadMap(Editor &editor, const wxString &directory);
+	void drawGroundStroke(Editor &editor);
+	void copyAndPaste(Editor &editor);
+
+	int mapSize;
+	int base = 0;
+	GroundBrush* groundBrush = nullptr;
+	GroundBrush* patchBrush = nullptr;
+	nlohmann::json results;
+	std::string error;
+};
+
+#endif
@@ -26,6 +26,49 @@
 #include "action.h"
 #include "gui.h"
 #include "settings.h"
+#include "threads.h"
+
+#include <bit>
+
+namespace {
+	// Pixels handed to a worker at once, a band is as many image rows as fit
+	constexpr int BitmapBandPixels = 65536;
+	// Distinct colours matched by a worker at once
+	constexpr size_t BitmapColorChunk = 4096;
+	// Colour table entries are 16 bits, with 0 meaning no brush
+	constexpr size_t BitmapMaxMappings = 0xFFFF;
+
+	// Colour table group of a 24-bit colour, its top 5 bits per channel
+	uint32_t getBitmapColorGroup(uint32_t color) {
+		return ((color >> 9) & 0x7C00) | ((color >> 6) & 0x03E0) | ((color >> 3) & 0x001F);
+	}
+
+	struct GroundPlacement {
+		Position position;
+		GroundBrush* brush;
+		// Copy of the tile already at the position with its borders cleaned, null if there is none
+		Tile* tile;
+	};
+
+	struct GroundBand {
+		int firstRow;
+		int lastRow;
+		int skipped = 0;
+		std::vector<GroundPlacement> placements;
+	};
+
+	struct BorderBand {
+		int firstRow;
+		int lastRow;
+		std::vector<TileLocation*> locations;
+		// Borderized copies, null where nothing changes
+		std::vector<Tile*> tiles;
+	};
+
+	size_t getConverterThreadCount() {
+		return std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+	}
+}
 
 BitmapToMapConverter::BitmapToMapConverter(Editor &editor) :
 	editor(editor) {
@@ -105,91 +148,169 @@ bool BitmapToMapConverter::isValidMapPosition(int x, int y, int z) const {
 	return x >= 0 && y >= 0 && x <= rme::MapMaxWidth && y <= rme::MapMaxHeight && z >= 0 && z <= rme::MapMaxLayer;
 }
 
-void BitmapToMapConverter::trackBorderNeighbors(int mapX, int mapY, int mapZ, std::set<Position> &borderPositions) const {
-	for (int dy = -1; dy <= 1; dy++) {
-		for (int dx = -1; dx <= 1; dx++) {
-			int bx = mapX + dx;
-			int by = mapY + dy;
-			if (isValidMapPosition(bx, by, mapZ)) {
-				borderPositions.insert(Position(bx, by, mapZ));
+GroundBrush* BitmapToMapConverter::ColorTable::getBrush(uint32_t color) const {
+	const uint32_t group = getBitmapColorGroup(color);
+	const auto first = colors.begin() + groups[group];
+	const auto last = colors.begin() + groups[group + 1];
+	const auto it = std::lower_bound(first, last, color);
+	if (it == last || *it != color) {
+		return nullptr;
+	}
+	return brushes[entries[it - colors.begin()]];
+}
+
+void BitmapToMapConverter::buildColorTable(const ConvertParams &params, ColorTable &table) const {
+	table.brushes.assign(1, nullptr);
+	for (const ColorMapping &mapping : params.mappings) {
+		Brush* brush = mapping.brushName.empty() ? nullptr : g_brushes.getBrush(mapping.brushName);
+		table.brushes.push_back(brush && brush->isGround() ? brush->asGround() : nullptr);
+	}
+
+	const int totalPixels = params.image.GetWidth() * params.image.GetHeight();
+	const unsigned char* imgData = params.image.GetData();
+	const unsigned char* alphaData = params.image.HasAlpha() ? params.image.GetAlpha() : nullptr;
+
+	// One bit per 24-bit colour, 2 MB
+	std::vector<uint64_t> used((1 << 24) / 64, 0);
+	for (int pixel = 0; pixel < totalPixels; ++pixel) {
+		if (alphaData && alphaData[pixel] < 128) {
+			continue;
+		}
+		const unsigned char* rgb = imgData + pixel * 3;
+		const uint32_t color = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
+		used[color / 64] |= uint64_t(1) << (color % 64);
+	}
+
+	// Counting sort into the groups, visiting the colours in order keeps each group sorted
+	const auto forEachUsedColor = [&used](auto &&function) {
+		for (uint32_t word = 0; word < used.size(); ++word) {
+			for (uint64_t bits = used[word]; bits != 0; bits &= bits - 1) {
+				function(word * 64 + std::countr_zero(bits));
 			}
 		}
+	};
+
+	table.groups.assign((1 << 15) + 1, 0);
+	forEachUsedColor([&](uint32_t color) {
+		++table.groups[getBitmapColorGroup(color) + 1];
+	});
+	for (size_t group = 1; group < table.groups.size(); ++group) {
+		table.groups[group] += table.groups[group - 1];
 	}
+
+	table.colors.resize(table.groups.back());
+	std::vector<uint32_t> next(table.groups.begin(), table.groups.end() - 1);
+	forEachUsedColor([&](uint32_t color) {
+		table.colors[next[getBitmapColorGroup(color)]++] = color;
+	});
+
+	table.entries.assign(table.colors.size(), 0);
+	RunParallelJobs(
+		(table.colors.size() + BitmapColorChunk - 1) / BitmapColorChunk, getConverterThreadCount(),
+		[&](size_t chunk) {
+			const size_t last = std::min(table.colors.size(), (chunk + 1) * BitmapColorChunk);
+			for (size_t index = chunk * BitmapColorChunk; index < last; ++index) {
+				const uint32_t color = table.colors[index];
+				const ColorMapping* mapping = findMatchingColor(color >> 16, (color >> 8) & 0xFF, color & 0xFF, params.mappings, params.tolerance, params.matchMode);
+				if (mapping) {
+					table.entries[index] = static_cast<uint16_t>(mapping - params.mappings.data() + 1);
+				}
+			}
+		},
+		[](size_t) { }
+	);
 }
 
 void BitmapToMapConverter::placeGroundTiles(
 	const ConvertParams &params,
+	const ColorTable &table,
 	BatchAction* batch,
-	std::set<Position> &borderPositions,
+	std::vector<uint8_t> &placed,
 	ConvertResult &result
 ) {
 	Map &map = editor.getMap();
-	int imgWidth = params.image.GetWidth();
-	int imgHeight = params.image.GetHeight();
-	int totalPixels = imgWidth * imgHeight;
-
-	Action* action = editor.createAction(batch);
+	const int imgWidth = params.image.GetWidth();
+	const int imgHeight = params.image.GetHeight();
+	const int maskWidth = imgWidth + 2;
 
 	const unsigned char* imgData = params.image.GetData();
-	bool hasAlpha = params.image.HasAlpha();
-	const unsigned char* alphaData = hasAlpha ? params.image.GetAlpha() : nullptr;
-
-	int pixelsDone = 0;
-	for (int py = 0; py < imgHeight; py++) {
-		for (int px = 0; px < imgWidth; px++) {
-			if (pixelsDone % 4096 == 0) {
-				g_gui.SetLoadDone(static_cast<int32_t>(50.0 * pixelsDone / totalPixels));
-			}
-			pixelsDone++;
-
-			if (hasAlpha && alphaData[py * imgWidth + px] < 128) {
-				result.tilesSkipped++;
-				continue;
-			}
-
-			int idx = (py * imgWidth + px) * 3;
-			uint8_t r = imgData[idx];
-			uint8_t g_color = imgData[idx + 1];
-			uint8_t b_color = imgData[idx + 2];
+	const unsigned char* alphaData = params.image.HasAlpha() ? params.image.GetAlpha() : nullptr;
 
-			const ColorMapping* mapping = findMatchingColor(r, g_color, b_color, params.mappings, params.tolerance, params.matchMode);
-			if (!mapping) {
-				result.tilesSkipped++;
-				continue;
-			}
-
-			Brush* brush = g_brushes.getBrush(mapping->brushName);
-			if (!brush || !brush->isGround()) {
-				result.tilesSkipped++;
-				continue;
-			}
+	Action* action = editor.createAction(batch);
 
-			int mapX = px + params.offsetX;
-			int mapY = py + params.offsetY;
-			int mapZ = params.offsetZ;
+	// Workers match the pixels of their rows and copy the tiles they replace, tiles are created
+	// and drawn here in pixel order so the random ground variations come out as before
+	const int rowsPerBand = std::max(1, BitmapBandPixels / std::max(imgWidth, 1));
+	const int bandCount = (imgHeight + rowsPerBand - 1) / rowsPerBand;
+	const size_t threadCount = getConverterThreadCount();
+	for (int firstBand = 0; firstBand < bandCount; firstBand += static_cast<int>(threadCount)) {
+		std::vector<GroundBand> bands(std::min<size_t>(threadCount, bandCount - firstBand));
+		for (size_t i = 0; i < bands.size(); ++i) {
+			bands[i].firstRow = (firstBand + static_cast<int>(i)) * rowsPerBand;
+			bands[i].lastRow = std::min(bands[i].firstRow + rowsPerBand, imgHeight) - 1;
+		}
 
-			if (!isValidMapPosition(mapX, mapY, mapZ)) {
-				result.tilesSkipped++;
-				continue;
+		RunParallelJobs(
+			bands.size(), threadCount,
+			[&](size_t index) {
+				GroundBand &band = bands[index];
+				// Neighbouring pixels mostly share a colour
+				uint32_t lastColor = 0;
+				GroundBrush* lastBrush = table.getBrush(lastColor);
+				for (int py = band.firstRow; py <= band.lastRow; py++) {
+					for (int px = 0; px < imgWidth; px++) {
+						const int pixel = py * imgWidth + px;
+						if (alphaData && alphaData[pixel] < 128) {
+							band.skipped++;
+							continue;
+						}
+
+						const unsigned char* rgb = imgData + pixel * 3;
+						const uint32_t color = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
+						if (color != lastColor) {
+							lastColor = color;
+							lastBrush = table.getBrush(color);
+						}
+						GroundBrush* brush = lastBrush;
+						if (!brush) {
+							band.skipped++;
+							continue;
+						}
+
+						const int mapX = px + params.offsetX;
+						const int mapY = py + params.offsetY;
+						if (!isValidMapPosition(mapX, mapY, params.offsetZ)) {
+							band.skipped++;
+							continue;
+						}
+
+						const Position pos(mapX, mapY, params.offsetZ);
+						Tile* new_tile = nullptr;
+						if (const Tile* tile = map.getTile(pos)) {
+							new_tile = tile->deepCopy(map);
+							new_tile->cleanBorders();
+						}
+						band.placements.push_back({ pos, brush, new_tile });
+					}
+				}
+			},
+			[&](size_t done) {
+				g_gui.SetLoadDone(static_cast<int32_t>(50.0 * (firstBand + done) / bandCount));
 			}
-
-			Position pos(mapX, mapY, mapZ);
-			TileLocation* location = map.createTileL(pos);
-			Tile* tile = location->get();
-			Tile* new_tile = nullptr;
-
-			if (tile) {
-				new_tile = tile->deepCopy(map);
-				new_tile->cleanBorders();
-			} else {
-				new_tile = map.allocator(location);
+		);
+
+		for (GroundBand &band : bands) {
+			result.tilesSkipped += band.skipped;
+			for (const GroundPlacement &placement : band.placements) {
+				Tile* new_tile = placement.tile ? placement.tile : map.allocator(map.createTileL(placement.position));
+				placement.brush->draw(&map, new_tile, nullptr);
+				action->addChange(newd Change(new_tile));
+				result.tilesPlaced++;
+
+				const int px = placement.position.x - params.offsetX;
+				const int py = placement.position.y - params.offsetY;
+				placed[(py + 1) * maskWidth + px + 1] = 1;
 			}
-
-			brush->asGround()->draw(&map, new_tile, nullptr);
-			action->addChange(newd Change(new_tile));
-			result.tilesPlaced++;
-
-			trackBorderNeighbors(mapX, mapY, mapZ, borderPositions);
 		}
 	}
 
@@ -197,39 +318,80 @@ void BitmapToMapConverter::placeGroundTiles(
 }
 
 void BitmapToMapConverter::borderizeTiles(
-	const std::set<Position> &borderPositions,
+	const ConvertParams &params,
+	const std::vector<uint8_t> &placed,
 	BatchAction* batch
 ) {
-	if (borderPositions.empty()) {
-		return;
-	}
-
 	Map &map = editor.getMap();
 	Action* action = editor.createAction(batch);
 
-	int bordersDone = 0;
-	auto totalBorders = static_cast<int>(borderPositions.size());
-
-	for (const Position &pos : borderPositions) {
-		if (bordersDone % 4096 == 0) {
-			g_gui.SetLoadDone(static_cast<int32_t>(50 + 49.0 * bordersDone / totalBorders));
+	// The mask has a one pixel margin around the image, every cell next to a placed pixel gets borderized
+	const int maskWidth = params.image.GetWidth() + 2;
+	const int maskHeight = params.image.GetHeight() + 2;
+	const auto touchesPlaced = [&](int x, int y) {
+		for (int dy = std::max(y - 1, 0); dy <= std::min(y + 1, maskHeight - 1); dy++) {
+			for (int dx = std::max(x - 1, 0); dx <= std::min(x + 1, maskWidth - 1); dx++) {
+				if (placed[dy * maskWidth + dx]) {
+					return true;
+				}
+			}
 		}
-		bordersDone++;
-
-		TileLocation* location = map.createTileL(pos);
-		Tile* tile = location->get();
-
-		if (tile) {
-			Tile* new_tile = tile->deepCopy(map);
-			new_tile->borderize(&map);
-			action->addChange(newd Change(new_tile));
-			continue;
+		return false;
+	};
+
+	// Locations are created here, the workers only borderize copies of the tiles
+	const int rowsPerBand = std::max(1, BitmapBandPixels / maskWidth);
+	const int bandCount = (maskHeight + rowsPerBand - 1) / rowsPerBand;
+	const size_t threadCount = getConverterThreadCount();
+	for (int firstBand = 0; firstBand < bandCount; firstBand += static_cast<int>(threadCount)) {
+		std::vector<BorderBand> bands(std::min<size_t>(threadCount, bandCount - firstBand));
+		for (size_t i = 0; i < bands.size(); ++i) {
+			BorderBand &band = bands[i];
+			band.firstRow = (firstBand + static_cast<int>(i)) * rowsPerBand;
+			band.lastRow = std::min(band.firstRow + rowsPerBand, maskHeight) - 1;
+			for (int y = band.firstRow; y <= band.lastRow; y++) {
+				for (int x = 0; x < maskWidth; x++) {
+					const int mapX = x - 1 + params.offsetX;
+					const int mapY = y - 1 + params.offsetY;
+					if (touchesPlaced(x, y) && isValidMapPosition(mapX, mapY, params.offsetZ)) {
+						band.locations.push_back(map.createTileL(mapX, mapY, params.offsetZ));
+					}
+				}
+			}
+			band.tiles.resize(band.locations.size(), nullptr);
 		}
 
-		std::unique_ptr<Tile> new_tile(map.allocator(location));
-		new_tile->borderize(&map);
-		if (!new_tile->empty()) {
-			action->addChange(newd Change(new_tile.release()));
+		RunParallelJobs(
+			bands.size(), threadCount,
+			[&](size_t index) {
+				BorderBand &band = bands[index];
+				for (size_t i = 0; i < band.locations.size(); ++i) {
+					TileLocation* location = band.locations[i];
+					if (const Tile* tile = location->get()) {
+						Tile* new_tile = tile->deepCopy(map);
+						new_tile->borderize(&map);
+						band.tiles[i] = new_tile;
+						continue;
+					}
+
+					std::unique_ptr<Tile> new_tile(map.allocator(location));
+					new_tile->borderize(&map);
+					if (!new_tile->empty()) {
+						band.tiles[i] = new_tile.release();
+					}
+				}
+			},
+			[&](size_t done) {
+				g_gui.SetLoadDone(static_cast<int32_t>(50 + 49.0 * (firstBand + done) / bandCount));
+			}
+		);
+
+		for (const BorderBand &band : bands) {
+			for (Tile* new_tile : band.tiles) {
+				if (new_tile) {
+					action->addChange(newd Change(new_tile));
+				}
+			}
 		}
 	}
 
@@ -258,14 +420,23 @@ ConvertResult BitmapToMapConverter::convert(
 		return result;
 	}
 
+	if (mappings.size() >= BitmapMaxMappings) {
+		result.errorMessage = "Too many color mappings.";
+		return result;
+	}
+
 	g_gui.CreateLoadBar("Generating map from bitmap...");
 
 	BatchAction* batch = editor.createBatch(ACTION_DRAW);
-	std::set<Position> borderPositions;
+	std::vector<uint8_t> placed((image.GetWidth() + 2) * (image.GetHeight() + 2), 0);
 
 	ConvertParams params { image, mappings, tolerance, matchMode, offsetX, offsetY, offsetZ };
-	placeGroundTiles(params, batch, borderPositions, result);
-	borderizeTiles(borderPositions, batch);
+	ColorTable table;
+	buildColorTable(params, table);
+	placeGroundTiles(params, table, batch, placed, result);
+	if (result.tilesPlaced > 0) {
+		borderizeTiles(params, placed, batch);
+	}
 
 	editor.addBatch(batch);
 	editor.updateActions();
@@ -22,7 +22,6 @@
 #include <wx/image.h>
 #include <string>
 #include <vector>
-#include <set>
 
 #include "position.h"
 
@@ -30,6 +29,7 @@ static constexpr float kAchromaticDelta = 0.05f;
 
 class BatchAction;
 class Editor;
+class GroundBrush;
 
 enum class MatchMode {
 	MATCH_PIXEL_RGB = 0,
@@ -77,8 +77,6 @@ private:
 
 	bool isValidMapPosition(int x, int y, int z) const;
 
-	void trackBorderNeighbors(int mapX, int mapY, int mapZ, std::set<Position> &borderPositions) const;
-
 	struct ConvertParams {
 		const wxImage &image;
 		const std::vector<ColorMapping> &mappings;
@@ -89,15 +87,36 @@ private:
 		int offsetZ;
 	};
 
+	// Brush of every colour used by the image, so each colour is matched once instead of once per pixel
+	struct ColorTable {
+		// The colours used as (r << 16) | (g << 8) | b, grouped by their top 5 bits per
+		// channel and sorted within a group. An image rarely uses many, so this stays small.
+		std::vector<uint32_t> colors;
+		// Index into brushes of each colour
+		std::vector<uint16_t> entries;
+		// Offset in colors of each 15-bit group, with the end of the last one at the back
+		std::vector<uint32_t> groups;
+		// The ground brush of each mapping, shifted by one so index 0 means no brush
+		std::vector<GroundBrush*> brushes;
+
+		// Brush of a colour used by the image, null if it matches no mapping
+		GroundBrush* getBrush(uint32_t color) const;
+	};
+
+	void buildColorTable(const ConvertParams &params, ColorTable &table) const;
+
+	// Marks the placed pixels with a one pixel margin, so the border pass knows which tiles to touch
 	void placeGroundTiles(
 		const ConvertParams &params,
+		const ColorTable &table,
 		BatchAction* batch,
-		std::set<Position> &borderPositions,
+		std::vector<uint8_t> &placed,
 		ConvertResult &result
 	);
 
 	void borderizeTiles(
-		const std::set<Position> &borderPositions,
+		const ConvertParams &params,
+		const std::vector<uint8_t> &placed,
 		BatchAction* batch
 	);
 };
@@ -58,6 +58,7 @@ Brushes::~Brushes() {
 }
 
 void Brushes::clear() {
+	GroundBrush::clearBorderTable();
 	for (auto brushEntry : brushes) {
 		delete brushEntry.second;
 	}
@@ -94,6 +95,8 @@ void Brushes::init() {
 	WallBrush::init();
 	TableBrush::init();
 	CarpetBrush::init();
+
+	GroundBrush::buildBorderTable();
 }
 
 bool Brushes::unserializeBrush(pugi::xml_node node, wxArrayString &warnings) {
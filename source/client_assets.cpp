@@ -102,50 +102,44 @@ bool ClientAssets::loadAppearanceProtobuf(wxString &error, wxArrayString &warnin
 
 	const std::string appearanceFileName = g_spriteAppearances.getAppearanceFileName();
 
-	std::fstream fileStream(assetsDirectory + appearanceFileName, std::ios::in | std::ios::binary);
+	std::ifstream fileStream(assetsDirectory + appearanceFileName, std::ios::in | std::ios::binary | std::ios::ate);
 	if (!fileStream.is_open()) {
 		error = "Failed to load " + appearanceFileName + " from the client folder, file cannot be oppened";
 		spdlog::error("[{}] - Failed to load {}, file cannot be oppened", __func__, appearanceFileName);
-		fileStream.close();
 		return false;
 	}
 
+	std::string appearancesData(static_cast<size_t>(fileStream.tellg()), '\0');
+	fileStream.seekg(0);
+	fileStream.read(appearancesData.data(), appearancesData.size());
+	fileStream.close();
+
 	// Verify that the version of the library that we linked against is
 	// compatible with the version of the headers we compiled against.
 	GOOGLE_PROTOBUF_VERIFY_VERSION;
-	g_gui.m_appearancesPtr = std::make_unique<Appearances>();
-	if (!g_gui.m_appearancesPtr->ParseFromIstream(&fileStream)) {
+
+	// Only the positions of the appearances are read here, items are decoded right
+	// away since everything else depends on them, outfits when they are first drawn
+	AppearanceIndex &appearances = g_gui.gfx.getAppearanceIndex();
+	if (!appearances.load(std::move(appearancesData))) {
 		error = "Failed to parse binary file " + appearanceFileName + ", file is invalid";
 		spdlog::error("[{}] - Failed to parse binary file {}, file is invalid", __func__, appearanceFileName);
-		fileStream.close();
 		return false;
 	}
 
 	// Parsing all items into ItemType
-	bool rt = g_items.loadFromProtobuf(error, warnings, *g_gui.m_appearancesPtr);
+	bool rt = g_items.loadFromProtobuf(error, warnings, appearances);
 	if (!rt) {
 		error = "Failed to parse item types from protobuf";
 		spdlog::error("[{}] - Failed to parse item types from protobuf", __func__);
-		fileStream.close();
 		return false;
 	}
 
-	// Load looktypes
-	for (int i = 0; i < g_gui.m_appearancesPtr->outfit().size(); i++) {
-		const auto &outfit = g_gui.m_appearancesPtr->outfit().Get(i);
-		if (!g_gui.gfx.loadOutfitSpriteMetadata(outfit, error, warnings)) {
-			error = "Failed to parse outfit types from protobuf";
-			spdlog::error("[{}] - Failed to parse outfit types from protobuf", __func__);
-			fileStream.close();
-			return false;
-		}
+	// Reserve looktypes
+	for (const AppearanceIndex::Entry &outfit : appearances.getOutfits()) {
+		g_gui.gfx.addLazyOutfit(outfit);
 	}
 
-	fileStream.close();
-
-	// Disposing allocated objects.
-	google::protobuf::ShutdownProtobufLibrary();
-
 	// Client loaded
 	setLoaded(true);
 	return true;
@@ -258,47 +258,57 @@ void CopyBuffer::paste(Editor &editor, const Position &toPosition) {
 
 	Map &map = editor.getMap();
 
+	const bool merge_paste = g_settings.getInteger(Config::MERGE_PASTE);
+	const Position offset = toPosition - copyPos;
+	// Positions around the pasted area, neighbours inside of it are pasted themselves
+	PositionVector surrounding;
+
 	BatchAction* batchAction = editor.createBatch(ACTION_PASTE_TILES);
 	Action* action = editor.createAction(batchAction);
 	for (MapIterator it = tiles->begin(); it != tiles->end(); ++it) {
-		Tile* buffer_tile = (*it)->get();
-		Position pos = buffer_tile->getPosition() - copyPos + toPosition;
+		const Tile* buffer_tile = (*it)->get();
+		Position pos = buffer_tile->getPosition() + offset;
 
 		if (!pos.isValid()) {
 			continue;
 		}
 
 		TileLocation* location = map.createTileL(pos);
-		Tile* copy_tile = buffer_tile->deepCopy(map);
-		Tile* old_dest_tile = location->get();
 		Tile* new_dest_tile = nullptr;
-		copy_tile->setLocation(location);
 
-		if (g_settings.getInteger(Config::MERGE_PASTE) || !copy_tile->ground) {
+		if (merge_paste || !buffer_tile->ground) {
+			Tile* old_dest_tile = location->get();
 			if (old_dest_tile) {
 				new_dest_tile = old_dest_tile->deepCopy(map);
 			} else {
 				new_dest_tile = map.allocator(location);
 			}
-			new_dest_tile->merge(copy_tile);
-			delete copy_tile;
+			new_dest_tile->mergeCopy(buffer_tile);
 		} else {
 			// If the copied tile has ground, replace target tile
-			new_dest_tile = copy_tile;
+			new_dest_tile = buffer_tile->deepCopy(map);
+			new_dest_tile->setLocation(location);
 		}
 
-		// Add all surrounding tiles to the map, so they get borders
-		map.createTile(pos.x - 1, pos.y - 1, pos.z);
-		map.createTile(pos.x, pos.y - 1, pos.z);
-		map.createTile(pos.x + 1, pos.y - 1, pos.z);
-		map.createTile(pos.x - 1, pos.y, pos.z);
-		map.createTile(pos.x + 1, pos.y, pos.z);
-		map.createTile(pos.x - 1, pos.y + 1, pos.z);
-		map.createTile(pos.x, pos.y + 1, pos.z);
-		map.createTile(pos.x + 1, pos.y + 1, pos.z);
+		for (int y = -1; y <= 1; ++y) {
+			for (int x = -1; x <= 1; ++x) {
+				if ((x != 0 || y != 0) && !tiles->getTile(buffer_tile->getX() + x, buffer_tile->getY() + y, buffer_tile->getZ())) {
+					surrounding.emplace_back(pos.x + x, pos.y + y, pos.z);
+				}
+			}
+		}
 
 		action->addChange(newd Change(new_dest_tile));
 	}
+
+	// Add the surrounding tiles to the map, so they get borders
+	std::sort(surrounding.begin(), surrounding.end());
+	surrounding.erase(std::unique(surrounding.begin(), surrounding.end()), surrounding.end());
+	for (const Position &position : surrounding) {
+		if (position.isValid()) {
+			map.createTile(position.x, position.y, position.z);
+		}
+	}
 	batchAction->addAndCommitAction(action);
 
 	if (g_settings.getInteger(Config::USE_AUTOMAGIC) && g_settings.getInteger(Config::BORDERIZE_PASTE)) {
@@ -45,6 +45,9 @@ public:
 
 private:
 	Position copyPos;
+	// A deep copy of the selection, which the paste preview draws as is. The copied tiles
+	// are not shared with the map: borderizeMap, randomizeMap and the map cleanup tools edit
+	// tiles and items in place, so shared tiles would need a copy-on-write check in each of them.
 	BaseMap* tiles;
 };
 
@@ -0,0 +1,415 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "data_snapshot.h"
+#include "items.h"
+#include "monsters.h"
+#include "npcs.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+	constexpr char SnapshotMagic[8] = { 'R', 'M', 'E', 'S', 'N', 'A', 'P', '\0' };
+	// Bump whenever the layout below, or what the parsers produce, changes
+	constexpr uint32_t SnapshotVersion = 1;
+
+	enum ItemFieldFlags : uint16_t {
+		ITEM_FIELD_READABLE = 1 << 0,
+		ITEM_FIELD_WRITEABLE = 1 << 1,
+		ITEM_FIELD_DECAYS = 1 << 2,
+		ITEM_FIELD_DIST_READ = 1 << 3,
+		ITEM_FIELD_CHARGEABLE = 1 << 4,
+		ITEM_FIELD_FLOOR_CHANGE = 1 << 5,
+		ITEM_FIELD_FLOOR_CHANGE_DOWN = 1 << 6,
+		ITEM_FIELD_FLOOR_CHANGE_NORTH = 1 << 7,
+		ITEM_FIELD_FLOOR_CHANGE_SOUTH = 1 << 8,
+		ITEM_FIELD_FLOOR_CHANGE_EAST = 1 << 9,
+		ITEM_FIELD_FLOOR_CHANGE_WEST = 1 << 10,
+	};
+
+	class SnapshotWriter {
+	public:
+		template <typename T>
+		void add(T value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto bytes = reinterpret_cast<const uint8_t*>(&value);
+			data.insert(data.end(), bytes, bytes + sizeof(T));
+		}
+		void addString(const std::string &str) {
+			add<uint32_t>(str.size());
+			data.insert(data.end(), str.begin(), str.end());
+		}
+
+		std::vector<uint8_t> data;
+	};
+
+	class SnapshotReader {
+	public:
+		SnapshotReader(const std::vector<uint8_t> &data) :
+			position(data.data()), end(data.data() + data.size()) { }
+
+		template <typename T>
+		bool get(T &value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (static_cast<size_t>(end - position) < sizeof(T)) {
+				return false;
+			}
+			memcpy(&value, position, sizeof(T));
+			position += sizeof(T);
+			return true;
+		}
+		bool getString(std::string &str) {
+			uint32_t size;
+			if (!get(size) || static_cast<size_t>(end - position) < size) {
+				return false;
+			}
+			str.assign(reinterpret_cast<const char*>(position), size);
+			position += size;
+			return true;
+		}
+		bool getBytes(const std::vector<uint8_t> &expected) {
+			if (static_cast<size_t>(end - position) < expected.size() || memcmp(position, expected.data(), expected.size()) != 0) {
+				return false;
+			}
+			position += expected.size();
+			return true;
+		}
+		bool atEnd() const noexcept {
+			return position == end;
+		}
+
+	private:
+		const uint8_t* position;
+		const uint8_t* end;
+	};
+
+	// FNV-1a, only used to notice edits that keep the size and time stamp
+	uint64_t hashFile(const std::filesystem::path &path) {
+		std::ifstream stream(path, std::ios::binary);
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		std::vector<char> buffer(64 * 1024);
+		while (stream) {
+			stream.read(buffer.data(), buffer.size());
+			const auto count = stream.gcount();
+			for (std::streamsize i = 0; i < count; ++i) {
+				hash ^= static_cast<uint8_t>(buffer[i]);
+				hash *= 0x100000001B3ULL;
+			}
+		}
+		return hash;
+	}
+
+	void writeOutfit(SnapshotWriter &writer, const Outfit &outfit) {
+		writer.addString(outfit.name);
+		writer.add<int32_t>(outfit.lookType);
+		writer.add<int32_t>(outfit.lookItem);
+		writer.add<int32_t>(outfit.lookMount);
+		writer.add<int32_t>(outfit.lookAddon);
+		writer.add<int32_t>(outfit.lookHead);
+		writer.add<int32_t>(outfit.lookBody);
+		writer.add<int32_t>(outfit.lookLegs);
+		writer.add<int32_t>(outfit.lookFeet);
+	}
+
+	bool readOutfit(SnapshotReader &reader, Outfit &outfit) {
+		return reader.getString(outfit.name) && reader.get(outfit.lookType) && reader.get(outfit.lookItem) && reader.get(outfit.lookMount) && reader.get(outfit.lookAddon) && reader.get(outfit.lookHead) && reader.get(outfit.lookBody) && reader.get(outfit.lookLegs) && reader.get(outfit.lookFeet);
+	}
+
+	template <typename Database>
+	void writeCreatures(SnapshotWriter &writer, Database &database) {
+		writer.add<uint32_t>(std::distance(database.begin(), database.end()));
+		for (const auto &[key, type] : database) {
+			writer.addString(type->name);
+			writer.add<uint8_t>(type->standard);
+			writeOutfit(writer, type->outfit);
+		}
+	}
+
+	struct CreatureEntry {
+		std::string name;
+		uint8_t standard = 0;
+		Outfit outfit;
+	};
+
+	bool readCreatures(SnapshotReader &reader, std::vector<CreatureEntry> &creatures) {
+		uint32_t count;
+		if (!reader.get(count)) {
+			return false;
+		}
+		creatures.resize(count);
+		for (CreatureEntry &creature : creatures) {
+			if (!reader.getString(creature.name) || !reader.get(creature.standard) || !readOutfit(reader, creature.outfit)) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+DataSnapshot::DataSnapshot(const FileName &filename) :
+	filename(filename) {
+	////
+}
+
+void DataSnapshot::addSource(const FileName &source) {
+	Source entry;
+	entry.path = nstr(source.GetFullPath());
+
+	std::error_code ec;
+	const std::filesystem::path path(entry.path);
+	if (std::filesystem::is_regular_file(path, ec)) {
+		entry.exists = true;
+		entry.size = std::filesystem::file_size(path, ec);
+		entry.modified = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+		entry.hash = hashFile(path);
+	}
+	sources.push_back(std::move(entry));
+}
+
+std::vector<uint8_t> DataSnapshot::getHeader() const {
+	SnapshotWriter writer;
+	for (char c : SnapshotMagic) {
+		writer.add(c);
+	}
+	writer.add(SnapshotVersion);
+	writer.add<uint32_t>(sources.size());
+	for (const Source &source : sources) {
+		writer.addString(source.path);
+		writer.add<uint8_t>(source.exists);
+		writer.add(source.size);
+		writer.add(source.modified);
+		writer.add(source.hash);
+	}
+	return writer.data;
+}
+
+DataSnapshot::ItemFields DataSnapshot::getItemFields(const ItemType &type) {
+	ItemFields fields;
+	fields.id = type.id;
+	fields.name = type.name;
+	fields.editorsuffix = type.editorsuffix;
+	fields.description = type.description;
+	fields.weight = type.weight;
+	fields.armor = type.armor;
+	fields.defense = type.defense;
+	fields.rotateTo = type.rotateTo;
+	fields.volume = type.volume;
+	fields.maxTextLen = type.maxTextLen;
+	fields.charges = type.charges;
+	fields.group = type.group;
+	fields.type = type.type;
+	fields.flags = (type.canReadText ? ITEM_FIELD_READABLE : 0)
+		| (type.canWriteText ? ITEM_FIELD_WRITEABLE : 0)
+		| (type.decays ? ITEM_FIELD_DECAYS : 0)
+		| (type.allowDistRead ? ITEM_FIELD_DIST_READ : 0)
+		| (type.extra_chargeable ? ITEM_FIELD_CHARGEABLE : 0)
+		| (type.floorChange ? ITEM_FIELD_FLOOR_CHANGE : 0)
+		| (type.floorChangeDown ? ITEM_FIELD_FLOOR_CHANGE_DOWN : 0)
+		| (type.floorChangeNorth ? ITEM_FIELD_FLOOR_CHANGE_NORTH : 0)
+		| (type.floorChangeSouth ? ITEM_FIELD_FLOOR_CHANGE_SOUTH : 0)
+		| (type.floorChangeEast ? ITEM_FIELD_FLOOR_CHANGE_EAST : 0)
+		| (type.floorChangeWest ? ITEM_FIELD_FLOOR_CHANGE_WEST : 0);
+	return fields;
+}
+
+void DataSnapshot::setItemFields(ItemType &type, const ItemFields &fields) {
+	type.name = fields.name;
+	type.editorsuffix = fields.editorsuffix;
+	type.description = fields.description;
+	type.weight = fields.weight;
+	type.armor = fields.armor;
+	type.defense = fields.defense;
+	type.rotateTo = fields.rotateTo;
+	type.volume = fields.volume;
+	type.maxTextLen = fields.maxTextLen;
+	type.charges = fields.charges;
+	type.group = static_cast<ItemGroup_t>(fields.group);
+	type.type = static_cast<ItemTypes_t>(fields.type);
+	type.canReadText = fields.flags & ITEM_FIELD_READABLE;
+	type.canWriteText = fields.flags & ITEM_FIELD_WRITEABLE;
+	type.decays = fields.flags & ITEM_FIELD_DECAYS;
+	type.allowDistRead = fields.flags & ITEM_FIELD_DIST_READ;
+	type.extra_chargeable = fields.flags & ITEM_FIELD_CHARGEABLE;
+	type.floorChange = fields.flags & ITEM_FIELD_FLOOR_CHANGE;
+	type.floorChangeDown = fields.flags & ITEM_FIELD_FLOOR_CHANGE_DOWN;
+	type.floorChangeNorth = fields.flags & ITEM_FIELD_FLOOR_CHANGE_NORTH;
+	type.floorChangeSouth = fields.flags & ITEM_FIELD_FLOOR_CHANGE_SOUTH;
+	type.floorChangeEast = fields.flags & ITEM_FIELD_FLOOR_CHANGE_EAST;
+	type.floorChangeWest = fields.flags & ITEM_FIELD_FLOOR_CHANGE_WEST;
+}
+
+bool DataSnapshot::load(wxArrayString &warnings) {
+	std::vector<uint8_t> data;
+	{
+		std::ifstream stream(std::filesystem::path(nstr(filename.GetFullPath())), std::ios::binary | std::ios::ate);
+		if (!stream.is_open()) {
+			return false;
+		}
+		data.resize(stream.tellg());
+		stream.seekg(0);
+		if (!stream.read(reinterpret_cast<char*>(data.data()), data.size())) {
+			return false;
+		}
+	}
+
+	SnapshotReader reader(data);
+	if (!reader.getBytes(getHeader())) {
+		spdlog::info("Startup snapshot is out of date, parsing data files");
+		return false;
+	}
+
+	// Decode everything before touching the databases, a truncated file must not
+	// leave them half filled
+	uint32_t itemCount;
+	if (!reader.get(itemCount)) {
+		return false;
+	}
+	std::vector<ItemFields> items(itemCount);
+	for (ItemFields &fields : items) {
+		if (!reader.get(fields.id) || !reader.getString(fields.name) || !reader.getString(fields.editorsuffix) || !reader.getString(fields.description)
+			|| !reader.get(fields.weight) || !reader.get(fields.armor) || !reader.get(fields.defense) || !reader.get(fields.rotateTo)
+			|| !reader.get(fields.volume) || !reader.get(fields.maxTextLen) || !reader.get(fields.charges) || !reader.get(fields.group)
+			|| !reader.get(fields.type) || !reader.get(fields.flags)) {
+			return false;
+		}
+		if (!g_items.isValidID(fields.id)) {
+			return false;
+		}
+	}
+
+	std::vector<CreatureEntry> monsters;
+	std::vector<CreatureEntry> npcs;
+	if (!readCreatures(reader, monsters) || !readCreatures(reader, npcs)) {
+		return false;
+	}
+
+	uint32_t warningCount;
+	if (!reader.get(warningCount)) {
+		return false;
+	}
+	wxArrayString snapshotWarnings;
+	for (uint32_t i = 0; i < warningCount; ++i) {
+		std::string warning;
+		if (!reader.getString(warning)) {
+			return false;
+		}
+		snapshotWarnings.push_back(wxstr(warning));
+	}
+	if (!reader.atEnd()) {
+		return false;
+	}
+
+	for (const ItemFields &fields : items) {
+		setItemFields(g_items.getItemType(fields.id), fields);
+	}
+	for (const CreatureEntry &monster : monsters) {
+		if (!g_monsters[monster.name]) {
+			g_monsters.addMonsterType(monster.name, monster.outfit)->standard = monster.standard != 0;
+		}
+	}
+	for (const CreatureEntry &npc : npcs) {
+		if (!g_npcs[npc.name]) {
+			g_npcs.addNpcType(npc.name, npc.outfit)->standard = npc.standard != 0;
+		}
+	}
+	for (const wxString &warning : snapshotWarnings) {
+		warnings.push_back(warning);
+	}
+	return true;
+}
+
+void DataSnapshot::captureItems() {
+	itemsBefore.clear();
+	for (uint16_t id = g_items.getMinID(); id <= g_items.getMaxID() && id != 0; ++id) {
+		if (g_items.isValidID(id)) {
+			itemsBefore.push_back(getItemFields(g_items.getItemType(id)));
+		}
+	}
+}
+
+bool DataSnapshot::save(const wxArrayString &warnings) {
+	SnapshotWriter writer;
+	writer.data = getHeader();
+
+	std::vector<ItemFields> changed;
+	auto before = itemsBefore.begin();
+	for (uint16_t id = g_items.getMinID(); id <= g_items.getMaxID() && id != 0; ++id) {
+		if (!g_items.isValidID(id)) {
+			continue;
+		}
+		ItemFields fields = getItemFields(g_items.getItemType(id));
+		while (before != itemsBefore.end() && before->id < id) {
+			++before;
+		}
+		if (before == itemsBefore.end() || before->id != id || !(*before == fields)) {
+			changed.push_back(std::move(fields));
+		}
+	}
+
+	writer.add<uint32_t>(changed.size());
+	for (const ItemFields &fields : changed) {
+		writer.add(fields.id);
+		writer.addString(fields.name);
+		writer.addString(fields.editorsuffix);
+		writer.addString(fields.description);
+		writer.add(fields.weight);
+		writer.add(fields.armor);
+		writer.add(fields.defense);
+		writer.add(fields.rotateTo);
+		writer.add(fields.volume);
+		writer.add(fields.maxTextLen);
+		writer.add(fields.charges);
+		writer.add(fields.group);
+		writer.add(fields.type);
+		writer.add(fields.flags);
+	}
+
+	writeCreatures(writer, g_monsters);
+	writeCreatures(writer, g_npcs);
+
+	writer.add<uint32_t>(warnings.size());
+	for (const wxString &warning : warnings) {
+		writer.addString(nstr(warning));
+	}
+
+	// Write next to the snapshot and swap it in, so an interrupted save never
+	// leaves a file that looks valid
+	const std::filesystem::path path(nstr(filename.GetFullPath()));
+	std::filesystem::path temporary = path;
+	temporary += ".tmp";
+	{
+		std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+		if (!stream.write(reinterpret_cast<const char*>(writer.data.data()), writer.data.size())) {
+			spdlog::warn("[DataSnapshot::save] Couldn't write {}", temporary.string());
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(temporary, path, ec);
+	if (ec) {
+		spdlog::warn("[DataSnapshot::save] Couldn't replace {}: {}", path.string(), ec.message());
+		std::filesystem::remove(temporary, ec);
+		return false;
+	}
+	return true;
+}
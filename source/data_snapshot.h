@@ -0,0 +1,90 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_DATA_SNAPSHOT_H_
+#define RME_DATA_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ItemType;
+
+// Binary cache of what items.xml, monsters.xml and npcs.xml produce at startup.
+// The snapshot is keyed by the size, modification time and content hash of every
+// source file that went into it; when they all match it is restored with a single
+// read, otherwise the caller parses the files again and saves a new snapshot.
+class DataSnapshot {
+public:
+	DataSnapshot(const FileName &filename);
+
+	// Adds a file the snapshot depends on, missing files are part of the key too
+	void addSource(const FileName &source);
+
+	// Applies the snapshot if it exists and all sources are unchanged
+	bool load(wxArrayString &warnings);
+
+	// Records the item types before the data files are parsed, so save() only has
+	// to store the types items.xml actually changed
+	void captureItems();
+	// Stores the freshly parsed databases, along with the warnings parsing them gave
+	bool save(const wxArrayString &warnings);
+
+protected:
+	struct Source {
+		std::string path;
+		bool exists = false;
+		uint64_t size = 0;
+		int64_t modified = 0;
+		uint64_t hash = 0;
+	};
+
+	// The parts of an item type items.xml can change
+	struct ItemFields {
+		uint16_t id = 0;
+		std::string name;
+		std::string editorsuffix;
+		std::string description;
+		float weight = 0.0;
+		int32_t armor = 0;
+		int32_t defense = 0;
+		uint16_t rotateTo = 0;
+		uint16_t volume = 0;
+		uint16_t maxTextLen = 0;
+		uint32_t charges = 0;
+		uint8_t group = 0;
+		uint8_t type = 0;
+		uint16_t flags = 0;
+
+		bool operator==(const ItemFields &other) const = default;
+	};
+
+	// Magic, version and the key of every source, a snapshot is only valid if it starts with these bytes
+	std::vector<uint8_t> getHeader() const;
+
+	static ItemFields getItemFields(const ItemType &type);
+	static void setItemFields(ItemType &type, const ItemFields &fields);
+
+	FileName filename;
+	std::vector<Source> sources;
+	std::vector<ItemFields> itemsBefore;
+
+	// The self tests compare parsed item types through ItemFields
+	friend class EditorTests;
+};
+
+#endif
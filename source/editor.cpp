@@ -42,6 +42,7 @@
 #include "live_server.h"
 #include "live_client.h"
 #include "live_action.h"
+#include "threads.h"
 
 #include <filesystem>
 #include <chrono>
@@ -49,6 +50,26 @@
 
 namespace fs = std::filesystem;
 
+namespace {
+	// Brush strokes bordering fewer tiles than this are borderized on the calling thread
+	constexpr size_t ParallelBorderizeMinTiles = 4096;
+	// Replaced tiles freed by a worker at once after a map import
+	constexpr size_t ImportDeleteChunk = 4096;
+
+	// Tiles of one partition of an imported map, translated on a worker
+	struct ImportedBlock {
+		struct Entry {
+			Tile* tile;
+			// House the tile is moved to, null when houses are not imported or it has none
+			House* house;
+			// Outside of the current map size
+			bool outside;
+		};
+		std::vector<Entry> tiles;
+		int discarded = 0;
+	};
+}
+
 Editor::Editor(CopyBuffer &copybuffer) :
 	live_server(nullptr),
 	live_client(nullptr),
@@ -461,18 +482,26 @@ bool Editor::importMiniMap(FileName filename, int import, int import_x_offset, i
 	return false;
 }
 
-bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offset, int import_z_offset, ImportType house_import_type, ImportType spawn_import_type, ImportType spawn_npc_import_type) {
+bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offset, int import_z_offset, ImportType house_import_type, ImportType spawn_import_type, ImportType spawn_npc_import_type, bool showdialog) {
 	selection.clear();
 	actionQueue->clear();
+	// Spawns and houses are merged into existing tiles in place
+	map.invalidateIndexes();
 
 	Map imported_map;
 	bool loaded = imported_map.open(nstr(filename.GetFullPath()));
 
 	if (!loaded) {
-		g_gui.PopupDialog("Error", "Error loading map!\n" + imported_map.getError(), wxOK | wxICON_INFORMATION);
+		if (showdialog) {
+			g_gui.PopupDialog("Error", "Error loading map!\n" + imported_map.getError(), wxOK | wxICON_INFORMATION);
+		} else {
+			spdlog::error("Error loading map {}: {}", nstr(filename.GetFullPath()), nstr(imported_map.getError()));
+		}
 		return false;
 	}
-	g_gui.ListDialog("Warning", imported_map.getWarnings());
+	if (showdialog) {
+		g_gui.ListDialog("Warning", imported_map.getWarnings());
+	}
 
 	Position offset(import_x_offset, import_y_offset, import_z_offset);
 
@@ -481,7 +510,9 @@ bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offs
 	int newsize_x = map.getWidth(), newsize_y = map.getHeight();
 	int discarded_tiles = 0;
 
-	g_gui.CreateLoadBar("Merging maps...");
+	if (showdialog) {
+		g_gui.CreateLoadBar("Merging maps...");
+	}
 
 	std::map<uint32_t, uint32_t> town_id_map;
 	std::map<uint32_t, uint32_t> house_id_map;
@@ -708,81 +739,118 @@ bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offs
 	map.waypoints.waypoints.insert(imported_map.waypoints.begin(), imported_map.waypoints.end());
 	imported_map.waypoints.waypoints.clear();
 
-	uint64_t tiles_merged = 0;
-	uint64_t tiles_to_import = imported_map.tilecount;
-	for (MapIterator mit = imported_map.begin(); mit != imported_map.end(); ++mit) {
-		if (tiles_merged % 8092 == 0) {
-			g_gui.SetLoadDone(int(100.0 * tiles_merged / tiles_to_import));
-		}
-		++tiles_merged;
-
-		Tile* import_tile = (*mit)->get();
-		Position new_pos = import_tile->getPosition() + offset;
-		if (!new_pos.isValid()) {
-			++discarded_tiles;
-			continue;
+	// House ids are resolved once, the workers only look them up
+	std::unordered_map<uint32_t, House*> imported_houses;
+	if (house_import_type != IMPORT_DONT) {
+		for (const auto &[imported_id, new_id] : house_id_map) {
+			imported_houses[imported_id] = map.houses.getHouse(new_id);
 		}
+	}
 
-		if (!resizemap && (new_pos.x > map.getWidth() || new_pos.y > map.getHeight())) {
-			if (resize_asked) {
-				++discarded_tiles;
-				continue;
-			} else {
-				resize_asked = true;
-				int ret = g_gui.PopupDialog("Collision", "The imported tiles are outside the current map scope. Do you want to resize the map? (Else additional tiles will be removed)", wxYES | wxNO);
+	// Positions and teleports are translated per partition on the worker threads
+	const int map_width = map.getWidth();
+	const int map_height = map.getHeight();
+	std::vector<ImportedBlock> blocks = collect_PartitionsOnMap(imported_map, ImportedBlock(), [&](const MapPartition &partition, ImportedBlock &block) {
+		partition.forEachTile([&](Tile* import_tile) {
+			const Position new_pos = import_tile->getPosition() + offset;
+			if (!new_pos.isValid()) {
+				++block.discarded;
+				return;
+			}
 
-				if (ret == wxID_YES) {
-					// ...
-					resizemap = true;
-				} else {
-					++discarded_tiles;
-					continue;
+			if (offset != Position(0, 0, 0)) {
+				for (Item* item : import_tile->items) {
+					if (Teleport* teleport = dynamic_cast<Teleport*>(item)) {
+						teleport->setDestination(teleport->getDestination() + offset);
+					}
 				}
 			}
-		}
 
-		if (new_pos.x > newsize_x) {
-			newsize_x = new_pos.x;
-		}
-		if (new_pos.y > newsize_y) {
-			newsize_y = new_pos.y;
+			House* house = nullptr;
+			if (import_tile->isHouseTile()) {
+				const auto it = imported_houses.find(import_tile->getHouseID());
+				house = it != imported_houses.end() ? it->second : nullptr;
+			}
+			block.tiles.push_back({ import_tile, house, new_pos.x > map_width || new_pos.y > map_height });
+		});
+	});
+
+	for (const ImportedBlock &block : blocks) {
+		discarded_tiles += block.discarded;
+		if (!resize_asked && std::ranges::any_of(block.tiles, [](const ImportedBlock::Entry &entry) { return entry.outside; })) {
+			resize_asked = true;
+			// Without a dialog the map grows, nothing of the imported map is lost
+			resizemap = !showdialog || g_gui.PopupDialog("Collision", "The imported tiles are outside the current map scope. Do you want to resize the map? (Else additional tiles will be removed)", wxYES | wxNO) == wxID_YES;
 		}
+	}
 
-		imported_map.setTile(import_tile->getPosition(), nullptr);
-		TileLocation* location = map.createTileL(new_pos);
+	// Linking into the quad tree is serial, house tile lists are updated once per house afterwards
+	std::unordered_map<House*, std::pair<PositionVector, PositionVector>> house_tiles;
+	std::vector<Tile*> replaced_tiles;
+	uint64_t tiles_merged = 0;
+	uint64_t tiles_to_import = imported_map.tilecount;
+	for (const ImportedBlock &block : blocks) {
+		for (const ImportedBlock::Entry &entry : block.tiles) {
+			if (showdialog && tiles_merged % 8092 == 0) {
+				g_gui.SetLoadDone(int(100.0 * tiles_merged / tiles_to_import));
+			}
+			++tiles_merged;
 
-		// Check if we should update any houses
-		int new_houseid = house_id_map[import_tile->getHouseID()];
-		House* house = map.houses.getHouse(new_houseid);
-		if (import_tile->isHouseTile() && house_import_type != IMPORT_DONT && house) {
-			// We need to notify houses of the tile moving
-			house->removeTile(import_tile);
-			import_tile->setLocation(location);
-			house->addTile(import_tile);
-		} else {
+			if (entry.outside && !resizemap) {
+				++discarded_tiles;
+				continue;
+			}
+
+			Tile* import_tile = entry.tile;
+			const Position old_pos = import_tile->getPosition();
+			const Position new_pos = old_pos + offset;
+			if (new_pos.x > newsize_x) {
+				newsize_x = new_pos.x;
+			}
+			if (new_pos.y > newsize_y) {
+				newsize_y = new_pos.y;
+			}
+
+			imported_map.setTile(old_pos, nullptr);
+			TileLocation* location = map.createTileL(new_pos);
 			import_tile->setLocation(location);
-		}
+			if (entry.house) {
+				// We need to notify houses of the tile moving
+				import_tile->setHouse(entry.house);
+				house_tiles[entry.house].first.push_back(old_pos);
+				house_tiles[entry.house].second.push_back(new_pos);
+			}
 
-		if (offset != Position(0, 0, 0)) {
-			for (ItemVector::iterator iter = import_tile->items.begin(); iter != import_tile->items.end(); ++iter) {
-				Item* item = *iter;
-				if (Teleport* teleport = dynamic_cast<Teleport*>(item)) {
-					teleport->setDestination(teleport->getDestination() + offset);
-				}
+			Tile* old_tile = location->get();
+			if (old_tile) {
+				map.removeSpawnMonster(old_tile);
+				map.removeSpawnNpc(old_tile);
 			}
-		}
+			import_tile->spawnMonster = nullptr;
+			import_tile->spawnNpc = nullptr;
 
-		Tile* old_tile = map.getTile(new_pos);
-		if (old_tile) {
-			map.removeSpawnMonster(old_tile);
-			map.removeSpawnNpc(old_tile);
+			old_tile = map.swapTile(new_pos, import_tile);
+			if (old_tile) {
+				replaced_tiles.push_back(old_tile);
+			}
 		}
-		import_tile->spawnMonster = nullptr;
-		import_tile->spawnNpc = nullptr;
+	}
 
-		map.setTile(new_pos, import_tile, true);
+	for (const auto &[house, positions] : house_tiles) {
+		house->replaceTiles(positions.first, positions.second);
 	}
 
+	RunParallelJobs(
+		(replaced_tiles.size() + ImportDeleteChunk - 1) / ImportDeleteChunk, std::max(g_settings.getInteger(Config::WORKER_THREADS), 1),
+		[&](size_t chunk) {
+			const size_t last = std::min(replaced_tiles.size(), (chunk + 1) * ImportDeleteChunk);
+			for (size_t index = chunk * ImportDeleteChunk; index < last; ++index) {
+				delete replaced_tiles[index];
+			}
+		},
+		[](size_t) { }
+	);
+
 	for (std::map<Position, SpawnMonster*>::iterator spawn_monster_iter = spawn_monster_map.begin(); spawn_monster_iter != spawn_monster_map.end(); ++spawn_monster_iter) {
 		Position pos = spawn_monster_iter->first;
 		TileLocation* location = map.createTileL(pos);
@@ -815,11 +883,12 @@ bool Editor::importMap(FileName filename, int import_x_offset, int import_y_offs
 		map.addSpawnNpc(tile);
 	}
 
-	g_gui.DestroyLoadBar();
-
 	map.setWidth(newsize_x);
 	map.setHeight(newsize_y);
-	g_gui.PopupDialog("Success", "Map imported successfully, " + i2ws(discarded_tiles) + " tiles were discarded as invalid.", wxOK);
+	if (showdialog) {
+		g_gui.DestroyLoadBar();
+		g_gui.PopupDialog("Success", "Map imported successfully, " + i2ws(discarded_tiles) + " tiles were discarded as invalid.", wxOK);
+	}
 
 	g_gui.RefreshPalettes();
 	g_gui.FitViewToMap();
@@ -849,18 +918,16 @@ void Editor::borderizeMap(bool showdialog) {
 		g_gui.CreateLoadBar("Borderizing map...");
 	}
 
-	uint64_t tiles_done = 0;
-	for (TileLocation* tileLocation : map) {
-		if (showdialog && tiles_done % 4096 == 0) {
-			g_gui.SetLoadDone(static_cast<int32_t>(tiles_done / double(map.tilecount) * 100.0));
-		}
+	// Tiles are changed in place
+	map.invalidateIndexes();
 
-		Tile* tile = tileLocation->get();
-		ASSERT(tile);
-
-		tile->borderize(&map);
-		++tiles_done;
-	}
+	// A tile's borders only depend on the grounds around it, which borderizing never
+	// changes, so every partition can be done at once with the same result as in order
+	foreach_PartitionOnMap(PartitionMapForWorkers(map), [this](const MapPartition &partition) {
+		partition.forEachTile([this](Tile* tile) {
+			tile->borderize(&map);
+		});
+	});
 
 	if (showdialog) {
 		g_gui.DestroyLoadBar();
@@ -900,6 +967,9 @@ void Editor::randomizeMap(bool showdialog) {
 		g_gui.CreateLoadBar("Randomizing map...");
 	}
 
+	// Tiles are changed in place
+	map.invalidateIndexes();
+
 	uint64_t tiles_done = 0;
 	for (TileLocation* tileLocation : map) {
 		if (showdialog && tiles_done % 4096 == 0) {
@@ -998,6 +1068,89 @@ void Editor::clearModifiedTileState(bool showdialog) {
 	}
 }
 
+bool Editor::canMoveWholeTiles(const Position &offset) const {
+	// Live sessions and merging moves need the per tile changes
+	if (IsLive() || g_settings.getInteger(Config::MERGE_MOVE)) {
+		return false;
+	}
+
+	for (const Tile* tile : selection.getTiles()) {
+		if (!tile->ground || tile->hasZone() || !TileSelectionState::isFullySelected(tile)) {
+			return false;
+		}
+		if (!(tile->getPosition() - offset).isValid()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int64_t Editor::removeItemsOnMap(const std::function<bool(Map &, Item*)> &condition, bool selectedOnly) {
+	const auto matches = [&](Tile* tile) {
+		return (tile->ground && condition(map, tile->ground)) || std::ranges::any_of(tile->items, [&](Item* item) { return condition(map, item); });
+	};
+	std::vector<TileVector> found = collect_PartitionsOnMap(map, TileVector(), [&](const MapPartition &partition, TileVector &tiles) {
+		partition.forEachTile([&](Tile* tile) {
+			if ((!selectedOnly || tile->isSelected()) && matches(tile)) {
+				tiles.push_back(tile);
+			}
+		});
+	});
+
+	BatchAction* batch = actionQueue->createBatch(ACTION_DELETE_TILES);
+	Action* action = actionQueue->createAction(batch);
+	int64_t removed = 0;
+	for (const TileVector &tiles : found) {
+		for (const Tile* tile : tiles) {
+			Tile* new_tile = tile->deepCopy(map);
+			if (new_tile->ground && condition(map, new_tile->ground)) {
+				delete new_tile->ground;
+				new_tile->ground = nullptr;
+				++removed;
+			}
+			for (auto it = new_tile->items.begin(); it != new_tile->items.end();) {
+				if (condition(map, *it)) {
+					delete *it;
+					it = new_tile->items.erase(it);
+					++removed;
+				} else {
+					++it;
+				}
+			}
+			action->addChange(newd Change(new_tile));
+		}
+	}
+	batch->addAndCommitAction(action);
+	addBatch(batch);
+	updateActions();
+	return removed;
+}
+
+int64_t Editor::removeTilesOnMap(const std::function<bool(Map &, Tile*)> &condition) {
+	// Evaluated against the unmodified map, removing a tile must not decide about its neighbours
+	std::vector<TileVector> found = collect_PartitionsOnMap(map, TileVector(), [&](const MapPartition &partition, TileVector &tiles) {
+		partition.forEachTile([&](Tile* tile) {
+			if (condition(map, tile)) {
+				tiles.push_back(tile);
+			}
+		});
+	});
+
+	BatchAction* batch = actionQueue->createBatch(ACTION_DELETE_TILES);
+	Action* action = actionQueue->createAction(batch);
+	int64_t removed = 0;
+	for (const TileVector &tiles : found) {
+		for (Tile* tile : tiles) {
+			action->addChange(newd Change(map.allocator(tile->getLocation())));
+			++removed;
+		}
+	}
+	batch->addAndCommitAction(action);
+	addBatch(batch);
+	updateActions();
+	return removed;
+}
+
 void Editor::moveSelection(const Position &offset) {
 	if (!CanEdit() || !hasSelection()) {
 		return;
@@ -1009,50 +1162,63 @@ void Editor::moveSelection(const Position &offset) {
 		&& g_settings.getInteger(Config::BORDERIZE_DRAG);
 
 	TileSet storage;
+	PositionVector source_positions;
+	source_positions.reserve(selection.size());
 	BatchAction* batch_action = actionQueue->createBatch(ACTION_MOVE);
 	Action* action = actionQueue->createAction(batch_action);
 
-	// Update the tiles with the new positions
-	for (Tile* tile : selection) {
-		Tile* new_tile = tile->deepCopy(map);
-		Tile* storage_tile = map.allocator(tile->getLocation());
-
-		ItemVector selected_items = new_tile->popSelectedItems();
-		for (Item* item : selected_items) {
-			storage_tile->addItem(item);
+	const bool whole_tiles = canMoveWholeTiles(offset);
+	if (whole_tiles) {
+		// Relink the tiles themselves, undo only needs the moved area and the replaced tiles
+		for (const Tile* tile : selection) {
+			source_positions.push_back(tile->getPosition());
 		}
+		action->addChange(Change::Create(SelectionArea::fromPositions(source_positions), Position(0, 0, 0) - offset));
+		borderize = true;
+	} else {
+		// Update the tiles with the new positions
+		for (Tile* tile : selection) {
+			Tile* new_tile = tile->deepCopy(map);
+			Tile* storage_tile = map.allocator(tile->getLocation());
 
-		// Move monster spawns
-		if (new_tile->spawnMonster && new_tile->spawnMonster->isSelected()) {
-			storage_tile->spawnMonster = new_tile->spawnMonster;
-			new_tile->spawnMonster = nullptr;
-		}
-		// Move monster
-		const auto monstersSelection = new_tile->popSelectedMonsters();
-		std::ranges::for_each(monstersSelection, [&](const auto monster) {
-			storage_tile->addMonster(monster);
-		});
-		// Move npc
-		if (new_tile->npc && new_tile->npc->isSelected()) {
-			storage_tile->npc = new_tile->npc;
-			new_tile->npc = nullptr;
-		}
-		// Move npc spawns
-		if (new_tile->spawnNpc && new_tile->spawnNpc->isSelected()) {
-			storage_tile->spawnNpc = new_tile->spawnNpc;
-			new_tile->spawnNpc = nullptr;
-		}
+			ItemVector selected_items = new_tile->popSelectedItems();
+			for (Item* item : selected_items) {
+				storage_tile->addItem(item);
+			}
 
-		if (storage_tile->ground) {
-			storage_tile->house_id = new_tile->house_id;
-			new_tile->house_id = 0;
-			storage_tile->setMapFlags(new_tile->getMapFlags());
-			new_tile->setMapFlags(TILESTATE_NONE);
-			borderize = true;
-		}
+			// Move monster spawns
+			if (new_tile->spawnMonster && new_tile->spawnMonster->isSelected()) {
+				storage_tile->spawnMonster = new_tile->spawnMonster;
+				new_tile->spawnMonster = nullptr;
+			}
+			// Move monster
+			const auto monstersSelection = new_tile->popSelectedMonsters();
+			std::ranges::for_each(monstersSelection, [&](const auto monster) {
+				storage_tile->addMonster(monster);
+			});
+			// Move npc
+			if (new_tile->npc && new_tile->npc->isSelected()) {
+				storage_tile->npc = new_tile->npc;
+				new_tile->npc = nullptr;
+			}
+			// Move npc spawns
+			if (new_tile->spawnNpc && new_tile->spawnNpc->isSelected()) {
+				storage_tile->spawnNpc = new_tile->spawnNpc;
+				new_tile->spawnNpc = nullptr;
+			}
 
-		storage.insert(storage_tile);
-		action->addChange(new Change(new_tile));
+			if (storage_tile->ground) {
+				storage_tile->house_id = new_tile->house_id;
+				new_tile->house_id = 0;
+				storage_tile->setMapFlags(new_tile->getMapFlags());
+				new_tile->setMapFlags(TILESTATE_NONE);
+				borderize = true;
+			}
+
+			source_positions.push_back(storage_tile->getPosition());
+			storage.insert(storage_tile);
+			action->addChange(new Change(new_tile));
+		}
 	}
 	batch_action->addAndCommitAction(action);
 
@@ -1061,8 +1227,7 @@ void Editor::moveSelection(const Position &offset) {
 		action = actionQueue->createAction(batch_action);
 		TileList borderize_tiles;
 		// Go through all modified (selected) tiles (might be slow)
-		for (const Tile* tile : storage) {
-			const Position &pos = tile->getPosition();
+		for (const Position &pos : source_positions) {
 			// Go through all neighbours
 			Tile* t;
 			t = map.getTile(pos.x, pos.y, pos.z);
@@ -1124,37 +1289,39 @@ void Editor::moveSelection(const Position &offset) {
 		batch_action->addAndCommitAction(action);
 	}
 
-	// New action for adding the destination tiles
-	action = actionQueue->createAction(batch_action);
-	for (Tile* tile : storage) {
-		const Position &old_pos = tile->getPosition();
-		Position new_pos = old_pos - offset;
-		if (new_pos.z < rme::MapMinLayer && new_pos.z > rme::MapMaxLayer) {
-			delete tile;
-			continue;
-		}
+	if (!whole_tiles) {
+		// New action for adding the destination tiles
+		action = actionQueue->createAction(batch_action);
+		for (Tile* tile : storage) {
+			const Position &old_pos = tile->getPosition();
+			Position new_pos = old_pos - offset;
+			if (new_pos.z < rme::MapMinLayer && new_pos.z > rme::MapMaxLayer) {
+				delete tile;
+				continue;
+			}
 
-		TileLocation* location = map.createTileL(new_pos);
-		Tile* old_dest_tile = location->get();
-		Tile* new_dest_tile = nullptr;
+			TileLocation* location = map.createTileL(new_pos);
+			Tile* old_dest_tile = location->get();
+			Tile* new_dest_tile = nullptr;
 
-		if (!tile->ground || g_settings.getInteger(Config::MERGE_MOVE)) {
-			// Move items
-			if (old_dest_tile) {
-				new_dest_tile = old_dest_tile->deepCopy(map);
+			if (!tile->ground || g_settings.getInteger(Config::MERGE_MOVE)) {
+				// Move items
+				if (old_dest_tile) {
+					new_dest_tile = old_dest_tile->deepCopy(map);
+				} else {
+					new_dest_tile = map.allocator(location);
+				}
+				new_dest_tile->merge(tile);
+				delete tile;
 			} else {
-				new_dest_tile = map.allocator(location);
+				// Replace tile instead of just merge
+				tile->setLocation(location);
+				new_dest_tile = tile;
 			}
-			new_dest_tile->merge(tile);
-			delete tile;
-		} else {
-			// Replace tile instead of just merge
-			tile->setLocation(location);
-			new_dest_tile = tile;
+			action->addChange(new Change(new_dest_tile));
 		}
-		action->addChange(new Change(new_dest_tile));
+		batch_action->addAndCommitAction(action);
 	}
-	batch_action->addAndCommitAction(action);
 
 	if (create_borders && selection.size() < static_cast<size_t>(drag_threshold)) {
 		action = actionQueue->createAction(batch_action);
@@ -1730,6 +1897,10 @@ void Editor::drawInternal(const PositionVector &tilestodraw, PositionVector &til
 		if (g_settings.getInteger(Config::USE_AUTOMAGIC)) {
 			// Do borders!
 			action = actionQueue->createAction(batch);
+			std::vector<Tile*> bordered_tiles;
+			std::vector<bool> new_tiles;
+			bordered_tiles.reserve(tilestoborder.size());
+			new_tiles.reserve(tilestoborder.size());
 			for (PositionVector::const_iterator it = tilestoborder.begin(); it != tilestoborder.end(); ++it) {
 				TileLocation* location = map.createTileL(*it);
 				Tile* tile = location->get();
@@ -1740,22 +1911,31 @@ void Editor::drawInternal(const PositionVector &tilestodraw, PositionVector &til
 						new_tile->tableize(&map);
 						new_tile->carpetize(&map);
 					}
-					new_tile->borderize(&map);
+					bordered_tiles.push_back(new_tile);
+					new_tiles.push_back(false);
+				} else {
+					// There are no carpets/tables/walls on empty tiles...
+					bordered_tiles.push_back(map.allocator(location));
+					new_tiles.push_back(true);
+				}
+			}
+
+			// The copies are not in the map yet and only read the grounds around them,
+			// so large areas are borderized on the worker threads
+			const size_t threads = bordered_tiles.size() >= ParallelBorderizeMinTiles ? std::max(g_settings.getInteger(Config::WORKER_THREADS), 1) : 1;
+			RunParallelJobs(
+				bordered_tiles.size(), threads, [&](size_t index) {
+					bordered_tiles[index]->borderize(&map);
+				},
+				[](size_t) { }
+			);
+
+			for (size_t index = 0; index < bordered_tiles.size(); ++index) {
+				Tile* new_tile = bordered_tiles[index];
+				if (!new_tiles[index] || new_tile->size() > 0) {
 					action->addChange(newd Change(new_tile));
 				} else {
-					Tile* new_tile = map.allocator(location);
-					if (brush->isEraser()) {
-						// There are no carpets/tables/walls on empty tiles...
-						// new_tile->wallize(map);
-						// new_tile->tableize(map);
-						// new_tile->carpetize(map);
-					}
-					new_tile->borderize(&map);
-					if (new_tile->size() > 0) {
-						action->addChange(newd Change(new_tile));
-					} else {
-						delete new_tile;
-					}
+					delete new_tile;
 				}
 			}
 			batch->addAndCommitAction(action);
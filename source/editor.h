@@ -93,7 +93,7 @@ public: // Functions
 	wxString getLoaderError() const {
 		return map.getError();
 	}
-	bool importMap(FileName filename, int import_x_offset, int import_y_offset, int import_z_offset, ImportType house_import_type, ImportType spawn_import_type, ImportType spawn_npc_import_type);
+	bool importMap(FileName filename, int import_x_offset, int import_y_offset, int import_z_offset, ImportType house_import_type, ImportType spawn_import_type, ImportType spawn_npc_import_type, bool showdialog = true);
 	bool importMiniMap(FileName filename, int import, int import_x_offset, int import_y_offset, int import_z_offset);
 
 	ActionQueue* getHistoryActions() const noexcept {
@@ -139,6 +139,11 @@ public: // Functions
 	void randomizeMap(bool showdialog);
 	void clearInvalidHouseTiles(bool showdialog);
 	void clearModifiedTileState(bool showdialog);
+	// These go through the undo queue as one action, the conditions are evaluated on the worker threads
+	// Removes the grounds and top level items for which condition(Map&, Item*) returns true
+	int64_t removeItemsOnMap(const std::function<bool(Map &, Item*)> &condition, bool selectedOnly);
+	// Empties the tiles for which condition(Map&, Tile*) returns true
+	int64_t removeTilesOnMap(const std::function<bool(Map &, Tile*)> &condition);
 
 	// Draw using the current brush to the target position
 	// alt is whether the ALT key is pressed
@@ -157,6 +162,9 @@ protected:
 	void drawInternal(const PositionVector &posvec, bool alt, bool dodraw);
 	void drawInternal(const PositionVector &todraw, PositionVector &toborder, bool alt, bool dodraw);
 
+	// Whether the selection can be moved by relinking whole tiles instead of copying them
+	bool canMoveWholeTiles(const Position &offset) const;
+
 	Editor(const Editor &);
 	Editor &operator=(const Editor &);
 
@@ -0,0 +1,1420 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "editor_tests.h"
+#include "bitmap_to_map_converter.h"
+#include "brush.h"
+#include "complexitem.h"
+#include "data_snapshot.h"
+#include "editor.h"
+#include "ground_brush.h"
+#include "gui.h"
+#include "house.h"
+#include "iomap_otbm.h"
+#include "iominimap.h"
+#include "items.h"
+#include "map.h"
+#include "map_image_renderer.h"
+#include "monster.h"
+#include "monsters.h"
+#include "npc.h"
+#include "npcs.h"
+#include "settings.h"
+#include "spawn_monster.h"
+#include "spawn_npc.h"
+#include "sprite_appearances.h"
+#include "tile.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+
+#include <wx/dir.h>
+#include <wx/stdpaths.h>
+
+namespace {
+	constexpr int SelfTestFloor = rme::MapGroundLayer;
+	constexpr int SelfTestPatchSize = 16;
+
+	// FNV-1a, enough to tell two maps apart
+	class MapHasher {
+	public:
+		void add(uint64_t value) {
+			for (int i = 0; i < 8; ++i) {
+				hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 0x100000001B3ULL;
+			}
+		}
+
+		void add(const std::string &value) {
+			add(value.size());
+			for (const char c : value) {
+				hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ULL;
+			}
+		}
+
+		void add(const Item* item) {
+			add(item->getID());
+			add(item->getSubtype());
+			add(item->getActionID());
+			add(item->getUniqueID());
+			add(item->getText());
+			if (const Container* container = dynamic_cast<const Container*>(item)) {
+				add(container->getItemCount());
+				for (size_t index = 0; index < container->getItemCount(); ++index) {
+					add(container->getItem(index));
+				}
+			}
+		}
+
+		uint64_t get() const noexcept {
+			return hash;
+		}
+
+	private:
+		uint64_t hash = 0xCBF29CE484222325ULL;
+	};
+
+	// Changes a setting for a test and puts the user's value back after it
+	class SelfTestSetting {
+	public:
+		SelfTestSetting(uint32_t key) :
+			key(key), previous(g_settings.getInteger(key)) {
+			////
+		}
+
+		~SelfTestSetting() {
+			g_settings.setInteger(key, previous);
+		}
+
+		void set(int value) {
+			g_settings.setInteger(key, value);
+		}
+
+	private:
+		uint32_t key;
+		int previous;
+	};
+
+	// At least four, so the threaded paths split the work even on small machines
+	int getSelfTestThreads() {
+		return std::max<int>(std::thread::hardware_concurrency(), 4);
+	}
+}
+
+EditorTests::EditorTests(const wxString &filter) :
+	filter(filter) {
+	////
+}
+
+bool EditorTests::run(const wxString &outputPath) {
+	// Whether the test draws with the two ground brushes
+	struct SelfTest {
+		std::string name;
+		Test test;
+		bool brushes;
+	};
+	static const std::vector<SelfTest> tests = {
+		{ "borderize_threads", &EditorTests::borderizeThreads, true },
+		{ "bitmap_convert_threads", &EditorTests::bitmapConvertThreads, true },
+		{ "move_undo", &EditorTests::moveUndo, true },
+		{ "sprite_preload", &EditorTests::spritePreload, false },
+		{ "data_file_tasks", &EditorTests::dataFileTasks, false },
+		{ "convert_threads", &EditorTests::convertThreads, true },
+		{ "import_threads", &EditorTests::importThreads, true },
+		{ "minimap_export_threads", &EditorTests::minimapExportThreads, true },
+		{ "render_image", &EditorTests::renderImage, true },
+		{ "data_snapshot", &EditorTests::dataSnapshot, false },
+		{ "border_table", &EditorTests::borderTable, false },
+		{ "journal_undo", &EditorTests::journalUndo, true },
+		{ "floor_traversal", &EditorTests::floorTraversal, false },
+		{ "map_statistics", &EditorTests::mapStatistics, true },
+	};
+
+	results = nlohmann::json::array();
+	bool allPassed = true;
+	const auto report = [&](const std::string &name) {
+		for (const std::string &failure : failures) {
+			spdlog::error("[EditorTests] {}: {}", name, failure);
+		}
+		spdlog::info("[EditorTests] {}: {}", name, failures.empty() ? "passed" : "FAILED");
+		results.push_back({ { "name", name }, { "success", failures.empty() }, { "failures", failures } });
+		allPassed = allPassed && failures.empty();
+	};
+
+	// Reported once, the tests that need the brushes then fail without running
+	failures.clear();
+	const bool brushesFound = findGroundBrushes();
+	if (!brushesFound) {
+		report("ground_brushes");
+	}
+
+	size_t ran = 0;
+	for (const auto &[name, test, brushes] : tests) {
+		if (!wxString(name).StartsWith(filter)) {
+			continue;
+		}
+		++ran;
+
+		// Same random choices on every run
+		mt_seed(0);
+		failures.clear();
+		if (brushes && !brushesFound) {
+			failures.emplace_back("Not run, the loaded version has no two bordered ground brushes");
+		} else if (!g_gui.NewMap()) {
+			failures.emplace_back("Could not create a map");
+		} else {
+			Editor* editor = g_gui.GetCurrentEditor();
+			(this->*test)(*editor);
+			// Nothing to save, close without asking
+			editor->clearChanges();
+			editor->clearActions();
+			g_gui.CloseCurrentEditor();
+		}
+		report(name);
+	}
+
+	if (ran == 0) {
+		spdlog::error("[EditorTests] No test matches '{}'", nstr(filter));
+		allPassed = false;
+	}
+
+	nlohmann::json document;
+	document["version"] = __RME_VERSION__;
+	document["success"] = allPassed;
+	document["results"] = results;
+
+	std::ofstream file(nstr(outputPath), std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		spdlog::error("[EditorTests] Unable to write {}", nstr(outputPath));
+		return false;
+	}
+	file << document.dump(4) << std::endl;
+	return allPassed;
+}
+
+uint64_t EditorTests::hashMap(BaseMap &map, bool emptyTiles) {
+	MapHasher hasher;
+	for (MapIterator it = map.begin(); it != map.end(); ++it) {
+		const Tile* tile = (*it)->get();
+		if (!emptyTiles && tile->empty() && tile->getHouseID() == 0) {
+			continue;
+		}
+		const Position &position = tile->getPosition();
+		hasher.add((static_cast<uint64_t>(position.x) << 32) | (static_cast<uint64_t>(position.y) << 8) | position.z);
+		hasher.add(tile->getHouseID());
+		hasher.add(tile->getMapFlags());
+		hasher.add(tile->isModified());
+		hasher.add(tile->ground ? tile->ground->getID() : 0);
+		if (tile->ground) {
+			hasher.add(tile->ground);
+		}
+
+		hasher.add(tile->items.size());
+		for (const Item* item : tile->items) {
+			hasher.add(item);
+		}
+
+		hasher.add(tile->monsters.size());
+		for (const Monster* monster : tile->monsters) {
+			hasher.add(monster->getName());
+		}
+		hasher.add(tile->npc ? tile->npc->getName() : std::string());
+		hasher.add(tile->spawnMonster ? tile->spawnMonster->getSize() : 0);
+		hasher.add(tile->spawnNpc ? tile->spawnNpc->getSize() : 0);
+		for (const unsigned int zone : tile->zones) {
+			hasher.add(zone);
+		}
+	}
+	return hasher.get();
+}
+
+bool EditorTests::check(bool condition, const std::string &message) {
+	if (!condition) {
+		failures.push_back(message);
+	}
+	return condition;
+}
+
+bool EditorTests::findGroundBrushes() {
+	for (const auto &[name, brush] : g_brushes.getMap()) {
+		if (!brush->isGround() || !brush->asGround()->hasOuterBorder()) {
+			continue;
+		}
+		if (!groundBrush) {
+			groundBrush = brush->asGround();
+		} else if (!patchBrush) {
+			patchBrush = brush->asGround();
+			return true;
+		}
+	}
+	failures.emplace_back("The loaded version needs two bordered ground brushes");
+	return false;
+}
+
+void EditorTests::generateMap(Editor &editor) {
+	Map &map = editor.getMap();
+	for (int x = Base; x < Base + MapSize; ++x) {
+		for (int y = Base; y < Base + MapSize; ++y) {
+			// Patches of different sizes, so the borders meet in every direction
+			const int patchX = (x - Base) / SelfTestPatchSize;
+			const int patchY = (y - Base) / SelfTestPatchSize;
+			const int inset = (patchX + patchY) % 4;
+			const bool inPatch = (x - Base) % SelfTestPatchSize >= inset && (y - Base) % SelfTestPatchSize >= inset;
+			const bool patch = ((patchX * 7 + patchY * 13) % 5) == 0 && inPatch;
+
+			Tile* tile = map.createTile(x, y, SelfTestFloor);
+			(patch ? patchBrush : groundBrush)->draw(&map, tile, nullptr);
+			tile->update();
+		}
+	}
+	map.invalidateIndexes();
+	map.doChange();
+}
+
+bool EditorTests::borderizeThreads(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting threads(Config::WORKER_THREADS);
+	generateMap(editor);
+	const uint64_t generated = hashMap(map);
+
+	threads.set(1);
+	editor.borderizeMap(false);
+	const uint64_t serial = hashMap(map);
+	check(serial != generated, "Borderizing the map added no border");
+
+	for (MapIterator it = map.begin(); it != map.end(); ++it) {
+		(*it)->get()->cleanBorders();
+	}
+	check(hashMap(map) == generated, "Removing the borders did not restore the generated map");
+
+	threads.set(getSelfTestThreads());
+	editor.borderizeMap(false);
+	check(hashMap(map) == serial, "Borderizing with several threads differs from one thread");
+
+	// A block large enough for Editor::draw to borderize in parallel
+	PositionVector todraw;
+	PositionVector toborder;
+	const int margin = MapSize / 8;
+	for (int x = Base + margin - 1; x <= Base + MapSize - margin; ++x) {
+		for (int y = Base + margin - 1; y <= Base + MapSize - margin; ++y) {
+			toborder.emplace_back(x, y, SelfTestFloor);
+			if (x >= Base + margin && x < Base + MapSize - margin && y >= Base + margin && y < Base + MapSize - margin) {
+				todraw.emplace_back(x, y, SelfTestFloor);
+			}
+		}
+	}
+
+	Brush* previousBrush = g_gui.GetCurrentBrush();
+	g_gui.SelectBrushInternal(patchBrush);
+
+	threads.set(1);
+	PositionVector serialBorder = toborder;
+	editor.draw(todraw, serialBorder, false);
+	const uint64_t serialStroke = hashMap(map);
+	editor.undo();
+	check(hashMap(map) == serial, "Undoing the stroke did not restore the map");
+
+	threads.set(getSelfTestThreads());
+	PositionVector parallelBorder = toborder;
+	editor.draw(todraw, parallelBorder, false);
+	check(hashMap(map) == serialStroke, "Drawing with several threads differs from one thread");
+
+	g_gui.SelectBrushInternal(previousBrush);
+	return failures.empty();
+}
+
+bool EditorTests::bitmapConvertThreads(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting threads(Config::WORKER_THREADS);
+
+	// Blocks of two mapped colours and an ignored one, each pixel a little off its colour, some
+	// transparent. Tall enough for the converter to split the rows between several workers.
+	const int width = 512;
+	const int height = 512;
+	const int tolerance = 10;
+	const std::vector<ColorMapping> mappings = {
+		{ 40, 160, 40, groundBrush->getName(), false, MatchMode::MATCH_PIXEL_RGB },
+		{ 200, 180, 100, patchBrush->getName(), false, MatchMode::MATCH_PIXEL_RGB },
+		{ 0, 0, 255, std::string(), true, MatchMode::MATCH_PIXEL_RGB },
+	};
+
+	wxImage image(width, height);
+	image.InitAlpha();
+	std::mt19937 random(0);
+	int expectedPlaced = 0;
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			const ColorMapping &mapping = mappings[((x / 24) * 5 + (y / 16) * 3) % mappings.size()];
+			const auto jitter = [&random](uint8_t channel) {
+				return static_cast<uint8_t>(std::clamp<int>(channel + static_cast<int>(random() % 7) - 3, 0, 255));
+			};
+			const bool transparent = (x + y) % 37 == 0;
+			image.SetRGB(x, y, jitter(mapping.r), jitter(mapping.g), jitter(mapping.b));
+			image.SetAlpha(x, y, transparent ? 0 : 255);
+			if (!transparent && !mapping.ignore) {
+				++expectedPlaced;
+			}
+		}
+	}
+
+	const auto convert = [&](int threadCount) {
+		threads.set(threadCount);
+		// The ground variations are random, in pixel order
+		mt_seed(0);
+		BitmapToMapConverter converter(editor);
+		return converter.convert(image, mappings, tolerance, MatchMode::MATCH_PIXEL_RGB, Base, Base, SelfTestFloor);
+	};
+
+	const uint64_t empty = hashMap(map);
+	const ConvertResult serial = convert(1);
+	check(serial.success, "Converting the bitmap failed: " + nstr(serial.errorMessage));
+	check(serial.tilesPlaced == expectedPlaced, fmt::format("Converting placed {} tiles, expected {}", serial.tilesPlaced, expectedPlaced));
+	check(serial.tilesPlaced + serial.tilesSkipped == width * height, "Some pixels were neither placed nor skipped");
+	const uint64_t serialHash = hashMap(map);
+
+	editor.undo();
+	check(hashMap(map) == empty, "Undoing the conversion did not restore the map");
+
+	const ConvertResult parallel = convert(getSelfTestThreads());
+	check(parallel.tilesPlaced == serial.tilesPlaced && parallel.tilesSkipped == serial.tilesSkipped, "Converting with several threads placed other tiles than one thread");
+	check(hashMap(map) == serialHash, "Converting with several threads differs from one thread");
+	return failures.empty();
+}
+
+bool EditorTests::moveUndo(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting mergeMove(Config::MERGE_MOVE);
+	mergeMove.set(0);
+	generateMap(editor);
+	editor.borderizeMap(false);
+
+	// One house moves with the selection, the other loses the tiles the selection lands on
+	const auto addHouse = [&map](int left, int top, int size) {
+		House* house = newd House(map);
+		house->id = map.houses.getEmptyID();
+		house->name = "Self test house " + std::to_string(house->id);
+		map.houses.addHouse(house);
+		for (int x = left; x < left + size; ++x) {
+			for (int y = top; y < top + size; ++y) {
+				if (Tile* tile = map.getTile(x, y, SelfTestFloor)) {
+					house->addTile(tile);
+				}
+			}
+		}
+		return house;
+	};
+	const House* movedHouse = addHouse(Base + 190, Base + 190, 12);
+	const House* replacedHouse = addHouse(Base + 236, Base + 236, 12);
+
+	Tile* spawnTile = map.getTile(Base + 200, Base + 210, SelfTestFloor);
+	spawnTile->spawnMonster = newd SpawnMonster(3);
+	map.addSpawnMonster(spawnTile);
+	for (int x = Base + 180; x < Base + 240; x += 3) {
+		map.getTile(x, Base + 185, SelfTestFloor)->modify();
+	}
+
+	const uint64_t original = hashMap(map, false);
+	const Tile* cornerTile = map.getTile(Base + 180, Base + 180, SelfTestFloor);
+	const PositionList movedHouseTiles = movedHouse->getTiles();
+	const PositionList replacedHouseTiles = replacedHouse->getTiles();
+
+	// Overlapping the sources, and running past the generated tiles
+	SelectionArea area;
+	area.add({ Base + 180, Base + 180, Base + 239, Base + 239, SelfTestFloor });
+	const Position offset(40, 30, 0);
+	Selection &selection = editor.getSelection();
+	selection.start();
+	selection.add(area);
+	selection.finish();
+
+	editor.moveSelection(Position(0, 0, 0) - offset);
+	const uint64_t moved = hashMap(map);
+	check(moved != original, "Moving the selection changed nothing");
+	check(map.getTile(Base + 180 + offset.x, Base + 180 + offset.y, SelfTestFloor) == cornerTile, "The selection was copied instead of relinked");
+	check(map.getTile(Base + 200 + offset.x, Base + 210 + offset.y, SelfTestFloor)->spawnMonster != nullptr, "The spawn did not move");
+
+	// A copying move leaves empty tiles behind
+	bool vacated = true;
+	area.forEachPosition([&](const Position &position) {
+		if (!area.contains(position - offset)) {
+			const Tile* tile = map.getTile(position);
+			vacated = vacated && tile && !tile->ground && tile->isModified();
+		}
+	});
+	check(vacated, "The move did not leave modified empty tiles at the sources");
+
+	PositionList expectedMoved;
+	for (const Position &position : movedHouseTiles) {
+		expectedMoved.push_back(position + offset);
+	}
+	check(movedHouse->getTiles() == expectedMoved, "The moved house tiles are not in their original order");
+
+	editor.undo();
+	check(hashMap(map, false) == original, "Undoing the move did not restore the map");
+	check(movedHouse->getTiles() == movedHouseTiles, "Undo did not restore the moved house tile list");
+	check(replacedHouse->getTiles() == replacedHouseTiles, "Undo did not restore the replaced house tile list");
+
+	// Undoing a copying move leaves empty tiles at the destinations that had none
+	bool filled = true;
+	area.forEachPosition([&](const Position &position) {
+		filled = filled && map.getTile(position + offset);
+	});
+	check(filled, "Undo left destinations without a tile");
+
+	editor.redo();
+	check(hashMap(map) == moved, "Redoing the move differs from the move");
+	return failures.empty();
+}
+
+bool EditorTests::spritePreload(Editor &editor) {
+	// Sheets nothing has drawn yet
+	std::vector<SpriteSheetPtr> sheets;
+	for (const SpriteSheetPtr &sheet : g_spriteAppearances.getSheets()) {
+		if (!sheet->data) {
+			sheets.push_back(sheet);
+			if (sheets.size() == 16) {
+				break;
+			}
+		}
+	}
+	if (!check(sheets.size() >= 4, "The client data has too few sheets left to load")) {
+		return false;
+	}
+
+	// Two requests sharing some sheets, the second made while the first is still loading
+	const size_t half = sheets.size() / 2;
+	std::vector<int> firstIds;
+	std::vector<int> secondIds;
+	for (size_t index = 0; index < sheets.size(); ++index) {
+		if (index < half + 2) {
+			firstIds.push_back(sheets[index]->firstId);
+		}
+		if (index >= half) {
+			secondIds.push_back(sheets[index]->firstId);
+		}
+	}
+
+	size_t firstCalls = 0;
+	size_t secondCalls = 0;
+	g_spriteAppearances.preloadSpriteSheets(firstIds, [&firstCalls]() { ++firstCalls; });
+	g_spriteAppearances.preloadSpriteSheets(secondIds, [&secondCalls]() { ++secondCalls; });
+
+	// The sheets are installed from the event loop
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+	const auto loading = [&sheets]() {
+		return std::ranges::any_of(sheets, [](const SpriteSheetPtr &sheet) {
+			return g_spriteAppearances.isSpriteLoading(sheet->firstId);
+		});
+	};
+	while (loading() && std::chrono::steady_clock::now() < deadline) {
+		wxTheApp->Yield(true);
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	if (!check(!loading(), "The sheets did not load within a minute")) {
+		return false;
+	}
+
+	check(firstCalls == firstIds.size(), fmt::format("The first request was called back {} times, expected {}", firstCalls, firstIds.size()));
+	check(secondCalls == secondIds.size(), fmt::format("The second request was called back {} times, expected {}", secondCalls, secondIds.size()));
+
+	for (const SpriteSheetPtr &sheet : sheets) {
+		const auto expected = SpriteAppearances::decodeSpriteSheet(sheet->path);
+		check(sheet->data && expected && std::memcmp(sheet->data.get(), expected.get(), BYTES_IN_SPRITE_SHEET) == 0, "The pixels of sheet " + sheet->path + " differ from a direct decode");
+	}
+	return failures.empty();
+}
+
+bool EditorTests::dataFileTasks(Editor &editor) {
+	SelfTestSetting threads(Config::WORKER_THREADS);
+
+	// Tasks of uneven length, some failing, each with its own warnings
+	const size_t taskCount = 24;
+	std::vector<std::atomic<int>> runs(taskCount);
+	const auto makeTasks = [&runs]() {
+		std::vector<DataFileTask> tasks(taskCount);
+		for (size_t index = 0; index < taskCount; ++index) {
+			tasks[index].status = fmt::format("Self test task {} ...", index);
+			tasks[index].load = [&runs, index](wxString &error, wxArrayString &warnings) {
+				++runs[index];
+				std::this_thread::sleep_for(std::chrono::milliseconds((index * 7) % 5));
+				for (size_t warning = 0; warning < index % 3; ++warning) {
+					warnings.push_back(wxString::Format("Task %zu warning %zu", index, warning));
+				}
+				if (index % 5 == 2) {
+					error = wxString::Format("Task %zu failed", index);
+				}
+			};
+		}
+		return tasks;
+	};
+
+	const auto run = [&](int threadCount, wxString &error, wxArrayString &warnings) {
+		threads.set(threadCount);
+		for (std::atomic<int> &count : runs) {
+			count = 0;
+		}
+		std::vector<DataFileTask> tasks = makeTasks();
+		const bool success = RunDataFileTasks(tasks, 0, 100, error, warnings);
+		check(std::ranges::all_of(runs, [](const std::atomic<int> &count) { return count == 1; }), fmt::format("With {} threads a task did not run exactly once", threadCount));
+		return success;
+	};
+
+	wxString serialError;
+	wxArrayString serialWarnings;
+	const bool serialSuccess = run(1, serialError, serialWarnings);
+	check(!serialSuccess && serialError == "Task 22 failed", "The serial run did not report the last failing task");
+
+	wxString parallelError;
+	wxArrayString parallelWarnings;
+	const bool parallelSuccess = run(getSelfTestThreads(), parallelError, parallelWarnings);
+	check(parallelSuccess == serialSuccess && parallelError == serialError, "Running the tasks in parallel reports another error than one after another");
+	check(parallelWarnings == serialWarnings, "Running the tasks in parallel merges the warnings in another order");
+
+	// The data files themselves. items.xml can only be parsed into g_items, on top of the
+	// appearances, where parsing it again sets the same values; the creatures get new databases.
+	using ItemFields = DataSnapshot::ItemFields;
+	const auto loadDataFiles = [&](int threadCount, MonsterDatabase &monsters, NpcDatabase &npcs, std::vector<ItemFields> &items, wxString &error, wxArrayString &warnings) {
+		threads.set(threadCount);
+		std::vector<DataFileTask> tasks = CreateDataFileTasks(g_items, monsters, npcs);
+		const bool success = RunDataFileTasks(tasks, 0, 100, error, warnings);
+		for (uint16_t id = g_items.getMinID(); id <= g_items.getMaxID() && id != 0; ++id) {
+			if (g_items.isValidID(id)) {
+				items.push_back(DataSnapshot::getItemFields(g_items.getItemType(id)));
+			}
+		}
+		return success;
+	};
+	const auto getCreatures = [](auto &database) {
+		std::vector<std::string> types;
+		for (const auto &[key, type] : database) {
+			const Outfit &outfit = type->outfit;
+			types.push_back(fmt::format("{} {} {} {} {} {} {} {} {} {} {} {} {}", key, type->name, type->standard, type->missing, outfit.name, outfit.lookType, outfit.lookItem, outfit.lookMount, outfit.lookAddon, outfit.lookHead, outfit.lookBody, outfit.lookLegs, outfit.lookFeet));
+		}
+		return types;
+	};
+
+	MonsterDatabase serialMonsters;
+	NpcDatabase serialNpcs;
+	std::vector<ItemFields> serialItems;
+	wxString serialDataError;
+	wxArrayString serialDataWarnings;
+	const bool serialLoaded = loadDataFiles(1, serialMonsters, serialNpcs, serialItems, serialDataError, serialDataWarnings);
+	check(serialLoaded, "Loading the data files failed: " + nstr(serialDataError));
+	check(!serialItems.empty() && serialMonsters.begin() != serialMonsters.end() && serialNpcs.begin() != serialNpcs.end(), "The data files left a database empty");
+
+	MonsterDatabase parallelMonsters;
+	NpcDatabase parallelNpcs;
+	std::vector<ItemFields> parallelItems;
+	wxString parallelDataError;
+	wxArrayString parallelDataWarnings;
+	const bool parallelLoaded = loadDataFiles(getSelfTestThreads(), parallelMonsters, parallelNpcs, parallelItems, parallelDataError, parallelDataWarnings);
+	check(parallelLoaded == serialLoaded && parallelDataError == serialDataError, "Loading the data files in parallel reports another error than one after another");
+	check(parallelDataWarnings == serialDataWarnings, "Loading the data files in parallel gives other warnings than one after another");
+	check(parallelItems == serialItems, "Loading the data files in parallel leaves other item types than one after another");
+	check(getCreatures(parallelMonsters) == getCreatures(serialMonsters), "Loading the data files in parallel gives other monsters than one after another");
+	check(getCreatures(parallelNpcs) == getCreatures(serialNpcs), "Loading the data files in parallel gives other npcs than one after another");
+	return failures.empty();
+}
+
+bool EditorTests::convertThreads(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting threads(Config::WORKER_THREADS);
+	generateMap(editor);
+	editor.borderizeMap(false);
+	const uint64_t generated = hashMap(map);
+
+	// Sorted ground and border ids of every tile, the keys Map::convert looks up
+	std::set<uint16_t> groundIds;
+	std::set<uint16_t> borderIds;
+	std::set<std::vector<uint16_t>> keys;
+	for (MapIterator it = map.begin(); it != map.end(); ++it) {
+		const Tile* tile = (*it)->get();
+		std::vector<uint16_t> key;
+		if (tile->ground) {
+			groundIds.insert(tile->ground->getID());
+			key.push_back(tile->ground->getID());
+		}
+		for (const Item* item : tile->items) {
+			if (item->isBorder()) {
+				borderIds.insert(item->getID());
+				key.push_back(item->getID());
+			}
+		}
+		std::ranges::sort(key);
+		keys.insert(std::move(key));
+	}
+	const std::vector<uint16_t> grounds(groundIds.begin(), groundIds.end());
+	const std::vector<uint16_t> borders(borderIds.begin(), borderIds.end());
+	if (grounds.size() < 2 || borders.size() < 2) {
+		check(false, "The generated map has too few ground and border ids to convert");
+		return false;
+	}
+
+	// Keys of every length map to a ground with a border, every other id is replaced one to many
+	ConversionMap table;
+	size_t index = 0;
+	for (const std::vector<uint16_t> &key : keys) {
+		if (!key.empty() && index % 3 == 0) {
+			const std::vector<uint16_t> prefix(key.begin(), key.begin() + 1 + index % key.size());
+			table.mtm[prefix] = { grounds[index % grounds.size()], borders[index % borders.size()] };
+		}
+		++index;
+	}
+	for (size_t i = 1; i < grounds.size(); i += 2) {
+		table.stm[grounds[i]] = { grounds[i - 1] };
+	}
+	for (size_t i = 1; i < borders.size(); i += 2) {
+		table.stm[borders[i]] = { borders[i - 1], borders[(i + 1) % borders.size()] };
+	}
+
+	// Map::convert can't be undone, so the parallel run converts a copy
+	Map copy;
+	for (MapIterator it = map.begin(); it != map.end(); ++it) {
+		const Tile* tile = (*it)->get();
+		Tile* tileCopy = tile->deepCopy(copy);
+		if (tile->isModified()) {
+			tileCopy->modify();
+		}
+		copy.setTile(tileCopy);
+	}
+	check(hashMap(copy) == generated, "Copying the map changed its tiles");
+
+	threads.set(1);
+	map.convert(table);
+	const uint64_t serial = hashMap(map);
+	check(serial != generated, "The conversion table changed no tile");
+
+	threads.set(getSelfTestThreads());
+	copy.convert(table);
+	check(hashMap(copy) == serial, "Converting with several threads differs from one thread");
+	return failures.empty();
+}
+
+bool EditorTests::importThreads(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting threads(Config::WORKER_THREADS);
+	generateMap(editor);
+	editor.borderizeMap(false);
+
+	const std::string houseName = "Self test import house";
+	House* house = newd House(map);
+	house->id = map.houses.getEmptyID();
+	house->name = houseName;
+	map.houses.addHouse(house);
+	for (int x = Base + 100; x < Base + 108; ++x) {
+		for (int y = Base + 100; y < Base + 108; ++y) {
+			house->addTile(map.getTile(x, y, SelfTestFloor));
+		}
+	}
+	house->setExit(&map, Position(Base + 99, Base + 100, SelfTestFloor));
+
+	Tile* spawnTile = map.getTile(Base + 150, Base + 150, SelfTestFloor);
+	spawnTile->spawnMonster = newd SpawnMonster(3);
+	map.addSpawnMonster(spawnTile);
+
+	const wxString directory = wxStandardPaths::Get().GetTempDir();
+	FileName file(directory, "rme-selftest-import.otbm");
+	map.setHouseFilename("rme-selftest-import-house.xml");
+	map.setSpawnMonsterFilename("rme-selftest-import-monster.xml");
+	map.setSpawnNpcFilename("rme-selftest-import-npc.xml");
+	map.setZoneFilename("rme-selftest-import-zones.xml");
+	IOMapOTBM saver(map.getVersion());
+	const bool saved = saver.saveMap(map, file);
+	check(saved, "Could not save " + nstr(file.GetFullPath()));
+
+	// A floor of the generated area, with houses by name since imported houses get new ids
+	const auto hashFloor = [&map](int z) {
+		MapHasher hasher;
+		for (int x = Base; x < Base + MapSize; ++x) {
+			for (int y = Base; y < Base + MapSize; ++y) {
+				const Tile* tile = map.getTile(x, y, z);
+				hasher.add(tile != nullptr);
+				if (!tile) {
+					continue;
+				}
+				const House* tileHouse = tile->isHouseTile() ? map.houses.getHouse(tile->getHouseID()) : nullptr;
+				hasher.add(tileHouse ? tileHouse->name : std::string());
+				hasher.add(tile->isHouseExit());
+				hasher.add(tile->getMapFlags());
+				hasher.add(tile->ground ? tile->ground->getID() : 0);
+				if (tile->ground) {
+					hasher.add(tile->ground);
+				}
+				hasher.add(tile->items.size());
+				for (const Item* item : tile->items) {
+					hasher.add(item);
+				}
+				hasher.add(tile->spawnMonster ? tile->spawnMonster->getSize() : 0);
+			}
+		}
+		return hasher.get();
+	};
+	// Tile order of the imported house on a floor
+	const auto houseTiles = [&map, &houseName](int z) {
+		std::vector<std::pair<int, int>> tiles;
+		for (const auto &[id, imported] : map.houses) {
+			if (imported->name != houseName || imported->getExit().z != z) {
+				continue;
+			}
+			for (const Position &position : imported->getTiles()) {
+				tiles.emplace_back(position.x, position.y);
+			}
+		}
+		return tiles;
+	};
+	const uint64_t original = hashFloor(SelfTestFloor);
+
+	if (saved) {
+		threads.set(1);
+		check(editor.importMap(file, 0, 0, -1, IMPORT_INSERT, IMPORT_MERGE, IMPORT_MERGE, false), "Importing with one thread failed");
+		threads.set(getSelfTestThreads());
+		check(editor.importMap(file, 0, 0, -2, IMPORT_INSERT, IMPORT_MERGE, IMPORT_MERGE, false), "Importing with several threads failed");
+
+		check(hashFloor(SelfTestFloor - 1) == original, "Importing with one thread did not reproduce the saved floor");
+		check(hashFloor(SelfTestFloor - 2) == original, "Importing with several threads did not reproduce the saved floor");
+		const std::vector<std::pair<int, int>> serialTiles = houseTiles(SelfTestFloor - 1);
+		check(serialTiles.size() == 64, "The house imported with one thread lost tiles");
+		check(houseTiles(SelfTestFloor - 2) == serialTiles, "Importing with several threads orders the house tiles differently");
+	}
+
+	for (const std::string &name : { map.getHouseFilename(), map.getSpawnFilename(), map.getSpawnNpcFilename(), map.getZoneFilename() }) {
+		wxRemoveFile(directory + wxFileName::GetPathSeparator() + wxstr(name));
+	}
+	wxRemoveFile(file.GetFullPath());
+	return failures.empty();
+}
+
+bool EditorTests::minimapExportThreads(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting threads(Config::WORKER_THREADS);
+	generateMap(editor);
+	editor.borderizeMap(false);
+
+	// A second floor over part of the map, so the OTMM file holds blocks of several floors
+	for (int x = Base + MapSize / 4; x < Base + MapSize * 3 / 4; ++x) {
+		for (int y = Base + MapSize / 4; y < Base + MapSize * 3 / 4; ++y) {
+			Tile* tile = map.createTile(x, y, SelfTestFloor - 1);
+			patchBrush->draw(&map, tile, nullptr);
+			tile->update();
+		}
+	}
+
+	// Every exporter writes into its own directory, the files are compared byte by byte
+	const wxString root = wxStandardPaths::Get().GetTempDir() + wxFileName::GetPathSeparator() + "rme-selftest-minimap-";
+	const auto exportAll = [&](int threadCount) {
+		threads.set(threadCount);
+		const wxString directory = root + std::to_string(threadCount);
+		wxFileName::Rmdir(directory, wxPATH_RMDIR_RECURSIVE);
+		wxFileName::Mkdir(directory, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+		IOMinimap otmm(&editor, MinimapExportFormat::Otmm, MinimapExportMode::AllFloors, false);
+		check(otmm.saveMinimap(nstr(directory), "minimap"), "Could not export the OTMM minimap: " + otmm.getError());
+		IOMinimap png(&editor, MinimapExportFormat::Png, MinimapExportMode::AllFloors, false, 256);
+		check(png.saveMinimap(nstr(directory), "minimap"), "Could not export the minimap images: " + png.getError());
+		check(map.exportMinimap(FileName(directory, "minimap.bmp"), SelfTestFloor), "Could not export the map minimap");
+
+		std::map<std::string, std::string> files;
+		wxArrayString paths;
+		wxDir::GetAllFiles(directory, &paths);
+		for (const wxString &path : paths) {
+			std::ifstream file(nstr(path), std::ios::binary);
+			files[nstr(wxFileName(path).GetFullName())] = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+		wxFileName::Rmdir(directory, wxPATH_RMDIR_RECURSIVE);
+		return files;
+	};
+
+	const std::map<std::string, std::string> serial = exportAll(1);
+	// The OTMM file, an image of each floor and the map minimap
+	check(serial.size() == 4, fmt::format("Exporting with one thread wrote {} files instead of 4", serial.size()));
+
+	const std::map<std::string, std::string> parallel = exportAll(getSelfTestThreads());
+	for (const auto &[name, content] : serial) {
+		const auto it = parallel.find(name);
+		if (it == parallel.end()) {
+			check(false, "Exporting with several threads did not write " + name);
+		} else {
+			check(it->second == content, "Exporting with several threads wrote another " + name);
+		}
+	}
+	check(parallel.size() == serial.size(), "Exporting with several threads wrote other files");
+	return failures.empty();
+}
+
+bool EditorTests::renderImage(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting threads(Config::WORKER_THREADS);
+	generateMap(editor);
+	editor.borderizeMap(false);
+
+	Position floorFrom;
+	Position floorTo;
+	const bool hasBounds = MapImageRenderer::getFloorBounds(map, SelfTestFloor, floorFrom, floorTo);
+	check(hasBounds && floorFrom == Position(Base, Base, SelfTestFloor) && floorTo == Position(Base + MapSize - 1, Base + MapSize - 1, SelfTestFloor), "The floor bounds are not the generated area");
+	Position emptyFrom;
+	Position emptyTo;
+	check(!MapImageRenderer::getFloorBounds(map, SelfTestFloor - 1, emptyFrom, emptyTo), "An empty floor has bounds");
+
+	// Taller than one strip and across several patches, so strips and borders meet inside it
+	const Position from(Base + 8, Base + 8, SelfTestFloor);
+	const Position to(Base + 55, Base + 47, SelfTestFloor);
+	const int middleX = Base + 30;
+	const int middleY = Base + 27;
+
+	const wxString directory = wxStandardPaths::Get().GetTempDir() + wxFileName::GetPathSeparator();
+	std::vector<wxString> files;
+	const auto render = [&](const Position &areaFrom, const Position &areaTo) {
+		const wxString file = directory + wxString::Format("rme-selftest-render-%zu.png", files.size());
+		files.push_back(file);
+		MapImageRenderer renderer(map, false);
+		check(renderer.render(areaFrom, areaTo, nstr(file)), "Could not render the map: " + renderer.getError());
+		wxImage image;
+		check(image.LoadFile(file, wxBITMAP_TYPE_PNG) && image.HasAlpha(), "The rendered image is not a PNG with alpha");
+		return image;
+	};
+	const auto readFile = [](const wxString &file) {
+		std::ifstream stream(nstr(file), std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	};
+
+	threads.set(1);
+	const wxImage whole = render(from, to);
+	if (whole.IsOk()) {
+		check(whole.GetWidth() == (to.x - from.x + 1) * rme::TileSize && whole.GetHeight() == (to.y - from.y + 1) * rme::TileSize, "The image does not have the size of the area");
+
+		// Every tile has a ground, so every tile shows something
+		for (int y = 0; y < whole.GetHeight(); y += rme::TileSize) {
+			for (int x = 0; x < whole.GetWidth(); x += rme::TileSize) {
+				bool drawn = false;
+				for (int i = 0; i < rme::TileSize * rme::TileSize && !drawn; ++i) {
+					drawn = whole.GetAlpha(x + i % rme::TileSize, y + i / rme::TileSize) != 0;
+				}
+				if (!drawn) {
+					check(false, fmt::format("Tile {}, {} is not drawn", from.x + x / rme::TileSize, from.y + y / rme::TileSize));
+				}
+			}
+		}
+	}
+
+	threads.set(getSelfTestThreads());
+	render(from, to);
+	check(readFile(files[0]) == readFile(files[1]), "Rendering with several threads wrote another file");
+
+	// The quarters of the area have to look like the same parts of the whole image
+	const std::vector<std::pair<Position, Position>> quarters = {
+		{ from, Position(middleX, middleY, SelfTestFloor) },
+		{ Position(middleX + 1, from.y, SelfTestFloor), Position(to.x, middleY, SelfTestFloor) },
+		{ Position(from.x, middleY + 1, SelfTestFloor), Position(middleX, to.y, SelfTestFloor) },
+		{ Position(middleX + 1, middleY + 1, SelfTestFloor), to },
+	};
+	for (const auto &[quarterFrom, quarterTo] : quarters) {
+		const wxImage quarter = render(quarterFrom, quarterTo);
+		if (!quarter.IsOk() || !whole.IsOk()) {
+			continue;
+		}
+		const int left = (quarterFrom.x - from.x) * rme::TileSize;
+		const int top = (quarterFrom.y - from.y) * rme::TileSize;
+		bool same = true;
+		for (int y = 0; y < quarter.GetHeight() && same; ++y) {
+			for (int x = 0; x < quarter.GetWidth() && same; ++x) {
+				same = quarter.GetRed(x, y) == whole.GetRed(left + x, top + y) && quarter.GetGreen(x, y) == whole.GetGreen(left + x, top + y) && quarter.GetBlue(x, y) == whole.GetBlue(left + x, top + y) && quarter.GetAlpha(x, y) == whole.GetAlpha(left + x, top + y);
+			}
+		}
+		check(same, fmt::format("The quarter from {}, {} differs from the whole image", quarterFrom.x, quarterFrom.y));
+	}
+
+	for (const wxString &file : files) {
+		wxRemoveFile(file);
+	}
+	return failures.empty();
+}
+
+bool EditorTests::dataSnapshot(Editor &editor) {
+	const wxString directory = wxStandardPaths::Get().GetTempDir();
+	const FileName source(directory, "rme-selftest-snapshot-source.xml");
+	const FileName file(directory, "rme-selftest-snapshot.bin");
+	const auto writeSource = [&source](const std::string &content) {
+		std::ofstream stream(nstr(source.GetFullPath()), std::ios::binary | std::ios::trunc);
+		stream << content;
+	};
+	writeSource("<items version=\"1\"/>");
+
+	// The first, a middle and the last item type stand in for what items.xml changes
+	std::vector<uint16_t> ids;
+	for (uint16_t id = g_items.getMinID(); id <= g_items.getMaxID() && id != 0; ++id) {
+		if (g_items.isValidID(id)) {
+			ids.push_back(id);
+		}
+	}
+	if (ids.size() < 3) {
+		check(false, "Too few item types are loaded");
+		return false;
+	}
+	ids = { ids.front(), ids[ids.size() / 2], ids.back() };
+
+	struct Fields {
+		std::string name;
+		std::string description;
+		float weight;
+		int32_t armor;
+		bool canReadText;
+		bool floorChangeNorth;
+
+		bool operator==(const Fields &other) const = default;
+	};
+	const auto getFields = [](uint16_t id) {
+		const ItemType &type = g_items.getItemType(id);
+		return Fields { type.name, type.description, type.weight, type.armor, type.canReadText, type.floorChangeNorth };
+	};
+	const auto setFields = [](uint16_t id, const Fields &fields) {
+		ItemType &type = g_items.getItemType(id);
+		type.name = fields.name;
+		type.description = fields.description;
+		type.weight = fields.weight;
+		type.armor = fields.armor;
+		type.canReadText = fields.canReadText;
+		type.floorChangeNorth = fields.floorChangeNorth;
+	};
+	const auto checkFields = [&](const std::vector<Fields> &expected, const std::string &message) {
+		for (size_t i = 0; i < ids.size(); ++i) {
+			check(getFields(ids[i]) == expected[i], fmt::format("{}, item {}", message, ids[i]));
+		}
+	};
+
+	std::vector<Fields> original;
+	std::vector<Fields> changed;
+	for (size_t i = 0; i < ids.size(); ++i) {
+		original.push_back(getFields(ids[i]));
+		changed.push_back({ fmt::format("self test item {}", ids[i]), "Changed by the self test", 1.5f * (i + 1), static_cast<int32_t>(7 + i), !original[i].canReadText, !original[i].floorChangeNorth });
+	}
+	const auto creatureCount = []() {
+		return std::make_pair(std::distance(g_monsters.begin(), g_monsters.end()), std::distance(g_npcs.begin(), g_npcs.end()));
+	};
+	const auto creatures = creatureCount();
+
+	// What parsing items.xml would leave behind, saved along with the warnings it gave
+	DataSnapshot snapshot(file);
+	snapshot.addSource(source);
+	snapshot.captureItems();
+	for (size_t i = 0; i < ids.size(); ++i) {
+		setFields(ids[i], changed[i]);
+	}
+	wxArrayString warnings;
+	warnings.push_back("Self test warning 1");
+	warnings.push_back("Self test warning 2");
+	check(snapshot.save(warnings), "Could not save the snapshot");
+	for (size_t i = 0; i < ids.size(); ++i) {
+		setFields(ids[i], original[i]);
+	}
+
+	DataSnapshot loader(file);
+	loader.addSource(source);
+	wxArrayString loadedWarnings;
+	check(loader.load(loadedWarnings), "Could not load the snapshot");
+	checkFields(changed, "Loading the snapshot did not restore the changed fields");
+	check(loadedWarnings == warnings, "Loading the snapshot did not restore the warnings");
+	check(creatureCount() == creatures, "Loading the snapshot added monsters or npcs that were loaded already");
+	for (size_t i = 0; i < ids.size(); ++i) {
+		setFields(ids[i], original[i]);
+	}
+
+	// A cut off snapshot is rejected before anything is applied
+	std::error_code ec;
+	const std::filesystem::path path(nstr(file.GetFullPath()));
+	std::filesystem::resize_file(path, std::filesystem::file_size(path, ec) - 1, ec);
+	DataSnapshot truncated(file);
+	truncated.addSource(source);
+	wxArrayString truncatedWarnings;
+	check(!truncated.load(truncatedWarnings) && truncatedWarnings.empty(), "A truncated snapshot was loaded");
+	checkFields(original, "A truncated snapshot changed an item");
+
+	// Edits that keep the size of a source make the snapshot out of date too
+	DataSnapshot current(file);
+	current.addSource(source);
+	current.captureItems();
+	check(current.save(wxArrayString()), "Could not save the snapshot again");
+	writeSource("<items version=\"2\"/>");
+	DataSnapshot stale(file);
+	stale.addSource(source);
+	wxArrayString staleWarnings;
+	check(!stale.load(staleWarnings), "A snapshot of a changed source was loaded");
+
+	wxRemoveFile(file.GetFullPath());
+	wxRemoveFile(source.GetFullPath());
+	return failures.empty();
+}
+
+bool EditorTests::borderTable(Editor &editor) {
+	// No brush, then every loaded ground brush
+	std::vector<GroundBrush*> grounds = { nullptr };
+	for (const auto &[name, brush] : g_brushes.getMap()) {
+		if (brush->isGround()) {
+			GroundBrush* ground = brush->asGround();
+			check(ground->border_index != 0, "Ground brush " + name + " has no row in the border table");
+			grounds.push_back(ground);
+		}
+	}
+
+	size_t mismatches = 0;
+	for (GroundBrush* first : grounds) {
+		for (GroundBrush* second : grounds) {
+			if (GroundBrush::getBrushTo(first, second) != GroundBrush::findBrushTo(first, second)) {
+				++mismatches;
+			}
+		}
+	}
+	check(mismatches == 0, fmt::format("{} of {} ground brush pairs get another border from the table", mismatches, grounds.size() * grounds.size()));
+	return failures.empty();
+}
+
+bool EditorTests::journalUndo(Editor &editor) {
+	Map &map = editor.getMap();
+	const ActionQueue &queue = *editor.getHistoryActions();
+	// Every batch but the one next to the current index goes to the journal
+	SelfTestSetting memorySize(Config::UNDO_MEM_SIZE);
+	memorySize.set(0);
+	SelfTestSetting spill(Config::UNDO_SPILL_TO_DISK);
+	spill.set(1);
+	SelfTestSetting group(Config::GROUP_ACTIONS);
+	group.set(0);
+	SelfTestSetting mergeMove(Config::MERGE_MOVE);
+	mergeMove.set(0);
+	generateMap(editor);
+	editor.borderizeMap(false);
+
+	// Creatures and spawns where the strokes and the move pass, zones only under the strokes
+	// as tiles with zones are not relinked
+	const auto addCreatures = [&map](int x, int y) {
+		Tile* spawnTile = map.getTile(x, y, SelfTestFloor);
+		spawnTile->spawnMonster = newd SpawnMonster(2);
+		map.addSpawnMonster(spawnTile);
+		map.getTile(x + 1, y, SelfTestFloor)->addMonster(newd Monster("Self test monster"));
+
+		Tile* npcTile = map.getTile(x + 2, y + 1, SelfTestFloor);
+		npcTile->spawnNpc = newd SpawnNpc(1);
+		map.addSpawnNpc(npcTile);
+		npcTile->npc = newd Npc("Self test npc");
+	};
+	addCreatures(Base + 50, Base + 50);
+	addCreatures(Base + 160, Base + 160);
+	for (int x = Base + 44; x < Base + 56; ++x) {
+		map.getTile(x, Base + 56, SelfTestFloor)->addZone(7);
+	}
+
+	std::vector<uint64_t> states { hashMap(map, false) };
+	const auto record = [&](const std::string &step) {
+		check(static_cast<size_t>(queue.getCurrentIndex()) == states.size(), step + " did not add one undo step");
+		states.push_back(hashMap(map, false));
+	};
+
+	Brush* previousBrush = g_gui.GetCurrentBrush();
+	const auto stroke = [&](GroundBrush* brush, int from, int to) {
+		PositionVector todraw;
+		PositionVector toborder;
+		for (int x = from - 1; x <= to + 1; ++x) {
+			for (int y = from - 1; y <= to + 1; ++y) {
+				toborder.emplace_back(x, y, SelfTestFloor);
+				if (x >= from && x <= to && y >= from && y <= to) {
+					todraw.emplace_back(x, y, SelfTestFloor);
+				}
+			}
+		}
+		g_gui.SelectBrushInternal(brush);
+		editor.draw(todraw, toborder, false);
+	};
+	stroke(patchBrush, Base + 32, Base + 63);
+	record("The first stroke");
+	stroke(groundBrush, Base + 48, Base + 79);
+	record("The second stroke");
+	g_gui.SelectBrushInternal(previousBrush);
+
+	Selection &selection = editor.getSelection();
+	const auto select = [&](int from, int to) {
+		SelectionArea area;
+		area.add({ from, from, to, to, SelfTestFloor });
+		selection.start();
+		selection.clear();
+		selection.add(area);
+		selection.finish();
+	};
+	select(Base + 32, Base + 63);
+	record("Selecting the strokes");
+	g_gui.copybuffer.copy(editor, SelfTestFloor);
+	g_gui.copybuffer.paste(editor, Position(Base + 100, Base + 20, SelfTestFloor));
+	record("The paste");
+
+	check(editor.removeItemsOnMap([](Map &, Item* item) { return item->isBorder(); }, false) > 0, "Removing the borders removed nothing");
+	record("Removing the borders");
+	check(editor.removeTilesOnMap([](Map &, Tile* tile) { return tile->getX() >= Base + 240; }) == 16 * MapSize, "Removing the tiles of the last columns removed another count");
+	record("Removing tiles");
+
+	select(Base + 150, Base + 179);
+	record("Selecting the creatures");
+	const Position offset(20, 10, 0);
+	const Tile* cornerTile = map.getTile(Base + 150, Base + 150, SelfTestFloor);
+	editor.moveSelection(Position(0, 0, 0) - offset);
+	check(map.getTile(Base + 150 + offset.x, Base + 150 + offset.y, SelfTestFloor) == cornerTile, "The selection was copied instead of relinked");
+	record("The move");
+
+	const size_t spilled = std::ranges::count_if(queue.getActions(), [](const BatchAction* batch) { return batch && batch->isSpilled(); });
+	if (!check(spilled + 1 == queue.size(), fmt::format("{} of {} undo steps were written to the journal, expected all but one", spilled, queue.size()))) {
+		return false;
+	}
+
+	for (size_t step = states.size() - 1; step > 0; --step) {
+		editor.undo();
+		check(static_cast<size_t>(queue.getCurrentIndex()) == step - 1, fmt::format("Undo step {} failed", step));
+		check(hashMap(map, false) == states[step - 1], fmt::format("Undoing step {} from the journal did not restore the map", step));
+	}
+	for (size_t step = 1; step < states.size(); ++step) {
+		editor.redo();
+		check(static_cast<size_t>(queue.getCurrentIndex()) == step, fmt::format("Redo step {} failed", step));
+		check(hashMap(map, false) == states[step], fmt::format("Redoing step {} from the journal differs from the edit", step));
+	}
+	return failures.empty();
+}
+
+bool EditorTests::floorTraversal(Editor &editor) {
+	Map &map = editor.getMap();
+
+	// Scattered over every floor, around leaf and node edges and at both ends of the plane
+	std::mt19937 random(28);
+	std::uniform_int_distribution<int> coordinate(0, 0xFFFF);
+	std::uniform_int_distribution<int> floor(0, rme::MapMaxLayer);
+	for (int i = 0; i < 2000; ++i) {
+		map.createTile(coordinate(random), coordinate(random), floor(random));
+	}
+	for (int x = Base - 5; x < Base + 70; ++x) {
+		for (int y = Base - 3; y < Base + 9; y += 2) {
+			map.createTile(x, y, (x + y) % rme::MapLayers);
+		}
+	}
+	for (const int edge : { 0, 3, 4, 0xFFFB, 0xFFFC, 0xFFFF }) {
+		map.createTile(edge, edge, rme::MapGroundLayer);
+		map.createTile(edge, 0xFFFF - edge, rme::MapMaxLayer);
+	}
+
+	std::vector<Position> iterated;
+	for (MapIterator it = map.begin(); it != map.end(); ++it) {
+		iterated.push_back((*it)->get()->getPosition());
+	}
+	check(iterated.size() == map.getTileCount(), "MapIterator did not visit every tile");
+
+	const auto visitFloors = [](auto &&walk) {
+		std::vector<Position> positions;
+		walk([&positions](FloorSpan span) {
+			for (TileLocation &location : span) {
+				if (const Tile* tile = location.get()) {
+					positions.push_back(tile->getPosition());
+				}
+			}
+		});
+		return positions;
+	};
+	const auto filterIterated = [&iterated](auto &&keep) {
+		std::vector<Position> positions;
+		std::ranges::copy_if(iterated, std::back_inserter(positions), keep);
+		return positions;
+	};
+
+	const std::vector<Position> all = visitFloors([&map](auto &&visit) { map.forEachFloor(visit); });
+	check(all == iterated, "forEachFloor visits the tiles in another order than MapIterator");
+
+	const int minZ = 5;
+	const int maxZ = 9;
+	const std::vector<Position> floors = visitFloors([&map](auto &&visit) { map.forEachFloor(visit, minZ, maxZ); });
+	check(floors == filterIterated([](const Position &position) { return position.z >= minZ && position.z <= maxZ; }), "forEachFloor with a floor range differs from MapIterator");
+
+	// Not aligned to the leaves, spans may reach past the box by up to three tiles
+	const Position from(Base - 2, Base - 1, 2);
+	const Position to(Base + 61, Base + 6, 12);
+	const std::vector<Position> boxed = visitFloors([&](auto &&visit) { map.forEachFloor(visit, from, to); });
+	const auto inLeaves = [&](const Position &position) {
+		return position.x >= (from.x & ~3) && position.x <= (to.x | 3) && position.y >= (from.y & ~3) && position.y <= (to.y | 3) && position.z >= from.z && position.z <= to.z;
+	};
+	check(boxed == filterIterated(inLeaves), "forEachFloor with a box differs from MapIterator on the leaves of the box");
+	check(std::ranges::count_if(boxed, [&](const Position &position) { return position.x >= from.x && position.x <= to.x && position.y >= from.y && position.y <= to.y; }) > 0, "forEachFloor with a box found nothing inside of it");
+
+	const Position cornerFrom(0xFFF0, 0xFFF0, 0);
+	const std::vector<Position> corner = visitFloors([&](auto &&visit) { map.forEachFloor(visit, cornerFrom, Position(0xFFFF, 0xFFFF, rme::MapMaxLayer)); });
+	check(corner == filterIterated([&cornerFrom](const Position &position) { return position.x >= cornerFrom.x && position.y >= cornerFrom.y; }), "forEachFloor with a box at the end of the plane differs from MapIterator");
+	return failures.empty();
+}
+
+bool EditorTests::mapStatistics(Editor &editor) {
+	Map &map = editor.getMap();
+	SelfTestSetting group(Config::GROUP_ACTIONS);
+	group.set(0);
+	generateMap(editor);
+	editor.borderizeMap(false);
+
+	// Something for every counter and lookup under the stroke, which is also what gets pasted
+	uint16_t containerId = 0;
+	for (uint16_t id = g_items.getMinID(); id <= g_items.getMaxID() && id != 0 && containerId == 0; ++id) {
+		if (!g_items.isValidID(id)) {
+			continue;
+		}
+		const ItemType &type = g_items.getItemType(id);
+		if (type.isContainer() && !type.isDepot() && type.sprite) {
+			containerId = id;
+		}
+	}
+	if (!check(containerId != 0, "No container item to place")) {
+		return false;
+	}
+	for (int i = 0; i < 8; ++i) {
+		Tile* tile = map.getTile(Base + 36 + i * 3, Base + 40 + i, SelfTestFloor);
+		Item* container = Item::Create(containerId);
+		container->setActionID(1000 + i % 3);
+		if (i % 2 == 0) {
+			container->setUniqueID(2000 + i);
+			static_cast<Container*>(container)->getVector().push_back(Item::Create(containerId));
+		} else {
+			container->setText(fmt::format("Self test {}", i));
+		}
+		tile->addItem(container);
+	}
+	Tile* spawnTile = map.getTile(Base + 50, Base + 50, SelfTestFloor);
+	spawnTile->spawnMonster = newd SpawnMonster(2);
+	map.addSpawnMonster(spawnTile);
+	map.getTile(Base + 51, Base + 50, SelfTestFloor)->addMonster(newd Monster("Self test monster"));
+	Tile* npcTile = map.getTile(Base + 52, Base + 51, SelfTestFloor);
+	npcTile->spawnNpc = newd SpawnNpc(1);
+	map.addSpawnNpc(npcTile);
+	npcTile->npc = newd Npc("Self test npc");
+
+	// The edits above were made in place, from here on the counters are only updated by setTile/swapTile
+	map.getStatistics();
+	map.getItemIndex();
+
+	const auto counters = [](const MapStatistics &statistics) {
+		return std::array<int64_t, 14> {
+			statistics.tile_count, statistics.detailed_tile_count, statistics.blocking_tile_count, statistics.walkable_tile_count,
+			statistics.spawn_monster_count, statistics.spawn_npc_count, statistics.monster_count, statistics.npc_count,
+			statistics.item_count, statistics.loose_item_count, statistics.depot_count, statistics.action_item_count,
+			statistics.unique_item_count, statistics.container_count
+		};
+	};
+	// Removed items may leave a count of 0 behind
+	const auto itemCounts = [](const MapStatistics &statistics) {
+		std::map<uint16_t, int64_t> counts;
+		for (const auto &[id, count] : statistics.item_counts) {
+			if (count != 0) {
+				counts.emplace(id, count);
+			}
+		}
+		return counts;
+	};
+	const auto compare = [&](const std::string &step) {
+		const MapStatistics &live = map.getCachedStatistics();
+		const ItemIndex &index = map.getCachedItemIndex();
+		if (!check(live.isValid() && index.isValid(), step + " invalidated the statistics or the item index")) {
+			return;
+		}
+
+		MapStatistics statistics;
+		statistics.rebuild(map);
+		check(counters(live) == counters(statistics), step + ": the counters differ from a rebuild");
+		const std::map<uint16_t, int64_t> counts = itemCounts(statistics);
+		check(itemCounts(live) == counts, step + ": the item counts differ from a rebuild");
+		check(counts.contains(containerId) && statistics.action_item_count > 0 && statistics.unique_item_count > 0, step + ": the special items are gone");
+
+		ItemIndex rebuilt;
+		rebuilt.rebuild(map);
+		std::set<uint16_t> ids;
+		for (const auto &[id, count] : itemCounts(live)) {
+			ids.insert(id);
+		}
+		for (const auto &[id, count] : counts) {
+			ids.insert(id);
+		}
+		check(std::ranges::all_of(ids, [&](uint16_t id) { return index.getItemFloors(id) == rebuilt.getItemFloors(id); }), step + ": the item floors differ from a rebuild");
+		check(index.getActionFloors() == rebuilt.getActionFloors() && index.getActionFloors(1001) == rebuilt.getActionFloors(1001), step + ": the action id floors differ from a rebuild");
+		check(index.getUniqueFloors() == rebuilt.getUniqueFloors() && index.getUniqueFloors(2002) == rebuilt.getUniqueFloors(2002), step + ": the unique id floors differ from a rebuild");
+		check(index.getContainerFloors() == rebuilt.getContainerFloors(), step + ": the container floors differ from a rebuild");
+		check(index.getWriteableFloors() == rebuilt.getWriteableFloors(), step + ": the writeable floors differ from a rebuild");
+	};
+	compare("Generating the map");
+
+	Brush* previousBrush = g_gui.GetCurrentBrush();
+	const auto stroke = [&](GroundBrush* brush, int from, int to) {
+		PositionVector todraw;
+		PositionVector toborder;
+		for (int x = from - 1; x <= to + 1; ++x) {
+			for (int y = from - 1; y <= to + 1; ++y) {
+				toborder.emplace_back(x, y, SelfTestFloor);
+				if (x >= from && x <= to && y >= from && y <= to) {
+					todraw.emplace_back(x, y, SelfTestFloor);
+				}
+			}
+		}
+		g_gui.SelectBrushInternal(brush);
+		editor.draw(todraw, toborder, false);
+	};
+	stroke(patchBrush, Base + 32, Base + 63);
+	compare("The stroke");
+
+	SelectionArea area;
+	area.add({ Base + 32, Base + 32, Base + 63, Base + 63, SelfTestFloor });
+	Selection &selection = editor.getSelection();
+	selection.start();
+	selection.clear();
+	selection.add(area);
+	selection.finish();
+	g_gui.copybuffer.copy(editor, SelfTestFloor);
+	g_gui.copybuffer.paste(editor, Position(Base + 100, Base + 20, SelfTestFloor));
+	compare("The paste");
+
+	const auto isBorder = [](Map &, Item* item) { return item->isBorder(); };
+	check(editor.removeItemsOnMap(isBorder, false) > 0, "Removing the borders removed nothing");
+	compare("Removing the borders");
+
+	const size_t steps = static_cast<size_t>(editor.getHistoryActions()->getCurrentIndex());
+	for (size_t step = steps; step > 0; --step) {
+		editor.undo();
+		compare(fmt::format("Undoing step {}", step));
+	}
+	for (size_t step = 1; step <= steps; ++step) {
+		editor.redo();
+		compare(fmt::format("Redoing step {}", step));
+	}
+
+	// Edits in place can't be followed, they have to leave the counters to a rebuild
+	const auto isContainer = [containerId](Map &, Item* item) { return item->getID() == containerId && item->getActionID() == 1000; };
+	check(RemoveItemOnMap(map, isContainer, false) > 0, "RemoveItemOnMap removed nothing");
+	check(!map.getCachedStatistics().isValid() && !map.getCachedItemIndex().isValid(), "RemoveItemOnMap left the statistics or the item index valid");
+	map.getStatistics();
+	map.getItemIndex();
+	compare("RemoveItemOnMap");
+
+	stroke(groundBrush, Base + 48, Base + 79);
+	g_gui.SelectBrushInternal(previousBrush);
+	compare("A stroke after the rebuild");
+	editor.undo();
+	compare("Undoing the stroke after the rebuild");
+	return failures.empty();
+}
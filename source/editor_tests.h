@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_EDITOR_TESTS_H_
+#define RME_EDITOR_TESTS_H_
+
+#include "main.h"
+
+class BaseMap;
+class Editor;
+class GroundBrush;
+
+// Checks the editor paths that need the client data, the brushes or a map, mostly
+// by comparing a threaded path against its serial version on a generated map.
+// Started from the command line with --selftest, see Application; the headless
+// parts have their own tests in tests/.
+class EditorTests {
+public:
+	EditorTests(const wxString &filter);
+
+	// Runs every test whose name starts with the filter, each on a new map; false if one failed
+	bool run(const wxString &outputPath);
+
+	// Hash of every tile and what is on it, in map order. Some edits leave empty tiles
+	// behind when undone, emptyTiles false leaves those out.
+	static uint64_t hashMap(BaseMap &map, bool emptyTiles = true);
+
+protected:
+	using Test = bool (EditorTests::*)(Editor &editor);
+
+	// Records a failure of the running test when the condition does not hold
+	bool check(bool condition, const std::string &message);
+
+	bool findGroundBrushes();
+	void generateMap(Editor &editor);
+
+	bool borderizeThreads(Editor &editor);
+	bool bitmapConvertThreads(Editor &editor);
+	bool moveUndo(Editor &editor);
+	bool spritePreload(Editor &editor);
+	bool dataFileTasks(Editor &editor);
+	bool convertThreads(Editor &editor);
+	bool importThreads(Editor &editor);
+	bool minimapExportThreads(Editor &editor);
+	bool renderImage(Editor &editor);
+	bool dataSnapshot(Editor &editor);
+	bool borderTable(Editor &editor);
+	bool journalUndo(Editor &editor);
+	bool floorTraversal(Editor &editor);
+	bool mapStatistics(Editor &editor);
+
+	static constexpr int MapSize = 256;
+	static constexpr int Base = 1024;
+
+	wxString filter;
+	GroundBrush* groundBrush = nullptr;
+	GroundBrush* patchBrush = nullptr;
+	nlohmann::json results;
+	std::vector<std::string> failures;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "items.h"
 #include "brush.h"
 #include "raw_brush.h"
+#include "item_name_index.h"
 
 BEGIN_EVENT_TABLE(FindItemDialog, wxDialog)
 EVT_TIMER(wxID_ANY, FindItemDialog::OnInputTimer)
@@ -281,102 +282,69 @@ void FindItemDialog::RefreshContentsInternal() {
 	okButton->Enable(false);
 
 	SearchMode selection = (SearchMode)optionsRadioBox->GetSelection();
-	bool foundSearchResults = false;
+	const ItemNameIndex::FlagMask pickupableMask = onlyPickupables ? ItemNameIndex::mask(ItemNameIndex::Pickupable) : 0;
 
+	std::vector<uint16_t> found;
 	if (selection == SearchMode::ItemIDs) {
 		uint16_t itemID = (uint16_t)itemIdSpin->GetValue();
-		for (int id = g_items.getMinID(); id <= g_items.getMaxID(); ++id) {
-			const ItemType &item = g_items.getItemType(id);
-			if (item.id == 0 || item.id != itemID) {
-				continue;
-			}
-
-			RAWBrush* rawBrush = item.raw_brush;
-			if (!rawBrush) {
-				continue;
-			}
-
-			if (onlyPickupables && !item.pickupable) {
-				continue;
-			}
-
-			foundSearchResults = true;
-			itemsList->AddBrush(rawBrush);
+		if (g_itemNameIndex.contains(itemID, pickupableMask)) {
+			found.push_back(itemID);
 		}
 	} else if (selection == SearchMode::Names) {
 		std::string searchString = as_lower_str(nstr(nameTextInput->GetValue()));
 		if (searchString.size() >= 2) {
-			for (int id = g_items.getMinID(); id <= g_items.getMaxID(); ++id) {
-				const ItemType &item = g_items.getItemType(id);
-				if (item.id == 0) {
-					continue;
-				}
-
-				RAWBrush* rawBrush = item.raw_brush;
-				if (!rawBrush) {
-					continue;
-				}
-
-				if (onlyPickupables && !item.pickupable) {
-					continue;
-				}
-
-				if (as_lower_str(rawBrush->getName()).find(searchString) == std::string::npos) {
-					continue;
-				}
-
-				foundSearchResults = true;
-				itemsList->AddBrush(rawBrush);
-			}
+			found = g_itemNameIndex.findByName(searchString, pickupableMask);
 		}
 	} else if (selection == SearchMode::Types) {
-		for (int id = g_items.getMinID(); id <= g_items.getMaxID(); ++id) {
-			const ItemType &item = g_items.getItemType(id);
-			if (item.id == 0) {
-				continue;
-			}
-
-			RAWBrush* rawBrush = item.raw_brush;
-			if (!rawBrush) {
-				continue;
-			}
-
-			if (onlyPickupables && !item.pickupable) {
-				continue;
-			}
-
-			SearchItemType selection = (SearchItemType)typesRadioBox->GetSelection();
-			if ((selection == SearchItemType::Depot && !item.isDepot()) || (selection == SearchItemType::Mailbox && !item.isMailbox()) || (selection == SearchItemType::TrashHolder && !item.isTrashHolder()) || (selection == SearchItemType::Container && !item.isContainer()) || (selection == SearchItemType::Door && !item.isDoor()) || (selection == SearchItemType::MagicField && !item.isMagicField()) || (selection == SearchItemType::Teleport && !item.isTeleport()) || (selection == SearchItemType::Bed && !item.isBed()) || (selection == SearchItemType::Key && !item.isKey())) {
-				continue;
-			}
-
-			foundSearchResults = true;
-			itemsList->AddBrush(rawBrush);
+		static constexpr ItemNameIndex::Flag typeFlags[] = {
+			ItemNameIndex::Depot,
+			ItemNameIndex::Mailbox,
+			ItemNameIndex::TrashHolder,
+			ItemNameIndex::Container,
+			ItemNameIndex::Door,
+			ItemNameIndex::MagicField,
+			ItemNameIndex::Teleport,
+			ItemNameIndex::Bed,
+			ItemNameIndex::Key,
+		};
+		const int type = typesRadioBox->GetSelection();
+		if (type >= 0 && type < static_cast<int>(std::size(typeFlags))) {
+			found = g_itemNameIndex.find(pickupableMask | ItemNameIndex::mask(typeFlags[type]));
 		}
 	} else if (selection == SearchMode::Properties) {
-		bool hasSelected = (unpassable->GetValue() || unmovable->GetValue() || blockMissiles->GetValue() || blockPathfinder->GetValue() || readable->GetValue() || writeable->GetValue() || pickupable->GetValue() || stackable->GetValue() || rotatable->GetValue() || hangable->GetValue() || hookEast->GetValue() || hookSouth->GetValue() || hasElevation->GetValue() || ignoreLook->GetValue() || floorChange->GetValue());
-
-		if (hasSelected) {
-			for (int id = g_items.getMinID(); id <= g_items.getMaxID(); ++id) {
-				const ItemType &item = g_items.getItemType(id);
-				if (item.id == 0) {
-					continue;
-				}
-
-				RAWBrush* rawBrush = item.raw_brush;
-				if (!rawBrush) {
-					continue;
-				}
-
-				if ((unpassable->GetValue() && !item.unpassable) || (unmovable->GetValue() && item.moveable) || (blockMissiles->GetValue() && !item.blockMissiles) || (blockPathfinder->GetValue() && !item.blockPathfinder) || (readable->GetValue() && !item.canReadText) || (writeable->GetValue() && !item.canWriteText) || (pickupable->GetValue() && !item.pickupable) || (stackable->GetValue() && !item.stackable) || (rotatable->GetValue() && !item.rotable) || (hangable->GetValue() && !item.isHangable) || (hookEast->GetValue() && (!item.hookEast && item.hook != ITEM_HOOK_EAST)) || (hookSouth->GetValue() && (!item.hookSouth && item.hook != ITEM_HOOK_SOUTH)) || (hasElevation->GetValue() && !item.hasElevation) || (ignoreLook->GetValue() && !item.ignoreLook) || (floorChange->GetValue() && !item.isFloorChange())) {
-					continue;
-				}
-
-				foundSearchResults = true;
-				itemsList->AddBrush(rawBrush);
+		const std::pair<wxCheckBox*, ItemNameIndex::Flag> properties[] = {
+			{ unpassable, ItemNameIndex::Unpassable },
+			{ unmovable, ItemNameIndex::Unmovable },
+			{ blockMissiles, ItemNameIndex::BlockMissiles },
+			{ blockPathfinder, ItemNameIndex::BlockPathfinder },
+			{ readable, ItemNameIndex::Readable },
+			{ writeable, ItemNameIndex::Writeable },
+			{ pickupable, ItemNameIndex::Pickupable },
+			{ stackable, ItemNameIndex::Stackable },
+			{ rotatable, ItemNameIndex::Rotatable },
+			{ hangable, ItemNameIndex::Hangable },
+			{ hookEast, ItemNameIndex::HookEast },
+			{ hookSouth, ItemNameIndex::HookSouth },
+			{ hasElevation, ItemNameIndex::HasElevation },
+			{ ignoreLook, ItemNameIndex::IgnoreLook },
+			{ floorChange, ItemNameIndex::FloorChange },
+		};
+
+		ItemNameIndex::FlagMask flags = 0;
+		for (const auto &[checkBox, flag] : properties) {
+			if (checkBox->GetValue()) {
+				flags |= ItemNameIndex::mask(flag);
 			}
 		}
+		if (flags != 0) {
+			found = g_itemNameIndex.find(flags);
+		}
+	}
+
+	for (uint16_t id : found) {
+		itemsList->AddBrush(g_items.getItemType(id).raw_brush);
 	}
+	const bool foundSearchResults = !found.empty();
 
 	okButton->Enable(foundSearchResults || selection == SearchMode::TileTypes);
 	if (foundSearchResults) {
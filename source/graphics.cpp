@@ -229,6 +229,8 @@ void GraphicManager::clear() {
 	sprite_space.swap(new_sprite_space);
 	image_space.clear();
 	cleanup_list.clear();
+	lazy_outfits.clear();
+	appearances.clear();
 
 	item_count = 0;
 	creature_count = 0;
@@ -247,6 +249,9 @@ void GraphicManager::cleanSoftwareSprites() {
 Sprite* GraphicManager::getSprite(int id) {
 	SpriteMap::iterator it = sprite_space.find(id);
 	if (it != sprite_space.end()) {
+		if (id > item_count && !lazy_outfits.empty()) {
+			decodeLazyOutfit(id);
+		}
 		return it->second;
 	}
 	return nullptr;
@@ -259,11 +264,18 @@ GameSprite* GraphicManager::getCreatureSprite(int id) {
 
 	SpriteMap::iterator it = sprite_space.find(id + getItemSpriteMaxID());
 	if (it != sprite_space.end()) {
+		if (!lazy_outfits.empty()) {
+			decodeLazyOutfit(it->first);
+		}
 		return static_cast<GameSprite*>(it->second);
 	}
 	return nullptr;
 }
 
+bool GraphicManager::hasCreatureSprite(int id) const {
+	return id >= 0 && sprite_space.contains(id + getItemSpriteMaxID());
+}
+
 uint16_t GraphicManager::getItemSpriteMaxID() const {
 	return item_count;
 }
@@ -885,11 +897,50 @@ bool GraphicManager::loadItemSpriteMetadata(const std::shared_ptr<ItemType> &t,
 	return true;
 }
 
-bool GraphicManager::loadOutfitSpriteMetadata(rme::protobuf::appearances::Appearance outfit, wxString &error, wxArrayString &warnings) {
+void GraphicManager::addLazyOutfit(const AppearanceIndex::Entry &entry) {
 	GameSprite* sType = newd GameSprite();
-	sType->id = outfit.id() + getItemSpriteMaxID();
-	sprite_space[outfit.id() + getItemSpriteMaxID()] = sType;
-	creature_count = std::max<uint16_t>(creature_count, outfit.id());
+	sType->id = entry.id + getItemSpriteMaxID();
+	sprite_space[sType->id] = sType;
+	creature_count = std::max<uint16_t>(creature_count, entry.id);
+	lazy_outfits[sType->id] = entry;
+}
+
+void GraphicManager::decodeLazyOutfit(int spriteId) {
+	const auto it = lazy_outfits.find(spriteId);
+	if (it == lazy_outfits.end()) {
+		return;
+	}
+
+	const AppearanceIndex::Entry entry = it->second;
+	lazy_outfits.erase(it);
+
+	rme::protobuf::appearances::Appearance outfit;
+	wxString error;
+	wxArrayString warnings;
+	if (!appearances.decode(entry, outfit) || !loadOutfitSpriteMetadata(static_cast<GameSprite*>(sprite_space[spriteId]), outfit, error, warnings)) {
+		spdlog::error("[GraphicManager::decodeLazyOutfit] - Outfit with id {} could not be decoded. {}", entry.id, nstr(error));
+		// Outfits are decoded while drawing, a dialog would interrupt every redraw
+		g_gui.SetStatusText(wxString::Format("Outfit %u could not be decoded and is not drawn, see the log for details.", entry.id));
+	}
+
+	// Every outfit is decoded, the raw file is not needed anymore
+	if (lazy_outfits.empty()) {
+		appearances.clear();
+	}
+}
+
+bool GraphicManager::warmLazyOutfits(size_t count) {
+	for (size_t i = 0; i < count && !lazy_outfits.empty(); ++i) {
+		decodeLazyOutfit(lazy_outfits.begin()->first);
+	}
+	return !lazy_outfits.empty();
+}
+
+bool GraphicManager::loadOutfitSpriteMetadata(GameSprite* sType, const rme::protobuf::appearances::Appearance &outfit, wxString &error, wxArrayString &warnings) {
+	if (outfit.frame_group_size() == 0) {
+		error = wxString::Format("Outfit %d has no frame groups", outfit.id());
+		return false;
+	}
 
 	// We dont need to worry about IDLE or MOVING frame group
 	const auto &frameGroup = outfit.frame_group().Get(0);
@@ -1238,12 +1289,17 @@ wxMemoryDC* GameSprite::getDC(SpriteSize spriteSize) {
 }
 
 void GameSprite::DrawTo(wxDC* dcWindow, SpriteSize spriteSize, int start_x, int start_y, int sizeWidth, int sizeHeight) {
+	// Palette icons whose sheet is still decoding in the background are drawn once it arrives
+	if (!m_wxMemoryDc[spriteSize] && !spriteList.empty() && g_spriteAppearances.isSpriteLoading(spriteList[0]->id)) {
+		return;
+	}
+
 	if (sizeWidth == -1 || sizeHeight == -1) {
 		if (spriteList.size() == 0) {
 			return;
 		}
 
-		const auto &sheet = g_spriteAppearances.getSheetBySpriteId(spriteList[0]->id);
+		const auto &sheet = g_spriteAppearances.getSheetBySpriteId(spriteList[0]->id, false);
 		if (!sheet) {
 			return;
 		}
@@ -19,11 +19,14 @@
 #define RME_GRAPHICS_H_
 
 #include "outfit.h"
+#include "appearance_index.h"
 #include "common.h"
 #include "enums.h"
 
 #include <wx/artprov.h>
 
+#include <unordered_map>
+
 // Forward declarations
 namespace rme {
 	namespace protobuf {
@@ -327,7 +330,10 @@ public:
 	void cleanSoftwareSprites();
 
 	Sprite* getSprite(int id);
+	// Decodes the outfit first if this is the first time it is requested
 	GameSprite* getCreatureSprite(int id);
+	// Only checks whether the outfit exists, safe to call from worker threads while loading
+	bool hasCreatureSprite(int id) const;
 	GameSprite* getEditorSprite(int id);
 
 	long getElapsedTime() const {
@@ -353,7 +359,15 @@ public:
 	bool loadSpriteData(const FileName &datafile, wxString &error, wxArrayString &warnings);
 
 	bool loadItemSpriteMetadata(const std::shared_ptr<ItemType> &t, wxString &error, wxArrayString &warnings);
-	bool loadOutfitSpriteMetadata(rme::protobuf::appearances::Appearance outfit, wxString &error, wxArrayString &warnings);
+	bool loadOutfitSpriteMetadata(GameSprite* sType, const rme::protobuf::appearances::Appearance &outfit, wxString &error, wxArrayString &warnings);
+
+	AppearanceIndex &getAppearanceIndex() noexcept {
+		return appearances;
+	}
+	// Reserves the sprite of an outfit, its appearance is decoded on first use
+	void addLazyOutfit(const AppearanceIndex::Entry &entry);
+	// Decodes up to count outfits nobody requested yet, returns true while some are left
+	bool warmLazyOutfits(size_t count);
 
 	// Cleans old & unused textures according to config settings
 	void garbageCollection();
@@ -378,6 +392,11 @@ private:
 	ImageMap image_space;
 	std::deque<GameSprite*> cleanup_list;
 
+	AppearanceIndex appearances;
+	// Outfit sprites by sprite id whose appearance has not been decoded yet
+	std::unordered_map<int, AppearanceIndex::Entry> lazy_outfits;
+	void decodeLazyOutfit(int spriteId);
+
 	uint16_t item_count;
 	uint16_t creature_count;
 	bool otfi_found;
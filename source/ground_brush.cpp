@@ -22,6 +22,8 @@
 #include "basemap.h"
 
 uint32_t GroundBrush::border_types[256];
+std::vector<const GroundBrush::BorderBlock*> GroundBrush::border_table;
+uint32_t GroundBrush::border_table_size = 0;
 
 int AutoBorder::edgeNameToID(const std::string &edgename) {
 	if (edgename == "n") {
@@ -562,6 +564,50 @@ void GroundBrush::draw(BaseMap* map, Tile* tile, void* parameter) {
 }
 
 const GroundBrush::BorderBlock* GroundBrush::getBrushTo(GroundBrush* first, GroundBrush* second) {
+	const uint32_t from = first ? first->border_index : 0;
+	const uint32_t to = second ? second->border_index : 0;
+	if ((!first || from != 0) && (!second || to != 0) && from < border_table_size && to < border_table_size) {
+		return border_table[from * border_table_size + to];
+	}
+	// Ground brushes only come from materials.xml, which is loaded completely before
+	// Brushes::init builds the table, so every loaded brush has a row. The lookup is for
+	// brushes that are not registered in g_brushes and for calls made before Brushes::init.
+	return findBrushTo(first, second);
+}
+
+void GroundBrush::buildBorderTable() {
+	std::vector<GroundBrush*> grounds;
+	for (const auto &[name, brush] : g_brushes.getMap()) {
+		if (brush->isGround()) {
+			brush->asGround()->border_index = 0;
+		}
+	}
+
+	grounds.push_back(nullptr);
+	for (const auto &[name, brush] : g_brushes.getMap()) {
+		if (brush->isGround() && brush->asGround()->border_index == 0) {
+			GroundBrush* ground = brush->asGround();
+			ground->border_index = static_cast<uint32_t>(grounds.size());
+			grounds.push_back(ground);
+		}
+	}
+
+	border_table_size = 0;
+	border_table.assign(grounds.size() * grounds.size(), nullptr);
+	for (size_t from = 0; from < grounds.size(); ++from) {
+		for (size_t to = 0; to < grounds.size(); ++to) {
+			border_table[from * grounds.size() + to] = findBrushTo(grounds[from], grounds[to]);
+		}
+	}
+	border_table_size = static_cast<uint32_t>(grounds.size());
+}
+
+void GroundBrush::clearBorderTable() {
+	border_table.clear();
+	border_table_size = 0;
+}
+
+const GroundBrush::BorderBlock* GroundBrush::findBrushTo(GroundBrush* first, GroundBrush* second) {
 	// printf("Border from %s to %s : ", first->getName().c_str(), second->getName().c_str());
 	if (first) {
 		if (second) {
@@ -695,8 +741,8 @@ void GroundBrush::doBorders(BaseMap* map, Tile* tile) {
 		neighbours[7] = { false, extractGroundBrushFromTile(map, x + 1, y + 1, z) };
 	}
 
-	static std::vector<const BorderBlock*> specificList;
-	specificList.clear();
+	// Local on purpose: borderizeMap runs doBorders from several threads at once.
+	std::vector<const BorderBlock*> specificList;
 
 	std::vector<BorderCluster> borderList;
 	for (int32_t i = 0; i < 8; ++i) {
@@ -45,6 +45,9 @@ public:
 	virtual void undraw(BaseMap* map, Tile* tile);
 	static void doBorders(BaseMap* map, Tile* tile);
 	static const BorderBlock* getBrushTo(GroundBrush* first, GroundBrush* second);
+	// Precomputes getBrushTo for every pair of loaded ground brushes, see Brushes::init
+	static void buildBorderTable();
+	static void clearBorderTable();
 
 	virtual int32_t getZ() const {
 		return z_order;
@@ -117,9 +120,19 @@ protected: // Members
 		}
 	};
 
+	// The lookup border_table caches, the self tests compare the two
+	static const BorderBlock* findBrushTo(GroundBrush* first, GroundBrush* second);
+	friend class EditorTests;
+
 	std::vector<BorderBlock*> borders;
 	std::vector<ItemChanceBlock> border_items;
 	int total_chance;
+	// Row and column of this brush in border_table, 0 when it is not in the table
+	uint32_t border_index = 0;
+
+	// (first, second) -> getBrushTo, indexed by border_index with 0 standing for no brush
+	static std::vector<const BorderBlock*> border_table;
+	static uint32_t border_table_size;
 
 public: // Static global members
 	static uint32_t border_types[256];
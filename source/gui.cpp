@@ -28,6 +28,7 @@
 #include "map.h"
 #include "sprites.h"
 #include "materials.h"
+#include "item_name_index.h"
 #include "doodad_brush.h"
 #include "spawn_monster_brush.h"
 
@@ -46,6 +47,8 @@
 #include "live_client.h"
 #include "live_tab.h"
 #include "live_server.h"
+#include "data_snapshot.h"
+#include "threads.h"
 
 #ifdef __WXOSX__
 	#include <AGL/agl.h>
@@ -62,6 +65,77 @@ namespace InternalGUI {
 	}
 } // namespace (internal use only)
 
+bool RunDataFileTasks(std::vector<DataFileTask> &tasks, int32_t fromProgress, int32_t toProgress, wxString &error, wxArrayString &warnings) {
+	const size_t threadCount = std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+	RunParallelJobs(
+		tasks.size(), threadCount,
+		[&tasks](size_t index) {
+			spdlog::info(tasks[index].status);
+			tasks[index].load(tasks[index].error, tasks[index].warnings);
+		},
+		[&](size_t done) {
+			// One at a time, the status names the file being loaded
+			const wxString status = threadCount <= 1 && done < tasks.size() ? wxstr(tasks[done].status) : wxString("Loading data files...");
+			g_gui.SetLoadDone(fromProgress + static_cast<int32_t>((toProgress - fromProgress) * done / std::max<size_t>(tasks.size(), 1)), status);
+		}
+	);
+
+	bool success = true;
+	for (const DataFileTask &task : tasks) {
+		if (!task.error.empty()) {
+			error = task.error;
+			success = false;
+		}
+		for (const wxString &warning : task.warnings) {
+			warnings.push_back(warning);
+		}
+	}
+	return success;
+}
+
+std::vector<DataFileTask> CreateDataFileTasks(ItemDatabase &items, MonsterDatabase &monsters, NpcDatabase &npcs) {
+	std::vector<DataFileTask> tasks(3);
+	tasks[0].status = "Loading items.xml ...";
+	tasks[0].load = [&items](wxString &error, wxArrayString &warnings) {
+		if (!items.loadFromGameXml(wxString("data/items/items.xml"), error, warnings)) {
+			warnings.push_back("Couldn't load items.xml: " + error);
+			spdlog::warn("[GUI::LoadDataFiles] {}: {}", wxString("data/items/items.xml").ToStdString(), error.ToStdString());
+		}
+	};
+
+	tasks[1].status = "Loading monsters.xml ...";
+	tasks[1].load = [&monsters](wxString &error, wxArrayString &warnings) {
+		if (!monsters.loadFromXML(wxString("data/creatures/monsters.xml"), true, error, warnings)) {
+			warnings.push_back("Couldn't load monsters.xml: " + error);
+			spdlog::warn("[GUI::LoadDataFiles] {}: {}", wxString("data/creatures/monsters.xml").ToStdString(), error.ToStdString());
+		}
+
+		spdlog::info("Loading user monsters");
+		FileName cdb = ClientAssets::getLocalPath();
+		cdb.AppendDir("materials");
+		cdb.SetFullName("monsters.xml");
+		wxString nerr;
+		wxArrayString nwarn;
+		monsters.loadFromXML(cdb, false, nerr, nwarn);
+	};
+
+	tasks[2].status = "Loading npcs.xml ...";
+	tasks[2].load = [&npcs](wxString &error, wxArrayString &warnings) {
+		if (!npcs.loadFromXML(wxString("data/creatures/npcs.xml"), true, error, warnings)) {
+			warnings.push_back("Couldn't load npcs.xml: " + error);
+			spdlog::warn("[GUI::LoadDataFiles] {}: {}", wxString("data/creatures/npcs.xml").ToStdString(), error.ToStdString());
+		}
+
+		spdlog::info("Loading user npcs");
+		FileName cdb = ClientAssets::getLocalPath();
+		cdb.AppendDir("materials");
+		cdb.SetFullName("npcs.xml");
+		wxString nerr;
+		npcs.loadFromXML(cdb, false, nerr, warnings);
+	};
+	return tasks;
+}
+
 const wxEventType EVT_UPDATE_MENUS = wxNewEventType();
 const wxEventType EVT_UPDATE_ACTIONS = wxNewEventType();
 
@@ -253,7 +327,6 @@ bool GUI::loadMapWindow(wxString &error, wxArrayString &warnings, bool force /*
 	DestroyMinimap();
 
 	ClientAssets::setLoaded(false);
-	m_appearancesPtr.reset();
 
 	g_spriteAppearances.terminate();
 
@@ -263,11 +336,20 @@ bool GUI::loadMapWindow(wxString &error, wxArrayString &warnings, bool force /*
 	bool ret = LoadDataFiles(error, warnings);
 	if (ret) {
 		g_gui.LoadPerspective();
+		WarmAppearances();
 	}
 
 	return ret;
 }
 
+void GUI::WarmAppearances() {
+	if (gfx.warmLazyOutfits(32)) {
+		wxTheApp->CallAfter([this]() {
+			WarmAppearances();
+		});
+	}
+}
+
 void GUI::EnableHotkeys() {
 	hotkeys_enabled = true;
 }
@@ -309,47 +391,40 @@ bool GUI::LoadDataFiles(wxString &error, wxArrayString &warnings) {
 		return false;
 	}
 
-	g_gui.SetLoadDone(30, "Loading items.xml ...");
-	spdlog::info("Loading items");
-	if (!g_items.loadFromGameXml(wxString("data/items/items.xml"), error, warnings)) {
-		warnings.push_back("Couldn't load items.xml: " + error);
-		spdlog::warn("[GUI::LoadDataFiles] {}: {}", wxString("data/items/items.xml").ToStdString(), error.ToStdString());
-	}
-
-	g_gui.SetLoadDone(45, "Loading monsters.xml ...");
-	spdlog::info("Loading monsters");
-	if (!g_monsters.loadFromXML(wxString("data/creatures/monsters.xml"), true, error, warnings)) {
-		warnings.push_back("Couldn't load monsters.xml: " + error);
-		spdlog::warn("[GUI::LoadDataFiles] {}: {}", wxString("data/creatures/monsters.xml").ToStdString(), error.ToStdString());
-	}
-
-	g_gui.SetLoadDone(45, "Loading user monsters.xml ...");
-	spdlog::info("Loading user monsters");
-	{
+	// Everything parsed from here to the materials is restored from the snapshot
+	// when none of the files it was built from changed since the last start
+	FileName snapshotPath = ClientAssets::getLocalPath();
+	snapshotPath.SetFullName("startup.snapshot");
+	DataSnapshot snapshot(snapshotPath);
+	snapshot.addSource(FileName(ClientAssets::getPath() + "/assets/" + wxstr(g_spriteAppearances.getAppearanceFileName())));
+	snapshot.addSource(FileName(wxString("data/items/items.xml")));
+	snapshot.addSource(FileName(wxString("data/creatures/monsters.xml")));
+	snapshot.addSource(FileName(wxString("data/creatures/npcs.xml")));
+	for (const wxString &name : { "monsters.xml", "npcs.xml" }) {
 		FileName cdb = ClientAssets::getLocalPath();
 		cdb.AppendDir("materials");
-		cdb.SetFullName("monsters.xml");
-		wxString nerr;
-		wxArrayString nwarn;
-		g_monsters.loadFromXML(cdb, false, nerr, nwarn);
+		cdb.SetFullName(name);
+		snapshot.addSource(cdb);
 	}
 
-	g_gui.SetLoadDone(45, "Loading npcs.xml ...");
-	spdlog::info("Loading npcs");
-	if (!g_npcs.loadFromXML(wxString("data/creatures/npcs.xml"), true, error, warnings)) {
-		warnings.push_back("Couldn't load npcs.xml: " + error);
-		spdlog::warn("[GUI::LoadDataFiles] {}: {}", wxString("data/creatures/npcs.xml").ToStdString(), error.ToStdString());
-	}
+	g_gui.SetLoadDone(30, "Loading startup snapshot ...");
+	if (snapshot.load(warnings)) {
+		spdlog::info("Loaded items, monsters and npcs from the startup snapshot");
+	} else {
+		snapshot.captureItems();
 
-	g_gui.SetLoadDone(45, "Loading user npcs.xml ...");
-	spdlog::info("Loading user npcs");
-	{
-		FileName cdb = ClientAssets::getLocalPath();
-		cdb.AppendDir("materials");
-		cdb.SetFullName("npcs.xml");
-		wxString nerr;
-		wxArrayString nwarn;
-		g_npcs.loadFromXML(cdb, false, nerr, warnings);
+		// Items, monsters and npcs only depend on the appearances loaded above and
+		// fill separate databases, materials below need all three of them.
+		std::vector<DataFileTask> tasks = CreateDataFileTasks(g_items, g_monsters, g_npcs);
+
+		const size_t firstWarning = warnings.size();
+		if (RunDataFileTasks(tasks, 30, 50, error, warnings)) {
+			wxArrayString parseWarnings;
+			for (size_t i = firstWarning; i < warnings.size(); ++i) {
+				parseWarnings.push_back(warnings[i]);
+			}
+			snapshot.save(parseWarnings);
+		}
 	}
 
 	g_gui.SetLoadDone(50, "Loading materials.xml ...");
@@ -366,6 +441,7 @@ bool GUI::LoadDataFiles(wxString &error, wxArrayString &warnings) {
 	g_brushes.init();
 	g_materials.createOtherTileset();
 	g_materials.createNpcTileset();
+	g_items.buildNameIndex(g_itemNameIndex);
 
 	g_gui.DestroyLoadBar();
 	spdlog::info("Assets loaded");
@@ -390,6 +466,7 @@ void GUI::unloadMapWindow() {
 	hatch_door_brush = nullptr;
 	window_door_brush = nullptr;
 
+	g_itemNameIndex.clear();
 	g_materials.clear();
 	g_brushes.clear();
 	g_items.clear();
@@ -30,16 +30,13 @@
 #include "palette_window.h"
 #include "zone_brush.h"
 
-namespace rme {
-	namespace protobuf {
-		namespace appearances {
-			class Appearances;
-		}
-	}
-}
+#include <functional>
 
 class BaseMap;
 class Map;
+class ItemDatabase;
+class MonsterDatabase;
+class NpcDatabase;
 
 class Editor;
 class Brush;
@@ -383,6 +380,8 @@ public:
 
 protected:
 	bool LoadDataFiles(wxString &error, wxArrayString &warnings);
+	// Decodes the outfits that were not needed yet a few at a time between events
+	void WarmAppearances();
 
 	//=========================================================================
 	// Palette Interface
@@ -456,8 +455,6 @@ public:
 	FlagBrush* pvp_brush;
 	ZoneBrush* zone_brush;
 
-	std::unique_ptr<rme::protobuf::appearances::Appearances> m_appearancesPtr; // Protobuf appearances file parsed
-
 protected:
 	//=========================================================================
 	// Global GUI state
@@ -554,4 +551,23 @@ public:
 void SetWindowToolTip(wxWindow* a, const wxString &tip);
 void SetWindowToolTip(wxWindow* a, wxWindow* b, const wxString &tip);
 
+// A data file loader that only touches its own database, so several of them
+// can run side by side once the appearances they look up are in place.
+struct DataFileTask {
+	std::string status;
+	std::function<void(wxString &, wxArrayString &)> load;
+	wxString error;
+	wxArrayString warnings;
+};
+
+// Runs the tasks with RunParallelJobs on up to Config::WORKER_THREADS threads while the
+// calling thread keeps the load bar alive, then merges errors and warnings in task order
+// so the result is the same as loading the files one after another. Returns false if any
+// of the tasks failed.
+bool RunDataFileTasks(std::vector<DataFileTask> &tasks, int32_t fromProgress, int32_t toProgress, wxString &error, wxArrayString &warnings);
+
+// Parses items.xml, monsters.xml and npcs.xml, the user's monsters and npcs included, into
+// the given databases; items.xml only changes item types the appearances already created.
+std::vector<DataFileTask> CreateDataFileTasks(ItemDatabase &items, MonsterDatabase &monsters, NpcDatabase &npcs);
+
 #endif
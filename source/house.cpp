@@ -132,6 +132,35 @@ void House::removeTile(Tile* tile) {
 	}
 }
 
+void House::replaceTiles(const PositionVector &removed, const PositionVector &added) {
+	if (!removed.empty()) {
+		const std::set<Position> removed_set(removed.begin(), removed.end());
+		tiles.remove_if([&](const Position &position) {
+			return removed_set.contains(position);
+		});
+	}
+	tiles.insert(tiles.end(), added.begin(), added.end());
+}
+
+void House::moveTiles(const std::set<Position> &removed, const std::map<Position, Position> &moved) {
+	for (auto it = tiles.begin(); it != tiles.end();) {
+		if (removed.contains(*it)) {
+			it = tiles.erase(it);
+			continue;
+		}
+
+		const auto move = moved.find(*it);
+		if (move != moved.end()) {
+			*it = move->second;
+		}
+		++it;
+	}
+}
+
+void House::setTiles(PositionList tiles) {
+	this->tiles = std::move(tiles);
+}
+
 uint8_t House::getEmptyDoorID() const {
 	std::set<uint8_t> taken;
 	for (PositionList::const_iterator tile_iter = tiles.begin(); tile_iter != tiles.end(); ++tile_iter) {
@@ -33,6 +33,12 @@ public:
 	void clean();
 	void addTile(Tile* tile);
 	void removeTile(Tile* tile);
+	// Drops and adds many tile positions at once, the tiles keep their house id
+	void replaceTiles(const PositionVector &removed, const PositionVector &added);
+	// Drops and moves many tile positions at once in place, keeping the order of the list
+	void moveTiles(const std::set<Position> &removed, const std::map<Position, Position> &moved);
+	// Puts back a list saved from getTiles
+	void setTiles(PositionList tiles);
 	size_t size() const;
 	std::string getDescription();
 
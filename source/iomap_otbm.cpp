@@ -39,6 +39,7 @@
 #include "complexitem.h"
 #include "town.h"
 #include "sprite_appearances.h"
+#include "sha256.h"
 
 #include <mapdata.pb.h>
 #include <staticdata.pb.h>
@@ -268,7 +269,8 @@ namespace {
 	constexpr bool CyclopediaComposeSatelliteSprites = false;
 	constexpr int CyclopediaFloorCount = CyclopediaMaxFloor - CyclopediaMinFloor + 1;
 	constexpr std::array<int, 3> CyclopediaChunkSizes { 1024, 512, 256 };
-	constexpr unsigned int CyclopediaMaxParallelAssetEncoders = 4;
+	// Input plus encoder state of the assets being compressed at once
+	constexpr uint64_t CyclopediaAssetEncodeMemoryBudget = 1024ull * 1024 * 1024;
 	constexpr std::array<char, 4> CyclopediaProgressSpinner { '|', '/', '-', '\\' };
 
 	struct CyclopediaAssetLayerConfig {
@@ -645,141 +647,8 @@ namespace {
 	constexpr uint32_t CyclopediaLzmaDictionarySize = 8 * 1024 * 1024;
 	constexpr double CyclopediaVirtualCameraHeight = 0.175;
 
-	struct Sha256Context {
-		std::array<uint8_t, 64> data {};
-		std::array<uint32_t, 8> state {
-			0x6A09E667u,
-			0xBB67AE85u,
-			0x3C6EF372u,
-			0xA54FF53Au,
-			0x510E527Fu,
-			0x9B05688Cu,
-			0x1F83D9ABu,
-			0x5BE0CD19u
-		};
-		size_t dataLength = 0;
-		uint64_t bitLength = 0;
-	};
-
-	inline uint32_t rotr(const uint32_t value, const uint32_t bits) {
-		return (value >> bits) | (value << (32 - bits));
-	}
-
-	void sha256Transform(Sha256Context &context, const uint8_t block[64]) {
-		static constexpr std::array<uint32_t, 64> k {
-			0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u, 0x3956C25Bu, 0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u,
-			0xD807AA98u, 0x12835B01u, 0x243185BEu, 0x550C7DC3u, 0x72BE5D74u, 0x80DEB1FEu, 0x9BDC06A7u, 0xC19BF174u,
-			0xE49B69C1u, 0xEFBE4786u, 0x0FC19DC6u, 0x240CA1CCu, 0x2DE92C6Fu, 0x4A7484AAu, 0x5CB0A9DCu, 0x76F988DAu,
-			0x983E5152u, 0xA831C66Du, 0xB00327C8u, 0xBF597FC7u, 0xC6E00BF3u, 0xD5A79147u, 0x06CA6351u, 0x14292967u,
-			0x27B70A85u, 0x2E1B2138u, 0x4D2C6DFCu, 0x53380D13u, 0x650A7354u, 0x766A0ABBu, 0x81C2C92Eu, 0x92722C85u,
-			0xA2BFE8A1u, 0xA81A664Bu, 0xC24B8B70u, 0xC76C51A3u, 0xD192E819u, 0xD6990624u, 0xF40E3585u, 0x106AA070u,
-			0x19A4C116u, 0x1E376C08u, 0x2748774Cu, 0x34B0BCB5u, 0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu, 0x682E6FF3u,
-			0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u, 0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
-		};
-
-		std::array<uint32_t, 64> words {};
-		for (size_t i = 0; i < 16; ++i) {
-			const size_t idx = i * 4;
-			words[i] = (static_cast<uint32_t>(block[idx]) << 24)
-				| (static_cast<uint32_t>(block[idx + 1]) << 16)
-				| (static_cast<uint32_t>(block[idx + 2]) << 8)
-				| static_cast<uint32_t>(block[idx + 3]);
-		}
-
-		for (size_t i = 16; i < words.size(); ++i) {
-			const uint32_t s0 = rotr(words[i - 15], 7) ^ rotr(words[i - 15], 18) ^ (words[i - 15] >> 3);
-			const uint32_t s1 = rotr(words[i - 2], 17) ^ rotr(words[i - 2], 19) ^ (words[i - 2] >> 10);
-			words[i] = words[i - 16] + s0 + words[i - 7] + s1;
-		}
-
-		uint32_t a = context.state[0];
-		uint32_t b = context.state[1];
-		uint32_t c = context.state[2];
-		uint32_t d = context.state[3];
-		uint32_t e = context.state[4];
-		uint32_t f = context.state[5];
-		uint32_t g = context.state[6];
-		uint32_t h = context.state[7];
-
-		for (size_t i = 0; i < words.size(); ++i) {
-			const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
-			const uint32_t ch = (e & f) ^ ((~e) & g);
-			const uint32_t temp1 = h + s1 + ch + k[i] + words[i];
-			const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
-			const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
-			const uint32_t temp2 = s0 + maj;
-
-			h = g;
-			g = f;
-			f = e;
-			e = d + temp1;
-			d = c;
-			c = b;
-			b = a;
-			a = temp1 + temp2;
-		}
-
-		context.state[0] += a;
-		context.state[1] += b;
-		context.state[2] += c;
-		context.state[3] += d;
-		context.state[4] += e;
-		context.state[5] += f;
-		context.state[6] += g;
-		context.state[7] += h;
-	}
-
-	void sha256Update(Sha256Context &context, const std::span<const uint8_t> bytes) {
-		for (const uint8_t byte : bytes) {
-			context.data[context.dataLength++] = byte;
-			if (context.dataLength == context.data.size()) {
-				sha256Transform(context, context.data.data());
-				context.bitLength += 512;
-				context.dataLength = 0;
-			}
-		}
-	}
-
-	std::array<uint8_t, 32> sha256Finalize(Sha256Context &context) {
-		std::array<uint8_t, 32> hash {};
-		size_t i = context.dataLength;
-
-		if (context.dataLength < 56) {
-			context.data[i++] = 0x80;
-			while (i < 56) {
-				context.data[i++] = 0;
-			}
-		} else {
-			context.data[i++] = 0x80;
-			while (i < 64) {
-				context.data[i++] = 0;
-			}
-			sha256Transform(context, context.data.data());
-			context.data.fill(0);
-		}
-		context.bitLength += static_cast<uint64_t>(context.dataLength) * 8;
-		for (size_t byteIndex = 0; byteIndex < 8; ++byteIndex) {
-			context.data[63 - byteIndex] = static_cast<uint8_t>((context.bitLength >> (byteIndex * 8)) & 0xFF);
-		}
-		sha256Transform(context, context.data.data());
-
-		for (size_t wordIndex = 0; wordIndex < context.state.size(); ++wordIndex) {
-			const uint32_t word = context.state[wordIndex];
-			const size_t outIndex = wordIndex * 4;
-			hash[outIndex] = static_cast<uint8_t>((word >> 24) & 0xFF);
-			hash[outIndex + 1] = static_cast<uint8_t>((word >> 16) & 0xFF);
-			hash[outIndex + 2] = static_cast<uint8_t>((word >> 8) & 0xFF);
-			hash[outIndex + 3] = static_cast<uint8_t>(word & 0xFF);
-		}
-		return hash;
-	}
-
 	std::array<uint8_t, 32> sha256Hash(const std::vector<uint8_t> &bytes) {
-		Sha256Context context;
-		if (!bytes.empty()) {
-			sha256Update(context, std::span<const uint8_t>(bytes.data(), bytes.size()));
-		}
-		return sha256Finalize(context);
+		return Sha256::hash(bytes);
 	}
 
 	std::string toHex(const std::array<uint8_t, 32> &bytes) {
@@ -792,11 +661,7 @@ namespace {
 	}
 
 	std::string sha256Hex(const std::string_view bytes) {
-		Sha256Context context;
-		if (!bytes.empty()) {
-			sha256Update(context, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()));
-		}
-		return toHex(sha256Finalize(context));
+		return toHex(Sha256::hash(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size())));
 	}
 
 	std::string buildCatalogDataFilename(const std::string_view prefix, const std::string_view bytes) {
@@ -919,9 +784,7 @@ namespace {
 		} while (value != 0);
 	}
 
-	bool compressLzmaRaw(const std::vector<uint8_t> &input, std::vector<uint8_t> &compressedRaw) {
-		compressedRaw.clear();
-
+	lzma_options_lzma getCyclopediaLzmaOptions() {
 		lzma_options_lzma options {};
 		options.dict_size = CyclopediaLzmaDictionarySize;
 		options.lc = 3;
@@ -931,7 +794,21 @@ namespace {
 		options.nice_len = 16;
 		options.mf = LZMA_MF_HC3;
 		options.depth = 4;
+		return options;
+	}
+
+	uint64_t getCyclopediaLzmaEncoderMemory() {
+		lzma_options_lzma options = getCyclopediaLzmaOptions();
+		std::array<lzma_filter, 2> filters { { { LZMA_FILTER_LZMA1, &options },
+											   { LZMA_VLI_UNKNOWN, nullptr } } };
+		const uint64_t usage = lzma_raw_encoder_memusage(filters.data());
+		return usage == UINT64_MAX ? 0 : usage;
+	}
 
+	bool compressLzmaRaw(const std::vector<uint8_t> &input, std::vector<uint8_t> &compressedRaw) {
+		compressedRaw.clear();
+
+		lzma_options_lzma options = getCyclopediaLzmaOptions();
 		std::array<lzma_filter, 2> filters { { { LZMA_FILTER_LZMA1, &options },
 											   { LZMA_VLI_UNKNOWN, nullptr } } };
 
@@ -5653,7 +5530,7 @@ bool IOMapOTBM::loadSpawnsMonster(Map &map, pugi::xml_document &doc) {
 			monster->setWeight(weight);
 			monsterTile->monsters.emplace_back(monster);
 
-			if (monsterTile->getLocation()->getSpawnMonsterCount() == 0) {
+			if (map.getSpawnMonsterCount(monsterTile->getPosition()) == 0) {
 				// No monster spawn, create a newd one
 				ASSERT(monsterTile->spawnMonster == nullptr);
 				SpawnMonster* spawnMonster = newd SpawnMonster(1);
@@ -5924,7 +5801,7 @@ bool IOMapOTBM::loadSpawnsNpc(Map &map, pugi::xml_document &doc) {
 			npc->setSpawnNpcTime(spawntime);
 			npcTile->npc = npc;
 
-			if (npcTile->getLocation()->getSpawnNpcCount() == 0) {
+			if (map.getSpawnNpcCount(npcTile->getPosition()) == 0) {
 				// No npc spawn, create a newd one
 				ASSERT(npcTile->spawnNpc == nullptr);
 				SpawnNpc* spawnNpc = newd SpawnNpc(1);
@@ -7058,6 +6935,37 @@ bool IOMapOTBM::serializeCyclopediaMapData(Map &map, std::string &buffer, std::v
 		return true;
 	};
 
+	// Assets are hashed and compressed on worker threads, and registered in submission
+	// order so the map data and asset list come out exactly as a serial export.
+	struct PendingCyclopediaAsset {
+		const CyclopediaAssetLayerConfig* config = nullptr;
+		CyclopediaChunkArea area;
+		uint64_t memory = 0;
+		std::future<CyclopediaEncodedAsset> encoded;
+	};
+
+	const size_t encodeThreads = std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+	const uint64_t encoderMemory = getCyclopediaLzmaEncoderMemory();
+	std::deque<PendingCyclopediaAsset> pendingAssets;
+	uint64_t pendingAssetMemory = 0;
+
+	auto registerOldestCyclopediaAsset = [&]() {
+		PendingCyclopediaAsset pending = std::move(pendingAssets.front());
+		pendingAssets.pop_front();
+		pendingAssetMemory -= pending.memory;
+
+		try {
+			const CyclopediaEncodedAsset encodedAsset = pending.encoded.get();
+			return registerEncodedCyclopediaAsset(*pending.config, pending.area, encodedAsset);
+		} catch (const std::exception &exception) {
+			spdlog::error("[serializeCyclopediaMapData] asset encoding failed: {}", exception.what());
+			return false;
+		} catch (...) {
+			spdlog::error("[serializeCyclopediaMapData] asset encoding failed with unknown error");
+			return false;
+		}
+	};
+
 	auto appendCyclopediaAsset = [&](const CyclopediaAssetLayerConfig &config, const CyclopediaChunkArea &area, const wxImage &outputAssetChunk, const int32_t done, const char spinner) {
 		if (!outputAssetChunk.IsOk() || outputAssetChunk.GetWidth() <= 0 || outputAssetChunk.GetHeight() <= 0) {
 			return true;
@@ -7073,16 +6981,22 @@ bool IOMapOTBM::serializeCyclopediaMapData(Map &map, std::string &buffer, std::v
 			return false;
 		}
 
-		try {
-			const CyclopediaEncodedAsset encodedAsset = encodeCyclopediaAssetBytes(bmpBytes);
-			return registerEncodedCyclopediaAsset(config, area, encodedAsset);
-		} catch (const std::exception &exception) {
-			spdlog::error("[serializeCyclopediaMapData] asset encoding failed: {}", exception.what());
-			return false;
-		} catch (...) {
-			spdlog::error("[serializeCyclopediaMapData] asset encoding failed with unknown error");
-			return false;
+		// Wait for the oldest assets until this one fits in the thread and memory budget
+		const uint64_t assetMemory = bmpBytes.size() + encoderMemory;
+		while (!pendingAssets.empty() && (pendingAssets.size() >= encodeThreads || pendingAssetMemory + assetMemory > CyclopediaAssetEncodeMemoryBudget)) {
+			if (!registerOldestCyclopediaAsset()) {
+				return false;
+			}
 		}
+
+		pendingAssets.emplace_back(
+			&config, area, assetMemory,
+			std::async(std::launch::async, [bmpBytes = std::move(bmpBytes)]() {
+				return encodeCyclopediaAssetBytes(bmpBytes);
+			})
+		);
+		pendingAssetMemory += assetMemory;
+		return true;
 	};
 
 	for (const auto &job : jobs) {
@@ -7122,6 +7036,12 @@ bool IOMapOTBM::serializeCyclopediaMapData(Map &map, std::string &buffer, std::v
 		}
 	}
 
+	while (!pendingAssets.empty()) {
+		if (!registerOldestCyclopediaAsset()) {
+			return false;
+		}
+	}
+
 	if (!hasAnyAsset) {
 		return false;
 	}
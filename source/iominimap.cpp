@@ -23,14 +23,51 @@
 #include "filehandle.h"
 #include "editor.h"
 #include "gui.h"
+#include "settings.h"
+#include "threads.h"
 
 #include <wx/image.h>
 #include <zlib.h>
 
+namespace {
+	// Upper bound for the image buffers being filled at the same time
+	constexpr size_t MinimapImageMemory = 256 * 1024 * 1024;
+
+	bool hasMinimapContent(const Tile* tile) {
+		return tile->ground || !tile->items.empty();
+	}
+
+	MinimapTile getMinimapTile(const Tile* tile) {
+		MinimapTile minimapTile;
+		minimapTile.color = tile->getMiniMapColor();
+		minimapTile.flags |= MinimapTileWasSeen;
+		if (tile->isBlocking()) {
+			minimapTile.flags |= MinimapTileNotWalkable;
+		}
+		// if (!tile->isPathable()) {
+		// minimapTile.flags |= MinimapTileNotPathable;
+		//}
+		minimapTile.speed = std::min<int>((int)std::ceil(tile->getGroundSpeed() / 10.f), 0xFF);
+		return minimapTile;
+	}
+
+	size_t getExportThreadCount() {
+		return std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+	}
+} // namespace
+
 void MinimapBlock::updateTile(int x, int y, const MinimapTile &tile) {
 	m_tiles[getTileIndex(x, y)] = tile;
 }
 
+void MinimapBlock::merge(const MinimapBlock &other) {
+	for (size_t i = 0; i < m_tiles.size(); ++i) {
+		if (other.m_tiles[i].flags & MinimapTileWasSeen) {
+			m_tiles[i] = other.m_tiles[i];
+		}
+	}
+}
+
 IOMinimap::IOMinimap(Editor* editor, MinimapExportFormat format, MinimapExportMode mode, bool updateLoadbar, int imageSize /* = 1024 */) :
 	m_editor(editor),
 	m_format(format),
@@ -84,16 +121,52 @@ bool IOMinimap::saveOtmm(const wxFileName &file) {
 		writer.addU16(start);
 		writer.seek(start);
 
-		unsigned long blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-		std::vector<uint8_t> buffer(compressBound(blockSize));
+		const unsigned long blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
 		constexpr int COMPRESS_LEVEL = 3;
 
+		if (m_updateLoadbar) {
+			g_gui.SetLoadScale(0, 70);
+		}
 		readBlocks();
+		if (m_updateLoadbar) {
+			g_gui.SetLoadScale(70, 100);
+		}
+
+		size_t totalBlocks = 0;
+		for (const auto &blocks : m_blocks) {
+			totalBlocks += blocks.size();
+		}
 
+		// Blocks are compressed on the worker threads one floor at a time, and written in
+		// the iteration order of the floor, so the file doesn't depend on the thread count
+		size_t writtenBlocks = 0;
 		for (uint8_t z = 0; z <= rme::MapMaxLayer; ++z) {
-			for (auto &it : m_blocks[z]) {
-				int index = it.first;
-				auto &block = it.second;
+			std::vector<std::pair<uint32_t, const MinimapBlock*>> blocks;
+			blocks.reserve(m_blocks[z].size());
+			for (const auto &it : m_blocks[z]) {
+				blocks.emplace_back(it.first, &it.second);
+			}
+
+			std::vector<std::vector<uint8_t>> compressed(blocks.size());
+			RunParallelJobs(
+				blocks.size(), getExportThreadCount(),
+				[&](size_t index) {
+					std::vector<uint8_t> &buffer = compressed[index];
+					buffer.resize(compressBound(blockSize));
+					unsigned long len = blockSize;
+					int ret = compress2(buffer.data(), &len, (const uint8_t*)&blocks[index].second->getTiles(), blockSize, COMPRESS_LEVEL);
+					assert(ret == Z_OK);
+					buffer.resize(len);
+				},
+				[&](size_t done) {
+					if (m_updateLoadbar && totalBlocks != 0) {
+						g_gui.SetLoadDone(static_cast<int32_t>(std::min<size_t>(99, 100 * (writtenBlocks + done) / totalBlocks)));
+					}
+				}
+			);
+
+			for (size_t i = 0; i < blocks.size(); ++i) {
+				const uint32_t index = blocks[i].first;
 
 				// write index pos
 				uint16_t x = static_cast<uint16_t>((index % (65536 / MMBLOCK_SIZE)) * MMBLOCK_SIZE);
@@ -102,15 +175,17 @@ bool IOMinimap::saveOtmm(const wxFileName &file) {
 				writer.addU16(y);
 				writer.addU8(z);
 
-				unsigned long len = blockSize;
-				int ret = compress2(buffer.data(), &len, (uint8_t*)&block.getTiles(), blockSize, COMPRESS_LEVEL);
-				assert(ret == Z_OK);
-				writer.addU16(len);
-				writer.addRAW(buffer.data(), len);
+				writer.addU16(compressed[i].size());
+				writer.addRAW(compressed[i].data(), compressed[i].size());
 			}
+			writtenBlocks += blocks.size();
 			m_blocks[z].clear();
 		}
 
+		if (m_updateLoadbar) {
+			g_gui.SetLoadScale(0, 100);
+		}
+
 		// end of file is an invalid pos
 		writer.addU16(65535);
 		writer.addU16(65535);
@@ -156,85 +231,79 @@ bool IOMinimap::exportMinimap(const std::string &directory) {
 	int min_z = m_floor == -1 ? 0 : m_floor;
 	int max_z = m_floor == -1 ? rme::MapMaxLayer : m_floor;
 	int max_x = 0, max_y = 0;
-	for (auto it = map.begin(); it != map.end(); ++it) {
-		auto tile = (*it)->get();
-		if (!tile || (!tile->ground && tile->items.empty())) {
-			continue;
-		}
-		const auto &position = tile->getPosition();
-		if (position.x > max_x) {
-			max_x = position.x;
-		}
-		if (position.y > max_y) {
-			max_y = position.y;
-		}
+	std::vector<Position> bounds = collect_PartitionsOnMap(map, Position(), [](const MapPartition &partition, Position &bound) {
+		partition.forEachTile([&bound](Tile* tile) {
+			if (!hasMinimapContent(tile)) {
+				return;
+			}
+			const auto &position = tile->getPosition();
+			bound.x = std::max(bound.x, position.x);
+			bound.y = std::max(bound.y, position.y);
+		});
+	});
+	for (const Position &bound : bounds) {
+		max_x = std::max(max_x, bound.x);
+		max_y = std::max(max_y, bound.y);
 	}
 
 	int last_x = ((max_x / m_imageSize) + 1) * m_imageSize - 1;
 	int last_y = ((max_y / m_imageSize) + 1) * m_imageSize - 1;
 
-	int pixels_size = m_imageSize * m_imageSize * rme::PixelFormatRGB;
-	uint8_t* pixels = new uint8_t[pixels_size];
-	auto image = new wxImage(m_imageSize, m_imageSize, pixels, true);
-
-	int processedTiles = 0;
-	int lastShownProgress = -1;
-
-	for (size_t z = min_z; z <= max_z; z++) {
-		for (int h = 0; h <= last_y; h += m_imageSize) {
-			for (int w = 0; w <= last_x; w += m_imageSize) {
-				memset(pixels, 0, pixels_size);
-				bool empty = true;
-
-				int index = 0;
-				for (int y = 0; y < m_imageSize; y++) {
-					for (int x = 0; x < m_imageSize; x++) {
-						int tile_x = w + x;
-						int tile_y = h + y;
-						if (tile_x > max_x || tile_y > max_y) {
-							index += rme::PixelFormatRGB;
-							continue;
-						}
-						auto tile = map.getTile(tile_x, tile_y, z);
-						if (!tile || (!tile->ground && tile->items.empty())) {
-							index += rme::PixelFormatRGB;
-							continue;
-						}
-
-						processedTiles++;
-						int progress = static_cast<int>((static_cast<double>(processedTiles) / map.size()) * 100);
-						if (progress > lastShownProgress) {
-							if (m_updateLoadbar) {
-								g_gui.SetLoadDone(progress);
-							}
-							lastShownProgress = progress;
-						}
-
-						uint8_t color = tile->getMiniMapColor();
-						pixels[index] = (uint8_t)(static_cast<int>(color / 36) % 6 * 51);
-						pixels[index + 1] = (uint8_t)(static_cast<int>(color / 6) % 6 * 51);
-						pixels[index + 2] = (uint8_t)(color % 6 * 51);
-						index += rme::PixelFormatRGB;
-						empty = false;
+	const int columns = (last_x + 1) / m_imageSize;
+	const int rows = (last_y + 1) / m_imageSize;
+	const size_t images = static_cast<size_t>(max_z - min_z + 1) * rows * columns;
+
+	const size_t pixels_size = static_cast<size_t>(m_imageSize) * m_imageSize * rme::PixelFormatRGB;
+	const size_t threadCount = std::min(getExportThreadCount(), std::max<size_t>(1, MinimapImageMemory / pixels_size));
+
+	const wxString extension = m_format == MinimapExportFormat::Png ? "png" : "bmp";
+	const wxBitmapType type = m_format == MinimapExportFormat::Png ? wxBITMAP_TYPE_PNG : wxBITMAP_TYPE_BMP;
+
+	// Every image is filled and encoded on its own, by whichever worker picks it up
+	RunParallelJobs(
+		images, threadCount,
+		[&](size_t job) {
+			const int z = min_z + static_cast<int>(job / (rows * columns));
+			const int h = static_cast<int>(job / columns % rows) * m_imageSize;
+			const int w = static_cast<int>(job % columns) * m_imageSize;
+
+			std::vector<uint8_t> pixels(pixels_size, 0);
+			bool empty = true;
+
+			const auto drawFloor = [&](FloorSpan locations) {
+				for (TileLocation &location : locations) {
+					const Tile* tile = location.get();
+					if (!tile || !hasMinimapContent(tile)) {
+						continue;
 					}
-				}
 
-				if (!empty) {
-					image->SetData(pixels, true);
-					wxString extension = m_format == MinimapExportFormat::Png ? "png" : "bmp";
-					wxBitmapType type = m_format == MinimapExportFormat::Png ? wxBITMAP_TYPE_PNG : wxBITMAP_TYPE_BMP;
-					wxString extension_wx = wxString::FromAscii(extension.mb_str());
-					wxFileName file = wxString::Format("Minimap_Color_%d_%d_%d.%s", w, h, (int)z, extension_wx);
-					file.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_TILDE | wxPATH_NORM_CASE | wxPATH_NORM_ABSOLUTE, directory);
-					image->SaveFile(file.GetFullPath(), type);
+					const Position &position = location.getPosition();
+					uint8_t color = tile->getMiniMapColor();
+					size_t index = (static_cast<size_t>(position.y - h) * m_imageSize + (position.x - w)) * rme::PixelFormatRGB;
+					pixels[index] = (uint8_t)(static_cast<int>(color / 36) % 6 * 51);
+					pixels[index + 1] = (uint8_t)(static_cast<int>(color / 6) % 6 * 51);
+					pixels[index + 2] = (uint8_t)(color % 6 * 51);
+					empty = false;
 				}
+			};
+			// Images are multiples of 64 tiles, so leaves never cross their edges
+			map.forEachFloor(drawFloor, Position(w, h, z), Position(w + m_imageSize - 1, h + m_imageSize - 1, z));
+
+			if (!empty) {
+				wxImage image(m_imageSize, m_imageSize, pixels.data(), true);
+				wxFileName file = wxString::Format("Minimap_Color_%d_%d_%d.%s", w, h, z, extension);
+				file.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_TILDE | wxPATH_NORM_CASE | wxPATH_NORM_ABSOLUTE, directory);
+				image.SaveFile(file.GetFullPath(), type);
+			}
+		},
+		[&](size_t done) {
+			if (m_updateLoadbar && images != 0) {
+				g_gui.SetLoadDone(static_cast<int32_t>(std::min<size_t>(99, 100 * done / images)));
 			}
 		}
-	}
+	);
 
 	g_gui.DestroyLoadBar();
-	image->Destroy();
-	delete[] pixels;
 	return true;
 }
 
@@ -341,51 +410,56 @@ void IOMinimap::readBlocks() {
 
 	auto &map = m_editor->getMap();
 
-	int tiles_iterated = 0;
-	for (auto it = map.begin(); it != map.end(); ++it) {
-		auto tile = (*it)->get();
-
-		if (m_updateLoadbar) {
-			++tiles_iterated;
-			if (tiles_iterated % 8192 == 0) {
-				g_gui.SetLoadDone(int(tiles_iterated / double(map.size()) * 90.0));
+	// Each partition fills its own blocks and remembers the order it created them in.
+	// Partitions are in map order, so inserting the blocks partition by partition creates
+	// them in the same order as a single pass over the map would.
+	struct PartitionBlocks {
+		std::vector<uint32_t> order[rme::MapLayers];
+		std::unordered_map<uint32_t, MinimapBlock> blocks[rme::MapLayers];
+	};
+
+	const bool selectedOnly = m_mode == MinimapExportMode::SelectedArea;
+	const int floor = m_floor;
+	std::vector<PartitionBlocks> partials = collect_PartitionsOnMap(map, PartitionBlocks(), [this, selectedOnly, floor](const MapPartition &partition, PartitionBlocks &partial) {
+		partition.forEachTile([&](Tile* tile) {
+			if (!hasMinimapContent(tile)) {
+				return;
 			}
-		}
-
-		if (!tile || (!tile->ground && tile->items.empty())) {
-			continue;
-		}
 
-		const auto &position = tile->getPosition();
+			const auto &position = tile->getPosition();
 
-		if (m_mode == MinimapExportMode::SelectedArea) {
-			if (!tile->isSelected()) {
-				continue;
+			if (selectedOnly) {
+				if (!tile->isSelected()) {
+					return;
+				}
+			} else if (floor != -1 && position.z != floor) {
+				return;
 			}
-		} else if (m_floor != -1 && position.z != m_floor) {
-			continue;
-		}
 
-		MinimapTile minimapTile;
-		minimapTile.color = tile->getMiniMapColor();
-		minimapTile.flags |= MinimapTileWasSeen;
-		if (tile->isBlocking()) {
-			minimapTile.flags |= MinimapTileNotWalkable;
-		}
-		// if (!tile->isPathable()) {
-		// minimapTile.flags |= MinimapTileNotPathable;
-		//}
-		minimapTile.speed = std::min<int>((int)std::ceil(tile->getGroundSpeed() / 10.f), 0xFF);
+			const uint32_t index = getBlockIndex(position);
+			auto [it, inserted] = partial.blocks[position.z].try_emplace(index);
+			if (inserted) {
+				partial.order[position.z].push_back(index);
+			}
 
-		auto &blocks = m_blocks[position.z];
-		uint32_t index = getBlockIndex(position);
-		if (blocks.find(index) == blocks.end()) {
-			blocks.insert({ index, MinimapBlock() });
+			int offset_x = position.x - (position.x % MMBLOCK_SIZE);
+			int offset_y = position.y - (position.y % MMBLOCK_SIZE);
+			it->second.updateTile(position.x - offset_x, position.y - offset_y, getMinimapTile(tile));
+		});
+	});
+
+	for (PartitionBlocks &partial : partials) {
+		for (int z = 0; z < rme::MapLayers; ++z) {
+			auto &blocks = m_blocks[z];
+			for (uint32_t index : partial.order[z]) {
+				MinimapBlock &block = partial.blocks[z].at(index);
+				auto [it, inserted] = blocks.try_emplace(index, block);
+				if (!inserted) {
+					// Blocks on the boundary of two partitions
+					it->second.merge(block);
+				}
+			}
+			partial.blocks[z].clear();
 		}
-
-		auto &block = blocks.at(index);
-		int offset_x = position.x - (position.x % MMBLOCK_SIZE);
-		int offset_y = position.y - (position.y % MMBLOCK_SIZE);
-		block.updateTile(position.x - offset_x, position.y - offset_y, minimapTile);
 	}
 }
@@ -55,6 +55,8 @@ struct MinimapTile {
 class MinimapBlock {
 public:
 	void updateTile(int x, int y, const MinimapTile &tile);
+	// Copies the tiles that were seen in the other block
+	void merge(const MinimapBlock &other);
 	MinimapTile &getTile(int x, int y) {
 		return m_tiles[getTileIndex(x, y)];
 	}
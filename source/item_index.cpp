@@ -0,0 +1,190 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "item_index.h"
+#include "map.h"
+#include "tile.h"
+#include "item.h"
+#include "complexitem.h"
+
+namespace {
+	void mergeFloorCounts(std::unordered_map<ItemIndex::FloorKey, uint32_t> &to, std::unordered_map<ItemIndex::FloorKey, uint32_t> &&from) {
+		if (to.empty()) {
+			to = std::move(from);
+			return;
+		}
+		for (const auto &[key, count] : from) {
+			to[key] += count;
+		}
+	}
+}
+
+void ItemIndex::invalidate() {
+	items.clear();
+	actions.clear();
+	uniques.clear();
+	containers.clear();
+	writeables.clear();
+	valid = false;
+}
+
+void ItemIndex::rebuild(Map &map) {
+	// Partitions never share a leaf, so merging them doesn't have to add up any counts
+	std::vector<ItemIndex> partials = collect_PartitionsOnMap(map, ItemIndex(), [](const MapPartition &partition, ItemIndex &partial) {
+		partition.forEachTile([&partial](Tile* tile) {
+			partial.updateTile(tile, true);
+		});
+	});
+
+	invalidate();
+	for (ItemIndex &partial : partials) {
+		merge(std::move(partial));
+	}
+	valid = true;
+}
+
+void ItemIndex::addTile(Tile* tile) {
+	if (valid && tile) {
+		updateTile(tile, true);
+	}
+}
+
+void ItemIndex::removeTile(Tile* tile) {
+	if (valid && tile) {
+		updateTile(tile, false);
+	}
+}
+
+void ItemIndex::updateTile(Tile* tile, bool add) {
+	const FloorKey key = getFloorKey(tile->getPosition());
+
+	const auto updateFloor = [key, add](FloorCounts &counts) {
+		if (add) {
+			++counts[key];
+			return;
+		}
+
+		// Tiles may have been changed in place since they were added, don't trust the counts blindly
+		auto it = counts.find(key);
+		if (it != counts.end() && --it->second == 0) {
+			counts.erase(it);
+		}
+	};
+
+	const auto updateId = [&](std::unordered_map<uint16_t, FloorCounts> &index, uint16_t id) {
+		if (add) {
+			updateFloor(index[id]);
+			return;
+		}
+
+		auto it = index.find(id);
+		if (it != index.end()) {
+			updateFloor(it->second);
+			if (it->second.empty()) {
+				index.erase(it);
+			}
+		}
+	};
+
+	foreach_ItemOnTile(tile, [&](Item* item) {
+		updateId(items, item->getID());
+		if (const uint16_t aid = item->getActionID()) {
+			updateId(actions, aid);
+		}
+		if (const uint16_t uid = item->getUniqueID()) {
+			updateId(uniques, uid);
+		}
+
+		const Container* container = dynamic_cast<const Container*>(item);
+		if (container && container->getItemCount() > 0) {
+			updateFloor(containers);
+		}
+		if (item->getText().length() > 0) {
+			updateFloor(writeables);
+		}
+	});
+}
+
+void ItemIndex::collectFloors(const FloorCounts &counts, std::vector<FloorKey> &floors) {
+	floors.reserve(floors.size() + counts.size());
+	for (const auto &[key, count] : counts) {
+		floors.push_back(key);
+	}
+}
+
+std::vector<ItemIndex::FloorKey> ItemIndex::sortFloors(std::vector<FloorKey> floors) {
+	std::sort(floors.begin(), floors.end());
+	floors.erase(std::unique(floors.begin(), floors.end()), floors.end());
+	return floors;
+}
+
+std::vector<ItemIndex::FloorKey> ItemIndex::getItemFloors(uint16_t id) const {
+	std::vector<FloorKey> floors;
+	if (auto it = items.find(id); it != items.end()) {
+		collectFloors(it->second, floors);
+	}
+	return sortFloors(std::move(floors));
+}
+
+std::vector<ItemIndex::FloorKey> ItemIndex::getActionFloors(uint16_t aid) const {
+	std::vector<FloorKey> floors;
+	for (const auto &[id, counts] : actions) {
+		if (aid == 0 || id == aid) {
+			collectFloors(counts, floors);
+		}
+	}
+	return sortFloors(std::move(floors));
+}
+
+std::vector<ItemIndex::FloorKey> ItemIndex::getUniqueFloors(uint16_t uid) const {
+	std::vector<FloorKey> floors;
+	for (const auto &[id, counts] : uniques) {
+		if (uid == 0 || id == uid) {
+			collectFloors(counts, floors);
+		}
+	}
+	return sortFloors(std::move(floors));
+}
+
+std::vector<ItemIndex::FloorKey> ItemIndex::getContainerFloors() const {
+	std::vector<FloorKey> floors;
+	collectFloors(containers, floors);
+	return sortFloors(std::move(floors));
+}
+
+std::vector<ItemIndex::FloorKey> ItemIndex::getWriteableFloors() const {
+	std::vector<FloorKey> floors;
+	collectFloors(writeables, floors);
+	return sortFloors(std::move(floors));
+}
+
+void ItemIndex::merge(ItemIndex &&other) {
+	for (auto &[id, counts] : other.items) {
+		mergeFloorCounts(items[id], std::move(counts));
+	}
+	for (auto &[id, counts] : other.actions) {
+		mergeFloorCounts(actions[id], std::move(counts));
+	}
+	for (auto &[id, counts] : other.uniques) {
+		mergeFloorCounts(uniques[id], std::move(counts));
+	}
+	mergeFloorCounts(containers, std::move(other.containers));
+	mergeFloorCounts(writeables, std::move(other.writeables));
+	other.invalidate();
+}
@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_ITEM_INDEX_H_
+#define RME_ITEM_INDEX_H_
+
+#include "position.h"
+
+#include <unordered_map>
+
+class Map;
+class Tile;
+
+// Keeps track of where items are on the map, by item id, action id and unique id,
+// as well as containers holding items and writeables with text.
+// Entries are kept per floor of a quad tree leaf (4x4 tiles): a lookup returns the
+// few floors worth visiting, and the caller checks the actual items on them.
+class ItemIndex {
+public:
+	// Floor of the leaf holding a position, keys sort by z, then y, then x
+	using FloorKey = uint32_t;
+
+	static FloorKey getFloorKey(const Position &position) noexcept {
+		return (static_cast<uint32_t>(position.z) << 28) | (static_cast<uint32_t>(position.y >> 2) << 14) | static_cast<uint32_t>(position.x >> 2);
+	}
+	// Returns the top left position of the floor
+	static Position getFloorPosition(FloorKey key) noexcept {
+		return Position((key & 0x3FFF) << 2, ((key >> 14) & 0x3FFF) << 2, key >> 28);
+	}
+
+	// An invalid index ignores updates, it has to be rebuilt before it can be used
+	bool isValid() const noexcept {
+		return valid;
+	}
+	void invalidate();
+	// Walks the whole map on the worker threads and replaces the contents of the index
+	void rebuild(Map &map);
+
+	void addTile(Tile* tile);
+	void removeTile(Tile* tile);
+
+	// All of these return sorted keys, an id of 0 matches any action/unique id
+	std::vector<FloorKey> getItemFloors(uint16_t id) const;
+	std::vector<FloorKey> getActionFloors(uint16_t aid = 0) const;
+	std::vector<FloorKey> getUniqueFloors(uint16_t uid = 0) const;
+	std::vector<FloorKey> getContainerFloors() const;
+	std::vector<FloorKey> getWriteableFloors() const;
+
+	// Moves the entries of another index into this one
+	void merge(ItemIndex &&other);
+
+protected:
+	using FloorCounts = std::unordered_map<FloorKey, uint32_t>;
+
+	void updateTile(Tile* tile, bool add);
+	static void collectFloors(const FloorCounts &counts, std::vector<FloorKey> &floors);
+	static std::vector<FloorKey> sortFloors(std::vector<FloorKey> floors);
+
+	std::unordered_map<uint16_t, FloorCounts> items;
+	std::unordered_map<uint16_t, FloorCounts> actions;
+	std::unordered_map<uint16_t, FloorCounts> uniques;
+	FloorCounts containers;
+	FloorCounts writeables;
+	bool valid = false;
+};
+
+#endif
@@ -0,0 +1,157 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "item_name_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cctype>
+
+ItemNameIndex g_itemNameIndex;
+
+namespace {
+	uint32_t getTrigram(const std::string &text, size_t offset) {
+		return (uint32_t(uint8_t(text[offset])) << 16) | (uint32_t(uint8_t(text[offset + 1])) << 8) | uint8_t(text[offset + 2]);
+	}
+
+	// Same as as_lower_str, which lives with the wx helpers
+	std::string toLowerName(const std::string &text) {
+		std::string lower = text;
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return lower;
+	}
+}
+
+void ItemNameIndex::clear() {
+	listed.clear();
+	for (Bits &bits : flagged) {
+		bits.clear();
+	}
+	ids.clear();
+	brushNames.clear();
+	itemNames.clear();
+	trigrams.clear();
+}
+
+void ItemNameIndex::add(uint16_t id, const std::string &brushName, const std::string &itemName, FlagMask flags) {
+	assert(ids.empty() || ids.back() < id);
+	ids.push_back(id);
+	set(listed, id);
+	for (uint8_t flag = 0; flag < FlagCount; ++flag) {
+		if (flags & mask(static_cast<Flag>(flag))) {
+			set(flagged[flag], id);
+		}
+	}
+
+	if (brushNames.size() <= id) {
+		brushNames.resize(id + 1);
+		itemNames.resize(id + 1);
+	}
+	const std::string &name = brushNames[id] = toLowerName(brushName);
+	itemNames[id] = toLowerName(itemName);
+
+	// Ids are added in order, so every posting list stays sorted
+	for (size_t offset = 0; offset + 3 <= name.size(); ++offset) {
+		std::vector<uint16_t> &posting = trigrams[getTrigram(name, offset)];
+		if (posting.empty() || posting.back() != id) {
+			posting.push_back(id);
+		}
+	}
+}
+
+ItemNameIndex::Bits ItemNameIndex::getFilter(FlagMask flags) const {
+	Bits filter = listed;
+	for (uint8_t flag = 0; flag < FlagCount; ++flag) {
+		if (!(flags & mask(static_cast<Flag>(flag)))) {
+			continue;
+		}
+
+		const Bits &bits = flagged[flag];
+		for (size_t word = 0; word < filter.size(); ++word) {
+			filter[word] &= word < bits.size() ? bits[word] : 0;
+		}
+	}
+	return filter;
+}
+
+bool ItemNameIndex::contains(uint16_t id, FlagMask flags) const noexcept {
+	if (!test(listed, id)) {
+		return false;
+	}
+	for (uint8_t flag = 0; flag < FlagCount; ++flag) {
+		if ((flags & mask(static_cast<Flag>(flag))) && !test(flagged[flag], id)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::vector<uint16_t> ItemNameIndex::find(FlagMask flags) const {
+	const Bits filter = getFilter(flags);
+	std::vector<uint16_t> found;
+	for (size_t word = 0; word < filter.size(); ++word) {
+		for (uint64_t bits = filter[word]; bits != 0; bits &= bits - 1) {
+			found.push_back(static_cast<uint16_t>(word * 64 + std::countr_zero(bits)));
+		}
+	}
+	return found;
+}
+
+std::vector<uint16_t> ItemNameIndex::findByName(const std::string &text, FlagMask flags) const {
+	const std::string query = toLowerName(text);
+	const Bits filter = getFilter(flags);
+	std::vector<uint16_t> found;
+
+	if (query.size() < 3) {
+		// Too short for a trigram, the names are already lower case so this is a plain scan
+		for (uint16_t id : ids) {
+			if (test(filter, id) && brushNames[id].find(query) != std::string::npos) {
+				found.push_back(id);
+			}
+		}
+	} else {
+		std::vector<const std::vector<uint16_t>*> postings;
+		for (size_t offset = 0; offset + 3 <= query.size(); ++offset) {
+			const auto it = trigrams.find(getTrigram(query, offset));
+			if (it == trigrams.end()) {
+				return found;
+			}
+			postings.push_back(&it->second);
+		}
+		std::ranges::sort(postings, {}, [](const std::vector<uint16_t>* posting) { return posting->size(); });
+
+		// Walk the shortest list, the trigrams only narrow it down so the name is checked at the end
+		for (uint16_t id : *postings.front()) {
+			if (!test(filter, id)) {
+				continue;
+			}
+			const bool inAll = std::all_of(postings.begin() + 1, postings.end(), [id](const std::vector<uint16_t>* posting) {
+				return std::binary_search(posting->begin(), posting->end(), id);
+			});
+			if (inAll && brushNames[id].find(query) != std::string::npos) {
+				found.push_back(id);
+			}
+		}
+	}
+
+	std::ranges::stable_sort(found, {}, [this, &query](uint16_t id) {
+		const std::string &name = itemNames[id];
+		return name == query ? 0 : name.starts_with(query) ? 1 : 2;
+	});
+	return found;
+}
@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_ITEM_NAME_INDEX_H_
+#define RME_ITEM_NAME_INDEX_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Search index over the items that have a raw brush, used by the find item dialog.
+// Names are split into trigrams with a sorted list of item ids each, and every flag
+// the dialog filters on is kept as a bitset over the item ids.
+class ItemNameIndex {
+public:
+	enum Flag : uint8_t {
+		Pickupable,
+		Unpassable,
+		Unmovable,
+		BlockMissiles,
+		BlockPathfinder,
+		Readable,
+		Writeable,
+		Stackable,
+		Rotatable,
+		Hangable,
+		HookEast,
+		HookSouth,
+		HasElevation,
+		IgnoreLook,
+		FloorChange,
+		Depot,
+		Mailbox,
+		TrashHolder,
+		Container,
+		Door,
+		MagicField,
+		Teleport,
+		Bed,
+		Key,
+		FlagCount,
+	};
+	using FlagMask = uint32_t;
+
+	static constexpr FlagMask mask(Flag flag) noexcept {
+		return FlagMask(1) << flag;
+	}
+
+	void clear();
+	// Adds an item, ids must be added in increasing order.
+	// The editor fills it from the loaded items with ItemDatabase::buildNameIndex.
+	void add(uint16_t id, const std::string &brushName, const std::string &itemName, FlagMask flags);
+
+	size_t size() const noexcept {
+		return ids.size();
+	}
+
+	bool contains(uint16_t id, FlagMask flags) const noexcept;
+	// Items having all the flags, in id order
+	std::vector<uint16_t> find(FlagMask flags) const;
+	// Items having all the flags whose lower case brush name contains the lower case text.
+	// Items named exactly like the text come first, then the ones whose name starts with it.
+	std::vector<uint16_t> findByName(const std::string &text, FlagMask flags) const;
+
+protected:
+	using Bits = std::vector<uint64_t>;
+
+	static bool test(const Bits &bits, uint16_t id) noexcept {
+		return id / 64 < bits.size() && (bits[id / 64] >> (id % 64) & 1) != 0;
+	}
+	static void set(Bits &bits, uint16_t id) {
+		if (id / 64 >= bits.size()) {
+			bits.resize(id / 64 + 1, 0);
+		}
+		bits[id / 64] |= uint64_t(1) << (id % 64);
+	}
+
+	Bits getFilter(FlagMask flags) const;
+
+	// Every indexed item, and the items of each flag
+	Bits listed;
+	std::array<Bits, FlagCount> flagged;
+	std::vector<uint16_t> ids;
+	// Lower case brush and item names, indexed by item id
+	std::vector<std::string> brushNames;
+	std::vector<std::string> itemNames;
+	std::unordered_map<uint32_t, std::vector<uint16_t>> trigrams;
+};
+
+extern ItemNameIndex g_itemNameIndex;
+
+#endif
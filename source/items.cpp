@@ -23,6 +23,9 @@
 #include "items.h"
 #include "item.h"
 #include "sprite_appearances.h"
+#include "appearance_index.h"
+#include "item_name_index.h"
+#include "raw_brush.h"
 
 #include <appearances.pb.h>
 
@@ -453,11 +456,15 @@ bool ItemDatabase::loadFromOtb(const FileName &datafile, wxString &error, wxArra
 }
 #endif
 
-bool ItemDatabase::loadFromProtobuf(wxString &error, wxArrayString &warnings, rme::protobuf::appearances::Appearances &appearances) {
+bool ItemDatabase::loadFromProtobuf(wxString &error, wxArrayString &warnings, const AppearanceIndex &appearances) {
 	using namespace rme::protobuf::appearances;
 
-	for (uint16_t it = 0; it < static_cast<uint16_t>(appearances.object_size()); ++it) {
-		Appearance object = appearances.object(it);
+	Appearance object;
+	for (const AppearanceIndex::Entry &entry : appearances.getObjects()) {
+		if (!appearances.decode(entry, object)) {
+			spdlog::error("[ItemDatabase::loadFromProtobuf] - Item with id {} could not be decoded and was ignored.", entry.id);
+			continue;
+		}
 
 		// This scenario should never happen but on custom assets this can break the loader.
 		if (!object.has_flags()) {
@@ -819,3 +826,49 @@ bool ItemDatabase::isValidID(uint16_t id) const {
 	}
 	return items[id] != nullptr;
 }
+
+void ItemDatabase::buildNameIndex(ItemNameIndex &index) {
+	index.clear();
+
+	for (int id = getMinID(); id <= getMaxID(); ++id) {
+		const ItemType &item = getItemType(id);
+		if (item.id == 0 || !item.raw_brush) {
+			continue;
+		}
+
+		ItemNameIndex::FlagMask flags = 0;
+		const auto addFlag = [&flags](ItemNameIndex::Flag flag, bool value) {
+			if (value) {
+				flags |= ItemNameIndex::mask(flag);
+			}
+		};
+		addFlag(ItemNameIndex::Pickupable, item.pickupable);
+		addFlag(ItemNameIndex::Unpassable, item.unpassable);
+		addFlag(ItemNameIndex::Unmovable, !item.moveable);
+		addFlag(ItemNameIndex::BlockMissiles, item.blockMissiles);
+		addFlag(ItemNameIndex::BlockPathfinder, item.blockPathfinder);
+		addFlag(ItemNameIndex::Readable, item.canReadText);
+		addFlag(ItemNameIndex::Writeable, item.canWriteText);
+		addFlag(ItemNameIndex::Stackable, item.stackable);
+		addFlag(ItemNameIndex::Rotatable, item.rotable);
+		addFlag(ItemNameIndex::Hangable, item.isHangable);
+		addFlag(ItemNameIndex::HookEast, item.hookEast || item.hook == ITEM_HOOK_EAST);
+		addFlag(ItemNameIndex::HookSouth, item.hookSouth || item.hook == ITEM_HOOK_SOUTH);
+		addFlag(ItemNameIndex::HasElevation, item.hasElevation);
+		addFlag(ItemNameIndex::IgnoreLook, item.ignoreLook);
+		addFlag(ItemNameIndex::FloorChange, item.isFloorChange());
+		addFlag(ItemNameIndex::Depot, item.isDepot());
+		addFlag(ItemNameIndex::Mailbox, item.isMailbox());
+		addFlag(ItemNameIndex::TrashHolder, item.isTrashHolder());
+		addFlag(ItemNameIndex::Container, item.isContainer());
+		addFlag(ItemNameIndex::Door, item.isDoor());
+		addFlag(ItemNameIndex::MagicField, item.isMagicField());
+		addFlag(ItemNameIndex::Teleport, item.isTeleport());
+		addFlag(ItemNameIndex::Bed, item.isBed());
+		addFlag(ItemNameIndex::Key, item.isKey());
+
+		index.add(item.id, item.raw_brush->getName(), item.name, flags);
+	}
+
+	spdlog::debug("Indexed {} item names", index.size());
+}
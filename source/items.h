@@ -21,13 +21,8 @@
 #include "filehandle.h"
 #include "brush_enums.h"
 
-namespace rme {
-	namespace protobuf {
-		namespace appearances {
-			class Appearances;
-		}
-	}
-}
+class AppearanceIndex;
+class ItemNameIndex;
 
 class Brush;
 class GroundBrush;
@@ -441,11 +436,14 @@ public:
 	bool isValidID(uint16_t id) const;
 
 	bool loadFromOtb(const FileName &datafile, wxString &error, wxArrayString &warnings);
-	bool loadFromProtobuf(wxString &error, wxArrayString &warnings, rme::protobuf::appearances::Appearances &appearances);
+	bool loadFromProtobuf(wxString &error, wxArrayString &warnings, const AppearanceIndex &appearances);
 	bool loadFromGameXml(const FileName &datafile, wxString &error, wxArrayString &warnings);
 	bool loadItemFromGameXml(pugi::xml_node itemNode, uint16_t id);
 	bool loadMetaItem(pugi::xml_node node);
 
+	// Fills the find item index with every item that has a raw brush
+	void buildNameIndex(ItemNameIndex &index);
+
 	// typedef std::map<int32_t, std::shared_ptr<ItemType>> ItemMap;
 	typedef contigous_vector<std::shared_ptr<ItemType>> ItemMap;
 	typedef std::map<std::string, std::shared_ptr<ItemType>> ItemNameMap;
@@ -0,0 +1,166 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "lua_scanner.h"
+
+#include <charconv>
+
+namespace LuaScanner {
+	bool isWordChar(char c) noexcept {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+	}
+
+	bool isSpace(char c) noexcept {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	size_t skipSpaces(std::string_view content, size_t pos) noexcept {
+		while (pos < content.size() && isSpace(content[pos])) {
+			++pos;
+		}
+		return pos;
+	}
+
+	size_t findToken(std::string_view content, std::string_view token, size_t pos, bool wholeWord) noexcept {
+		for (pos = content.find(token, pos); pos != std::string_view::npos; pos = content.find(token, pos + 1)) {
+			if (pos > 0 && isWordChar(content[pos - 1])) {
+				continue;
+			}
+			const size_t end = pos + token.size();
+			if (wholeWord && end < content.size() && isWordChar(content[end])) {
+				continue;
+			}
+			return pos;
+		}
+		return std::string_view::npos;
+	}
+
+	size_t readIdentifier(std::string_view content, size_t pos, std::string_view &identifier) noexcept {
+		if (pos >= content.size() || !isWordChar(content[pos]) || (content[pos] >= '0' && content[pos] <= '9')) {
+			return std::string_view::npos;
+		}
+
+		const size_t start = pos;
+		while (pos < content.size() && isWordChar(content[pos])) {
+			++pos;
+		}
+		identifier = content.substr(start, pos - start);
+		return pos;
+	}
+
+	bool findIntegerField(std::string_view content, std::string_view name, int &value) {
+		for (size_t pos = findToken(content, name, 0, true); pos != std::string_view::npos; pos = findToken(content, name, pos + 1, true)) {
+			size_t valuePos = skipSpaces(content, pos + name.size());
+			if (valuePos >= content.size() || content[valuePos] != '=') {
+				continue;
+			}
+
+			valuePos = skipSpaces(content, valuePos + 1);
+			size_t digitsPos = valuePos;
+			if (digitsPos < content.size() && content[digitsPos] == '-') {
+				++digitsPos;
+			}
+			if (digitsPos >= content.size() || content[digitsPos] < '0' || content[digitsPos] > '9') {
+				continue;
+			}
+
+			const auto result = std::from_chars(content.data() + valuePos, content.data() + content.size(), value);
+			return result.ec == std::errc();
+		}
+		return false;
+	}
+
+	bool findAssignedIdentifier(std::string_view content, std::string_view token, std::string &identifier) {
+		for (size_t pos = findToken(content, token); pos != std::string_view::npos; pos = findToken(content, token, pos + 1)) {
+			size_t valuePos = skipSpaces(content, pos + token.size());
+			if (valuePos >= content.size() || content[valuePos] != '=') {
+				continue;
+			}
+
+			std::string_view name;
+			if (readIdentifier(content, skipSpaces(content, valuePos + 1), name) != std::string_view::npos) {
+				identifier = name;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool findCalledIdentifier(std::string_view content, std::string_view token, std::string &identifier) {
+		for (size_t pos = findToken(content, token); pos != std::string_view::npos; pos = findToken(content, token, pos + 1)) {
+			size_t argumentPos = skipSpaces(content, pos + token.size());
+			if (argumentPos >= content.size() || content[argumentPos] != '(') {
+				continue;
+			}
+
+			std::string_view name;
+			const size_t end = readIdentifier(content, skipSpaces(content, argumentPos + 1), name);
+			if (end == std::string_view::npos) {
+				continue;
+			}
+
+			const size_t closePos = skipSpaces(content, end);
+			if (closePos < content.size() && content[closePos] == ')') {
+				identifier = name;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<std::pair<std::string, size_t>> findLocalAssignments(std::string_view content) {
+		constexpr std::string_view keyword = "local";
+
+		std::vector<std::pair<std::string, size_t>> assignments;
+		size_t pos = findToken(content, keyword);
+		while (pos != std::string_view::npos) {
+			const size_t namePos = skipSpaces(content, pos + keyword.size());
+			std::string_view name;
+			const size_t nameEnd = namePos > pos + keyword.size() ? readIdentifier(content, namePos, name) : std::string_view::npos;
+			if (nameEnd != std::string_view::npos) {
+				const size_t equalsPos = skipSpaces(content, nameEnd);
+				if (equalsPos < content.size() && content[equalsPos] == '=') {
+					assignments.emplace_back(std::string(name), equalsPos + 1);
+					pos = findToken(content, keyword, equalsPos + 1);
+					continue;
+				}
+			}
+			pos = findToken(content, keyword, pos + 1);
+		}
+		return assignments;
+	}
+
+	std::vector<size_t> findLineAssignments(std::string_view content, std::string_view name) {
+		std::vector<size_t> assignments;
+		for (size_t pos = content.find(name); pos != std::string_view::npos; pos = content.find(name, pos + 1)) {
+			// Only whitespace may come between the start of the line and the name
+			size_t linePos = pos;
+			while (linePos > 0 && isSpace(content[linePos - 1]) && content[linePos - 1] != '\n' && content[linePos - 1] != '\r') {
+				--linePos;
+			}
+			if (linePos > 0 && content[linePos - 1] != '\n' && content[linePos - 1] != '\r') {
+				continue;
+			}
+
+			const size_t equalsPos = skipSpaces(content, pos + name.size());
+			if (equalsPos < content.size() && content[equalsPos] == '=') {
+				assignments.push_back(equalsPos + 1);
+			}
+		}
+		return assignments;
+	}
+}
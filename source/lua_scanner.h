@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_LUA_SCANNER_H_
+#define RME_LUA_SCANNER_H_
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Hand-written matching for the few constructs the server Lua importers look for,
+// such as `lookType = 130` inside an outfit table or `local name = "..."`.
+// It works on the raw text like the regular expressions it replaces did: comments
+// and strings are not skipped, and a whole word is a run of [A-Za-z0-9_].
+namespace LuaScanner {
+	bool isWordChar(char c) noexcept;
+	bool isSpace(char c) noexcept;
+	size_t skipSpaces(std::string_view content, size_t pos) noexcept;
+
+	// Returns the position of the first `token` at or after pos that does not
+	// continue a word, or npos. With wholeWord it must not be followed by one either.
+	size_t findToken(std::string_view content, std::string_view token, size_t pos = 0, bool wholeWord = false) noexcept;
+	// Reads an identifier ([A-Za-z_][A-Za-z0-9_]*) starting at pos, returns the
+	// position after it or npos if there is none
+	size_t readIdentifier(std::string_view content, size_t pos, std::string_view &identifier) noexcept;
+
+	// First `name = <integer>` where name is a whole word
+	bool findIntegerField(std::string_view content, std::string_view name, int &value);
+	// First `token = identifier`, as in `npcConfig.name = npcName`
+	bool findAssignedIdentifier(std::string_view content, std::string_view token, std::string &identifier);
+	// First `token(identifier)`, as in `Game.createNpcType(npcName)`
+	bool findCalledIdentifier(std::string_view content, std::string_view token, std::string &identifier);
+
+	// Every `local name =`, with the position right after the '='
+	std::vector<std::pair<std::string, size_t>> findLocalAssignments(std::string_view content);
+	// Every `name =` that starts a line, with the position right after the '='
+	std::vector<size_t> findLineAssignments(std::string_view content, std::string_view name);
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include "dat_debug_view.h"
 #include "result_window.h"
 #include "find_item_window.h"
+#include "map_image_renderer.h"
 #include "settings.h"
 #include "iomap_otbm.h"
 #include "gui.h"
@@ -583,6 +584,7 @@ MainMenuBar::MainMenuBar(MainFrame* frame) :
 	MAKE_ACTION(IMPORT_BITMAP_TO_MAP, wxITEM_NORMAL, OnImportBitmapToMap);
 
 	MAKE_ACTION(EXPORT_MINIMAP, wxITEM_NORMAL, OnExportMinimap);
+	MAKE_ACTION(EXPORT_MAP_IMAGE, wxITEM_NORMAL, OnExportMapImage);
 	MAKE_ACTION(EXPORT_STATIC_HOUSE_DATA, wxITEM_NORMAL, OnExportStaticHouseData);
 	MAKE_ACTION(EXPORT_CYCLOPEDIA_MAP, wxITEM_NORMAL, OnExportCyclopediaMapData);
 	MAKE_ACTION(REVERT_CYCLOPEDIA_ASSETS, wxITEM_NORMAL, OnRevertCyclopediaAssets);
@@ -779,10 +781,7 @@ namespace OnMapRemoveItems {
 
 		uint16_t itemId;
 
-		bool operator()(Map &map, Item* item, int64_t removed, int64_t done) {
-			if (done % 0x8000 == 0) {
-				g_gui.SetLoadDone((uint32_t)(100 * done / map.getTileCount()));
-			}
+		bool operator()(Map &map, Item* item) {
 			return item->getID() == itemId && !item->isComplex();
 		}
 	};
@@ -873,6 +872,7 @@ void MainMenuBar::Update() {
 	EnableItem(IMPORT_NPCS_FROM_SERVER, loaded);
 	EnableItem(IMPORT_MINIMAP, false);
 	EnableItem(EXPORT_MINIMAP, is_local);
+	EnableItem(EXPORT_MAP_IMAGE, is_local);
 	EnableItem(EXPORT_STATIC_HOUSE_DATA, is_local);
 	EnableItem(EXPORT_CYCLOPEDIA_MAP, is_local);
 	EnableItem(REVERT_CYCLOPEDIA_ASSETS, true);
@@ -1353,6 +1353,59 @@ void MainMenuBar::OnExportMinimap(wxCommandEvent &WXUNUSED(event)) {
 	dialog.ShowModal();
 }
 
+void MainMenuBar::OnExportMapImage(wxCommandEvent &WXUNUSED(event)) {
+	if (!g_gui.IsEditorOpen()) {
+		return;
+	}
+
+	wxFileDialog dialog(frame, "Export map image", "", "", "PNG files (*.png)|*.png", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+	if (dialog.ShowModal() != wxID_OK) {
+		return;
+	}
+
+	Editor &editor = *g_gui.GetCurrentEditor();
+	Map &map = editor.getMap();
+	const int floor = g_gui.GetCurrentFloor();
+
+	// Renders the selection on the current floor, or the whole floor without one
+	Position from(rme::MapMaxWidth, rme::MapMaxHeight, floor);
+	Position to(0, 0, floor);
+	const auto extend = [&from, &to](const Position &position) {
+		from.x = std::min(from.x, position.x);
+		from.y = std::min(from.y, position.y);
+		to.x = std::max(to.x, position.x);
+		to.y = std::max(to.y, position.y);
+	};
+
+	bool selectionOnFloor = false;
+	for (const Tile* tile : editor.getSelection().getTiles()) {
+		if (tile->getZ() == floor) {
+			extend(tile->getPosition());
+			selectionOnFloor = true;
+		}
+	}
+
+	if (!selectionOnFloor) {
+		g_gui.CreateLoadBar("Measuring floor...");
+		MapImageRenderer::getFloorBounds(map, floor, from, to);
+		g_gui.DestroyLoadBar();
+	}
+
+	if (from.x > to.x || from.y > to.y) {
+		g_gui.PopupDialog("Export map image", "There is nothing to render on this floor.", wxOK);
+		return;
+	}
+
+	g_gui.CreateLoadBar("Rendering map image...");
+	MapImageRenderer renderer(map, true);
+	const bool rendered = renderer.render(from, to, nstr(dialog.GetPath()));
+	g_gui.DestroyLoadBar();
+
+	if (!rendered) {
+		g_gui.PopupDialog("Error", wxString(renderer.getError()), wxOK);
+	}
+}
+
 void MainMenuBar::OnExportStaticHouseData(wxCommandEvent &) {
 	if (!g_gui.IsEditorOpen()) {
 		return;
@@ -1626,26 +1679,24 @@ void MainMenuBar::OnRedo(wxCommandEvent &WXUNUSED(event)) {
 namespace OnSearchForItem {
 	struct Finder {
 		Finder(uint16_t itemId, uint32_t maxCount, bool findTile = false) :
-			itemId(itemId), maxCount(maxCount), findTile(findTile) { }
+			itemId(itemId), maxCount(maxCount), findTile(findTile),
+			tileSearchType(static_cast<FindItemDialog::SearchTileType>(g_settings.getInteger(Config::FIND_TILE_TYPE))) { }
 
 		bool findTile = false;
 		uint16_t itemId;
 		uint32_t maxCount;
+		FindItemDialog::SearchTileType tileSearchType;
 		std::vector<std::pair<Tile*, Item*>> result;
 
 		bool limitReached() const {
 			return result.size() >= (size_t)maxCount;
 		}
 
-		void operator()(Map &map, Tile* tile, Item* item, long long done) {
+		void operator()(Map &map, Tile* tile, Item* item) {
 			if (result.size() >= (size_t)maxCount) {
 				return;
 			}
 
-			if (done % 0x8000 == 0) {
-				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
-			}
-
 			if (item->getID() == itemId) {
 				result.push_back(std::make_pair(tile, item));
 			}
@@ -1658,7 +1709,6 @@ namespace OnSearchForItem {
 				return;
 			}
 
-			const auto &tileSearchType = static_cast<FindItemDialog::SearchTileType>(g_settings.getInteger(Config::FIND_TILE_TYPE));
 			if (tileSearchType == FindItemDialog::SearchTileType::NoLogout && !tile->isNoLogout()) {
 				return;
 			}
@@ -1685,6 +1735,11 @@ namespace OnSearchForItem {
 
 			result.push_back(std::make_pair(tile, nullptr));
 		}
+
+		void merge(Finder &&other) {
+			const size_t count = std::min(other.result.size(), (size_t)maxCount - std::min(result.size(), (size_t)maxCount));
+			result.insert(result.end(), other.result.begin(), other.result.begin() + count);
+		}
 	};
 }
 
@@ -1705,7 +1760,12 @@ void MainMenuBar::OnSearchForItem(wxCommandEvent &WXUNUSED(event)) {
 
 		g_gui.CreateLoadBar("Searching map...");
 
-		foreach_ItemOnMap(g_gui.GetCurrentMap(), finder, false);
+		Map &map = g_gui.GetCurrentMap();
+		if (finder.findTile) {
+			foreach_ItemOnMapParallel(map, finder, false);
+		} else {
+			foreach_ItemOnFloors(map, map.getItemIndex().getItemFloors(finder.itemId), finder, false);
+		}
 		std::vector<std::pair<Tile*, Item*>> &result = finder.result;
 
 		g_gui.DestroyLoadBar();
@@ -1772,10 +1832,7 @@ namespace OnSearchForStuff {
 		bool search_writeable;
 		std::vector<std::pair<Tile*, Item*>> found;
 
-		void operator()(Map &map, Tile* tile, Item* item, long long done) {
-			if (done % 0x8000 == 0) {
-				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
-			}
+		void operator()(Map &map, Tile* tile, Item* item) {
 			Container* container;
 			if ((search_unique && item->getUniqueID() > 0) || (search_action && item->getActionID() > 0) || (search_container && ((container = dynamic_cast<Container*>(item)) && container->getItemCount())) || (search_writeable && item && item->getText().length() > 0)) {
 				found.push_back(std::make_pair(tile, item));
@@ -1877,7 +1934,8 @@ void MainMenuBar::OnSearchForItemOnSelection(wxCommandEvent &WXUNUSED(event)) {
 		OnSearchForItem::Finder finder(dialog.getResultID(), (uint32_t)g_settings.getInteger(Config::REPLACE_SIZE), false);
 		g_gui.CreateLoadBar("Searching on selected area...");
 
-		foreach_ItemOnMap(g_gui.GetCurrentMap(), finder, true);
+		Map &map = g_gui.GetCurrentMap();
+		foreach_ItemOnFloors(map, map.getItemIndex().getItemFloors(finder.itemId), finder, true);
 		std::vector<std::pair<Tile*, Item*>> &result = finder.result;
 
 		g_gui.DestroyLoadBar();
@@ -2146,12 +2204,11 @@ void MainMenuBar::OnMapRemoveItems(wxCommandEvent &WXUNUSED(event)) {
 		uint16_t itemid = dialog.getResultID();
 
 		g_gui.GetCurrentEditor()->getSelection().clear();
-		g_gui.GetCurrentEditor()->clearActions();
 
 		OnMapRemoveItems::RemoveItemCondition condition(itemid);
 		g_gui.CreateLoadBar("Searching map for items to remove...");
 
-		int64_t count = RemoveItemOnMap(g_gui.GetCurrentMap(), condition, false);
+		int64_t count = g_gui.GetCurrentEditor()->removeItemsOnMap(condition, false);
 
 		g_gui.DestroyLoadBar();
 
@@ -2169,11 +2226,7 @@ namespace OnMapRemoveCorpses {
 	struct condition {
 		condition() { }
 
-		bool operator()(Map &map, Item* item, long long removed, long long done) {
-			if (done % 0x800 == 0) {
-				g_gui.SetLoadDone((unsigned int)(100 * done / map.getTileCount()));
-			}
-
+		bool operator()(Map &map, Item* item) {
 			return g_materials.isInTileset(item, "Corpses") && !item->isComplex();
 		}
 	};
@@ -2188,12 +2241,11 @@ void MainMenuBar::OnMapRemoveCorpses(wxCommandEvent &WXUNUSED(event)) {
 
 	if (ok == wxID_YES) {
 		g_gui.GetCurrentEditor()->getSelection().clear();
-		g_gui.GetCurrentEditor()->clearActions();
 
 		OnMapRemoveCorpses::condition func;
 		g_gui.CreateLoadBar("Searching map for items to remove...");
 
-		int64_t count = RemoveItemOnMap(g_gui.GetCurrentMap(), func, false);
+		int64_t count = g_gui.GetCurrentEditor()->removeItemsOnMap(func, false);
 
 		g_gui.DestroyLoadBar();
 
@@ -2218,11 +2270,7 @@ namespace OnMapRemoveUnreachable {
 			return false;
 		}
 
-		bool operator()(Map &map, Tile* tile, long long removed, long long done, long long total) {
-			if (done % 0x1000 == 0) {
-				g_gui.SetLoadDone((unsigned int)(100 * done / total));
-			}
-
+		bool operator()(Map &map, Tile* tile) {
 			const Position &pos = tile->getPosition();
 			int sx = std::max(pos.x - 10, 0);
 			int ex = std::min(pos.x + 10, 65535);
@@ -2262,12 +2310,11 @@ void MainMenuBar::OnMapRemoveUnreachable(wxCommandEvent &WXUNUSED(event)) {
 
 	if (ok == wxID_YES) {
 		g_gui.GetCurrentEditor()->getSelection().clear();
-		g_gui.GetCurrentEditor()->clearActions();
 
 		OnMapRemoveUnreachable::condition func;
 		g_gui.CreateLoadBar("Searching map for tiles to remove...");
 
-		long long removed = remove_if_TileOnMap(g_gui.GetCurrentMap(), func);
+		long long removed = g_gui.GetCurrentEditor()->removeTilesOnMap(func);
 
 		g_gui.DestroyLoadBar();
 
@@ -2520,28 +2567,11 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent &WXUNUSED(event)) {
 
 	Map* map = &g_gui.GetCurrentMap();
 
-	int load_counter = 0;
-
-	uint64_t tile_count = 0;
-	uint64_t detailed_tile_count = 0;
-	uint64_t blocking_tile_count = 0;
-	uint64_t walkable_tile_count = 0;
 	double percent_pathable = 0.0;
 	double percent_detailed = 0.0;
-	uint64_t spawn_monster_count = 0;
-	uint64_t spawn_npc_count = 0;
-	uint64_t monster_count = 0;
-	uint64_t npc_count = 0;
 	double monsters_per_spawn = 0.0;
 	double npcs_per_spawn = 0.0;
 
-	uint64_t item_count = 0;
-	uint64_t loose_item_count = 0;
-	uint64_t depot_count = 0;
-	uint64_t action_item_count = 0;
-	uint64_t unique_item_count = 0;
-	uint64_t container_count = 0; // Only includes containers containing more than 1 item
-
 	int town_count = map->towns.count();
 	int house_count = map->houses.count();
 	std::map<uint32_t, uint32_t> town_sqm_count;
@@ -2554,86 +2584,33 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent &WXUNUSED(event)) {
 	double sqm_per_house = 0.0;
 	double sqm_per_town = 0.0;
 
-	for (MapIterator mit = map->begin(); mit != map->end(); ++mit) {
-		Tile* tile = (*mit)->get();
-		if (load_counter % 8192 == 0) {
-			g_gui.SetLoadDone((unsigned int)(int64_t(load_counter) * 95ll / int64_t(map->getTileCount())));
-		}
-
-		if (tile->empty()) {
-			continue;
-		}
-
-		tile_count += 1;
-
-		bool is_detailed = false;
-#define ANALYZE_ITEM(_item)                                             \
-	{                                                                   \
-		item_count += 1;                                                \
-		if (!(_item)->isGroundTile() && !(_item)->isBorder()) {         \
-			is_detailed = true;                                         \
-			const ItemType &it = g_items.getItemType((_item)->getID()); \
-			if (it.moveable) {                                          \
-				loose_item_count += 1;                                  \
-			}                                                           \
-			if (it.isDepot()) {                                         \
-				depot_count += 1;                                       \
-			}                                                           \
-			if ((_item)->getActionID() > 0) {                           \
-				action_item_count += 1;                                 \
-			}                                                           \
-			if ((_item)->getUniqueID() > 0) {                           \
-				unique_item_count += 1;                                 \
-			}                                                           \
-			if (Container* c = dynamic_cast<Container*>((_item))) {     \
-				if (c->getVector().size()) {                            \
-					container_count += 1;                               \
-				}                                                       \
-			}                                                           \
-		}                                                               \
-	}
-		if (tile->ground) {
-			ANALYZE_ITEM(tile->ground);
-		}
-
-		for (Item* item : tile->items) {
-			ANALYZE_ITEM(item);
-		}
-#undef ANALYZE_ITEM
-
-		if (tile->spawnMonster) {
-			spawn_monster_count += 1;
-		}
-
-		if (tile->spawnNpc) {
-			spawn_npc_count += 1;
-		}
-
-		monster_count += tile->monsters.size();
-
-		if (tile->npc) {
-			npc_count += 1;
-		}
-
-		if (tile->isBlocking()) {
-			blocking_tile_count += 1;
-		} else {
-			walkable_tile_count += 1;
-		}
-
-		if (is_detailed) {
-			detailed_tile_count += 1;
-		}
-
-		load_counter += 1;
-	}
+	// Counters are kept up to date as the map changes, this only walks the map if they were invalidated
+	g_gui.SetLoadScale(0, 95);
+	const MapStatistics &statistics = map->getStatistics();
+	g_gui.SetLoadScale(0, 100);
+
+	const uint64_t tile_count = statistics.tile_count;
+	const uint64_t detailed_tile_count = statistics.detailed_tile_count;
+	const uint64_t blocking_tile_count = statistics.blocking_tile_count;
+	const uint64_t walkable_tile_count = statistics.walkable_tile_count;
+	const uint64_t spawn_monster_count = statistics.spawn_monster_count;
+	const uint64_t spawn_npc_count = statistics.spawn_npc_count;
+	const uint64_t monster_count = statistics.monster_count;
+	const uint64_t npc_count = statistics.npc_count;
+
+	const uint64_t item_count = statistics.item_count;
+	const uint64_t loose_item_count = statistics.loose_item_count;
+	const uint64_t depot_count = statistics.depot_count;
+	const uint64_t action_item_count = statistics.action_item_count;
+	const uint64_t unique_item_count = statistics.unique_item_count;
+	const uint64_t container_count = statistics.container_count;
 
 	monsters_per_spawn = (spawn_monster_count != 0 ? double(monster_count) / double(spawn_monster_count) : -1.0);
 	npcs_per_spawn = (spawn_npc_count != 0 ? double(npc_count) / double(spawn_npc_count) : -1.0);
 	percent_pathable = 100.0 * (tile_count != 0 ? double(walkable_tile_count) / double(tile_count) : -1.0);
 	percent_detailed = 100.0 * (tile_count != 0 ? double(detailed_tile_count) / double(tile_count) : -1.0);
 
-	load_counter = 0;
+	int load_counter = 0;
 	Houses &houses = map->houses;
 	for (HouseMap::const_iterator hit = houses.begin(); hit != houses.end(); ++hit) {
 		const House* house = hit->second;
@@ -2687,6 +2664,11 @@ void MainMenuBar::OnMapStatistics(wxCommandEvent &WXUNUSED(event)) {
 	if (percent_detailed >= 0.0) {
 		os << "\t\tPercent detailed tiles: " << percent_detailed << "%\n";
 	}
+	for (int z = 0; z < rme::MapLayers; ++z) {
+		if (const uint64_t floor_tile_count = map->getTileCount(z)) {
+			os << "\t\tTiles on floor " << z << ": " << floor_tile_count << "\n";
+		}
+	}
 
 	os << "\tItem data:\n";
 	os << "\t\tTotal number of items: " << item_count << "\n";
@@ -3124,7 +3106,29 @@ void MainMenuBar::SearchItems(bool unique, bool action, bool container, bool wri
 	searcher.search_container = container;
 	searcher.search_writeable = writable;
 
-	foreach_ItemOnMap(g_gui.GetCurrentMap(), searcher, onSelection);
+	// Only the floors holding something we're looking for have to be searched
+	Map &map = g_gui.GetCurrentMap();
+	const ItemIndex &index = map.getItemIndex();
+	std::vector<ItemIndex::FloorKey> floors;
+	const auto addFloors = [&floors](const std::vector<ItemIndex::FloorKey> &keys) {
+		floors.insert(floors.end(), keys.begin(), keys.end());
+	};
+	if (unique) {
+		addFloors(index.getUniqueFloors());
+	}
+	if (action) {
+		addFloors(index.getActionFloors());
+	}
+	if (container) {
+		addFloors(index.getContainerFloors());
+	}
+	if (writable) {
+		addFloors(index.getWriteableFloors());
+	}
+	std::sort(floors.begin(), floors.end());
+	floors.erase(std::unique(floors.begin(), floors.end()), floors.end());
+
+	foreach_ItemOnFloors(map, floors, searcher, onSelection);
 	searcher.sort();
 	std::vector<std::pair<Tile*, Item*>> &found = searcher.found;
 
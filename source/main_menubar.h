@@ -37,6 +37,7 @@ namespace MenuBar {
 		IMPORT_NPCS_FROM_SERVER,
 		IMPORT_MINIMAP,
 		EXPORT_MINIMAP,
+		EXPORT_MAP_IMAGE,
 		EXPORT_STATIC_HOUSE_DATA,
 		EXPORT_CYCLOPEDIA_MAP,
 		REVERT_CYCLOPEDIA_ASSETS,
@@ -225,6 +226,7 @@ public:
 	void OnImportMinimap(wxCommandEvent &event);
 	void OnImportBitmapToMap(wxCommandEvent &event);
 	void OnExportMinimap(wxCommandEvent &event);
+	void OnExportMapImage(wxCommandEvent &event);
 	void OnExportStaticHouseData(wxCommandEvent &event);
 	void OnExportCyclopediaMapData(wxCommandEvent &event);
 	void OnRevertCyclopediaAssets(wxCommandEvent &event);
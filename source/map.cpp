@@ -19,9 +19,160 @@
 
 #include "gui.h"
 #include "map.h"
+#include "settings.h"
 
 #include "client_assets.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+	struct ItemIdListHash {
+		size_t operator()(const std::vector<uint16_t> &ids) const noexcept {
+			size_t hash = ids.size();
+			for (uint16_t id : ids) {
+				hash ^= id + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			}
+			return hash;
+		}
+	};
+
+	// Hashed copy of a ConversionMap, so the tiles can be converted without ordered lookups
+	class ConversionLookup {
+	public:
+		explicit ConversionLookup(const ConversionMap &rm) :
+			single(std::numeric_limits<uint16_t>::max() + 1, nullptr) {
+			many.reserve(rm.mtm.size());
+			for (const auto &[ids, replacement] : rm.mtm) {
+				many.emplace(ids, &replacement);
+				longestKey = std::max(longestKey, ids.size());
+			}
+			for (const auto &[id, replacement] : rm.stm) {
+				single[id] = &replacement;
+			}
+		}
+
+		const std::vector<uint16_t>* findMany(const std::vector<uint16_t> &ids) const {
+			const auto it = many.find(ids);
+			return it != many.end() ? it->second : nullptr;
+		}
+		const std::vector<uint16_t>* findSingle(uint16_t id) const noexcept {
+			return single[id];
+		}
+		// No list of ids longer than this can match
+		size_t getLongestKey() const noexcept {
+			return longestKey;
+		}
+
+	private:
+		std::unordered_map<std::vector<uint16_t>, const std::vector<uint16_t>*, ItemIdListHash> many;
+		std::vector<const std::vector<uint16_t>*> single;
+		size_t longestKey = 0;
+	};
+
+	// id_list is scratch space, kept by the caller to avoid an allocation per tile
+	void convertTile(Tile* tile, const ConversionLookup &lookup, std::vector<uint16_t> &id_list) {
+		if (tile->size() == 0) {
+			return;
+		}
+
+		// id_list try MTM conversion
+		id_list.clear();
+
+		if (tile->ground) {
+			id_list.push_back(tile->ground->getID());
+		}
+		for (const Item* item : tile->items) {
+			if (item->isBorder()) {
+				id_list.push_back(item->getID());
+			}
+		}
+
+		std::sort(id_list.begin(), id_list.end());
+		if (id_list.size() > lookup.getLongestKey()) {
+			id_list.resize(lookup.getLongestKey());
+		}
+
+		const std::vector<uint16_t>* new_items = nullptr;
+		while (id_list.size()) {
+			new_items = lookup.findMany(id_list);
+			if (new_items) {
+				break;
+			}
+			id_list.pop_back();
+		}
+
+		// Keep track of how many items have been inserted at the bottom
+		size_t inserted_items = 0;
+
+		if (new_items) {
+			// id_list now holds the matched key
+			const std::vector<uint16_t> &v = id_list;
+
+			if (tile->ground && std::find(v.begin(), v.end(), tile->ground->getID()) != v.end()) {
+				delete tile->ground;
+				tile->ground = nullptr;
+			}
+
+			for (ItemVector::iterator item_iter = tile->items.begin(); item_iter != tile->items.end();) {
+				if (std::find(v.begin(), v.end(), (*item_iter)->getID()) != v.end()) {
+					delete *item_iter;
+					item_iter = tile->items.erase(item_iter);
+				} else {
+					++item_iter;
+				}
+			}
+
+			for (uint16_t id : *new_items) {
+				Item* item = Item::Create(id);
+				if (item->isGroundTile()) {
+					tile->ground = item;
+				} else {
+					tile->items.insert(tile->items.begin(), item);
+					++inserted_items;
+				}
+			}
+		}
+
+		if (tile->ground) {
+			if (const std::vector<uint16_t>* v = lookup.findSingle(tile->ground->getID())) {
+				uint16_t aid = tile->ground->getActionID();
+				uint16_t uid = tile->ground->getUniqueID();
+				delete tile->ground;
+				tile->ground = nullptr;
+
+				for (uint16_t id : *v) {
+					Item* item = Item::Create(id);
+					if (item->isGroundTile()) {
+						item->setActionID(aid);
+						item->setUniqueID(uid);
+						tile->addItem(item);
+					} else {
+						tile->items.insert(tile->items.begin(), item);
+						++inserted_items;
+					}
+				}
+			}
+		}
+
+		for (ItemVector::iterator replace_item_iter = tile->items.begin() + inserted_items; replace_item_iter != tile->items.end();) {
+			const std::vector<uint16_t>* v = lookup.findSingle((*replace_item_iter)->getID());
+			if (v) {
+				delete *replace_item_iter;
+
+				replace_item_iter = tile->items.erase(replace_item_iter);
+				for (uint16_t id : *v) {
+					replace_item_iter = tile->items.insert(replace_item_iter, Item::Create(id));
+					++replace_item_iter;
+				}
+			} else {
+				++replace_item_iter;
+			}
+		}
+	}
+}
+
 Map::Map() :
 	BaseMap(),
 	width(512),
@@ -46,6 +197,12 @@ bool Map::open(const std::string file) {
 	}
 
 	tilecount = 0;
+	std::fill(std::begin(floor_tilecount), std::end(floor_tilecount), 0);
+	// The loader adds every spawn of the file again
+	spawnMonsterAreas.clear();
+	spawnNpcAreas.clear();
+	// Tiles are added one by one while loading, it's much cheaper to index them all at once afterwards
+	invalidateIndexes();
 
 	IOMapOTBM maploader(getVersion());
 
@@ -62,6 +219,9 @@ bool Map::open(const std::string file) {
 
 	has_changed = false;
 
+	itemIndex.rebuild(*this);
+	statistics.rebuild(*this);
+
 	wxFileName fn = wxstr(file);
 	filename = fn.GetFullPath().mb_str(wxConvUTF8);
 	name = fn.GetFullName().mb_str(wxConvUTF8);
@@ -120,130 +280,20 @@ bool Map::convert(MapVersion to, bool showdialog) {
 }
 
 bool Map::convert(const ConversionMap &rm, bool showdialog) {
+	invalidateIndexes();
+
 	if (showdialog) {
 		g_gui.CreateLoadBar("Converting map ...");
 	}
 
-	uint64_t tiles_done = 0;
-	std::vector<uint16_t> id_list;
-
-	// std::ofstream conversions("converted_items.txt");
-
-	for (MapIterator miter = begin(); miter != end(); ++miter) {
-		Tile* tile = (*miter)->get();
-		ASSERT(tile);
-
-		if (tile->size() == 0) {
-			continue;
-		}
-
-		// id_list try MTM conversion
-		id_list.clear();
-
-		if (tile->ground) {
-			id_list.push_back(tile->ground->getID());
-		}
-		for (ItemVector::const_iterator item_iter = tile->items.begin(); item_iter != tile->items.end(); ++item_iter) {
-			if ((*item_iter)->isBorder()) {
-				id_list.push_back((*item_iter)->getID());
-			}
-		}
-
-		std::sort(id_list.begin(), id_list.end());
-
-		ConversionMap::MTM::const_iterator cfmtm = rm.mtm.end();
-
-		while (id_list.size()) {
-			cfmtm = rm.mtm.find(id_list);
-			if (cfmtm != rm.mtm.end()) {
-				break;
-			}
-			id_list.pop_back();
-		}
-
-		// Keep track of how many items have been inserted at the bottom
-		size_t inserted_items = 0;
-
-		if (cfmtm != rm.mtm.end()) {
-			const std::vector<uint16_t> &v = cfmtm->first;
-
-			if (tile->ground && std::find(v.begin(), v.end(), tile->ground->getID()) != v.end()) {
-				delete tile->ground;
-				tile->ground = nullptr;
-			}
-
-			for (ItemVector::iterator item_iter = tile->items.begin(); item_iter != tile->items.end();) {
-				if (std::find(v.begin(), v.end(), (*item_iter)->getID()) != v.end()) {
-					delete *item_iter;
-					item_iter = tile->items.erase(item_iter);
-				} else {
-					++item_iter;
-				}
-			}
-
-			const std::vector<uint16_t> &new_items = cfmtm->second;
-			for (std::vector<uint16_t>::const_iterator iit = new_items.begin(); iit != new_items.end(); ++iit) {
-				Item* item = Item::Create(*iit);
-				if (item->isGroundTile()) {
-					tile->ground = item;
-				} else {
-					tile->items.insert(tile->items.begin(), item);
-					++inserted_items;
-				}
-			}
-		}
-
-		if (tile->ground) {
-			ConversionMap::STM::const_iterator cfstm = rm.stm.find(tile->ground->getID());
-			if (cfstm != rm.stm.end()) {
-				uint16_t aid = tile->ground->getActionID();
-				uint16_t uid = tile->ground->getUniqueID();
-				delete tile->ground;
-				tile->ground = nullptr;
-
-				const std::vector<uint16_t> &v = cfstm->second;
-				// conversions << "Converted " << tile->getX() << ":" << tile->getY() << ":" << tile->getZ() << " " << id << " -> ";
-				for (std::vector<uint16_t>::const_iterator iit = v.begin(); iit != v.end(); ++iit) {
-					Item* item = Item::Create(*iit);
-					// conversions << *iit << " ";
-					if (item->isGroundTile()) {
-						item->setActionID(aid);
-						item->setUniqueID(uid);
-						tile->addItem(item);
-					} else {
-						tile->items.insert(tile->items.begin(), item);
-						++inserted_items;
-					}
-				}
-				// conversions << std::endl;
-			}
-		}
-
-		for (ItemVector::iterator replace_item_iter = tile->items.begin() + inserted_items; replace_item_iter != tile->items.end();) {
-			uint16_t id = (*replace_item_iter)->getID();
-			ConversionMap::STM::const_iterator cf = rm.stm.find(id);
-			if (cf != rm.stm.end()) {
-				// uint16_t aid = (*replace_item_iter)->getActionID();
-				// uint16_t uid = (*replace_item_iter)->getUniqueID();
-				delete *replace_item_iter;
-
-				replace_item_iter = tile->items.erase(replace_item_iter);
-				const std::vector<uint16_t> &v = cf->second;
-				for (std::vector<uint16_t>::const_iterator iit = v.begin(); iit != v.end(); ++iit) {
-					replace_item_iter = tile->items.insert(replace_item_iter, Item::Create(*iit));
-					// conversions << "Converted " << tile->getX() << ":" << tile->getY() << ":" << tile->getZ() << " " << id << " -> " << *iit << std::endl;
-					++replace_item_iter;
-				}
-			} else {
-				++replace_item_iter;
-			}
-		}
-
-		++tiles_done;
-		if (showdialog && tiles_done % 0x10000 == 0) {
-			g_gui.SetLoadDone(int(tiles_done / double(getTileCount()) * 100.0));
-		}
-	}
+	// Every tile is converted on its own, so all partitions can run at once with the same result as in order
+	const ConversionLookup lookup(rm);
+	foreach_PartitionOnMap(PartitionMapForWorkers(*this), [&lookup](const MapPartition &partition) {
+		std::vector<uint16_t> id_list;
+		partition.forEachTile([&](Tile* tile) {
+			convertTile(tile, lookup, id_list);
+		});
+	});
 
 	if (showdialog) {
 		g_gui.DestroyLoadBar();
@@ -253,6 +303,8 @@ bool Map::convert(const ConversionMap &rm, bool showdialog) {
 }
 
 void Map::cleanInvalidTiles(bool showdialog) {
+	invalidateIndexes();
+
 	if (showdialog) {
 		g_gui.CreateLoadBar("Removing invalid tiles...");
 	}
@@ -397,18 +449,7 @@ void Map::setSpawnNpcFilename(const std::string &new_spawnnpcfile) {
 bool Map::addSpawnMonster(Tile* tile) {
 	SpawnMonster* spawnMonster = tile->spawnMonster;
 	if (spawnMonster) {
-		int z = tile->getZ();
-		int start_x = tile->getX() - spawnMonster->getSize();
-		int start_y = tile->getY() - spawnMonster->getSize();
-		int end_x = tile->getX() + spawnMonster->getSize();
-		int end_y = tile->getY() + spawnMonster->getSize();
-
-		for (int y = start_y; y <= end_y; ++y) {
-			for (int x = start_x; x <= end_x; ++x) {
-				TileLocation* ctile_loc = createTileL(x, y, z);
-				ctile_loc->increaseSpawnCount();
-			}
-		}
+		spawnMonsterAreas.add(tile->getPosition(), spawnMonster->getSize());
 		spawnsMonster.addSpawnMonster(tile);
 		return true;
 	}
@@ -419,20 +460,7 @@ void Map::removeSpawnMonsterInternal(Tile* tile) {
 	SpawnMonster* spawnMonster = tile->spawnMonster;
 	ASSERT(spawnMonster);
 
-	int z = tile->getZ();
-	int start_x = tile->getX() - spawnMonster->getSize();
-	int start_y = tile->getY() - spawnMonster->getSize();
-	int end_x = tile->getX() + spawnMonster->getSize();
-	int end_y = tile->getY() + spawnMonster->getSize();
-
-	for (int y = start_y; y <= end_y; ++y) {
-		for (int x = start_x; x <= end_x; ++x) {
-			TileLocation* ctile_loc = getTileL(x, y, z);
-			if (ctile_loc != nullptr && ctile_loc->getSpawnMonsterCount() > 0) {
-				ctile_loc->decreaseSpawnMonsterCount();
-			}
-		}
-	}
+	spawnMonsterAreas.remove(tile->getPosition(), spawnMonster->getSize());
 }
 
 void Map::removeSpawnMonster(Tile* tile) {
@@ -448,68 +476,11 @@ SpawnMonsterList Map::getSpawnMonsterList(const Tile* tile) const {
 		return list;
 	}
 
-	const TileLocation* location = tile->getLocation();
-	if (!location || location->getSpawnMonsterCount() == 0) {
-		return list;
-	}
-
-	uint32_t found = 0;
-	if (tile->spawnMonster) {
-		++found;
-		list.push_back(tile->spawnMonster);
-	}
-
-	// Scans the border tiles in an expanding square around the original spawn
-	const Position &position = tile->getPosition();
-	int start_x = position.x - 1;
-	int end_x = position.x + 1;
-	int start_y = position.y - 1;
-	int end_y = position.y + 1;
-
-	while (found != location->getSpawnMonsterCount()) {
-		for (int x = start_x; x <= end_x; ++x) {
-			const Tile* start_tile = getTile(x, start_y, position.z);
-			if (start_tile && start_tile->spawnMonster) {
-				list.push_back(start_tile->spawnMonster);
-				++found;
-			}
-
-			const Tile* end_tile = getTile(x, end_y, position.z);
-			if (end_tile && end_tile->spawnMonster) {
-				list.push_back(end_tile->spawnMonster);
-				++found;
-			}
+	for (const Position &position : spawnMonsterAreas.find(tile->getPosition())) {
+		const Tile* spawnTile = getTile(position);
+		if (spawnTile && spawnTile->spawnMonster) {
+			list.push_back(spawnTile->spawnMonster);
 		}
-
-		for (int y = start_y + 1; y < end_y; ++y) {
-			const Tile* start_tile = getTile(start_x, y, position.z);
-			if (start_tile && start_tile->spawnMonster) {
-				list.push_back(start_tile->spawnMonster);
-				++found;
-			}
-			const Tile* end_tile = getTile(end_x, y, position.z);
-			if (end_tile && end_tile->spawnMonster) {
-				list.push_back(end_tile->spawnMonster);
-				++found;
-			}
-		}
-
-		for (int y = start_y + 1; y < end_y; ++y) {
-			const Tile* start_tile = getTile(start_x, y, position.z);
-			if (start_tile && start_tile->spawnMonster) {
-				list.push_back(start_tile->spawnMonster);
-				++found;
-			}
-			const Tile* end_tile = getTile(end_x, y, position.z);
-			if (end_tile && end_tile->spawnMonster) {
-				list.push_back(end_tile->spawnMonster);
-				++found;
-			}
-		}
-		--start_x;
-		--start_y;
-		++end_x;
-		++end_y;
 	}
 	return list;
 }
@@ -527,18 +498,7 @@ SpawnMonsterList Map::getSpawnMonsterList(int x, int y, int z) const {
 bool Map::addSpawnNpc(Tile* tile) {
 	SpawnNpc* spawnNpc = tile->spawnNpc;
 	if (spawnNpc) {
-		int z = tile->getZ();
-		int start_x = tile->getX() - spawnNpc->getSize();
-		int start_y = tile->getY() - spawnNpc->getSize();
-		int end_x = tile->getX() + spawnNpc->getSize();
-		int end_y = tile->getY() + spawnNpc->getSize();
-
-		for (int y = start_y; y <= end_y; ++y) {
-			for (int x = start_x; x <= end_x; ++x) {
-				TileLocation* ctile_loc = createTileL(x, y, z);
-				ctile_loc->increaseSpawnNpcCount();
-			}
-		}
+		spawnNpcAreas.add(tile->getPosition(), spawnNpc->getSize());
 		spawnsNpc.addSpawnNpc(tile);
 		return true;
 	}
@@ -549,20 +509,7 @@ void Map::removeSpawnNpcInternal(Tile* tile) {
 	SpawnNpc* spawnNpc = tile->spawnNpc;
 	ASSERT(spawnNpc);
 
-	int z = tile->getZ();
-	int start_x = tile->getX() - spawnNpc->getSize();
-	int start_y = tile->getY() - spawnNpc->getSize();
-	int end_x = tile->getX() + spawnNpc->getSize();
-	int end_y = tile->getY() + spawnNpc->getSize();
-
-	for (int y = start_y; y <= end_y; ++y) {
-		for (int x = start_x; x <= end_x; ++x) {
-			TileLocation* ctile_loc = getTileL(x, y, z);
-			if (ctile_loc != nullptr && ctile_loc->getSpawnNpcCount() > 0) {
-				ctile_loc->decreaseSpawnNpcCount();
-			}
-		}
-	}
+	spawnNpcAreas.remove(tile->getPosition(), spawnNpc->getSize());
 }
 
 void Map::removeSpawnNpc(Tile* tile) {
@@ -578,55 +525,11 @@ SpawnNpcList Map::getSpawnNpcList(const Tile* tile) const {
 		return listNpc;
 	}
 
-	const TileLocation* location = tile->getLocation();
-	if (!location || location->getSpawnNpcCount() == 0) {
-		return listNpc;
-	}
-
-	uint32_t found = 0;
-	if (tile->spawnNpc) {
-		++found;
-		listNpc.push_back(tile->spawnNpc);
-	}
-
-	// Scans the border tiles in an expanding square around the original spawn
-	const Position &position = tile->getPosition();
-	int start_x = position.x - 1;
-	int end_x = position.x + 1;
-	int start_y = position.y - 1;
-	int end_y = position.y + 1;
-
-	while (found != location->getSpawnNpcCount()) {
-		for (int x = start_x; x <= end_x; ++x) {
-			const Tile* start_tile = getTile(x, start_y, position.z);
-			if (start_tile && start_tile->spawnNpc) {
-				listNpc.push_back(start_tile->spawnNpc);
-				++found;
-			}
-
-			const Tile* end_tile = getTile(x, end_y, position.z);
-			if (end_tile && end_tile->spawnNpc) {
-				listNpc.push_back(end_tile->spawnNpc);
-				++found;
-			}
+	for (const Position &position : spawnNpcAreas.find(tile->getPosition())) {
+		const Tile* spawnTile = getTile(position);
+		if (spawnTile && spawnTile->spawnNpc) {
+			listNpc.push_back(spawnTile->spawnNpc);
 		}
-
-		for (int y = start_y + 1; y < end_y; ++y) {
-			const Tile* start_tile = getTile(start_x, y, position.z);
-			if (start_tile && start_tile->spawnNpc) {
-				listNpc.push_back(start_tile->spawnNpc);
-				++found;
-			}
-			const Tile* end_tile = getTile(end_x, y, position.z);
-			if (end_tile && end_tile->spawnNpc) {
-				listNpc.push_back(end_tile->spawnNpc);
-				++found;
-			}
-		}
-		--start_x;
-		--start_y;
-		++end_x;
-		++end_y;
 	}
 	return listNpc;
 }
@@ -657,28 +560,27 @@ bool Map::exportMinimap(FileName filename, int floor /*= rme::MapGroundLayer*/,
 			minimap_colors[i] = colorFromEightBit(i).GetRGB();
 		}
 
-		for (MapIterator mit = begin(); mit != end(); ++mit) {
-			if ((*mit)->get() == nullptr || (*mit)->empty()) {
-				continue;
-			}
-
-			Position pos = (*mit)->getPosition();
-
-			if (pos.x < min_x) {
-				min_x = pos.x;
-			}
-
-			if (pos.y < min_y) {
-				min_y = pos.y;
-			}
-
-			if (pos.x > max_x) {
-				max_x = pos.x;
-			}
-
-			if (pos.y > max_y) {
-				max_y = pos.y;
-			}
+		struct Bounds {
+			int min_x = 0x10000, min_y = 0x10000;
+			int max_x = 0x00000, max_y = 0x00000;
+		};
+		std::vector<Bounds> bounds = collect_PartitionsOnMap(*this, Bounds(), [](const MapPartition &partition, Bounds &bound) {
+			partition.forEachTile([&bound](Tile* tile) {
+				if (tile->empty()) {
+					return;
+				}
+				const Position &pos = tile->getPosition();
+				bound.min_x = std::min(bound.min_x, pos.x);
+				bound.min_y = std::min(bound.min_y, pos.y);
+				bound.max_x = std::max(bound.max_x, pos.x);
+				bound.max_y = std::max(bound.max_y, pos.y);
+			});
+		});
+		for (const Bounds &bound : bounds) {
+			min_x = std::min(min_x, bound.min_x);
+			min_y = std::min(min_y, bound.min_y);
+			max_x = std::max(max_x, bound.max_x);
+			max_y = std::max(max_y, bound.max_y);
 		}
 
 		int minimap_width = max_x - min_x + 1;
@@ -688,34 +590,35 @@ bool Map::exportMinimap(FileName filename, int floor /*= rme::MapGroundLayer*/,
 
 		memset(pic, 0, minimap_width * minimap_height);
 
-		int tiles_iterated = 0;
-		for (MapIterator mit = begin(); mit != end(); ++mit) {
-			Tile* tile = (*mit)->get();
-			++tiles_iterated;
-			if (tiles_iterated % 8192 == 0 && displaydialog) {
-				g_gui.SetLoadDone(int(tiles_iterated / double(tilecount) * 90.0));
-			}
-
-			if (tile->empty() || tile->getZ() != floor) {
-				continue;
-			}
+		if (displaydialog) {
+			g_gui.SetLoadScale(0, 90);
+		}
+		// Every tile owns its pixel, so the partitions can fill the picture concurrently
+		foreach_PartitionOnMap(PartitionMapForWorkers(*this), [&](const MapPartition &partition) {
+			partition.forEachTile([&](Tile* tile) {
+				if (tile->empty() || tile->getZ() != floor) {
+					return;
+				}
 
-			// std::cout << "Pixel : " << (tile->getY() - min_y) * width + (tile->getX() - min_x) << std::endl;
-			uint32_t pixelpos = (tile->getY() - min_y) * minimap_width + (tile->getX() - min_x);
-			uint8_t &pixel = pic[pixelpos];
+				uint32_t pixelpos = (tile->getY() - min_y) * minimap_width + (tile->getX() - min_x);
+				uint8_t &pixel = pic[pixelpos];
 
-			for (ItemVector::const_reverse_iterator item_iter = tile->items.rbegin(); item_iter != tile->items.rend(); ++item_iter) {
-				if ((*item_iter)->getMiniMapColor()) {
-					pixel = (*item_iter)->getMiniMapColor();
-					break;
+				for (ItemVector::const_reverse_iterator item_iter = tile->items.rbegin(); item_iter != tile->items.rend(); ++item_iter) {
+					if ((*item_iter)->getMiniMapColor()) {
+						pixel = (*item_iter)->getMiniMapColor();
+						break;
+					}
 				}
-			}
-			if (pixel == 0) {
-				// check ground too
-				if (tile->hasGround()) {
-					pixel = tile->ground->getMiniMapColor();
+				if (pixel == 0) {
+					// check ground too
+					if (tile->hasGround()) {
+						pixel = tile->ground->getMiniMapColor();
+					}
 				}
-			}
+			});
+		});
+		if (displaydialog) {
+			g_gui.SetLoadScale(0, 100);
 		}
 
 		// Create a file for writing
@@ -799,7 +702,27 @@ bool Map::exportMinimap(FileName filename, int floor /*= rme::MapGroundLayer*/,
 	return true;
 }
 
+ItemIndex &Map::getItemIndex() {
+	if (!itemIndex.isValid()) {
+		itemIndex.rebuild(*this);
+	}
+	return itemIndex;
+}
+
+MapStatistics &Map::getStatistics() {
+	if (!statistics.isValid()) {
+		statistics.rebuild(*this);
+	}
+	return statistics;
+}
+
 void Map::updateUniqueIds(Tile* old_tile, Tile* new_tile) {
+	itemIndex.removeTile(old_tile);
+	itemIndex.addTile(new_tile);
+	statistics.removeTile(old_tile);
+	statistics.addTile(new_tile);
+	minimapCache.markDirty(new_tile ? new_tile : old_tile);
+
 	if (old_tile && old_tile->hasUniqueItem()) {
 		if (old_tile->ground) {
 			uint16_t uid = old_tile->ground->getUniqueID();
@@ -858,7 +781,64 @@ bool Map::hasUniqueId(uint16_t uid) const {
 	return it != uniqueIds.end();
 }
 
+std::vector<MapPartition> PartitionMapForWorkers(Map &map) {
+	// More partitions than threads, so a dense part of the map doesn't stall a single worker
+	const size_t threadCount = std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+	return map.getPartitions(threadCount * 8);
+}
+
+void foreach_PartitionOnMap(const std::vector<MapPartition> &partitions, const std::function<void(const MapPartition &)> &visitor) {
+	size_t totalLeaves = 0;
+	for (const MapPartition &partition : partitions) {
+		totalLeaves += partition.getLeafCount();
+	}
+
+	const auto progress = [totalLeaves](size_t leavesDone) {
+		// SetLoadDone(100) would close the load bar, the caller does that
+		return totalLeaves == 0 ? 0 : static_cast<int32_t>(std::min<size_t>(99, 100 * leavesDone / totalLeaves));
+	};
+
+	const size_t threadCount = std::min<size_t>(std::max(g_settings.getInteger(Config::WORKER_THREADS), 1), partitions.size());
+	if (threadCount <= 1) {
+		size_t leavesDone = 0;
+		for (const MapPartition &partition : partitions) {
+			visitor(partition);
+			leavesDone += partition.getLeafCount();
+			g_gui.SetLoadDone(progress(leavesDone));
+		}
+		return;
+	}
+
+	std::atomic<size_t> nextPartition = 0;
+	std::atomic<size_t> leavesDone = 0;
+	std::atomic<size_t> runningWorkers = threadCount;
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		workers.emplace_back([&]() {
+			size_t index;
+			while ((index = nextPartition.fetch_add(1, std::memory_order_relaxed)) < partitions.size()) {
+				visitor(partitions[index]);
+				leavesDone.fetch_add(partitions[index].getLeafCount(), std::memory_order_relaxed);
+			}
+			runningWorkers.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	while (runningWorkers.load(std::memory_order_acquire) > 0) {
+		g_gui.SetLoadDone(progress(leavesDone.load(std::memory_order_relaxed)));
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+	}
+
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+}
+
 int64_t RemoveMonstersOnMap(Map &map, bool selectedOnly) {
+	map.invalidateIndexes();
+
 	int64_t done = 0;
 	int64_t removed = 0;
 
@@ -28,6 +28,12 @@
 #include "zones.h"
 #include "templates.h"
 #include "spawn_npc.h"
+#include "spawn_index.h"
+#include "item_index.h"
+#include "map_statistics.h"
+#include "minimap_cache.h"
+
+#include <functional>
 
 class Map : public BaseMap {
 public:
@@ -47,6 +53,29 @@ public:
 
 	// Query information about the map
 
+	// Index of special items, rebuilt first if it was invalidated
+	ItemIndex &getItemIndex();
+	// Doesn't rebuild, check ItemIndex::isValid before using it
+	const ItemIndex &getCachedItemIndex() const noexcept {
+		return itemIndex;
+	}
+	// Live counters of the map contents, rebuilt first if they were invalidated
+	MapStatistics &getStatistics();
+	// Doesn't rebuild, check MapStatistics::isValid before using it
+	const MapStatistics &getCachedStatistics() const noexcept {
+		return statistics;
+	}
+	// Minimap images of the map, blocks are rebuilt as tiles change
+	MinimapCache &getMinimapCache() noexcept {
+		return minimapCache;
+	}
+	// Call after changing tiles in place, without going through setTile/swapTile
+	void invalidateIndexes() {
+		itemIndex.invalidate();
+		statistics.invalidate();
+		minimapCache.invalidate();
+	}
+
 	MapVersion getVersion() const noexcept {
 		return mapVersion;
 	}
@@ -80,7 +109,15 @@ public:
 		removeSpawnMonster(getTile(position));
 	}
 
-	// Returns all possible spawnsMonster on the target tile
+	// Number of monster spawns whose area covers the position
+	size_t getSpawnMonsterCount(const Position &position) const {
+		return spawnMonsterAreas.count(position);
+	}
+	// False without monster spawns, callers going over many tiles can skip the counts then
+	bool hasSpawnMonsterAreas() const noexcept {
+		return !spawnMonsterAreas.empty();
+	}
+	// Returns all possible spawnsMonster on the target tile, closest first
 	SpawnMonsterList getSpawnMonsterList(const Tile* tile) const;
 	SpawnMonsterList getSpawnMonsterList(const Position &position) const;
 	SpawnMonsterList getSpawnMonsterList(int x, int y, int z) const;
@@ -92,7 +129,14 @@ public:
 		removeSpawnNpc(getTile(position));
 	}
 
-	// Returns all possible npc spawns on the target tile
+	// Number of npc spawns whose area covers the position
+	size_t getSpawnNpcCount(const Position &position) const {
+		return spawnNpcAreas.count(position);
+	}
+	bool hasSpawnNpcAreas() const noexcept {
+		return !spawnNpcAreas.empty();
+	}
+	// Returns all possible npc spawns on the target tile, closest first
 	SpawnNpcList getSpawnNpcList(const Tile* tile) const;
 	SpawnNpcList getSpawnNpcList(const Position &position) const;
 	SpawnNpcList getSpawnNpcList(int x, int y, int z) const;
@@ -186,6 +230,9 @@ protected:
 	void addUniqueId(uint16_t uid);
 	void removeUniqueId(uint16_t uid);
 
+	SpawnIndex spawnMonsterAreas;
+	SpawnIndex spawnNpcAreas;
+
 	bool has_changed; // If the map has changed
 	bool unnamed; // If the map has yet to receive a name
 
@@ -199,8 +246,40 @@ public:
 
 private:
 	std::vector<uint16_t> uniqueIds;
+	ItemIndex itemIndex;
+	MapStatistics statistics;
+	MinimapCache minimapCache;
 };
 
+// Calls callback(Item*) for every item on the tile, descending into containers
+template <typename ForeachType>
+inline void foreach_ItemOnTile(Tile* tile, ForeachType &&callback) {
+	if (tile->ground) {
+		callback(tile->ground);
+	}
+
+	std::queue<Container*> containers;
+	for (Item* item : tile->items) {
+		Container* container = dynamic_cast<Container*>(item);
+		callback(item);
+		if (container) {
+			containers.push(container);
+
+			do {
+				container = containers.front();
+				for (Item* i : container->getVector()) {
+					Container* c = dynamic_cast<Container*>(i);
+					callback(i);
+					if (c) {
+						containers.push(c);
+					}
+				}
+				containers.pop();
+			} while (containers.size());
+		}
+	}
+}
+
 template <typename ForeachType>
 inline void foreach_ItemOnMap(Map &map, ForeachType &foreach, bool selectedTiles) {
 	MapIterator tileiter = map.begin();
@@ -215,36 +294,10 @@ inline void foreach_ItemOnMap(Map &map, ForeachType &foreach, bool selectedTiles
 			continue;
 		}
 
-		if (tile->ground) {
-			foreach (map, tile, tile->ground, done)
-				;
-		}
-
-		std::queue<Container*> containers;
-		for (ItemVector::iterator itemiter = tile->items.begin(); itemiter != tile->items.end(); ++itemiter) {
-			Item* item = *itemiter;
-			Container* container = dynamic_cast<Container*>(item);
+		foreach_ItemOnTile(tile, [&](Item* item) {
 			foreach (map, tile, item, done)
 				;
-			if (container) {
-				containers.push(container);
-
-				do {
-					container = containers.front();
-					ItemVector &v = container->getVector();
-					for (ItemVector::iterator containeriter = v.begin(); containeriter != v.end(); ++containeriter) {
-						Item* i = *containeriter;
-						Container* c = dynamic_cast<Container*>(i);
-						foreach (map, tile, i, done)
-							;
-						if (c) {
-							containers.push(c);
-						}
-					}
-					containers.pop();
-				} while (containers.size());
-			}
-		}
+		});
 		++tileiter;
 	}
 }
@@ -261,62 +314,144 @@ inline void foreach_TileOnMap(Map &map, ForeachType &foreach) {
 	}
 }
 
+// Calls foreach(Map&, Tile*, Item*) for every item on the given floors, see ItemIndex
+template <typename ForeachType>
+inline void foreach_ItemOnFloors(Map &map, const std::vector<ItemIndex::FloorKey> &floors, ForeachType &foreach, bool selectedTiles) {
+	for (const ItemIndex::FloorKey key : floors) {
+		const Position position = ItemIndex::getFloorPosition(key);
+		QTreeNode* leaf = map.getLeaf(position.x, position.y);
+		Floor* floor = leaf ? leaf->getFloor(position.z) : nullptr;
+		if (!floor) {
+			continue;
+		}
+
+		for (TileLocation &location : floor->locs) {
+			Tile* tile = location.get();
+			if (!tile || (selectedTiles && !tile->isSelected())) {
+				continue;
+			}
+
+			foreach_ItemOnTile(tile, [&](Item* item) {
+				foreach (map, tile, item)
+					;
+			});
+		}
+	}
+}
+
+// Parallel traversal of the whole map
+// The map is split into partitions (see BaseMap::getPartitions) which are visited on
+// Config::WORKER_THREADS threads while the calling thread keeps the load bar updated.
+// Visitors run concurrently and must not modify the map or touch the GUI; they
+// write into their own per-partition result, which is merged in map order afterwards.
+std::vector<MapPartition> PartitionMapForWorkers(Map &map);
+void foreach_PartitionOnMap(const std::vector<MapPartition> &partitions, const std::function<void(const MapPartition &)> &visitor);
+
+// Runs visitor(partition, result) for every partition, each result starting as a copy of 'initial'
+// Results are returned in map order
+template <typename ResultType, typename VisitorType>
+inline std::vector<ResultType> collect_PartitionsOnMap(Map &map, const ResultType &initial, VisitorType &&visitor) {
+	const std::vector<MapPartition> partitions = PartitionMapForWorkers(map);
+	std::vector<ResultType> results(partitions.size(), initial);
+	foreach_PartitionOnMap(partitions, [&](const MapPartition &partition) {
+		visitor(partition, results[partition.getIndex()]);
+	});
+	return results;
+}
+
+// Parallel counterpart of foreach_TileOnMap, calling foreach(Map&, Tile*) on a copy of 'foreach'
+// for every partition. The copies are folded back into 'foreach' with ForeachType::merge, in map order.
+template <typename ForeachType>
+inline void foreach_TileOnMapParallel(Map &map, ForeachType &foreach, bool selectedTiles) {
+	std::vector<ForeachType> partials = collect_PartitionsOnMap(map, foreach, [&map, selectedTiles](const MapPartition &partition, ForeachType &partial) {
+		partition.forEachTile([&](Tile* tile) {
+			if (!selectedTiles || tile->isSelected()) {
+				partial(map, tile);
+			}
+		});
+	});
+
+	for (ForeachType &partial : partials) {
+		foreach.merge(std::move(partial));
+	}
+}
+
+// Parallel counterpart of foreach_ItemOnMap, calling foreach(Map&, Tile*, Item*) the same way
+template <typename ForeachType>
+inline void foreach_ItemOnMapParallel(Map &map, ForeachType &foreach, bool selectedTiles) {
+	std::vector<ForeachType> partials = collect_PartitionsOnMap(map, foreach, [&map, selectedTiles](const MapPartition &partition, ForeachType &partial) {
+		partition.forEachTile([&](Tile* tile) {
+			if (!selectedTiles || tile->isSelected()) {
+				foreach_ItemOnTile(tile, [&](Item* item) {
+					partial(map, tile, item);
+				});
+			}
+		});
+	});
+
+	for (ForeachType &partial : partials) {
+		foreach.merge(std::move(partial));
+	}
+}
+
+// Removes every tile for which remove_if(Map&, Tile*) returns true
+// The condition is evaluated in parallel against the unmodified map, the tiles are then removed in map order.
 template <typename RemoveIfType>
 inline long long remove_if_TileOnMap(Map &map, RemoveIfType &remove_if) {
-	MapIterator tileiter = map.begin();
-	MapIterator end = map.end();
-	long long done = 0;
-	long long removed = 0;
-	long long total = map.getTileCount();
+	std::vector<std::vector<Position>> found = collect_PartitionsOnMap(map, std::vector<Position>(), [&map, &remove_if](const MapPartition &partition, std::vector<Position> &positions) {
+		partition.forEachTile([&](Tile* tile) {
+			if (remove_if(map, tile)) {
+				positions.push_back(tile->getPosition());
+			}
+		});
+	});
 
-	while (tileiter != end) {
-		Tile* tile = (*tileiter)->get();
-		if (remove_if(map, tile, removed, done, total)) {
-			map.setTile(tile->getPosition(), nullptr, true);
+	long long removed = 0;
+	for (const std::vector<Position> &positions : found) {
+		for (const Position &position : positions) {
+			map.setTile(position, nullptr, true);
 			++removed;
 		}
-		++tileiter;
-		++done;
 	}
-
 	return removed;
 }
 
+// Removes every ground or top level item for which condition(Map&, Item*) returns true
+// The condition is evaluated in parallel, the items are then deleted in map order.
 template <typename RemoveIfType>
 inline int64_t RemoveItemOnMap(Map &map, RemoveIfType &condition, bool selectedOnly) {
-	int64_t done = 0;
-	int64_t removed = 0;
+	map.invalidateIndexes();
 
-	MapIterator it = map.begin();
-	MapIterator end = map.end();
+	using TileItems = std::vector<std::pair<Tile*, Item*>>;
+	std::vector<TileItems> found = collect_PartitionsOnMap(map, TileItems(), [&map, &condition, selectedOnly](const MapPartition &partition, TileItems &items) {
+		partition.forEachTile([&](Tile* tile) {
+			if (selectedOnly && !tile->isSelected()) {
+				return;
+			}
 
-	while (it != end) {
-		++done;
-		Tile* tile = (*it)->get();
-		if (selectedOnly && !tile->isSelected()) {
-			++it;
-			continue;
-		}
+			if (tile->ground && condition(map, tile->ground)) {
+				items.emplace_back(tile, tile->ground);
+			}
 
-		if (tile->ground) {
-			if (condition(map, tile->ground, removed, done)) {
-				delete tile->ground;
-				tile->ground = nullptr;
-				++removed;
+			for (Item* item : tile->items) {
+				if (condition(map, item)) {
+					items.emplace_back(tile, item);
+				}
 			}
-		}
+		});
+	});
 
-		for (auto iit = tile->items.begin(); iit != tile->items.end();) {
-			Item* item = *iit;
-			if (condition(map, item, removed, done)) {
-				iit = tile->items.erase(iit);
-				delete item;
-				++removed;
+	int64_t removed = 0;
+	for (const TileItems &items : found) {
+		for (const auto &[tile, item] : items) {
+			if (item == tile->ground) {
+				tile->ground = nullptr;
 			} else {
-				++iit;
+				tile->items.erase(std::find(tile->items.begin(), tile->items.end(), item));
 			}
+			delete item;
+			++removed;
 		}
-		++it;
 	}
 	return removed;
 }
@@ -328,6 +463,8 @@ int64_t EditMonsterSpawnTime(Map &map, bool selectedOnly, int32_t spawnTime);
 
 template <typename RemoveIfType>
 inline int64_t RemoveItemDuplicateOnMap(Map &map, RemoveIfType &condition, bool selectedOnly) {
+	map.invalidateIndexes();
+
 	int64_t done = 0;
 	int64_t removed = 0;
 
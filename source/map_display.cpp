@@ -1072,101 +1072,8 @@ void MapCanvas::OnMouseActionRelease(wxMouseEvent &event) {
 						last_click_map_y = tmp;
 					}
 
-					int numtiles = 0;
-					int threadcount = std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
-
-					int start_x = 0, start_y = 0, start_z = 0;
-					int end_x = 0, end_y = 0, end_z = 0;
-
-					switch (g_settings.getInteger(Config::SELECTION_TYPE)) {
-						case SELECT_CURRENT_FLOOR: {
-							start_z = end_z = floor;
-							start_x = last_click_map_x;
-							start_y = last_click_map_y;
-							end_x = mouse_map_x;
-							end_y = mouse_map_y;
-							break;
-						}
-						case SELECT_ALL_FLOORS: {
-							start_x = last_click_map_x;
-							start_y = last_click_map_y;
-							start_z = rme::MapMaxLayer;
-							end_x = mouse_map_x;
-							end_y = mouse_map_y;
-							end_z = floor;
-
-							if (g_settings.getInteger(Config::COMPENSATED_SELECT)) {
-								start_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-								start_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-
-								end_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-								end_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-							}
-
-							numtiles = (start_z - end_z) * (end_x - start_x) * (end_y - start_y);
-							break;
-						}
-						case SELECT_VISIBLE_FLOORS: {
-							start_x = last_click_map_x;
-							start_y = last_click_map_y;
-							if (floor < 8) {
-								start_z = rme::MapGroundLayer;
-							} else {
-								start_z = std::min(rme::MapMaxLayer, floor + 2);
-							}
-							end_x = mouse_map_x;
-							end_y = mouse_map_y;
-							end_z = floor;
-
-							if (g_settings.getInteger(Config::COMPENSATED_SELECT)) {
-								start_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-								start_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-
-								end_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-								end_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-							}
-							break;
-						}
-					}
-
-					if (numtiles < 500) {
-						// No point in threading for such a small set.
-						threadcount = 1;
-					}
-					// Subdivide the selection area
-					// We know it's a square, just split it into several areas
-					int width = end_x - start_x;
-					if (width < threadcount) {
-						threadcount = std::min(1, width);
-					}
-					// Let's divide!
-					int remainder = width;
-					int cleared = 0;
-					std::vector<SelectionThread*> threads;
-					if (width == 0) {
-						threads.push_back(newd SelectionThread(editor, Position(start_x, start_y, start_z), Position(start_x, end_y, end_z)));
-					} else {
-						for (int i = 0; i < threadcount; ++i) {
-							int chunksize = width / threadcount;
-							// The last threads takes all the remainder
-							if (i == threadcount - 1) {
-								chunksize = remainder;
-							}
-							threads.push_back(newd SelectionThread(editor, Position(start_x + cleared, start_y, start_z), Position(start_x + cleared + chunksize, end_y, end_z)));
-							cleared += chunksize;
-							remainder -= chunksize;
-						}
-					}
-					ASSERT(cleared == width);
-					ASSERT(remainder == 0);
-
 					selection.start(); // Start a selection session
-					for (SelectionThread* thread : threads) {
-						thread->Execute();
-					}
-					for (SelectionThread* thread : threads) {
-						selection.join(thread);
-					}
+					selection.add(getBoundboxArea(last_click_map_x, last_click_map_y, mouse_map_x, mouse_map_y));
 					selection.finish(); // Finish the selection session
 					selection.updateSelectionCount();
 				}
@@ -1500,100 +1407,7 @@ void MapCanvas::OnMousePropertiesRelease(wxMouseEvent &event) {
 			}
 
 			selection.start(); // Start a selection session
-			switch (g_settings.getInteger(Config::SELECTION_TYPE)) {
-				case SELECT_CURRENT_FLOOR: {
-					for (int x = last_click_map_x; x <= mouse_map_x; x++) {
-						for (int y = last_click_map_y; y <= mouse_map_y; y++) {
-							Tile* tile = editor.getMap().getTile(x, y, floor);
-							if (!tile) {
-								continue;
-							}
-							selection.add(tile);
-						}
-					}
-					break;
-				}
-				case SELECT_ALL_FLOORS: {
-					int start_x, start_y, start_z;
-					int end_x, end_y, end_z;
-
-					start_x = last_click_map_x;
-					start_y = last_click_map_y;
-					start_z = rme::MapMaxLayer;
-					end_x = mouse_map_x;
-					end_y = mouse_map_y;
-					end_z = floor;
-
-					if (g_settings.getInteger(Config::COMPENSATED_SELECT)) {
-						start_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-						start_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-
-						end_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-						end_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-					}
-
-					for (int z = start_z; z >= end_z; z--) {
-						for (int x = start_x; x <= end_x; x++) {
-							for (int y = start_y; y <= end_y; y++) {
-								Tile* tile = editor.getMap().getTile(x, y, z);
-								if (!tile) {
-									continue;
-								}
-								selection.add(tile);
-							}
-						}
-						if (z <= rme::MapGroundLayer && g_settings.getInteger(Config::COMPENSATED_SELECT)) {
-							start_x++;
-							start_y++;
-							end_x++;
-							end_y++;
-						}
-					}
-					break;
-				}
-				case SELECT_VISIBLE_FLOORS: {
-					int start_x, start_y, start_z;
-					int end_x, end_y, end_z;
-
-					start_x = last_click_map_x;
-					start_y = last_click_map_y;
-					if (floor < 8) {
-						start_z = rme::MapGroundLayer;
-					} else {
-						start_z = std::min(rme::MapMaxLayer, floor + 2);
-					}
-					end_x = mouse_map_x;
-					end_y = mouse_map_y;
-					end_z = floor;
-
-					if (g_settings.getInteger(Config::COMPENSATED_SELECT)) {
-						start_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-						start_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-
-						end_x -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-						end_y -= (floor < rme::MapGroundLayer ? rme::MapGroundLayer - floor : 0);
-					}
-
-					for (int z = start_z; z >= end_z; z--) {
-						for (int x = start_x; x <= end_x; x++) {
-							for (int y = start_y; y <= end_y; y++) {
-								Tile* tile = editor.getMap().getTile(x, y, z);
-								if (!tile) {
-									continue;
-								}
-								selection.add(tile);
-							}
-						}
-						if (z <= rme::MapGroundLayer && g_settings.getInteger(Config::COMPENSATED_SELECT)) {
-							start_x++;
-							start_y++;
-							end_x++;
-							end_y++;
-						}
-					}
-					break;
-				}
-			}
+			selection.add(getBoundboxArea(last_click_map_x, last_click_map_y, mouse_map_x, mouse_map_y));
 			selection.finish(); // Finish the selection session
 			selection.updateSelectionCount();
 		}
@@ -2769,6 +2583,38 @@ void MapCanvas::getTilesToDraw(int mouse_map_x, int mouse_map_y, int floor, Posi
 	}
 }
 
+SelectionArea MapCanvas::getBoundboxArea(int start_x, int start_y, int end_x, int end_y) const {
+	const int selection_type = g_settings.getInteger(Config::SELECTION_TYPE);
+	int start_z = floor;
+	if (selection_type == SELECT_ALL_FLOORS) {
+		start_z = rme::MapMaxLayer;
+	} else if (selection_type == SELECT_VISIBLE_FLOORS) {
+		start_z = floor < 8 ? rme::MapGroundLayer : std::min(rme::MapMaxLayer, floor + 2);
+	}
+
+	// Floors above the ground are drawn shifted, compensate so the box covers what is seen
+	const bool compensated = selection_type != SELECT_CURRENT_FLOOR && g_settings.getInteger(Config::COMPENSATED_SELECT);
+	if (compensated && floor < rme::MapGroundLayer) {
+		const int offset = rme::MapGroundLayer - floor;
+		start_x -= offset;
+		start_y -= offset;
+		end_x -= offset;
+		end_y -= offset;
+	}
+
+	SelectionArea area;
+	for (int z = start_z; z >= floor; --z) {
+		area.add({ start_x, start_y, end_x, end_y, z });
+		if (compensated && z <= rme::MapGroundLayer) {
+			++start_x;
+			++start_y;
+			++end_x;
+			++end_y;
+		}
+	}
+	return area;
+}
+
 bool MapCanvas::floodFill(Map* map, const Position &center, int x, int y, GroundBrush* brush, PositionVector* positions) {
 	if (x < 0 || y < 0 || x > BLOCK_SIZE || y > BLOCK_SIZE) {
 		return false;
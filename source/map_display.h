@@ -131,6 +131,8 @@ public:
 protected:
 	void getTilesToDraw(int mouse_map_x, int mouse_map_y, int floor, PositionVector* tilestodraw, PositionVector* tilestoborder, bool fill = false);
 	bool floodFill(Map* map, const Position &center, int x, int y, GroundBrush* brush, PositionVector* positions);
+	// Tiles of a boundbox between the two corners, on the floors of the selection type
+	SelectionArea getBoundboxArea(int start_x, int start_y, int end_x, int end_y) const;
 
 private:
 	enum {
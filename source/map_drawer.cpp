@@ -1484,18 +1484,22 @@ void MapDrawer::DrawTile(TileLocation* location) {
 				r = int(r * factor[idx]);
 			}
 
-			if (options.show_spawns_monster && location->getSpawnMonsterCount() > 0) {
+			// Maps without spawns of a kind skip its lookup for every tile
+			const Map &map = canvas->editor.getMap();
+			const size_t spawn_monster_count = options.show_spawns_monster && map.hasSpawnMonsterAreas() ? map.getSpawnMonsterCount(position) : 0;
+			if (spawn_monster_count > 0) {
 				float f = 1.0f;
-				for (uint32_t i = 0; i < location->getSpawnMonsterCount(); ++i) {
+				for (size_t i = 0; i < spawn_monster_count; ++i) {
 					f *= 0.7f;
 				}
 				g = uint8_t(g * f);
 				b = uint8_t(b * f);
 			}
 
-			if (options.show_spawns_npc && location->getSpawnNpcCount() > 0) {
+			const size_t spawn_npc_count = options.show_spawns_npc && map.hasSpawnNpcAreas() ? map.getSpawnNpcCount(position) : 0;
+			if (spawn_npc_count > 0) {
 				float f = 1.0f;
-				for (uint32_t i = 0; i < location->getSpawnNpcCount(); ++i) {
+				for (size_t i = 0; i < spawn_npc_count; ++i) {
 					f *= 0.7f;
 				}
 				g = uint8_t(g * f);
@@ -0,0 +1,415 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "map_image_renderer.h"
+#include "map.h"
+#include "tile.h"
+#include "item.h"
+#include "items.h"
+#include "graphics.h"
+#include "gui.h"
+#include "settings.h"
+#include "threads.h"
+
+#include <fstream>
+#include <limits>
+#include <zlib.h>
+
+namespace {
+	// Sprites are drawn up and left of their tile, by their size and elevation, so tiles
+	// this far below or right of a strip can still reach into it
+	constexpr int RenderTileMargin = 3;
+	// Upper bound for the pixels of one strip
+	constexpr size_t RenderStripMemory = 64 * 1024 * 1024;
+	constexpr int RenderMaxStripTiles = 32;
+
+	void writeU32(std::ofstream &stream, uint32_t value) {
+		const uint8_t bytes[4] = { uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value) };
+		stream.write(reinterpret_cast<const char*>(bytes), 4);
+	}
+
+	void writeChunk(std::ofstream &stream, const char* type, const uint8_t* data, size_t size) {
+		writeU32(stream, static_cast<uint32_t>(size));
+		stream.write(type, 4);
+		if (size != 0) {
+			stream.write(reinterpret_cast<const char*>(data), size);
+		}
+		uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+		if (size != 0) {
+			// crc32 returns its initial value for a null buffer
+			crc = crc32(crc, data, static_cast<uInt>(size));
+		}
+		writeU32(stream, static_cast<uint32_t>(crc));
+	}
+
+	// Raw deflate of one strip. Strips end on a sync flush, so the compressed strips can be
+	// concatenated into a single zlib stream, the last one finishes it.
+	bool deflateStrip(const std::vector<uint8_t> &input, bool last, std::vector<uint8_t> &output) {
+		z_stream stream {};
+		if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+			return false;
+		}
+
+		output.resize(deflateBound(&stream, input.size()) + 64);
+		stream.next_in = const_cast<Bytef*>(input.data());
+		stream.avail_in = static_cast<uInt>(input.size());
+
+		int ret;
+		do {
+			if (stream.total_out == output.size()) {
+				output.resize(output.size() * 2);
+			}
+			stream.next_out = output.data() + stream.total_out;
+			stream.avail_out = static_cast<uInt>(output.size() - stream.total_out);
+			ret = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+		} while (ret == Z_OK && stream.avail_out == 0);
+
+		output.resize(stream.total_out);
+		deflateEnd(&stream);
+		return last ? ret == Z_STREAM_END : ret == Z_OK;
+	}
+} // namespace
+
+MapImageRenderer::MapImageRenderer(Map &map, bool updateLoadbar) :
+	map(map),
+	updateLoadbar(updateLoadbar) {
+	////
+}
+
+bool MapImageRenderer::getFloorBounds(Map &map, int floor, Position &from, Position &to) {
+	using Bounds = std::pair<Position, Position>;
+	const Bounds empty(Position(rme::MapMaxWidth, rme::MapMaxHeight, floor), Position(0, 0, floor));
+	std::vector<Bounds> bounds = collect_PartitionsOnMap(map, empty, [floor](const MapPartition &partition, Bounds &bound) {
+		partition.forEachTile([&bound, floor](Tile* tile) {
+			const Position &position = tile->getPosition();
+			if (position.z != floor) {
+				return;
+			}
+			bound.first.x = std::min(bound.first.x, position.x);
+			bound.first.y = std::min(bound.first.y, position.y);
+			bound.second.x = std::max(bound.second.x, position.x);
+			bound.second.y = std::max(bound.second.y, position.y);
+		});
+	});
+
+	from = empty.first;
+	to = empty.second;
+	for (const Bounds &bound : bounds) {
+		from.x = std::min(from.x, bound.first.x);
+		from.y = std::min(from.y, bound.first.y);
+		to.x = std::max(to.x, bound.second.x);
+		to.y = std::max(to.y, bound.second.y);
+	}
+	return from.x <= to.x && from.y <= to.y;
+}
+
+bool MapImageRenderer::render(const Position &from, const Position &to, const std::string &filename) {
+	const int columns = to.x - from.x + 1;
+	const int rows = to.y - from.y + 1;
+	if (columns <= 0 || rows <= 0) {
+		error = "The area to render is empty.";
+		return false;
+	}
+
+	const size_t width = static_cast<size_t>(columns) * rme::TileSize;
+	const size_t height = static_cast<size_t>(rows) * rme::TileSize;
+	// Every row starts with its PNG filter type
+	const size_t stride = 1 + width * 4;
+	if (width > 0x7FFFFFFF || height > 0x7FFFFFFF || stride > std::numeric_limits<uInt>::max() / rme::TileSize) {
+		error = "The area to render is too large.";
+		return false;
+	}
+
+	std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+	if (!stream.is_open()) {
+		error = "Unable to open " + filename + " for writing.";
+		return false;
+	}
+
+	constexpr uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	stream.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	uint8_t header[13];
+	for (int i = 0; i < 4; ++i) {
+		header[i] = uint8_t(width >> (24 - i * 8));
+		header[4 + i] = uint8_t(height >> (24 - i * 8));
+	}
+	header[8] = 8; // bit depth
+	header[9] = 6; // RGBA
+	header[10] = 0; // deflate
+	header[11] = 0; // adaptive filtering
+	header[12] = 0; // no interlace
+	writeChunk(stream, "IHDR", header, sizeof(header));
+
+	constexpr uint8_t zlibHeader[2] = { 0x78, 0x9C };
+	writeChunk(stream, "IDAT", zlibHeader, sizeof(zlibHeader));
+
+	const int stripTiles = static_cast<int>(std::clamp<size_t>(RenderStripMemory / (stride * rme::TileSize), 1, RenderMaxStripTiles));
+	const int stripCount = (rows + stripTiles - 1) / stripTiles;
+	const size_t threadCount = std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+
+	struct Strip {
+		int firstRow;
+		int lastRow;
+		std::vector<DrawCommand> commands;
+		std::vector<uint8_t> compressed;
+		uLong adler;
+		size_t size;
+		bool ok;
+	};
+
+	uLong adler = adler32(0, nullptr, 0);
+	for (int firstStrip = 0; firstStrip < stripCount; firstStrip += static_cast<int>(threadCount)) {
+		// Sprites are looked up here, the workers only read the pixels gathered for them
+		std::vector<Strip> strips(std::min<size_t>(threadCount, stripCount - firstStrip));
+		for (size_t i = 0; i < strips.size(); ++i) {
+			Strip &strip = strips[i];
+			strip.firstRow = (firstStrip + static_cast<int>(i)) * stripTiles;
+			strip.lastRow = std::min(strip.firstRow + stripTiles, rows) - 1;
+			collectStrip(from, to, strip.firstRow, strip.lastRow, strip.commands);
+		}
+
+		RunParallelJobs(
+			strips.size(), threadCount,
+			[&](size_t index) {
+				Strip &strip = strips[index];
+				const int stripHeight = (strip.lastRow - strip.firstRow + 1) * rme::TileSize;
+				const int offset = strip.firstRow * rme::TileSize;
+
+				std::vector<uint8_t> pixels(stride * stripHeight, 0);
+				for (const DrawCommand &command : strip.commands) {
+					blendSprite(pixels.data() + 1, stride, static_cast<int>(width), stripHeight, command.sprite->pixels->pixels.data(), command.sprite->width, command.sprite->height, command.x, command.y - offset);
+				}
+
+				// Sub filter, each byte minus the same byte of the pixel to its left
+				for (int y = 0; y < stripHeight; ++y) {
+					uint8_t* row = pixels.data() + y * stride;
+					row[0] = 1;
+					for (size_t i = width * 4; i > 4; --i) {
+						row[i] -= row[i - 4];
+					}
+				}
+
+				strip.size = pixels.size();
+				strip.adler = adler32(adler32(0, nullptr, 0), pixels.data(), static_cast<uInt>(pixels.size()));
+				strip.ok = deflateStrip(pixels, strip.lastRow == rows - 1, strip.compressed);
+			},
+			[&](size_t done) {
+				if (updateLoadbar) {
+					g_gui.SetLoadDone(static_cast<int32_t>(std::min<size_t>(99, 100 * (firstStrip + done) / stripCount)));
+				}
+			}
+		);
+
+		for (Strip &strip : strips) {
+			if (!strip.ok) {
+				error = "Failed to compress the image.";
+				return false;
+			}
+			writeChunk(stream, "IDAT", strip.compressed.data(), strip.compressed.size());
+			adler = adler32_combine(adler, strip.adler, static_cast<z_off_t>(strip.size));
+		}
+	}
+
+	uint8_t trailer[4];
+	for (int i = 0; i < 4; ++i) {
+		trailer[i] = uint8_t(adler >> (24 - i * 8));
+	}
+	writeChunk(stream, "IDAT", trailer, sizeof(trailer));
+	writeChunk(stream, "IEND", nullptr, 0);
+
+	sprites.clear();
+
+	if (!stream.good()) {
+		error = "Failed to write " + filename + ".";
+		return false;
+	}
+	return true;
+}
+
+void MapImageRenderer::collectStrip(const Position &from, const Position &to, int firstRow, int lastRow, std::vector<DrawCommand> &commands) {
+	const int min_x = from.x;
+	const int max_x = std::min(to.x + RenderTileMargin, rme::MapMaxWidth);
+	const int min_y = from.y + firstRow;
+	const int max_y = std::min(from.y + lastRow + RenderTileMargin, rme::MapMaxHeight);
+	const int z = from.z;
+
+	const int top = firstRow * rme::TileSize;
+	const int bottom = (lastRow + 1) * rme::TileSize;
+	const int right = (to.x - from.x + 1) * rme::TileSize;
+
+	// Same order as the map drawer, leaf by leaf with columns outside
+	for (int nd_x = min_x & ~3; nd_x <= max_x; nd_x += 4) {
+		for (int nd_y = min_y & ~3; nd_y <= max_y; nd_y += 4) {
+			QTreeNode* leaf = map.getLeaf(nd_x, nd_y);
+			if (!leaf) {
+				continue;
+			}
+
+			for (int map_x = 0; map_x < 4; ++map_x) {
+				for (int map_y = 0; map_y < 4; ++map_y) {
+					const int x = nd_x + map_x;
+					const int y = nd_y + map_y;
+					if (x < min_x || x > max_x || y < min_y || y > max_y) {
+						continue;
+					}
+
+					TileLocation* location = leaf->getTile(map_x, map_y, z);
+					const Tile* tile = location ? location->get() : nullptr;
+					if (!tile) {
+						continue;
+					}
+
+					const size_t first = commands.size();
+					int draw_x = (x - from.x) * rme::TileSize;
+					int draw_y = (y - from.y) * rme::TileSize;
+					if (tile->hasGround()) {
+						collectItem(tile, tile->ground, draw_x, draw_y, commands);
+					}
+					for (const Item* item : tile->items) {
+						collectItem(tile, item, draw_x, draw_y, commands);
+					}
+
+					// Drop the sprites of the margin tiles that don't reach into the strip
+					const auto outside = [&](const DrawCommand &command) {
+						return command.y >= bottom || command.y + command.sprite->height <= top || command.x >= right || command.x + command.sprite->width <= 0;
+					};
+					commands.erase(std::remove_if(commands.begin() + first, commands.end(), outside), commands.end());
+				}
+			}
+		}
+	}
+}
+
+void MapImageRenderer::collectItem(const Tile* tile, const Item* item, int &draw_x, int &draw_y, std::vector<DrawCommand> &commands) {
+	const ItemType &type = g_items.getItemType(item->getID());
+	if (type.id == 0 || type.isMetaItem()) {
+		return;
+	}
+
+	GameSprite* sprite = type.sprite;
+	if (!sprite) {
+		return;
+	}
+
+	const int screenx = draw_x - sprite->getDrawOffset().x;
+	const int screeny = draw_y - sprite->getDrawOffset().y;
+
+	// Set the new drawing height accordingly
+	draw_x -= sprite->getDrawHeight();
+	draw_y -= sprite->getDrawHeight();
+
+	const Position &pos = tile->getPosition();
+
+	int subtype = -1;
+
+	int pattern_x = pos.x % sprite->pattern_x;
+	int pattern_y = pos.y % sprite->pattern_y;
+	int pattern_z = pos.z % sprite->pattern_z;
+
+	if (type.isSplash() || type.isFluidContainer()) {
+		subtype = Item::liquidSubTypeToSpriteSubType(item->getSubtype());
+	} else if (type.isHangable) {
+		if (tile->hasProperty(HOOK_SOUTH)) {
+			pattern_x = 1;
+		} else if (tile->hasProperty(HOOK_EAST)) {
+			pattern_x = 2;
+		} else {
+			pattern_x = 0;
+		}
+	} else if (type.stackable) {
+		if (item->getSubtype() <= 1) {
+			subtype = 0;
+		} else if (item->getSubtype() <= 2) {
+			subtype = 1;
+		} else if (item->getSubtype() <= 3) {
+			subtype = 2;
+		} else if (item->getSubtype() <= 4) {
+			subtype = 3;
+		} else if (item->getSubtype() < 10) {
+			subtype = 4;
+		} else if (item->getSubtype() < 25) {
+			subtype = 5;
+		} else if (item->getSubtype() < 50) {
+			subtype = 6;
+		} else {
+			subtype = 7;
+		}
+	}
+
+	// Animations always show their first frame, so renders of the same map are identical
+	if (const RenderSprite* pixels = getSprite(sprite->getSpriteID(0, subtype, pattern_x, pattern_y, pattern_z, 0))) {
+		commands.push_back({ screenx, screeny, pixels });
+	}
+}
+
+const MapImageRenderer::RenderSprite* MapImageRenderer::getSprite(uint32_t spriteId) {
+	if (spriteId == 0) {
+		return nullptr;
+	}
+
+	auto it = sprites.find(spriteId);
+	if (it == sprites.end()) {
+		// Missing sprites are remembered too, so they are only looked up once
+		RenderSprite &sprite = sprites[spriteId];
+		if (SpriteSheetPtr sheet = g_spriteAppearances.getSheetBySpriteId(spriteId)) {
+			sprite.pixels = g_spriteAppearances.loadSprite(spriteId);
+			sprite.width = sheet->getSpriteSize().width;
+			sprite.height = sheet->getSpriteSize().height;
+		}
+		return sprite.pixels ? &sprite : nullptr;
+	}
+	return it->second.pixels ? &it->second : nullptr;
+}
+
+void MapImageRenderer::blendSprite(uint8_t* image, size_t stride, int width, int height, const uint8_t* sprite, int spriteWidth, int spriteHeight, int x, int y) noexcept {
+	const int first_x = std::max(0, -x);
+	const int last_x = std::min(spriteWidth, width - x);
+	if (first_x >= last_x) {
+		return;
+	}
+
+	for (int sprite_y = std::max(0, -y); sprite_y < spriteHeight && y + sprite_y < height; ++sprite_y) {
+		const uint8_t* source = sprite + (sprite_y * spriteWidth + first_x) * 4;
+		uint8_t* target = image + (y + sprite_y) * stride + (x + first_x) * 4;
+		for (int sprite_x = first_x; sprite_x < last_x; ++sprite_x, source += 4, target += 4) {
+			// Sprites are BGRA, the image is RGBA
+			const int alpha = source[3];
+			if (alpha == 0) {
+				continue;
+			}
+
+			const int under = target[3] * (255 - alpha);
+			if (alpha == 255 || under == 0) {
+				target[0] = source[2];
+				target[1] = source[1];
+				target[2] = source[0];
+				target[3] = static_cast<uint8_t>(alpha);
+				continue;
+			}
+
+			// Straight alpha "over", the weights are scaled by 255
+			const int total = alpha * 255 + under;
+			target[0] = static_cast<uint8_t>((source[2] * alpha * 255 + target[0] * under) / total);
+			target[1] = static_cast<uint8_t>((source[1] * alpha * 255 + target[1] * under) / total);
+			target[2] = static_cast<uint8_t>((source[0] * alpha * 255 + target[2] * under) / total);
+			target[3] = static_cast<uint8_t>((total + 127) / 255);
+		}
+	}
+}
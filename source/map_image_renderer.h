@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_IMAGE_RENDERER_H_
+#define RME_MAP_IMAGE_RENDERER_H_
+
+#include "position.h"
+#include "sprite_appearances.h"
+
+#include <unordered_map>
+
+class Map;
+class Tile;
+class Item;
+
+// Renders an area of one floor into a PNG file at full sprite resolution, without OpenGL.
+// The image is produced in horizontal strips: the calling thread gathers the sprites of
+// each strip, since it owns the sprite data, the worker threads composite and compress
+// them, and the strips are appended to the file in order. Only a few strips are ever
+// held in memory, so the area can be as large as the whole floor.
+class MapImageRenderer {
+public:
+	MapImageRenderer(Map &map, bool updateLoadbar);
+
+	// Renders the inclusive area between from and to, on floor from.z
+	bool render(const Position &from, const Position &to, const std::string &filename);
+
+	const std::string &getError() const noexcept {
+		return error;
+	}
+
+	// Smallest area holding every tile of the floor, false if the floor has no tile
+	static bool getFloorBounds(Map &map, int floor, Position &from, Position &to);
+
+	// Draws a BGRA sprite over an RGBA image at (x, y), clipped to the image.
+	// Rows of the image start every 'stride' bytes.
+	static void blendSprite(uint8_t* image, size_t stride, int width, int height, const uint8_t* sprite, int spriteWidth, int spriteHeight, int x, int y) noexcept;
+
+protected:
+	struct RenderSprite {
+		SpritePtr pixels;
+		// Sprites::size has its sides swapped, the sheet layout is used instead
+		int width = 0;
+		int height = 0;
+	};
+
+	struct DrawCommand {
+		// Top left corner of the sprite, in pixels from the top left of the image
+		int x;
+		int y;
+		const RenderSprite* sprite;
+	};
+
+	void collectStrip(const Position &from, const Position &to, int firstRow, int lastRow, std::vector<DrawCommand> &commands);
+	void collectItem(const Tile* tile, const Item* item, int &draw_x, int &draw_y, std::vector<DrawCommand> &commands);
+	const RenderSprite* getSprite(uint32_t spriteId);
+
+	Map &map;
+	bool updateLoadbar;
+	std::unordered_map<uint32_t, RenderSprite> sprites;
+	std::string error;
+};
+
+#endif
@@ -27,8 +27,6 @@
 TileLocation::TileLocation() :
 	tile(nullptr),
 	position(0, 0, 0),
-	spawn_monster_count(0),
-	spawn_npc_count(0),
 	waypoint_count(0),
 	house_exits(nullptr) {
 	////
@@ -43,7 +41,7 @@ int TileLocation::size() const {
 	if (tile) {
 		return tile->size();
 	}
-	return spawn_monster_count + spawn_npc_count + waypoint_count + (house_exits ? 1 : 0);
+	return waypoint_count + (house_exits ? 1 : 0);
 }
 
 bool TileLocation::empty() const {
@@ -245,8 +243,10 @@ Tile* QTreeNode::setTile(int x, int y, int z, Tile* newtile) {
 
 	if (newtile && !oldtile) {
 		++map.tilecount;
+		++map.floor_tilecount[z];
 	} else if (oldtile && !newtile) {
 		--map.tilecount;
+		--map.floor_tilecount[z];
 	}
 
 	return oldtile;
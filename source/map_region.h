@@ -37,8 +37,6 @@ public:
 protected:
 	Tile* tile;
 	Position position;
-	size_t spawn_monster_count;
-	size_t spawn_npc_count;
 	size_t waypoint_count;
 	HouseExitList* house_exits; // Any house exits pointing here
 
@@ -68,26 +66,6 @@ public:
 		return position.z;
 	}
 
-	size_t getSpawnMonsterCount() const noexcept {
-		return spawn_monster_count;
-	}
-	void increaseSpawnCount() noexcept {
-		spawn_monster_count++;
-	}
-	void decreaseSpawnMonsterCount() noexcept {
-		spawn_monster_count--;
-	}
-
-	size_t getSpawnNpcCount() const noexcept {
-		return spawn_npc_count;
-	}
-	void increaseSpawnNpcCount() noexcept {
-		spawn_npc_count++;
-	}
-	void decreaseSpawnNpcCount() noexcept {
-		spawn_npc_count--;
-	}
-
 	size_t getWaypointCount() const noexcept {
 		return waypoint_count;
 	}
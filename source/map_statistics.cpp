@@ -0,0 +1,162 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "map_statistics.h"
+#include "map.h"
+#include "tile.h"
+#include "item.h"
+#include "items.h"
+#include "complexitem.h"
+
+void MapStatistics::invalidate() {
+	*this = MapStatistics();
+}
+
+void MapStatistics::rebuild(Map &map) {
+	std::vector<MapStatistics> partials = collect_PartitionsOnMap(map, MapStatistics(), [](const MapPartition &partition, MapStatistics &partial) {
+		partition.forEachTile([&partial](Tile* tile) {
+			partial.updateTile(tile, 1);
+		});
+	});
+
+	invalidate();
+	for (MapStatistics &partial : partials) {
+		merge(std::move(partial));
+	}
+	valid = true;
+}
+
+void MapStatistics::addTile(Tile* tile) {
+	if (valid && tile) {
+		updateTile(tile, 1);
+	}
+}
+
+void MapStatistics::removeTile(Tile* tile) {
+	if (valid && tile) {
+		updateTile(tile, -1);
+	}
+}
+
+uint64_t MapStatistics::getItemCount(uint16_t id) const {
+	auto it = item_counts.find(id);
+	return it != item_counts.end() ? std::max<int64_t>(it->second, 0) : 0;
+}
+
+bool MapStatistics::updateItem(Item* item, int64_t delta) {
+	item_count += delta;
+	if (item->isGroundTile() || item->isBorder()) {
+		return false;
+	}
+
+	const ItemType &it = g_items.getItemType(item->getID());
+	if (it.moveable) {
+		loose_item_count += delta;
+	}
+	if (it.isDepot()) {
+		depot_count += delta;
+	}
+	if (item->getActionID() > 0) {
+		action_item_count += delta;
+	}
+	if (item->getUniqueID() > 0) {
+		unique_item_count += delta;
+	}
+	if (Container* c = dynamic_cast<Container*>(item)) {
+		if (c->getVector().size()) {
+			container_count += delta;
+		}
+	}
+	return true;
+}
+
+void MapStatistics::updateTile(Tile* tile, int64_t delta) {
+	foreach_ItemOnTile(tile, [&](Item* item) {
+		auto it = item_counts.try_emplace(item->getID(), 0).first;
+		it->second += delta;
+		if (it->second == 0) {
+			item_counts.erase(it);
+		}
+	});
+
+	if (tile->empty()) {
+		return;
+	}
+
+	tile_count += delta;
+
+	bool is_detailed = false;
+	if (tile->ground) {
+		is_detailed |= updateItem(tile->ground, delta);
+	}
+
+	for (Item* item : tile->items) {
+		is_detailed |= updateItem(item, delta);
+	}
+
+	if (tile->spawnMonster) {
+		spawn_monster_count += delta;
+	}
+
+	if (tile->spawnNpc) {
+		spawn_npc_count += delta;
+	}
+
+	monster_count += delta * static_cast<int64_t>(tile->monsters.size());
+
+	if (tile->npc) {
+		npc_count += delta;
+	}
+
+	if (tile->isBlocking()) {
+		blocking_tile_count += delta;
+	} else {
+		walkable_tile_count += delta;
+	}
+
+	if (is_detailed) {
+		detailed_tile_count += delta;
+	}
+}
+
+void MapStatistics::merge(MapStatistics &&other) {
+	tile_count += other.tile_count;
+	detailed_tile_count += other.detailed_tile_count;
+	blocking_tile_count += other.blocking_tile_count;
+	walkable_tile_count += other.walkable_tile_count;
+	spawn_monster_count += other.spawn_monster_count;
+	spawn_npc_count += other.spawn_npc_count;
+	monster_count += other.monster_count;
+	npc_count += other.npc_count;
+	item_count += other.item_count;
+	loose_item_count += other.loose_item_count;
+	depot_count += other.depot_count;
+	action_item_count += other.action_item_count;
+	unique_item_count += other.unique_item_count;
+	container_count += other.container_count;
+
+	if (item_counts.empty()) {
+		item_counts = std::move(other.item_counts);
+	} else {
+		for (const auto &[id, count] : other.item_counts) {
+			item_counts[id] += count;
+		}
+	}
+	other.invalidate();
+}
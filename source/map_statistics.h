@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MAP_STATISTICS_H_
+#define RME_MAP_STATISTICS_H_
+
+#include <unordered_map>
+
+class Map;
+class Tile;
+class Item;
+
+// Counters over the contents of the map, kept up to date as tiles are swapped in and out
+// Tile and item counters only look at non-empty tiles and at the ground and top level
+// items, item_counts has the occurrences of every item id including container contents.
+class MapStatistics {
+public:
+	// An invalid instance ignores updates, it has to be rebuilt before it can be used
+	bool isValid() const noexcept {
+		return valid;
+	}
+	void invalidate();
+	// Walks the whole map on the worker threads and recounts everything
+	void rebuild(Map &map);
+
+	void addTile(Tile* tile);
+	void removeTile(Tile* tile);
+
+	uint64_t getItemCount(uint16_t id) const;
+
+	// Adds the counters of another instance to this one
+	void merge(MapStatistics &&other);
+
+	int64_t tile_count = 0;
+	int64_t detailed_tile_count = 0;
+	int64_t blocking_tile_count = 0;
+	int64_t walkable_tile_count = 0;
+	int64_t spawn_monster_count = 0;
+	int64_t spawn_npc_count = 0;
+	int64_t monster_count = 0;
+	int64_t npc_count = 0;
+
+	int64_t item_count = 0;
+	int64_t loose_item_count = 0;
+	int64_t depot_count = 0;
+	int64_t action_item_count = 0;
+	int64_t unique_item_count = 0;
+	int64_t container_count = 0; // Only includes containers containing more than 1 item
+
+	std::unordered_map<uint16_t, int64_t> item_counts;
+
+protected:
+	void updateTile(Tile* tile, int64_t delta);
+	// Returns true if the item counts as detail
+	bool updateItem(Item* item, int64_t delta);
+
+	bool valid = false;
+};
+
+#endif
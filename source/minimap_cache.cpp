@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "main.h"
+
+#include "minimap_cache.h"
+#include "map.h"
+#include "tile.h"
+
+uint64_t MinimapCache::nextVersion = 1;
+
+const MinimapCache::Block &MinimapCache::getBlock(Map &map, int level, int x, int y, int z) {
+	Block &block = blocks[getBlockKey(level, x, y, z)];
+	if (block.dirty) {
+		if (level == 0) {
+			buildTiles(map, block, x, y, z);
+		} else {
+			buildLevel(map, block, level, x, y, z);
+		}
+		block.version = nextVersion++;
+		block.dirty = false;
+	}
+	return block;
+}
+
+void MinimapCache::markDirty(const Position &position) {
+	if (blocks.empty()) {
+		return;
+	}
+
+	for (int level = 0; level <= MaxLevel; ++level) {
+		const int shift = 8 + level;
+		auto it = blocks.find(getBlockKey(level, position.x >> shift, position.y >> shift, position.z));
+		if (it == blocks.end()) {
+			// Blocks are built bottom up, so there can't be any above a missing one
+			break;
+		}
+		it->second.dirty = true;
+	}
+}
+
+void MinimapCache::markDirty(const Tile* tile) {
+	if (tile) {
+		markDirty(tile->getPosition());
+	}
+}
+
+void MinimapCache::invalidate() {
+	blocks.clear();
+}
+
+void MinimapCache::buildTiles(Map &map, Block &block, int x, int y, int z) {
+	block.pixels.clear();
+
+	const Position from(x * BlockSize, y * BlockSize, z);
+	const Position to(from.x + BlockSize - 1, from.y + BlockSize - 1, z);
+	const auto drawFloor = [&](FloorSpan locations) {
+		for (TileLocation &location : locations) {
+			const Tile* tile = location.get();
+			if (!tile) {
+				continue;
+			}
+
+			const uint8_t color = tile->getMiniMapColor();
+			if (color == 0) {
+				continue;
+			}
+
+			if (block.pixels.empty()) {
+				block.pixels.resize(BlockPixels * 4);
+			}
+			const Position &position = location.getPosition();
+			setPixel(block.pixels.data(), position.x - from.x, position.y - from.y, color);
+		}
+	};
+	map.forEachFloor(drawFloor, from, to);
+}
+
+void MinimapCache::buildLevel(Map &map, Block &block, int level, int x, int y, int z) {
+	const uint8_t* sources[4];
+	for (int i = 0; i < 4; ++i) {
+		const Block &source = getBlock(map, level - 1, x * 2 + (i & 1), y * 2 + (i >> 1), z);
+		sources[i] = source.pixels.empty() ? nullptr : source.pixels.data();
+	}
+
+	block.pixels.resize(BlockPixels * 4);
+	if (!downsample(sources, block.pixels.data())) {
+		block.pixels.clear();
+	}
+}
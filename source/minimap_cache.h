@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_MINIMAP_CACHE_H_
+#define RME_MINIMAP_CACHE_H_
+
+#include "position.h"
+
+#include <unordered_map>
+
+class Map;
+class Tile;
+
+// Minimap images of the map, in square RGBA blocks kept per floor.
+// Level 0 has one pixel per tile, every level above halves the resolution of the one below,
+// so any zoom level can be drawn by blitting a handful of blocks.
+// Blocks are only built when they are asked for, edits mark the blocks holding the tile dirty
+// and they are rebuilt the next time they are needed.
+class MinimapCache {
+public:
+	static constexpr int BlockSize = 256;
+	static constexpr int BlockPixels = BlockSize * BlockSize;
+	static constexpr int MaxLevel = 4;
+
+	struct Block {
+		// BlockPixels RGBA values, empty if there is nothing to draw in the block
+		std::vector<uint8_t> pixels;
+		// Changes every time the block is rebuilt, unique across caches
+		uint64_t version = 0;
+		bool dirty = true;
+	};
+
+	// Number of tiles covered by one side of a block at the given level
+	static constexpr int getBlockSpan(int level) noexcept {
+		return BlockSize << level;
+	}
+
+	// Returns the block at (x, y) in block coordinates of the level, building it first if needed
+	const Block &getBlock(Map &map, int level, int x, int y, int z);
+
+	void markDirty(const Position &position);
+	void markDirty(const Tile* tile);
+	// Drops all blocks, use after changing tiles in place
+	void invalidate();
+
+	// The pixel helpers below are defined in minimap_pixels.cpp, they don't need the map
+
+	// Writes the RGBA value of a minimap color, color 0 is fully transparent
+	static void getColor(uint8_t color, uint8_t* rgba) noexcept;
+	// Fills the pixel (x, y) of a block with a minimap color
+	static void setPixel(uint8_t* pixels, int x, int y, uint8_t color) noexcept;
+	// Halves the four blocks of a 2x2 square into one, sources are ordered top left, top right,
+	// bottom left, bottom right and may be nullptr for empty blocks.
+	// Returns false if the result is empty.
+	static bool downsample(const uint8_t* const sources[4], uint8_t* pixels) noexcept;
+
+protected:
+	using BlockKey = uint32_t;
+
+	static BlockKey getBlockKey(int level, int x, int y, int z) noexcept {
+		return (static_cast<uint32_t>(level) << 28) | (static_cast<uint32_t>(z) << 20) | (static_cast<uint32_t>(y) << 10) | static_cast<uint32_t>(x);
+	}
+
+	void buildTiles(Map &map, Block &block, int x, int y, int z);
+	void buildLevel(Map &map, Block &block, int level, int x, int y, int z);
+
+	std::unordered_map<BlockKey, Block> blocks;
+	static uint64_t nextVersion;
+};
+
+#endif
@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "minimap_cache.h"
+
+#include <algorithm>
+
+void MinimapCache::getColor(uint8_t color, uint8_t* rgba) noexcept {
+	// Same palette as colorFromEightBit, without going through wxColor
+	if (color == 0 || color >= 216) {
+		rgba[0] = rgba[1] = rgba[2] = 0;
+		rgba[3] = color == 0 ? 0 : 255;
+		return;
+	}
+	rgba[0] = static_cast<uint8_t>(color / 36 % 6 * 51);
+	rgba[1] = static_cast<uint8_t>(color / 6 % 6 * 51);
+	rgba[2] = static_cast<uint8_t>(color % 6 * 51);
+	rgba[3] = 255;
+}
+
+void MinimapCache::setPixel(uint8_t* pixels, int x, int y, uint8_t color) noexcept {
+	getColor(color, pixels + (y * BlockSize + x) * 4);
+}
+
+bool MinimapCache::downsample(const uint8_t* const sources[4], uint8_t* pixels) noexcept {
+	constexpr int half = BlockSize / 2;
+
+	bool empty = true;
+	for (int i = 0; i < 4; ++i) {
+		const uint8_t* source = sources[i];
+		const int offset_x = (i & 1) * half;
+		const int offset_y = (i >> 1) * half;
+		for (int y = 0; y < half; ++y) {
+			uint8_t* target = pixels + ((offset_y + y) * BlockSize + offset_x) * 4;
+			if (!source) {
+				std::fill(target, target + half * 4, 0);
+				continue;
+			}
+
+			const uint8_t* top = source + (y * 2) * BlockSize * 4;
+			const uint8_t* bottom = top + BlockSize * 4;
+			for (int x = 0; x < half; ++x, top += 8, bottom += 8, target += 4) {
+				const uint8_t* samples[4] = { top, top + 4, bottom, bottom + 4 };
+				// Colors are weighted by coverage, so empty tiles don't darken the average
+				int red = 0, green = 0, blue = 0, alpha = 0;
+				for (const uint8_t* sample : samples) {
+					red += sample[0] * sample[3];
+					green += sample[1] * sample[3];
+					blue += sample[2] * sample[3];
+					alpha += sample[3];
+				}
+
+				if (alpha == 0) {
+					target[0] = target[1] = target[2] = target[3] = 0;
+					continue;
+				}
+
+				target[0] = static_cast<uint8_t>(red / alpha);
+				target[1] = static_cast<uint8_t>(green / alpha);
+				target[2] = static_cast<uint8_t>(blue / alpha);
+				target[3] = static_cast<uint8_t>((alpha + 2) / 4);
+				empty = false;
+			}
+		}
+	}
+	return !empty;
+}
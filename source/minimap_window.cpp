@@ -27,6 +27,7 @@
 
 BEGIN_EVENT_TABLE(MinimapWindow, wxPanel)
 EVT_LEFT_DOWN(MinimapWindow::OnMouseClick)
+EVT_MOUSEWHEEL(MinimapWindow::OnMouseWheel)
 EVT_SIZE(MinimapWindow::OnSize)
 EVT_PAINT(MinimapWindow::OnPaint)
 EVT_ERASE_BACKGROUND(MinimapWindow::OnEraseBackground)
@@ -37,16 +38,14 @@ END_EVENT_TABLE()
 
 MinimapWindow::MinimapWindow(wxWindow* parent) :
 	wxPanel(parent, wxID_ANY, wxDefaultPosition, wxSize(205, 130)),
-	update_timer(this) {
-	for (int i = 0; i < 256; ++i) {
-		pens[i] = new wxPen(colorFromEightBit(i));
-	}
+	update_timer(this),
+	last_start_x(0),
+	last_start_y(0) {
+	////
 }
 
 MinimapWindow::~MinimapWindow() {
-	for (int i = 0; i < 256; ++i) {
-		delete pens[i];
-	}
+	////
 }
 
 void MinimapWindow::OnSize(wxSizeEvent &event) {
@@ -77,11 +76,17 @@ void MinimapWindow::OnPaint(wxPaintEvent &event) {
 		return;
 	}
 	Editor &editor = *g_gui.GetCurrentEditor();
-	const Map &map = editor.getMap();
+	Map &map = editor.getMap();
 
-	int window_width = GetSize().GetWidth();
-	int window_height = GetSize().GetHeight();
-	// printf("W:%d\tH:%d\n", window_width, window_height);
+	if (bitmaps_map != &map) {
+		bitmaps.clear();
+		bitmaps_map = &map;
+	}
+
+	const int scale = 1 << level;
+	// Size of the window in tiles
+	int view_width = GetSize().GetWidth() * scale;
+	int view_height = GetSize().GetHeight() * scale;
 	int center_x, center_y;
 
 	MapCanvas* canvas = g_gui.GetCurrentMapTab()->GetCanvas();
@@ -89,29 +94,30 @@ void MinimapWindow::OnPaint(wxPaintEvent &event) {
 
 	int start_x, start_y;
 	int end_x, end_y;
-	start_x = center_x - window_width / 2;
-	start_y = center_y - window_height / 2;
+	start_x = center_x - view_width / 2;
+	start_y = center_y - view_height / 2;
 
-	end_x = center_x + window_width / 2;
-	end_y = center_y + window_height / 2;
+	end_x = center_x + view_width / 2;
+	end_y = center_y + view_height / 2;
 
 	if (start_x < 0) {
 		start_x = 0;
-		end_x = window_width;
+		end_x = view_width;
 	} else if (end_x > map.getWidth()) {
-		start_x = map.getWidth() - window_width;
+		start_x = map.getWidth() - view_width;
 		end_x = map.getWidth();
 	}
 	if (start_y < 0) {
 		start_y = 0;
-		end_y = window_height;
+		end_y = view_height;
 	} else if (end_y > map.getHeight()) {
-		start_y = map.getHeight() - window_height;
+		start_y = map.getHeight() - view_height;
 		end_y = map.getHeight();
 	}
 
-	start_x = std::max(start_x, 0);
-	start_y = std::max(start_y, 0);
+	// Keep the view on whole pixels of the level, so blocks land on exact window coordinates
+	start_x = std::max(start_x, 0) & ~(scale - 1);
+	start_y = std::max(start_y, 0) & ~(scale - 1);
 	end_x = std::min(end_x, map.getWidth());
 	end_y = std::min(end_y, map.getHeight());
 
@@ -120,27 +126,33 @@ void MinimapWindow::OnPaint(wxPaintEvent &event) {
 
 	int floor = g_gui.GetCurrentFloor();
 
-	// printf("Draw from %d:%d to %d:%d\n", start_x, start_y, end_x, end_y);
-	uint8_t last = 0;
 	if (g_gui.IsRenderingEnabled()) {
-		for (int y = start_y, window_y = 0; y <= end_y; ++y, ++window_y) {
-			for (int x = start_x, window_x = 0; x <= end_x; ++x, ++window_x) {
-				const Tile* tile = map.getTile(x, y, floor);
-				if (tile) {
-					uint8_t color = tile->getMiniMapColor();
-					if (color) {
-						if (last != color) {
-							pdc.SetPen(*pens[color]);
-							last = color;
-						}
-						pdc.DrawPoint(window_x, window_y);
-					}
+		// Whole blocks are blitted, so the cost depends on the window size and not on the tiles in view
+		MinimapCache &cache = map.getMinimapCache();
+		const int span = MinimapCache::getBlockSpan(level);
+		for (int block_y = start_y / span; block_y <= end_y / span; ++block_y) {
+			for (int block_x = start_x / span; block_x <= end_x / span; ++block_x) {
+				const MinimapCache::Block &block = cache.getBlock(map, level, block_x, block_y, floor);
+				if (block.pixels.empty()) {
+					continue;
 				}
+				pdc.DrawBitmap(getBitmap(block, block_x, block_y, floor), (block_x * span - start_x) / scale, (block_y * span - start_y) / scale);
+			}
+		}
+
+		// Bitmaps that went out of view are converted again if they come back
+		for (auto it = bitmaps.begin(); it != bitmaps.end();) {
+			if (it->second.used) {
+				it->second.used = false;
+				++it;
+			} else {
+				it = bitmaps.erase(it);
 			}
 		}
 
 		if (g_settings.getInteger(Config::MINIMAP_VIEW_BOX)) {
 			pdc.SetPen(*wxWHITE_PEN);
+			pdc.SetBrush(*wxTRANSPARENT_BRUSH);
 			// Draw the rectangle on the minimap
 
 			// Some view info
@@ -163,29 +175,58 @@ void MinimapWindow::OnPaint(wxPaintEvent &event) {
 			view_end_x = view_start_x + screensize_x / tile_size + 1;
 			view_end_y = view_start_y + screensize_y / tile_size + 1;
 
-			for (int x = view_start_x; x <= view_end_x; ++x) {
-				pdc.DrawPoint(x - start_x, view_start_y - start_y);
-				pdc.DrawPoint(x - start_x, view_end_y - start_y);
-			}
-			for (int y = view_start_y; y < view_end_y; ++y) {
-				pdc.DrawPoint(view_start_x - start_x, y - start_y);
-				pdc.DrawPoint(view_end_x - start_x, y - start_y);
-			}
+			const int box_x = (view_start_x - start_x) / scale;
+			const int box_y = (view_start_y - start_y) / scale;
+			pdc.DrawRectangle(box_x, box_y, (view_end_x - start_x) / scale - box_x + 1, (view_end_y - start_y) / scale - box_y + 1);
 		}
 	}
 }
 
+const wxBitmap &MinimapWindow::getBitmap(const MinimapCache::Block &block, int x, int y, int z) {
+	const uint64_t key = (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(z) << 40) | (static_cast<uint64_t>(y) << 20) | static_cast<uint64_t>(x);
+	CachedBitmap &cached = bitmaps[key];
+	cached.used = true;
+	if (cached.version == block.version) {
+		return cached.bitmap;
+	}
+
+	wxImage image(MinimapCache::BlockSize, MinimapCache::BlockSize, false);
+	uint8_t* rgb = image.GetData();
+	const uint8_t* rgba = block.pixels.data();
+	for (int i = 0; i < MinimapCache::BlockPixels; ++i, rgb += 3, rgba += 4) {
+		// The minimap is drawn on black, so the alpha can be applied right away
+		rgb[0] = static_cast<uint8_t>(rgba[0] * rgba[3] / 255);
+		rgb[1] = static_cast<uint8_t>(rgba[1] * rgba[3] / 255);
+		rgb[2] = static_cast<uint8_t>(rgba[2] * rgba[3] / 255);
+	}
+
+	cached.bitmap = wxBitmap(image);
+	cached.version = block.version;
+	return cached.bitmap;
+}
+
 void MinimapWindow::OnMouseClick(wxMouseEvent &event) {
 	if (!g_gui.IsEditorOpen()) {
 		return;
 	}
-	int new_map_x = last_start_x + event.GetX();
-	int new_map_y = last_start_y + event.GetY();
+	int new_map_x = last_start_x + (event.GetX() << level);
+	int new_map_y = last_start_y + (event.GetY() << level);
 	g_gui.SetScreenCenterPosition(Position(new_map_x, new_map_y, g_gui.GetCurrentFloor()));
 	Refresh();
 	g_gui.RefreshView();
 }
 
+void MinimapWindow::OnMouseWheel(wxMouseEvent &event) {
+	if (event.GetWheelRotation() == 0) {
+		return;
+	}
+	const int new_level = std::clamp(level + (event.GetWheelRotation() > 0 ? -1 : 1), 0, MinimapCache::MaxLevel);
+	if (new_level != level) {
+		level = new_level;
+		Refresh();
+	}
+}
+
 void MinimapWindow::OnKey(wxKeyEvent &event) {
 	if (g_gui.GetCurrentTab() != nullptr) {
 		g_gui.GetCurrentMapTab()->GetEventHandler()->AddPendingEvent(event);
@@ -18,6 +18,10 @@
 #ifndef RME_MINIMAP_WINDOW_H_
 #define RME_MINIMAP_WINDOW_H_
 
+#include "minimap_cache.h"
+
+#include <unordered_map>
+
 class MinimapWindow : public wxPanel {
 public:
 	MinimapWindow(wxWindow* parent);
@@ -26,6 +30,7 @@ public:
 	void OnPaint(wxPaintEvent &);
 	void OnEraseBackground(wxEraseEvent &) { }
 	void OnMouseClick(wxMouseEvent &);
+	void OnMouseWheel(wxMouseEvent &);
 	void OnSize(wxSizeEvent &);
 	void OnClose(wxCloseEvent &);
 
@@ -34,10 +39,23 @@ public:
 	void OnKey(wxKeyEvent &event);
 
 protected:
-	wxPen* pens[256];
+	struct CachedBitmap {
+		wxBitmap bitmap;
+		uint64_t version = 0;
+		bool used = false;
+	};
+
+	// Returns the bitmap of a minimap block, converting it again if the block was rebuilt
+	const wxBitmap &getBitmap(const MinimapCache::Block &block, int x, int y, int z);
+
 	wxTimer update_timer;
 	int last_start_x;
 	int last_start_y;
+	// Minimap level being drawn, each pixel covers (1 << level) tiles across
+	int level = 0;
+
+	const Map* bitmaps_map = nullptr;
+	std::unordered_map<uint64_t, CachedBitmap> bitmaps;
 
 	DECLARE_EVENT_TABLE()
 };
@@ -23,6 +23,15 @@
 #include "monster.h"
 #include "basemap.h"
 #include "spawn_monster.h"
+#include "map.h"
+
+namespace {
+	// Only the editor map keeps track of spawn areas
+	size_t getMonsterSpawnCount(const BaseMap* map, const Position &position) {
+		const Map* spawnMap = dynamic_cast<const Map*>(map);
+		return spawnMap ? spawnMap->getSpawnMonsterCount(position) : 0;
+	}
+}
 
 //=============================================================================
 // Monster brush
@@ -57,7 +66,7 @@ bool MonsterBrush::canDraw(BaseMap* map, const Position &position) const {
 	}
 
 	if (monster_type && !tile->isBlocking()) {
-		if (tile->getLocation()->getSpawnMonsterCount() != 0 || g_settings.getInteger(Config::AUTO_CREATE_SPAWN_MONSTER)) {
+		if (getMonsterSpawnCount(map, position) != 0 || g_settings.getInteger(Config::AUTO_CREATE_SPAWN_MONSTER)) {
 			if (tile->isPZ()) {
 				return false;
 			} else {
@@ -94,7 +103,7 @@ void MonsterBrush::draw(BaseMap* map, Tile* tile, void* parameter) {
 	ASSERT(parameter);
 	if (tile && canDraw(map, tile->getPosition())) {
 		if (monster_type) {
-			if (tile->spawnMonster == nullptr && tile->getLocation()->getSpawnMonsterCount() == 0) {
+			if (tile->spawnMonster == nullptr && getMonsterSpawnCount(map, tile->getPosition()) == 0) {
 				// manually place spawnMonster on location
 				tile->spawnMonster = newd SpawnMonster(1);
 			}
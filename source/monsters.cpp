@@ -22,11 +22,12 @@
 #include "brush.h"
 #include "monsters.h"
 #include "monster_brush.h"
+#include "lua_scanner.h"
+#include "settings.h"
 
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
-#include <regex>
 #include <unordered_set>
 #include <vector>
 
@@ -94,14 +95,7 @@ namespace {
 	}
 
 	bool extractLuaIntegerField(const std::string &content, const char* fieldName, int &value) {
-		const std::regex pattern("\\b" + std::string(fieldName) + "\\b\\s*=\\s*(-?\\d+)");
-		std::smatch match;
-		if (!std::regex_search(content, match, pattern)) {
-			return false;
-		}
-
-		value = std::stoi(match[1].str());
-		return true;
+		return LuaScanner::findIntegerField(content, fieldName, value);
 	}
 
 	bool hasMonsterNodeByName(const pugi::xml_node &monsterNodes, const std::string &name) {
@@ -274,6 +268,41 @@ namespace {
 
 		return monsterType;
 	}
+
+	bool findServerLuaFiles(const FileName &directory, std::vector<fs::path> &luaFiles, wxString &error) {
+		try {
+			for (const auto &entry : fs::recursive_directory_iterator(fs::path(nstr(directory.GetFullPath())))) {
+				if (entry.is_regular_file() && entry.path().extension() == ".lua") {
+					luaFiles.push_back(entry.path());
+				}
+			}
+		} catch (const std::exception &e) {
+			error = wxString::Format("Failed to scan server data folder: %s", wxString(e.what(), wxConvUTF8));
+			return false;
+		}
+
+		// Directory order depends on the file system, sort so duplicates always resolve the same way
+		std::sort(luaFiles.begin(), luaFiles.end());
+		return true;
+	}
+
+	// Parses the files on the worker threads, returns one entry per file in the same order
+	std::vector<std::unique_ptr<MonsterType>> loadFromServerLua(const std::vector<fs::path> &luaFiles) {
+		std::vector<std::unique_ptr<MonsterType>> monsterTypes(luaFiles.size());
+		RunParallelJobs(
+			luaFiles.size(), std::max(g_settings.getInteger(Config::WORKER_THREADS), 1),
+			[&](size_t index) {
+				monsterTypes[index].reset(loadFromServerLua(luaFiles[index]));
+			},
+			[&](size_t done) {
+				g_gui.SetLoadDone(
+					static_cast<int32_t>(std::min<size_t>(99, 100 * done / luaFiles.size())),
+					wxString::Format("Importing monsters... (%zu/%zu)", done, luaFiles.size())
+				);
+			}
+		);
+		return monsterTypes;
+	}
 } // namespace
 
 MonsterDatabase g_monsters;
@@ -324,7 +353,7 @@ MonsterType* MonsterType::loadFromXML(pugi::xml_node node, wxArrayString &warnin
 
 	if ((attribute = node.attribute("looktype"))) {
 		ct->outfit.lookType = attribute.as_int();
-		if (g_gui.gfx.getCreatureSprite(ct->outfit.lookType) == nullptr) {
+		if (!g_gui.gfx.hasCreatureSprite(ct->outfit.lookType)) {
 			warnings.push_back("Invalid monster \"" + wxstr(ct->name) + "\" look type #" + std::to_string(ct->outfit.lookType));
 		}
 	}
@@ -619,16 +648,24 @@ bool MonsterDatabase::importMissingFromServerLua(const FileName &directory, cons
 		return false;
 	}
 
+	std::vector<fs::path> luaFiles;
+	if (!findServerLuaFiles(directory, luaFiles, error)) {
+		return false;
+	}
+
+	struct LoadBarGuard {
+		~LoadBarGuard() {
+			g_gui.DestroyLoadBar();
+		}
+	} loadBarGuard;
+	g_gui.CreateLoadBar("Importing missing monsters from server...");
+
 	bool xmlChanged = false;
 	int importedCount = 0;
 
+	const std::vector<std::unique_ptr<MonsterType>> parsedMonsters = loadFromServerLua(luaFiles);
 	try {
-		for (const auto &entry : fs::recursive_directory_iterator(fs::path(nstr(directory.GetFullPath())))) {
-			if (!entry.is_regular_file() || entry.path().extension() != ".lua") {
-				continue;
-			}
-
-			std::unique_ptr<MonsterType> parsedMonster(loadFromServerLua(entry.path()));
+		for (const std::unique_ptr<MonsterType> &parsedMonster : parsedMonsters) {
 			if (!parsedMonster) {
 				continue;
 			}
@@ -706,14 +743,7 @@ bool MonsterDatabase::importFromServerLua(const FileName &directory, const FileN
 	int importedCount = 0;
 
 	std::vector<fs::path> luaFiles;
-	try {
-		for (const auto &entry : fs::recursive_directory_iterator(fs::path(nstr(directory.GetFullPath())))) {
-			if (entry.is_regular_file() && entry.path().extension() == ".lua") {
-				luaFiles.push_back(entry.path());
-			}
-		}
-	} catch (const std::exception &e) {
-		error = wxString::Format("Failed to scan server data folder: %s", wxString(e.what(), wxConvUTF8));
+	if (!findServerLuaFiles(directory, luaFiles, error)) {
 		return false;
 	}
 
@@ -724,19 +754,9 @@ bool MonsterDatabase::importFromServerLua(const FileName &directory, const FileN
 	} loadBarGuard;
 	g_gui.CreateLoadBar("Importing monsters from server...");
 
-	const size_t totalFiles = luaFiles.size();
+	std::vector<std::unique_ptr<MonsterType>> parsedMonsters = loadFromServerLua(luaFiles);
 	try {
-		for (size_t fileIndex = 0; fileIndex < totalFiles; ++fileIndex) {
-			const fs::path &filePath = luaFiles[fileIndex];
-
-			if (totalFiles > 0) {
-				g_gui.SetLoadDone(
-					static_cast<int>(100.0 * (fileIndex + 1) / totalFiles),
-					wxString::Format("Importing monsters... (%zu/%zu)", fileIndex + 1, totalFiles)
-				);
-			}
-
-			std::unique_ptr<MonsterType> parsedMonster(loadFromServerLua(filePath));
+		for (std::unique_ptr<MonsterType> &parsedMonster : parsedMonsters) {
 			if (!parsedMonster) {
 				continue;
 			}
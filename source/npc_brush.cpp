@@ -23,6 +23,15 @@
 #include "npc.h"
 #include "basemap.h"
 #include "spawn_npc.h"
+#include "map.h"
+
+namespace {
+	// Only the editor map keeps track of spawn areas
+	size_t getNpcSpawnCount(const BaseMap* map, const Position &position) {
+		const Map* spawnMap = dynamic_cast<const Map*>(map);
+		return spawnMap ? spawnMap->getSpawnNpcCount(position) : 0;
+	}
+}
 
 //=============================================================================
 // Npc brush
@@ -51,7 +60,7 @@ std::string NpcBrush::getName() const {
 bool NpcBrush::canDraw(BaseMap* map, const Position &position) const {
 	Tile* tile = map->getTile(position);
 	if (npc_type && tile && !tile->isBlocking()) {
-		if (tile->getLocation()->getSpawnNpcCount() != 0 || g_settings.getInteger(Config::AUTO_CREATE_SPAWN_NPC)) {
+		if (getNpcSpawnCount(map, position) != 0 || g_settings.getInteger(Config::AUTO_CREATE_SPAWN_NPC)) {
 			if (tile->isPZ()) {
 				return true;
 			} else {
@@ -73,7 +82,7 @@ void NpcBrush::draw(BaseMap* map, Tile* tile, void* parameter) {
 	if (canDraw(map, tile->getPosition())) {
 		undraw(map, tile);
 		if (npc_type) {
-			if (tile->spawnNpc == nullptr && tile->getLocation()->getSpawnNpcCount() == 0) {
+			if (tile->spawnNpc == nullptr && getNpcSpawnCount(map, tile->getPosition()) == 0) {
 				// manually place npc spawn on location
 				tile->spawnNpc = newd SpawnNpc(1);
 			}
@@ -22,11 +22,12 @@
 #include "brush.h"
 #include "npcs.h"
 #include "npc_brush.h"
+#include "lua_scanner.h"
+#include "settings.h"
 
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
-#include <regex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -159,21 +160,19 @@ namespace {
 	}
 
 	void collectLuaStringVariables(const std::string &content, std::unordered_map<std::string, std::string> &variables) {
-		const std::regex localAssignmentPattern(R"(\blocal\s+([A-Za-z_]\w*)\s*=)");
-		for (std::sregex_iterator it(content.begin(), content.end(), localAssignmentPattern), end; it != end; ++it) {
-			size_t pos = it->position() + it->length();
+		for (const auto &[name, pos] : LuaScanner::findLocalAssignments(content)) {
 			std::string value;
 			if (readAssignmentStringValue(content, pos, value)) {
-				variables[(*it)[1].str()] = value;
+				variables[name] = value;
 			}
 		}
 
-		const std::regex namedAssignmentPattern(R"((?:^|[\r\n])\s*(internalNpcName|npcName)\s*=)");
-		for (std::sregex_iterator it(content.begin(), content.end(), namedAssignmentPattern), end; it != end; ++it) {
-			size_t pos = it->position() + it->length();
-			std::string value;
-			if (readAssignmentStringValue(content, pos, value)) {
-				variables[(*it)[1].str()] = value;
+		for (const char* name : { "internalNpcName", "npcName" }) {
+			for (const size_t pos : LuaScanner::findLineAssignments(content, name)) {
+				std::string value;
+				if (readAssignmentStringValue(content, pos, value)) {
+					variables[name] = value;
+				}
 			}
 		}
 	}
@@ -254,10 +253,9 @@ namespace {
 			}
 		}
 		if (configName.empty()) {
-			const std::regex npcConfigNameVarPattern(R"(\bnpcConfig\.name\s*=\s*([A-Za-z_]\w*))");
-			std::smatch nameMatch;
-			if (std::regex_search(content, nameMatch, npcConfigNameVarPattern)) {
-				const auto variableIt = variables.find(nameMatch[1].str());
+			std::string variableName;
+			if (LuaScanner::findAssignedIdentifier(content, "npcConfig.name", variableName)) {
+				const auto variableIt = variables.find(variableName);
 				if (variableIt != variables.end()) {
 					configName = variableIt->second;
 				}
@@ -272,10 +270,9 @@ namespace {
 		}
 
 		if (!extractLuaStringArgument(content, "Game.createNpcType", variables, createTypeName)) {
-			const std::regex createNpcTypeVarPattern(R"(\bGame\.createNpcType\s*\(\s*([A-Za-z_]\w*)\s*\))");
-			std::smatch createMatch;
-			if (std::regex_search(content, createMatch, createNpcTypeVarPattern)) {
-				const auto variableIt = variables.find(createMatch[1].str());
+			std::string variableName;
+			if (LuaScanner::findCalledIdentifier(content, "Game.createNpcType", variableName)) {
+				const auto variableIt = variables.find(variableName);
 				if (variableIt != variables.end()) {
 					createTypeName = variableIt->second;
 				}
@@ -336,14 +333,7 @@ namespace {
 	}
 
 	bool extractLuaIntegerField(const std::string &content, const char* fieldName, int &value) {
-		const std::regex pattern("\\b" + std::string(fieldName) + "\\b\\s*=\\s*(-?\\d+)");
-		std::smatch match;
-		if (!std::regex_search(content, match, pattern)) {
-			return false;
-		}
-
-		value = std::stoi(match[1].str());
-		return true;
+		return LuaScanner::findIntegerField(content, fieldName, value);
 	}
 
 	void ensureXmlUtf8Declaration(pugi::xml_document &doc) {
@@ -509,6 +499,46 @@ namespace {
 
 		return npcType;
 	}
+
+	struct ServerLuaNpc {
+		std::unique_ptr<NpcType> npcType;
+		std::string truncatedAlias;
+	};
+
+	bool findServerLuaFiles(const FileName &directory, std::vector<fs::path> &luaFiles, wxString &error) {
+		try {
+			for (const auto &entry : fs::recursive_directory_iterator(fs::path(nstr(directory.GetFullPath())))) {
+				if (entry.is_regular_file() && entry.path().extension() == ".lua") {
+					luaFiles.push_back(entry.path());
+				}
+			}
+		} catch (const std::exception &e) {
+			error = wxString::Format("Failed to scan server data folder: %s", wxString(e.what(), wxConvUTF8));
+			return false;
+		}
+
+		// Directory order depends on the file system, sort so duplicates always resolve the same way
+		std::sort(luaFiles.begin(), luaFiles.end());
+		return true;
+	}
+
+	// Parses the files on the worker threads, returns one entry per file in the same order
+	std::vector<ServerLuaNpc> loadFromServerLua(const std::vector<fs::path> &luaFiles) {
+		std::vector<ServerLuaNpc> npcs(luaFiles.size());
+		RunParallelJobs(
+			luaFiles.size(), std::max(g_settings.getInteger(Config::WORKER_THREADS), 1),
+			[&](size_t index) {
+				npcs[index].npcType.reset(loadFromServerLua(luaFiles[index], npcs[index].truncatedAlias));
+			},
+			[&](size_t done) {
+				g_gui.SetLoadDone(
+					static_cast<int32_t>(std::min<size_t>(99, 100 * done / luaFiles.size())),
+					wxString::Format("Importing NPCs... (%zu/%zu)", done, luaFiles.size())
+				);
+			}
+		);
+		return npcs;
+	}
 } // namespace
 
 NpcDatabase g_npcs;
@@ -559,7 +589,7 @@ NpcType* NpcType::loadFromXML(pugi::xml_node node, wxArrayString &warnings) {
 
 	if ((attribute = node.attribute("looktype"))) {
 		npcType->outfit.lookType = attribute.as_int();
-		if (g_gui.gfx.getCreatureSprite(npcType->outfit.lookType) == nullptr) {
+		if (!g_gui.gfx.hasCreatureSprite(npcType->outfit.lookType)) {
 			warnings.push_back("Invalid npc \"" + wxstr(npcType->name) + "\" look type #" + std::to_string(npcType->outfit.lookType));
 		}
 	}
@@ -801,17 +831,26 @@ bool NpcDatabase::importMissingFromServerLua(const FileName &directory, const Fi
 		return false;
 	}
 
+	std::vector<fs::path> luaFiles;
+	if (!findServerLuaFiles(directory, luaFiles, error)) {
+		return false;
+	}
+
+	struct LoadBarGuard {
+		~LoadBarGuard() {
+			g_gui.DestroyLoadBar();
+		}
+	} loadBarGuard;
+	g_gui.CreateLoadBar("Importing missing NPCs from server...");
+
 	bool xmlChanged = false;
 	int importedCount = 0;
 
+	std::vector<ServerLuaNpc> parsedNpcs = loadFromServerLua(luaFiles);
 	try {
-		for (const auto &entry : fs::recursive_directory_iterator(fs::path(nstr(directory.GetFullPath())))) {
-			if (!entry.is_regular_file() || entry.path().extension() != ".lua") {
-				continue;
-			}
-
-			std::string truncatedAlias;
-			std::unique_ptr<NpcType> parsedNpc(loadFromServerLua(entry.path(), truncatedAlias));
+		for (ServerLuaNpc &parsed : parsedNpcs) {
+			std::unique_ptr<NpcType> &parsedNpc = parsed.npcType;
+			const std::string &truncatedAlias = parsed.truncatedAlias;
 			if (!parsedNpc) {
 				continue;
 			}
@@ -912,14 +951,7 @@ bool NpcDatabase::importFromServerLua(const FileName &directory, const FileName
 	int importedCount = 0;
 
 	std::vector<fs::path> luaFiles;
-	try {
-		for (const auto &entry : fs::recursive_directory_iterator(fs::path(nstr(directory.GetFullPath())))) {
-			if (entry.is_regular_file() && entry.path().extension() == ".lua") {
-				luaFiles.push_back(entry.path());
-			}
-		}
-	} catch (const std::exception &e) {
-		error = wxString::Format("Failed to scan server data folder: %s", wxString(e.what(), wxConvUTF8));
+	if (!findServerLuaFiles(directory, luaFiles, error)) {
 		return false;
 	}
 
@@ -930,20 +962,11 @@ bool NpcDatabase::importFromServerLua(const FileName &directory, const FileName
 	} loadBarGuard;
 	g_gui.CreateLoadBar("Importing NPCs from server...");
 
-	const size_t totalFiles = luaFiles.size();
+	std::vector<ServerLuaNpc> parsedNpcs = loadFromServerLua(luaFiles);
 	try {
-		for (size_t fileIndex = 0; fileIndex < totalFiles; ++fileIndex) {
-			const fs::path &filePath = luaFiles[fileIndex];
-
-			if (totalFiles > 0) {
-				g_gui.SetLoadDone(
-					static_cast<int>(100.0 * (fileIndex + 1) / totalFiles),
-					wxString::Format("Importing NPCs... (%zu/%zu)", fileIndex + 1, totalFiles)
-				);
-			}
-
-			std::string truncatedAlias;
-			std::unique_ptr<NpcType> parsedNpc(loadFromServerLua(filePath, truncatedAlias));
+		for (ServerLuaNpc &parsed : parsedNpcs) {
+			std::unique_ptr<NpcType> &parsedNpc = parsed.npcType;
+			const std::string &truncatedAlias = parsed.truncatedAlias;
 			if (!parsedNpc) {
 				continue;
 			}
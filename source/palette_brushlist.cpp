@@ -23,6 +23,37 @@
 #include "add_tileset_window.h"
 #include "add_item_window.h"
 #include "materials.h"
+#include "raw_brush.h"
+#include "map.h"
+#include "sprite_appearances.h"
+
+#include <wx/weakref.h>
+
+namespace {
+	// Decodes the sprite sheets behind brushes [begin, end) on worker threads and
+	// repaints the window, and its buttons, each time one of them arrives.
+	void PreloadBrushIcons(wxWindow* window, const TilesetCategory* tileset, size_t begin, size_t end) {
+		std::vector<int> spriteIds;
+		spriteIds.reserve(end - begin);
+		for (size_t index = begin; index < end; ++index) {
+			const auto sprite = dynamic_cast<GameSprite*>(g_gui.gfx.getSprite(tileset->brushlist[index]->getLookID()));
+			if (sprite) {
+				spriteIds.emplace_back(sprite->getSpriteID(0, 0, 0, 0, 0, 0));
+			}
+		}
+
+		wxWeakRef<wxWindow> windowRef(window);
+		g_spriteAppearances.preloadSpriteSheets(spriteIds, [windowRef]() {
+			if (!windowRef) {
+				return;
+			}
+			windowRef->Refresh();
+			for (wxWindow* child : windowRef->GetChildren()) {
+				child->Refresh();
+			}
+		});
+	}
+}
 
 // ============================================================================
 // Brush Palette Panel
@@ -592,6 +623,8 @@ bool BrushIconBox::LoadContentByPage(int page /* = 1 */) {
 	endOffset = page > 1 ? endOffset : startOffset + endOffset;
 	endOffset = endOffset > tileset->brushlist.size() ? tileset->brushlist.size() : endOffset;
 
+	PreloadBrushIcons(this, tileset, startOffset, endOffset);
+
 	if (stacksizer) {
 		stacksizer->ShowItems(false);
 		stacksizer->Clear();
@@ -767,6 +800,7 @@ BrushListBox::BrushListBox(wxWindow* parent, const TilesetCategory* tileset) :
 	wxVListBox(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLB_SINGLE),
 	BrushBoxInterface(tileset) {
 	SetItemCount(tileset->size());
+	PreloadBrushIcons(this, tileset, 0, tileset->size());
 }
 
 void BrushListBox::SelectFirstBrush() {
@@ -815,7 +849,15 @@ void BrushListBox::OnDrawItem(wxDC &dc, const wxRect &rect, size_t index) const
 	} else {
 		dc.SetTextForeground(wxColor(0x00, 0x00, 0x00));
 	}
-	dc.DrawText(wxstr(tileset->brushlist[index]->getName()), rect.GetX() + 40, rect.GetY() + 6);
+	wxString label = wxstr(tileset->brushlist[index]->getName());
+	if (RAWBrush* raw = tileset->brushlist[index]->asRaw(); raw && g_gui.IsEditorOpen()) {
+		// Only use the counters when they're up to date, rebuilding them while painting would stall the UI
+		const MapStatistics &statistics = g_gui.GetCurrentMap().getCachedStatistics();
+		if (statistics.isValid()) {
+			label << wxString::Format(" (%llu)", static_cast<unsigned long long>(statistics.getItemCount(raw->getItemID())));
+		}
+	}
+	dc.DrawText(label, rect.GetX() + 40, rect.GetY() + 6);
 }
 
 wxCoord BrushListBox::OnMeasureItem(size_t index) const {
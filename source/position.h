@@ -18,6 +18,9 @@
 #ifndef __POSITION_HPP__
 #define __POSITION_HPP__
 
+#include "const.h"
+
+#include <istream>
 #include <ostream>
 #include <cstdint>
 #include <vector>
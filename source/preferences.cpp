@@ -100,6 +100,11 @@ wxNotebookPage* PreferencesWindow::CreateGeneralPage() {
 	use_old_item_properties_window->SetToolTip("Enables the use of the old item properties window");
 	sizer->Add(use_old_item_properties_window, 0, wxLEFT | wxTOP, 5);
 
+	undo_spill_to_disk_chkbox = newd wxCheckBox(general_page, wxID_ANY, "Keep old undo history on disk");
+	undo_spill_to_disk_chkbox->SetValue(g_settings.getInteger(Config::UNDO_SPILL_TO_DISK) == 1);
+	undo_spill_to_disk_chkbox->SetToolTip("When the undo queue exceeds its memory size, older actions are compressed into a journal in the backups folder instead of being discarded.");
+	sizer->Add(undo_spill_to_disk_chkbox, 0, wxLEFT | wxTOP, 5);
+
 	sizer->AddSpacer(10);
 
 	auto* grid_sizer = newd wxFlexGridSizer(2, 10, 10);
@@ -628,6 +633,7 @@ void PreferencesWindow::Apply() {
 	g_settings.setInteger(Config::ONLY_ONE_INSTANCE, only_one_instance_chkbox->GetValue());
 	g_settings.setInteger(Config::UNDO_SIZE, undo_size_spin->GetValue());
 	g_settings.setInteger(Config::UNDO_MEM_SIZE, undo_mem_size_spin->GetValue());
+	g_settings.setInteger(Config::UNDO_SPILL_TO_DISK, undo_spill_to_disk_chkbox->GetValue());
 	g_settings.setInteger(Config::WORKER_THREADS, worker_threads_spin->GetValue());
 	g_settings.setInteger(Config::REPLACE_SIZE, replace_size_spin->GetValue());
 	g_settings.setInteger(Config::DELETE_BACKUP_DAYS, delete_backup_days_spin->GetValue());
@@ -50,6 +50,7 @@ protected:
 	wxCheckBox* show_welcome_dialog_chkbox;
 	wxCheckBox* enable_tileset_editing_chkbox;
 	wxCheckBox* use_old_item_properties_window;
+	wxCheckBox* undo_spill_to_disk_chkbox;
 	wxSpinCtrl* undo_size_spin;
 	wxSpinCtrl* undo_mem_size_spin;
 	wxSpinCtrl* worker_threads_spin;
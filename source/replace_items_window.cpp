@@ -139,6 +139,9 @@ void ReplaceItemsListBox::OnDrawItem(wxDC &dc, const wxRect &rect, size_t index)
 			x = rect.GetWidth() - 100;
 			dc.DrawBitmap(m_flag_bitmap, x + 70, y + 10, true);
 			dc.DrawText(wxString::Format("Total: %d", item.total), x, y + 10);
+		} else if (item.found > 0) {
+			x = rect.GetWidth() - 100;
+			dc.DrawText(wxString::Format("Found: %llu", static_cast<unsigned long long>(item.found)), x, y + 10);
 		}
 	}
 
@@ -292,6 +295,11 @@ void ReplaceItemsDialog::OnAddButtonClicked(wxCommandEvent &WXUNUSED(event)) {
 		ReplacingItem item;
 		item.replaceId = replaceId;
 		item.withId = withId;
+		// The map keeps live item counts, so we can tell up front how many items will be touched
+		MapTab* tab = dynamic_cast<MapTab*>(GetParent());
+		if (!selectionOnly && tab) {
+			item.found = tab->GetMap()->getStatistics().getItemCount(replaceId);
+		}
 		if (list->AddItem(item)) {
 			replace_button->SetItemId(0);
 			with_button->SetItemId(0);
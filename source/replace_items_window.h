@@ -24,7 +24,7 @@
 
 struct ReplacingItem {
 	ReplacingItem() :
-		replaceId(0), withId(0), total(0), complete(false) { }
+		replaceId(0), withId(0), total(0), found(0), complete(false) { }
 
 	bool operator==(const ReplacingItem &other) const {
 		return replaceId == other.replaceId && withId == other.withId;
@@ -33,6 +33,8 @@ struct ReplacingItem {
 	uint16_t replaceId;
 	uint16_t withId;
 	uint32_t total;
+	// Occurrences on the map when the item was added, 0 if unknown
+	uint64_t found;
 	bool complete;
 };
 
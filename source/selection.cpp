@@ -22,6 +22,8 @@
 #include "monster.h"
 #include "npc.h"
 #include "item.h"
+#include "spawn_monster.h"
+#include "spawn_npc.h"
 #include "editor.h"
 #include "gui.h"
 
@@ -197,6 +199,14 @@ void Selection::add(const Tile* tile) {
 	subsession->addChange(newd Change(new_tile));
 }
 
+void Selection::add(const SelectionArea &area) {
+	ASSERT(subsession);
+
+	if (!area.empty()) {
+		subsession->addChange(Change::Create(area, true));
+	}
+}
+
 void Selection::remove(Tile* tile, Item* item) {
 	ASSERT(subsession);
 	ASSERT(tile);
@@ -303,6 +313,14 @@ void Selection::remove(Tile* tile) {
 	subsession->addChange(newd Change(new_tile));
 }
 
+void Selection::remove(const SelectionArea &area) {
+	ASSERT(subsession);
+
+	if (!area.empty()) {
+		subsession->addChange(Change::Create(area, false));
+	}
+}
+
 void Selection::addInternal(Tile* tile) {
 	ASSERT(tile);
 
@@ -314,13 +332,18 @@ void Selection::removeInternal(Tile* tile) {
 	tiles.erase(tile);
 }
 
+void Selection::reserveInternal(size_t count) {
+	tiles.reserve(tiles.size() + count);
+}
+
 void Selection::clear() {
 	if (session) {
-		for (Tile* tile : tiles) {
-			Tile* new_tile = tile->deepCopy(editor.getMap());
-			new_tile->deselect();
-			subsession->addChange(newd Change(new_tile));
+		std::vector<Position> positions;
+		positions.reserve(tiles.size());
+		for (const Tile* tile : tiles) {
+			positions.push_back(tile->getPosition());
 		}
+		remove(SelectionArea::fromPositions(std::move(positions)));
 	} else {
 		for (Tile* tile : tiles) {
 			tile->deselect();
@@ -331,9 +354,7 @@ void Selection::clear() {
 
 void Selection::start(SessionFlags flags, ActionIdentifier identifier) {
 	if (!(flags & INTERNAL)) {
-		if (!(flags & SUBTHREAD)) {
-			session = editor.createBatch(identifier);
-		}
+		session = editor.createBatch(identifier);
 		subsession = editor.createAction(identifier);
 	}
 	busy = true;
@@ -357,23 +378,18 @@ void Selection::commit() {
 
 void Selection::finish(SessionFlags flags) {
 	if (!(flags & INTERNAL)) {
-		if (flags & SUBTHREAD) {
-			ASSERT(subsession);
-			subsession = nullptr;
-		} else {
-			ASSERT(session);
-			ASSERT(subsession);
-			// We need to exit the session before we do the action, else peril awaits us!
-			BatchAction* batch = session;
-			session = nullptr;
-
-			batch->addAndCommitAction(subsession);
-			editor.addBatch(batch, 2);
-			editor.updateActions();
-
-			session = nullptr;
-			subsession = nullptr;
-		}
+		ASSERT(session);
+		ASSERT(subsession);
+		// We need to exit the session before we do the action, else peril awaits us!
+		BatchAction* batch = session;
+		session = nullptr;
+
+		batch->addAndCommitAction(subsession);
+		editor.addBatch(batch, 2);
+		editor.updateActions();
+
+		session = nullptr;
+		subsession = nullptr;
 	}
 	busy = false;
 }
@@ -390,53 +406,94 @@ void Selection::updateSelectionCount() {
 	}
 }
 
-void Selection::join(SelectionThread* thread) {
-	thread->Wait();
+namespace {
+	// Calls visitor with everything on the tile that can be selected, in the order of Tile::select
+	template <typename TileType, typename Visitor>
+	void forEachSelectable(TileType* tile, Visitor &&visitor) {
+		if (tile->ground) {
+			visitor(tile->ground);
+		}
+		if (tile->spawnMonster) {
+			visitor(tile->spawnMonster);
+		}
+		if (tile->spawnNpc) {
+			visitor(tile->spawnNpc);
+		}
+		if (tile->npc) {
+			visitor(tile->npc);
+		}
+		for (const auto monster : tile->monsters) {
+			visitor(monster);
+		}
+		for (Item* item : tile->items) {
+			visitor(item);
+		}
+	}
+}
+
+void SelectionArea::forEachTile(BaseMap &map, const std::function<void(Tile*)> &visitor) const {
+	for (const SelectionRect &rect : rects) {
+		for (int leaf_x = rect.start_x & ~3; leaf_x <= rect.end_x; leaf_x += 4) {
+			for (int leaf_y = rect.start_y & ~3; leaf_y <= rect.end_y; leaf_y += 4) {
+				QTreeNode* leaf = map.getLeaf(leaf_x, leaf_y);
+				if (!leaf) {
+					continue;
+				}
 
-	ASSERT(session);
-	session->addAction(thread->result);
-	thread->selection.subsession = nullptr;
+				const int end_x = std::min(leaf_x + 3, rect.end_x);
+				const int end_y = std::min(leaf_y + 3, rect.end_y);
+				for (int x = std::max(leaf_x, rect.start_x); x <= end_x; ++x) {
+					for (int y = std::max(leaf_y, rect.start_y); y <= end_y; ++y) {
+						TileLocation* location = leaf->getTile(x, y, rect.z);
+						if (location && location->get()) {
+							visitor(location->get());
+						}
+					}
+				}
+			}
+		}
+	}
+}
 
-	delete thread;
+TileSelectionState::TileSelectionState(const Tile* tile) :
+	position(tile->getPosition()) {
+	bool everything = true;
+	forEachSelectable(tile, [&](const auto* object) {
+		flags.push_back(object->isSelected());
+		everything = everything && object->isSelected();
+	});
+	if (everything) {
+		flags.clear();
+	}
 }
 
-SelectionThread::SelectionThread(Editor &editor, Position start, Position end) :
-	wxThread(wxTHREAD_JOINABLE),
-	editor(editor),
-	start(start),
-	end(end),
-	selection(editor),
-	result(nullptr) {
+TileSelectionState::TileSelectionState(const Position &position, std::vector<bool> flags) :
+	position(position),
+	flags(std::move(flags)) {
 	////
 }
 
-void SelectionThread::Execute() {
-	Create();
-	Run();
+bool TileSelectionState::isFullySelected(const Tile* tile) {
+	bool everything = true;
+	forEachSelectable(tile, [&](const auto* object) {
+		everything = everything && object->isSelected();
+	});
+	return everything;
 }
 
-wxThread::ExitCode SelectionThread::Entry() {
-	selection.start(Selection::SUBTHREAD);
-	bool compesated = g_settings.getInteger(Config::COMPENSATED_SELECT);
-	for (int z = start.z; z >= end.z; --z) {
-		for (int x = start.x; x <= end.x; ++x) {
-			for (int y = start.y; y <= end.y; ++y) {
-				Tile* tile = editor.getMap().getTile(x, y, z);
-				if (!tile) {
-					continue;
-				}
+void TileSelectionState::restore(Tile* tile) const {
+	if (flags.empty()) {
+		tile->select();
+		return;
+	}
 
-				selection.add(tile);
-			}
-		}
-		if (compesated && z <= rme::MapGroundLayer) {
-			++start.x;
-			++start.y;
-			++end.x;
-			++end.y;
+	tile->deselect();
+	size_t index = 0;
+	forEachSelectable(tile, [&](auto* object) {
+		if (index < flags.size() && flags[index]) {
+			object->select();
 		}
-	}
-	result = selection.subsession;
-	selection.finish(Selection::SUBTHREAD);
-	return nullptr;
+		++index;
+	});
+	tile->update();
 }
@@ -26,8 +26,6 @@ class Action;
 class Editor;
 class BatchAction;
 
-class SelectionThread;
-
 class Selection {
 public:
 	Selection(Editor &editor);
@@ -42,6 +40,8 @@ public:
 	void add(const Tile* tile, Monster* monster);
 	void add(const Tile* tile, Npc* npc);
 	void add(const Tile* tile);
+	// Whole tiles of an area, selected in place instead of through tile copies
+	void add(const SelectionArea &area);
 	void remove(Tile* tile, Item* item);
 	void remove(Tile* tile, SpawnMonster* spawnMonster);
 	void remove(Tile* tile, SpawnNpc* spawnNpc);
@@ -49,10 +49,13 @@ public:
 	void remove(Tile* tile, Monster* monster);
 	void remove(Tile* tile, Npc* npc);
 	void remove(Tile* tile);
+	void remove(const SelectionArea &area);
 
 	// The tile will be added to the list of selected tiles, however, the items on the tile won't be selected
 	void addInternal(Tile* tile);
 	void removeInternal(Tile* tile);
+	// Makes room for that many more tiles before a batch of addInternal calls
+	void reserveInternal(size_t count);
 
 	// Clears the selection completely
 	void clear();
@@ -68,23 +71,15 @@ public:
 
 	// This manages a "selection session"
 	// Internal session doesn't store the result (eg. no undo)
-	// Subthread means the session doesn't create a complete
-	// action, just part of one to be merged with the main thread
-	// later.
 	enum SessionFlags {
 		NONE,
 		INTERNAL = 1,
-		SUBTHREAD = 2,
 	};
 
 	void start(SessionFlags flags = NONE, ActionIdentifier identifier = ACTION_SELECT);
 	void commit();
 	void finish(SessionFlags flags = NONE);
 
-	// Joins the selection instance in this thread with this instance
-	// This deletes the thread
-	void join(SelectionThread* thread);
-
 	size_t size() const noexcept {
 		return tiles.size();
 	}
@@ -112,24 +107,6 @@ private:
 	Action* subsession;
 	TileSet tiles;
 	bool busy;
-
-	friend class SelectionThread;
-};
-
-class SelectionThread : public wxThread {
-public:
-	SelectionThread(Editor &editor, Position start, Position end);
-
-	void Execute(); // Calls "Create" and then "Run"
-
-protected:
-	virtual ExitCode Entry();
-	Editor &editor;
-	Position start, end;
-	Selection selection;
-	Action* result;
-
-	friend class Selection;
 };
 
 #endif
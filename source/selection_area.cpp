@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "selection_area.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+void SelectionArea::add(const SelectionRect &rect) {
+	SelectionRect clamped = rect;
+	clamped.start_x = std::max(clamped.start_x, 0);
+	clamped.start_y = std::max(clamped.start_y, 0);
+	clamped.end_x = std::min(clamped.end_x, rme::MapMaxWidth);
+	clamped.end_y = std::min(clamped.end_y, rme::MapMaxHeight);
+	if (clamped.empty() || clamped.z < rme::MapMinLayer || clamped.z > rme::MapMaxLayer) {
+		return;
+	}
+
+	// Keeping the rectangles disjoint means every position is visited once
+	subtract(clamped);
+	rects.push_back(clamped);
+}
+
+void SelectionArea::subtract(const SelectionRect &rect) {
+	if (rect.empty()) {
+		return;
+	}
+
+	std::vector<SelectionRect> remaining;
+	remaining.reserve(rects.size());
+	for (const SelectionRect &current : rects) {
+		if (!current.intersects(rect)) {
+			remaining.push_back(current);
+			continue;
+		}
+
+		// Rows above and below the cut, then what is left on its sides
+		const int top = std::max(current.start_y, rect.start_y);
+		const int bottom = std::min(current.end_y, rect.end_y);
+		const SelectionRect pieces[] = {
+			{ current.start_x, current.start_y, current.end_x, rect.start_y - 1, current.z },
+			{ current.start_x, rect.end_y + 1, current.end_x, current.end_y, current.z },
+			{ current.start_x, top, rect.start_x - 1, bottom, current.z },
+			{ rect.end_x + 1, top, current.end_x, bottom, current.z },
+		};
+		for (const SelectionRect &piece : pieces) {
+			if (!piece.empty()) {
+				remaining.push_back(piece);
+			}
+		}
+	}
+	rects.swap(remaining);
+}
+
+bool SelectionArea::contains(const Position &position) const {
+	return std::ranges::any_of(rects, [&](const SelectionRect &rect) {
+		return rect.contains(position);
+	});
+}
+
+uint64_t SelectionArea::count() const {
+	uint64_t total = 0;
+	for (const SelectionRect &rect : rects) {
+		total += rect.count();
+	}
+	return total;
+}
+
+void SelectionArea::forEachPosition(const std::function<void(const Position &)> &visitor) const {
+	for (const SelectionRect &rect : rects) {
+		for (int y = rect.start_y; y <= rect.end_y; ++y) {
+			for (int x = rect.start_x; x <= rect.end_x; ++x) {
+				visitor(Position(x, y, rect.z));
+			}
+		}
+	}
+}
+
+SelectionArea SelectionArea::fromPositions(std::vector<Position> positions) {
+	std::ranges::sort(positions, [](const Position &a, const Position &b) {
+		return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x);
+	});
+	positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+	SelectionArea area;
+	// Rectangle that can still grow downwards, by floor and run
+	std::map<std::tuple<int, int, int>, size_t> open;
+	for (size_t index = 0; index < positions.size();) {
+		const Position &start = positions[index];
+		size_t next = index + 1;
+		while (next < positions.size() && positions[next].z == start.z && positions[next].y == start.y && positions[next].x == positions[next - 1].x + 1) {
+			++next;
+		}
+		const int end_x = positions[next - 1].x;
+
+		const auto key = std::make_tuple(start.z, start.x, end_x);
+		const auto it = open.find(key);
+		if (it != open.end() && area.rects[it->second].end_y == start.y - 1) {
+			area.rects[it->second].end_y = start.y;
+		} else {
+			open[key] = area.rects.size();
+			area.rects.push_back({ start.x, start.y, end_x, start.y, start.z });
+		}
+		index = next;
+	}
+	return area;
+}
+
+SelectionArea SelectionArea::fromDisjointRects(std::vector<SelectionRect> rects) {
+	SelectionArea area;
+	area.rects = std::move(rects);
+	return area;
+}
@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_SELECTION_AREA_H_
+#define RME_SELECTION_AREA_H_
+
+#include "position.h"
+
+#include <functional>
+
+class BaseMap;
+class Tile;
+
+// Rectangle of whole tiles on one floor, the end is inclusive
+struct SelectionRect {
+	int start_x;
+	int start_y;
+	int end_x;
+	int end_y;
+	int z;
+
+	bool empty() const noexcept {
+		return start_x > end_x || start_y > end_y;
+	}
+	bool contains(const Position &position) const noexcept {
+		return position.z == z && position.x >= start_x && position.x <= end_x && position.y >= start_y && position.y <= end_y;
+	}
+	bool intersects(const SelectionRect &other) const noexcept {
+		return z == other.z && start_x <= other.end_x && other.start_x <= end_x && start_y <= other.end_y && other.start_y <= end_y;
+	}
+	uint64_t count() const noexcept {
+		return empty() ? 0 : uint64_t(end_x - start_x + 1) * uint64_t(end_y - start_y + 1);
+	}
+};
+
+// A set of positions kept as disjoint rectangles. Selecting or deselecting a box
+// costs a few rectangles, whatever the number of tiles inside of it.
+class SelectionArea {
+public:
+	// Union with the rectangle, clamped to the map bounds
+	void add(const SelectionRect &rect);
+	void subtract(const SelectionRect &rect);
+
+	bool contains(const Position &position) const;
+	bool empty() const noexcept {
+		return rects.empty();
+	}
+	// Number of positions in the area
+	uint64_t count() const;
+	const std::vector<SelectionRect> &getRects() const noexcept {
+		return rects;
+	}
+
+	// Every position once, rectangle by rectangle
+	void forEachPosition(const std::function<void(const Position &)> &visitor) const;
+	// Every existing tile of the map inside the area once, skipping the empty quad tree leaves.
+	// Defined in selection.cpp with the rest of the tile code, so the area builds without the map.
+	void forEachTile(BaseMap &map, const std::function<void(Tile*)> &visitor) const;
+
+	// Merges the positions into horizontal runs, and runs stacked on each other into rectangles
+	static SelectionArea fromPositions(std::vector<Position> positions);
+	// Takes the rectangles of another area back as they are, they must not overlap
+	static SelectionArea fromDisjointRects(std::vector<SelectionRect> rects);
+
+protected:
+	std::vector<SelectionRect> rects;
+};
+
+// Selection flags of everything on a tile, so a partly selected tile can be put back
+// after a whole area has been selected or deselected. Defined in selection.cpp.
+class TileSelectionState {
+public:
+	explicit TileSelectionState(const Tile* tile);
+	TileSelectionState(const Position &position, std::vector<bool> flags);
+
+	const Position &getPosition() const noexcept {
+		return position;
+	}
+	// In the order of Tile::select, empty when everything on the tile was selected
+	const std::vector<bool> &getFlags() const noexcept {
+		return flags;
+	}
+
+	void restore(Tile* tile) const;
+
+	// Whether everything on the tile is selected, without recording the flags
+	static bool isFullySelected(const Tile* tile);
+
+protected:
+	Position position;
+	std::vector<bool> flags;
+};
+
+#endif
@@ -236,6 +236,7 @@ void Settings::IO(IOMode mode) {
 	Int(MERGE_PASTE, 0);
 	Int(UNDO_SIZE, 400);
 	Int(UNDO_MEM_SIZE, 40);
+	Int(UNDO_SPILL_TO_DISK, 1);
 	Int(GROUP_ACTIONS, 1);
 	Int(SELECTION_TYPE, SELECT_CURRENT_FLOOR);
 	Int(COMPENSATED_SELECT, 1);
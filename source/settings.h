@@ -70,6 +70,7 @@ namespace Config {
 		ZOOM_SPEED,
 		UNDO_SIZE,
 		UNDO_MEM_SIZE,
+		UNDO_SPILL_TO_DISK,
 		MERGE_PASTE,
 		SELECTION_TYPE,
 		COMPENSATED_SELECT,
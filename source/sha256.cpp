@@ -0,0 +1,336 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "sha256.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define RME_SHA256_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define RME_SHA256_TARGET
+	#else
+		#include <cpuid.h>
+		#define RME_SHA256_TARGET __attribute__((target("sha,sse4.1")))
+	#endif
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO) || defined(_M_ARM64))
+	#define RME_SHA256_ARM
+	#include <arm_neon.h>
+	#if defined(__linux__)
+		#include <sys/auxv.h>
+		#include <asm/hwcap.h>
+	#elif defined(_WIN32)
+		#include <windows.h>
+	#endif
+#endif
+
+namespace {
+	alignas(16) constexpr uint32_t Sha256RoundConstants[64] = {
+		0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u, 0x3956C25Bu, 0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u,
+		0xD807AA98u, 0x12835B01u, 0x243185BEu, 0x550C7DC3u, 0x72BE5D74u, 0x80DEB1FEu, 0x9BDC06A7u, 0xC19BF174u,
+		0xE49B69C1u, 0xEFBE4786u, 0x0FC19DC6u, 0x240CA1CCu, 0x2DE92C6Fu, 0x4A7484AAu, 0x5CB0A9DCu, 0x76F988DAu,
+		0x983E5152u, 0xA831C66Du, 0xB00327C8u, 0xBF597FC7u, 0xC6E00BF3u, 0xD5A79147u, 0x06CA6351u, 0x14292967u,
+		0x27B70A85u, 0x2E1B2138u, 0x4D2C6DFCu, 0x53380D13u, 0x650A7354u, 0x766A0ABBu, 0x81C2C92Eu, 0x92722C85u,
+		0xA2BFE8A1u, 0xA81A664Bu, 0xC24B8B70u, 0xC76C51A3u, 0xD192E819u, 0xD6990624u, 0xF40E3585u, 0x106AA070u,
+		0x19A4C116u, 0x1E376C08u, 0x2748774Cu, 0x34B0BCB5u, 0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu, 0x682E6FF3u,
+		0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u, 0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u
+	};
+
+	std::atomic<bool> sha256HardwareEnabled = true;
+
+	inline uint32_t sha256Rotr(const uint32_t value, const uint32_t bits) {
+		return (value >> bits) | (value << (32 - bits));
+	}
+
+#ifdef RME_SHA256_X86
+	bool detectSha256Hardware() {
+		int leaf1[4] = {};
+		int leaf7[4] = {};
+	#ifdef _MSC_VER
+		__cpuid(leaf1, 0);
+		if (leaf1[0] < 7) {
+			return false;
+		}
+		__cpuid(leaf1, 1);
+		__cpuidex(leaf7, 7, 0);
+	#else
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+			return false;
+		}
+		leaf7[1] = static_cast<int>(ebx);
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+			return false;
+		}
+		leaf1[2] = static_cast<int>(ecx);
+	#endif
+		const bool ssse3 = (leaf1[2] & (1 << 9)) != 0;
+		const bool sse41 = (leaf1[2] & (1 << 19)) != 0;
+		const bool sha = (leaf7[1] & (1 << 29)) != 0;
+		return ssse3 && sse41 && sha;
+	}
+
+	RME_SHA256_TARGET void sha256TransformX86(uint32_t state[8], const uint8_t* blocks, size_t count) {
+		const __m128i byteSwap = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+		// The instructions keep the state as ABEF and CDGH
+		__m128i cdab = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+		__m128i cdgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+		__m128i abef = _mm_alignr_epi8(cdab, cdgh, 8);
+		cdgh = _mm_blend_epi16(cdgh, cdab, 0xF0);
+
+		for (; count > 0; --count, blocks += 64) {
+			const __m128i abefSaved = abef;
+			const __m128i cdghSaved = cdgh;
+
+			__m128i words[4];
+			for (int group = 0; group < 16; ++group) {
+				__m128i &current = words[group & 3];
+				if (group < 4) {
+					current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + group * 16)), byteSwap);
+				} else {
+					const __m128i previous = words[(group + 3) & 3];
+					const __m128i partial = _mm_add_epi32(_mm_sha256msg1_epu32(current, words[(group + 1) & 3]), _mm_alignr_epi8(previous, words[(group + 2) & 3], 4));
+					current = _mm_sha256msg2_epu32(partial, previous);
+				}
+
+				__m128i message = _mm_add_epi32(current, _mm_load_si128(reinterpret_cast<const __m128i*>(&Sha256RoundConstants[group * 4])));
+				cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+				message = _mm_shuffle_epi32(message, 0x0E);
+				abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+			}
+
+			abef = _mm_add_epi32(abef, abefSaved);
+			cdgh = _mm_add_epi32(cdgh, cdghSaved);
+		}
+
+		const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+		const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xF0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+	}
+#endif
+
+#ifdef RME_SHA256_ARM
+	bool detectSha256Hardware() {
+	#if defined(__linux__)
+		return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+	#elif defined(_WIN32)
+		return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+	#else
+		// Built with the SHA2 feature enabled, e.g. every Apple arm64 target
+		return true;
+	#endif
+	}
+
+	void sha256TransformArm(uint32_t state[8], const uint8_t* blocks, size_t count) {
+		uint32x4_t abcd = vld1q_u32(&state[0]);
+		uint32x4_t efgh = vld1q_u32(&state[4]);
+
+		for (; count > 0; --count, blocks += 64) {
+			const uint32x4_t abcdSaved = abcd;
+			const uint32x4_t efghSaved = efgh;
+
+			uint32x4_t words[4];
+			for (int group = 0; group < 16; ++group) {
+				uint32x4_t &current = words[group & 3];
+				if (group < 4) {
+					current = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + group * 16)));
+				} else {
+					current = vsha256su1q_u32(vsha256su0q_u32(current, words[(group + 1) & 3]), words[(group + 2) & 3], words[(group + 3) & 3]);
+				}
+
+				const uint32x4_t message = vaddq_u32(current, vld1q_u32(&Sha256RoundConstants[group * 4]));
+				const uint32x4_t previous = abcd;
+				abcd = vsha256hq_u32(abcd, efgh, message);
+				efgh = vsha256h2q_u32(efgh, previous, message);
+			}
+
+			abcd = vaddq_u32(abcd, abcdSaved);
+			efgh = vaddq_u32(efgh, efghSaved);
+		}
+
+		vst1q_u32(&state[0], abcd);
+		vst1q_u32(&state[4], efgh);
+	}
+#endif
+
+	// Runs the hardware transform once on the padded message "abc" before trusting it
+	bool checkSha256Hardware() {
+		uint8_t block[64] = { 'a', 'b', 'c', 0x80 };
+		block[63] = 24;
+		uint32_t state[8] = { 0x6A09E667u, 0xBB67AE85u, 0x3C6EF372u, 0xA54FF53Au, 0x510E527Fu, 0x9B05688Cu, 0x1F83D9ABu, 0x5BE0CD19u };
+		constexpr uint32_t expected[8] = { 0xBA7816BFu, 0x8F01CFEAu, 0x414140DEu, 0x5DAE2223u, 0xB00361A3u, 0x96177A9Cu, 0xB410FF61u, 0xF20015ADu };
+		Sha256::transformHardware(state, block, 1);
+		return std::memcmp(state, expected, sizeof(expected)) == 0;
+	}
+}
+
+void Sha256::transformPortable(uint32_t state[8], const uint8_t* blocks, size_t count) {
+	for (; count > 0; --count, blocks += 64) {
+		uint32_t words[64];
+		for (size_t i = 0; i < 16; ++i) {
+			const uint8_t* word = blocks + i * 4;
+			words[i] = (static_cast<uint32_t>(word[0]) << 24)
+				| (static_cast<uint32_t>(word[1]) << 16)
+				| (static_cast<uint32_t>(word[2]) << 8)
+				| static_cast<uint32_t>(word[3]);
+		}
+
+		for (size_t i = 16; i < 64; ++i) {
+			const uint32_t s0 = sha256Rotr(words[i - 15], 7) ^ sha256Rotr(words[i - 15], 18) ^ (words[i - 15] >> 3);
+			const uint32_t s1 = sha256Rotr(words[i - 2], 17) ^ sha256Rotr(words[i - 2], 19) ^ (words[i - 2] >> 10);
+			words[i] = words[i - 16] + s0 + words[i - 7] + s1;
+		}
+
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+		uint32_t f = state[5];
+		uint32_t g = state[6];
+		uint32_t h = state[7];
+
+		for (size_t i = 0; i < 64; ++i) {
+			const uint32_t s1 = sha256Rotr(e, 6) ^ sha256Rotr(e, 11) ^ sha256Rotr(e, 25);
+			const uint32_t ch = (e & f) ^ ((~e) & g);
+			const uint32_t temp1 = h + s1 + ch + Sha256RoundConstants[i] + words[i];
+			const uint32_t s0 = sha256Rotr(a, 2) ^ sha256Rotr(a, 13) ^ sha256Rotr(a, 22);
+			const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+			const uint32_t temp2 = s0 + maj;
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + temp1;
+			d = c;
+			c = b;
+			b = a;
+			a = temp1 + temp2;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
+
+void Sha256::transformHardware(uint32_t state[8], const uint8_t* blocks, size_t count) {
+#if defined(RME_SHA256_X86)
+	sha256TransformX86(state, blocks, count);
+#elif defined(RME_SHA256_ARM)
+	sha256TransformArm(state, blocks, count);
+#else
+	transformPortable(state, blocks, count);
+#endif
+}
+
+bool Sha256::hasHardwareSupport() {
+#if defined(RME_SHA256_X86) || defined(RME_SHA256_ARM)
+	static const bool supported = detectSha256Hardware() && checkSha256Hardware();
+	return supported;
+#else
+	return false;
+#endif
+}
+
+void Sha256::setHardwareEnabled(bool enabled) {
+	sha256HardwareEnabled = enabled;
+}
+
+void Sha256::transform(const uint8_t* blocks, size_t count) {
+	if (sha256HardwareEnabled && hasHardwareSupport()) {
+		transformHardware(state, blocks, count);
+	} else {
+		transformPortable(state, blocks, count);
+	}
+}
+
+void Sha256::update(std::span<const uint8_t> bytes) {
+	if (bytes.empty()) {
+		return;
+	}
+
+	const uint8_t* data = bytes.data();
+	size_t size = bytes.size();
+	length += size;
+
+	if (bufferLength > 0) {
+		const size_t taken = std::min(size, buffer.size() - bufferLength);
+		std::memcpy(buffer.data() + bufferLength, data, taken);
+		bufferLength += taken;
+		data += taken;
+		size -= taken;
+		if (bufferLength < buffer.size()) {
+			return;
+		}
+		transform(buffer.data(), 1);
+		bufferLength = 0;
+	}
+
+	if (const size_t blocks = size / 64; blocks > 0) {
+		transform(data, blocks);
+		data += blocks * 64;
+		size -= blocks * 64;
+	}
+
+	if (size > 0) {
+		std::memcpy(buffer.data(), data, size);
+		bufferLength = size;
+	}
+}
+
+Sha256::Digest Sha256::finalize() {
+	const uint64_t bitLength = length * 8;
+
+	buffer[bufferLength++] = 0x80;
+	if (bufferLength > 56) {
+		std::fill(buffer.begin() + bufferLength, buffer.end(), 0);
+		transform(buffer.data(), 1);
+		bufferLength = 0;
+	}
+	std::fill(buffer.begin() + bufferLength, buffer.begin() + 56, 0);
+	for (size_t i = 0; i < 8; ++i) {
+		buffer[63 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+	}
+	transform(buffer.data(), 1);
+
+	Digest digest;
+	for (size_t i = 0; i < 8; ++i) {
+		digest[i * 4] = static_cast<uint8_t>(state[i] >> 24);
+		digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+		digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+		digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+	}
+	return digest;
+}
+
+Sha256::Digest Sha256::hash(std::span<const uint8_t> bytes) {
+	Sha256 context;
+	context.update(bytes);
+	return context.finalize();
+}
@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_SHA256_H_
+#define RME_SHA256_H_
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// SHA-256 used to name exported cyclopedia assets. The block transform runs on the
+// SHA extensions of x86 (SHA-NI) or ARMv8 when the CPU has them, and on the portable
+// code otherwise; both produce the same digest.
+class Sha256 {
+public:
+	using Digest = std::array<uint8_t, 32>;
+
+	void update(std::span<const uint8_t> bytes);
+	Digest finalize();
+
+	static Digest hash(std::span<const uint8_t> bytes);
+
+	// True when the hardware transform is available and passed its known-answer check
+	static bool hasHardwareSupport();
+	// Lets callers force the portable transform, e.g. to compare both paths
+	static void setHardwareEnabled(bool enabled);
+
+	static void transformPortable(uint32_t state[8], const uint8_t* blocks, size_t count);
+	static void transformHardware(uint32_t state[8], const uint8_t* blocks, size_t count);
+
+private:
+	void transform(const uint8_t* blocks, size_t count);
+
+	uint32_t state[8] = { 0x6A09E667u, 0xBB67AE85u, 0x3C6EF372u, 0xA54FF53Au, 0x510E527Fu, 0x9B05688Cu, 0x1F83D9ABu, 0x5BE0CD19u };
+	std::array<uint8_t, 64> buffer {};
+	size_t bufferLength = 0;
+	uint64_t length = 0;
+};
+
+#endif
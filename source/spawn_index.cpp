@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "spawn_index.h"
+
+#include <algorithm>
+
+namespace {
+	// Calls visitor(x, y) with a tile of every cell overlapped by the area, clamped to the map
+	template <typename Visitor>
+	void forEachSpawnCell(const Position &center, int radius, int shift, Visitor &&visitor) {
+		const int cell_size = 1 << shift;
+		const int start_x = std::max(center.x - radius, 0) >> shift;
+		const int start_y = std::max(center.y - radius, 0) >> shift;
+		const int end_x = std::min(center.x + radius, rme::MapMaxWidth) >> shift;
+		const int end_y = std::min(center.y + radius, rme::MapMaxHeight) >> shift;
+		for (int y = start_y; y <= end_y; ++y) {
+			for (int x = start_x; x <= end_x; ++x) {
+				visitor(x * cell_size, y * cell_size);
+			}
+		}
+	}
+}
+
+void SpawnIndex::add(const Position &center, int radius) {
+	if (center.z < 0 || center.z >= rme::MapLayers) {
+		return;
+	}
+
+	Cells &cells = floors[center.z];
+	forEachSpawnCell(center, radius, CellShift, [&](int x, int y) {
+		cells[getCellKey(x, y)].push_back(Area { center, radius });
+	});
+	++area_count;
+}
+
+void SpawnIndex::remove(const Position &center, int radius) {
+	if (center.z < 0 || center.z >= rme::MapLayers) {
+		return;
+	}
+
+	bool removed = false;
+	Cells &cells = floors[center.z];
+	forEachSpawnCell(center, radius, CellShift, [&](int x, int y) {
+		const auto cell = cells.find(getCellKey(x, y));
+		if (cell == cells.end()) {
+			return;
+		}
+
+		std::vector<Area> &areas = cell->second;
+		const auto it = std::ranges::find_if(areas, [&](const Area &area) {
+			return area.center == center && area.radius == radius;
+		});
+		if (it != areas.end()) {
+			areas.erase(it);
+			removed = true;
+		}
+		if (areas.empty()) {
+			cells.erase(cell);
+		}
+	});
+
+	if (removed) {
+		--area_count;
+	}
+}
+
+void SpawnIndex::clear() {
+	for (Cells &cells : floors) {
+		cells.clear();
+	}
+	area_count = 0;
+}
+
+const std::vector<SpawnIndex::Area>* SpawnIndex::getCell(const Position &position) const {
+	if (area_count == 0 || position.z < 0 || position.z >= rme::MapLayers || position.x < 0 || position.y < 0) {
+		return nullptr;
+	}
+
+	const Cells &cells = floors[position.z];
+	const auto cell = cells.find(getCellKey(position.x, position.y));
+	return cell != cells.end() ? &cell->second : nullptr;
+}
+
+size_t SpawnIndex::count(const Position &position) const {
+	const std::vector<Area>* areas = getCell(position);
+	if (!areas) {
+		return 0;
+	}
+	return std::ranges::count_if(*areas, [&](const Area &area) {
+		return area.covers(position.x, position.y);
+	});
+}
+
+std::vector<Position> SpawnIndex::find(const Position &position) const {
+	std::vector<Area> covering;
+	if (const std::vector<Area>* areas = getCell(position)) {
+		for (const Area &area : *areas) {
+			if (area.covers(position.x, position.y)) {
+				covering.push_back(area);
+			}
+		}
+	}
+
+	const auto distance = [&](const Area &area) {
+		return std::max(std::abs(area.center.x - position.x), std::abs(area.center.y - position.y));
+	};
+	std::ranges::stable_sort(covering, [&](const Area &a, const Area &b) {
+		return distance(a) < distance(b);
+	});
+
+	std::vector<Position> centers;
+	centers.reserve(covering.size());
+	for (const Area &area : covering) {
+		centers.push_back(area.center);
+	}
+	return centers;
+}
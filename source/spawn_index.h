@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_SPAWN_INDEX_H_
+#define RME_SPAWN_INDEX_H_
+
+#include "position.h"
+
+#include <array>
+#include <cstdlib>
+#include <unordered_map>
+
+// Keeps track of the square areas covered by spawns. Areas are bucketed per floor in
+// cells of 32x32 tiles, so a lookup only checks the few spawns registered near the
+// position, and a spawn takes a handful of entries whatever its radius.
+class SpawnIndex {
+public:
+	void add(const Position &center, int radius);
+	// Removes one area added with the same center and radius
+	void remove(const Position &center, int radius);
+	void clear();
+
+	bool empty() const noexcept {
+		return area_count == 0;
+	}
+
+	// Number of spawn areas covering the position
+	size_t count(const Position &position) const;
+	// Centers of the spawn areas covering the position, closest first
+	std::vector<Position> find(const Position &position) const;
+
+protected:
+	static constexpr int CellShift = 5;
+
+	struct Area {
+		Position center;
+		int radius;
+
+		bool covers(int x, int y) const noexcept {
+			return std::abs(x - center.x) <= radius && std::abs(y - center.y) <= radius;
+		}
+	};
+	using CellKey = uint32_t;
+	using Cells = std::unordered_map<CellKey, std::vector<Area>>;
+
+	static CellKey getCellKey(int x, int y) noexcept {
+		return (static_cast<uint32_t>(x >> CellShift) << 16) | static_cast<uint32_t>(y >> CellShift);
+	}
+	const std::vector<Area>* getCell(const Position &position) const;
+
+	std::array<Cells, rme::MapLayers> floors;
+	size_t area_count = 0;
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include "main.h"
 
 #include "sprite_appearances.h"
+#include "sprite_pixels.h"
 #include "settings.h"
 #include "filehandle.h"
 #include "gui.h"
@@ -41,6 +42,7 @@ void SpriteAppearances::init() {
 }
 
 void SpriteAppearances::terminate() {
+	stopSheetLoader();
 	unload();
 }
 
@@ -95,10 +97,21 @@ bool SpriteAppearances::loadSpriteSheet(const SpriteSheetPtr &sheet) {
 		return false;
 	}
 
-	std::ifstream file(sheet->path, std::ios::binary | std::ios::in);
+	auto data = decodeSpriteSheet(sheet->path);
+	if (!data) {
+		return false;
+	}
+
+	sheet->data = std::move(data);
+	sheet->loaded = true;
+	return true;
+}
+
+std::unique_ptr<uint8_t[]> SpriteAppearances::decodeSpriteSheet(const std::string &path) {
+	std::ifstream file(path, std::ios::binary | std::ios::in);
 	if (!file.is_open()) {
 		spdlog::error("[SpriteAppearances::loadSpriteSheet] - Unable to open given sheets files");
-		return false;
+		return nullptr;
 	}
 
 	std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), (std::istreambuf_iterator<char>()));
@@ -150,20 +163,21 @@ bool SpriteAppearances::loadSpriteSheet(const SpriteSheetPtr &sheet) {
 	lzma_ret ret = lzma_raw_decoder(&stream, filters);
 	if (ret != LZMA_OK) {
 		spdlog::error("Failed to initialize lzma raw decoder result: {}", static_cast<int>(ret));
-		return false;
+		return nullptr;
 	}
 
 	std::unique_ptr<uint8_t[]> decompressed = std::make_unique<uint8_t[]>(LZMA_UNCOMPRESSED_SIZE); // uncompressed size, bmp file + 122 bytes header
 
 	stream.next_in = &buffer[pos];
 	stream.next_out = decompressed.get();
-	stream.avail_in = buffer.size();
+	stream.avail_in = buffer.size() - pos;
 	stream.avail_out = LZMA_UNCOMPRESSED_SIZE;
 
 	ret = lzma_code(&stream, LZMA_RUN);
 	if (ret != LZMA_STREAM_END) {
 		spdlog::error("Failed to decode lzma buffer result: {}", static_cast<int>(ret));
-		return false;
+		lzma_end(&stream);
+		return nullptr;
 	}
 
 	lzma_end(&stream); // free memory
@@ -182,11 +196,9 @@ bool SpriteAppearances::loadSpriteSheet(const SpriteSheetPtr &sheet) {
 		std::swap_ranges(itr1, itr1 + SPRITE_SHEET_WIDTH_BYTES, itr2);
 	}
 
-	sheet->data = std::make_unique<uint8_t[]>(LZMA_UNCOMPRESSED_SIZE);
-	std::memcpy(sheet->data.get(), pixelData, BYTES_IN_SPRITE_SHEET);
-
-	sheet->loaded = true;
-	return true;
+	auto data = std::make_unique<uint8_t[]>(LZMA_UNCOMPRESSED_SIZE);
+	std::memcpy(data.get(), pixelData, BYTES_IN_SPRITE_SHEET);
+	return data;
 }
 
 void SpriteAppearances::unload() {
@@ -307,52 +319,121 @@ wxImage SpriteAppearances::getWxImageBySpriteId(int id, bool toSavePng /* = fals
 	}
 
 	const int bgshade = g_settings.getInteger(Config::ICON_BACKGROUND);
-	constexpr uint32_t magenta = 0xFF00FF;
-	constexpr uint32_t lightMagenta = 0xD000CF;
 
-	const int width = sprite->size.height <= rme::SpritePixels && sprite->size.width <= rme::SpritePixels ? sprite->size.width : rme::SpritePixels + 32;
+	const int width = GetSpriteImageWidth(sprite->size.width, sprite->size.height);
 	const int height = sprite->size.height;
-	auto pixels = sprite->pixels.data();
-	wxImage image(width, height);
+	wxImage image(width, height, false);
 	image.InitAlpha();
-	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; ++x) {
-			const int index = (y * width + x) * 4;
-
-			// Starts with magenta color
-			uint8_t a = 255;
-			uint8_t r = 255;
-			uint8_t g = 0;
-			uint8_t b = 255;
-
-			// If index is inside pixels bounds applies the color of the sprite
-			if (sprite->pixels.size() > index) {
-				a = pixels[index + 3];
-				r = pixels[index + 2];
-				g = pixels[index + 1];
-				b = pixels[index];
-			}
+	ConvertSpritePixels(sprite->pixels.data(), sprite->pixels.size(), width * height, bgshade, image.GetData(), image.GetAlpha());
 
-			// Combines the color channels into a single 32-bit value
-			uint32_t color = (r << 16) | (g << 8) | b;
+	// Cut duplicated image and sets to the selected bgshade the empty background
+	if (sprite->size.width > rme::SpritePixels && sprite->size.height <= rme::SpritePixels) {
+		const auto imageSize = image.GetSize();
+		image.Resize(wxSize(imageSize.x, imageSize.y), wxPoint(-imageSize.x + rme::SpritePixels, 0), bgshade, bgshade, bgshade);
+	}
 
-			// Replaces magenta with the background color
-			if (color == magenta || color == lightMagenta) {
-				r = g = b = bgshade; // Sets RGB to the background color
+	return image;
+}
+
+void SpriteAppearances::preloadSpriteSheets(const std::vector<int> &spriteIds, std::function<void()> onLoaded) {
+	std::vector<SpriteSheetPtr> pending;
+	std::unordered_set<const SpriteSheet*> requested;
+	for (const int spriteId : spriteIds) {
+		const auto &sheet = getSheetBySpriteId(spriteId, false);
+		if (!sheet || sheet->data || !requested.emplace(sheet.get()).second) {
+			continue;
+		}
+
+		// A sheet an earlier request queued is not queued again, it calls both callbacks
+		auto [it, queued] = loadingSheets.try_emplace(sheet.get());
+		if (onLoaded) {
+			it->second.emplace_back(onLoaded);
+		}
+		if (queued) {
+			pending.emplace_back(sheet);
+		}
+	}
+
+	if (pending.empty()) {
+		return;
+	}
+
+	{
+		// The latest request is usually the page on screen, so it goes first
+		std::scoped_lock lock(sheetQueueMutex);
+		sheetQueue.insert(sheetQueue.begin(), pending.begin(), pending.end());
+	}
+
+	if (sheetLoaders.empty()) {
+		const size_t threadCount = std::max(g_settings.getInteger(Config::WORKER_THREADS), 1);
+		for (size_t i = 0; i < threadCount; ++i) {
+			sheetLoaders.emplace_back(&SpriteAppearances::runSheetLoader, this);
+		}
+	}
+	sheetQueueSignal.notify_all();
+}
+
+void SpriteAppearances::runSheetLoader() {
+	while (true) {
+		SpriteSheetPtr sheet;
+		{
+			std::unique_lock lock(sheetQueueMutex);
+			sheetQueueSignal.wait(lock, [this]() {
+				return cancelSheetLoader || !sheetQueue.empty();
+			});
+			if (cancelSheetLoader) {
+				return;
 			}
+			sheet = std::move(sheetQueue.front());
+			sheetQueue.pop_front();
+		}
 
-			image.SetAlpha(x, y, a);
-			image.SetRGB(x, y, r, g, b);
+		// wx needs a copyable functor, so the decoded sheet travels in a shared holder
+		auto data = std::make_shared<std::unique_ptr<uint8_t[]>>(decodeSpriteSheet(sheet->path));
+		if (cancelSheetLoader || !wxTheApp) {
+			return;
 		}
+
+		wxTheApp->CallAfter([this, sheet, data]() {
+			if (*data && !sheet->data) {
+				sheet->data = std::move(*data);
+				sheet->loaded = true;
+			}
+
+			const auto it = loadingSheets.find(sheet.get());
+			if (it == loadingSheets.end()) {
+				return;
+			}
+			const std::vector<std::function<void()>> callbacks = std::move(it->second);
+			loadingSheets.erase(it);
+			for (const auto &callback : callbacks) {
+				callback();
+			}
+		});
 	}
+}
 
-	// Cut duplicated image and sets to the selected bgshade the empty background
-	if (sprite->size.width > rme::SpritePixels && sprite->size.height <= rme::SpritePixels) {
-		const auto imageSize = image.GetSize();
-		image.Resize(wxSize(imageSize.x, imageSize.y), wxPoint(-imageSize.x + rme::SpritePixels, 0), bgshade, bgshade, bgshade);
+bool SpriteAppearances::isSpriteLoading(int spriteId) {
+	if (loadingSheets.empty()) {
+		return false;
 	}
+	const auto &sheet = getSheetBySpriteId(spriteId, false);
+	return sheet && loadingSheets.contains(sheet.get());
+}
 
-	return image;
+void SpriteAppearances::stopSheetLoader() {
+	{
+		std::scoped_lock lock(sheetQueueMutex);
+		cancelSheetLoader = true;
+		sheetQueue.clear();
+	}
+	sheetQueueSignal.notify_all();
+	for (std::thread &loader : sheetLoaders) {
+		loader.join();
+	}
+	sheetLoaders.clear();
+	cancelSheetLoader = false;
+	loadingSheets.clear();
 }
 
 SpritePtr SpriteAppearances::getSprite(int spriteId) {
@@ -363,6 +444,14 @@ SpritePtr SpriteAppearances::getSprite(int spriteId) {
 		return it->second;
 	}
 
+	SpritePtr sprite = loadSprite(spriteId);
+	if (sprite) {
+		sprites[spriteId] = sprite;
+	}
+	return sprite;
+}
+
+SpritePtr SpriteAppearances::loadSprite(int spriteId) {
 	// Retrieve sprite sheet
 	const auto &sheet = getSheetBySpriteId(spriteId);
 	if (!sheet || !sheet->loaded) {
@@ -444,8 +533,5 @@ SpritePtr SpriteAppearances::getSprite(int spriteId) {
 		std::ranges::copy(std::span(bufferData, spriteWidthBytes), dest);
 	}
 
-	// Cache the sprite
-	sprites[spriteId] = sprite;
-
 	return sprite;
 }
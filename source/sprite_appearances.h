@@ -22,6 +22,14 @@
 #include "main.h"
 #include "graphics.h"
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 class GameSprite;
 
@@ -164,6 +172,10 @@ using SpriteSheetPtr = std::shared_ptr<SpriteSheet>;
 //@bindsingleton g_spriteAppearances
 class SpriteAppearances {
 public:
+	~SpriteAppearances() {
+		stopSheetLoader();
+	}
+
 	void init();
 	void terminate();
 
@@ -172,6 +184,8 @@ public:
 	// sprites
 	void exportSpriteImage(int id, const std::string &path);
 	SpritePtr getSprite(int spriteId);
+	// Same as getSprite, without keeping the sprite in the cache
+	SpritePtr loadSprite(int spriteId);
 
 	int getSpritesCount() {
 		return spritesCount;
@@ -194,12 +208,21 @@ public:
 	*/
 	wxImage getWxImageBySpriteId(int id, bool toSavePng = false);
 
+	// Queues the unloaded sheets of the given sprites for the loader threads, ahead of the
+	// sheets queued before. Each sheet is installed on the UI thread as it completes, then
+	// onLoaded and the callbacks of earlier requests for the same sheet are called there.
+	void preloadSpriteSheets(const std::vector<int> &spriteIds, std::function<void()> onLoaded);
+	// True while the sheet of this sprite is queued by preloadSpriteSheets
+	bool isSpriteLoading(int spriteId);
+
 	const std::string getAppearanceFileName() const {
 		return appearanceFile;
 	}
 
 	bool loadCatalogContent(const std::string &dir, bool loadData = true);
 	bool loadSpriteSheet(const SpriteSheetPtr &sheet);
+	// Reads and decompresses a sheet file, safe to call from any thread
+	static std::unique_ptr<uint8_t[]> decodeSpriteSheet(const std::string &path);
 	void saveSheetToFileBySprite(int id, const std::string &file);
 	void saveSheetToFile(const SpriteSheetPtr &sheet, const std::string &file);
 	struct AtlasInfo {
@@ -219,10 +242,22 @@ public:
 	void saveSpriteToFile(int id, const std::string &file);
 
 private:
+	void runSheetLoader();
+	void stopSheetLoader();
+
 	int spritesCount = 0;
 	std::vector<SpriteSheetPtr> sheets;
 	std::map<int, SpritePtr> sprites;
 	std::string appearanceFile;
+
+	// Sheets queued by preloadSpriteSheets and the callbacks waiting on them, UI thread only
+	std::unordered_map<const SpriteSheet*, std::vector<std::function<void()>>> loadingSheets;
+	// Started by the first preloadSpriteSheets and kept until terminate
+	std::vector<std::thread> sheetLoaders;
+	std::deque<SpriteSheetPtr> sheetQueue;
+	std::mutex sheetQueueMutex;
+	std::condition_variable sheetQueueSignal;
+	std::atomic<bool> cancelSheetLoader = false;
 };
 
 extern SpriteAppearances g_spriteAppearances;
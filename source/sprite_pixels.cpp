@@ -0,0 +1,49 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "sprite_pixels.h"
+#include "const.h"
+
+#include <algorithm>
+
+int GetSpriteImageWidth(int width, int height) noexcept {
+	return height <= rme::SpritePixels && width <= rme::SpritePixels ? width : rme::SpritePixels + 32;
+}
+
+void ConvertSpritePixels(const uint8_t* pixels, size_t size, int count, uint8_t bgshade, uint8_t* rgb, uint8_t* alpha) noexcept {
+	constexpr uint32_t magenta = 0xFF00FF;
+	constexpr uint32_t lightMagenta = 0xD000CF;
+
+	// Pixels past the end of the sprite are magenta, which becomes the background below
+	const int available = std::min<size_t>(count, size / 4);
+	for (int i = 0; i < available; ++i, pixels += 4, rgb += 3) {
+		const uint32_t color = (pixels[2] << 16) | (pixels[1] << 8) | pixels[0];
+		if (color == magenta || color == lightMagenta) {
+			rgb[0] = rgb[1] = rgb[2] = bgshade;
+		} else {
+			rgb[0] = pixels[2];
+			rgb[1] = pixels[1];
+			rgb[2] = pixels[0];
+		}
+		alpha[i] = pixels[3];
+	}
+
+	if (available < count) {
+		std::fill(rgb, rgb + (count - available) * 3, bgshade);
+		std::fill(alpha + available, alpha + count, 255);
+	}
+}
@@ -0,0 +1,35 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_SPRITE_PIXELS_H_
+#define RME_SPRITE_PIXELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The pixel conversion behind SpriteAppearances::getWxImageBySpriteId, kept apart from wx
+// so the headless tests can check it.
+
+// Width of the image a sprite is converted to: sprites larger than one tile get a 64 pixel
+// wide image, which getWxImageBySpriteId crops to their right half when they are one tile tall
+int GetSpriteImageWidth(int width, int height) noexcept;
+
+// Writes count BGRA sprite pixels into wxImage RGB and alpha buffers: magenta and 0xD000CF
+// become bgshade, pixels past size are opaque bgshade
+void ConvertSpritePixels(const uint8_t* pixels, size_t size, int count, uint8_t bgshade, uint8_t* rgb, uint8_t* alpha) noexcept;
+
+#endif
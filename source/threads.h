@@ -20,6 +20,12 @@
 
 #include "main.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 class Thread : public wxThread {
 public:
 	Thread(wxThreadKind);
@@ -47,4 +53,41 @@ inline void Thread::Execute() {
 	Run();
 }
 
+// Calls job(index) for every index below count on up to threadCount threads, in no
+// particular order. The calling thread waits and calls progress(done) about every
+// 16ms so it can keep a load bar going. With a single thread the jobs run inline.
+template <typename Job, typename Progress>
+void RunParallelJobs(size_t count, size_t threadCount, Job &&job, Progress &&progress) {
+	threadCount = std::min(threadCount, count);
+	if (threadCount <= 1) {
+		for (size_t index = 0; index < count; ++index) {
+			progress(index);
+			job(index);
+		}
+		return;
+	}
+
+	std::atomic<size_t> next = 0;
+	std::atomic<size_t> done = 0;
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		workers.emplace_back([&]() {
+			for (size_t index = next++; index < count; index = next++) {
+				job(index);
+				++done;
+			}
+		});
+	}
+
+	while (done < count) {
+		progress(done.load());
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+	}
+
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+}
+
 #endif
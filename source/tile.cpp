@@ -139,12 +139,6 @@ int Tile::size() const {
 		if (location->getHouseExits()) {
 			++sz;
 		}
-		if (location->getSpawnMonsterCount()) {
-			++sz;
-		}
-		if (location->getSpawnNpcCount()) {
-			++sz;
-		}
 		if (location->getWaypointCount()) {
 			++sz;
 		}
@@ -200,6 +194,47 @@ void Tile::merge(Tile* other) {
 	other->items.clear();
 }
 
+void Tile::mergeCopy(const Tile* other) {
+	if (!other) {
+		return;
+	}
+
+	if (other->isPZ()) {
+		setPZ(true);
+	}
+	if (other->house_id) {
+		house_id = other->house_id;
+	}
+
+	if (other->ground) {
+		delete ground;
+		ground = other->ground->deepCopy();
+	}
+
+	if (other->spawnMonster) {
+		delete spawnMonster;
+		spawnMonster = other->spawnMonster->deepCopy();
+	}
+
+	if (other->npc) {
+		delete npc;
+		npc = other->npc->deepCopy();
+	}
+
+	if (other->spawnNpc) {
+		delete spawnNpc;
+		spawnNpc = other->spawnNpc->deepCopy();
+	}
+
+	for (const auto monster : other->monsters) {
+		addMonster(monster->deepCopy());
+	}
+
+	for (const Item* item : other->items) {
+		addItem(item->deepCopy());
+	}
+}
+
 bool Tile::hasProperty(enum ITEMPROPERTY prop) const {
 	if (prop == PROTECTIONZONE && isPZ()) {
 		return true;
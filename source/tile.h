@@ -101,6 +101,8 @@ public:
 public: // Functions
 	// Absorb the other tile into this tile
 	void merge(Tile* other);
+	// Same as merge, but adds copies and leaves the other tile untouched
+	void mergeCopy(const Tile* other);
 
 	// Has tile been modified since the map was loaded/created?
 	bool isModified() const {
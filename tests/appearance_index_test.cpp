@@ -0,0 +1,137 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "appearance_index.h"
+
+#include <appearances.pb.h>
+
+namespace {
+	using rme::protobuf::appearances::Appearance;
+	using rme::protobuf::appearances::Appearances;
+	using AppearanceList = google::protobuf::RepeatedPtrField<Appearance>;
+
+	void fillAppearance(Appearance* appearance, uint32_t id, uint32_t sprites) {
+		appearance->set_id(id);
+		appearance->set_name("appearance " + std::to_string(id));
+		// Nested ids must not be taken for the id of the appearance
+		rme::protobuf::appearances::FrameGroup* group = appearance->add_frame_group();
+		group->set_id(id + 1000);
+		group->mutable_sprite_info()->set_layers(1 + id % 2);
+		for (uint32_t i = 0; i < sprites; ++i) {
+			group->mutable_sprite_info()->add_sprite_id(id * 16 + i);
+		}
+		group->mutable_sprite_info()->mutable_animation()->add_sprite_phase()->set_duration_min(100 + id);
+		appearance->mutable_flags()->set_bottom(id % 3 == 0);
+	}
+
+	// Some of everything the client file holds, in the order the client writes it
+	Appearances makeAppearances() {
+		Appearances appearances;
+		for (uint32_t id = 100; id < 400; ++id) {
+			fillAppearance(appearances.add_object(), id, id % 5);
+		}
+		for (uint32_t id = 1; id < 150; ++id) {
+			fillAppearance(appearances.add_outfit(), id, 8 + id % 24);
+		}
+		for (uint32_t id = 1; id < 40; ++id) {
+			fillAppearance(appearances.add_effect(), id, 3);
+		}
+		for (uint32_t id = 1; id < 20; ++id) {
+			fillAppearance(appearances.add_missile(), id, 9);
+		}
+		appearances.mutable_special_meaning_appearance_ids()->set_gold_coin_id(3031);
+		return appearances;
+	}
+
+	// Decoding an entry later has to give the appearance a full parse gives right away
+	void compareWithEager(const AppearanceIndex &index, const std::vector<AppearanceIndex::Entry> &entries, const AppearanceList &eager) {
+		REQUIRE(entries.size() == static_cast<size_t>(eager.size()));
+		for (size_t i = 0; i < entries.size(); ++i) {
+			CHECK_EQ(entries[i].id, eager.Get(i).id());
+			Appearance lazy;
+			CHECK(index.decode(entries[i], lazy));
+			CHECK(lazy.SerializeAsString() == eager.Get(i).SerializeAsString());
+		}
+	}
+}
+
+TEST_CASE(appearance_index_matches_eager_parse) {
+	const std::string data = makeAppearances().SerializeAsString();
+	Appearances eager;
+	REQUIRE(eager.ParseFromString(data));
+
+	AppearanceIndex index;
+	REQUIRE(index.load(data));
+	CHECK(index.isLoaded());
+	compareWithEager(index, index.getObjects(), eager.object());
+	compareWithEager(index, index.getOutfits(), eager.outfit());
+	compareWithEager(index, index.getEffects(), eager.effect());
+	compareWithEager(index, index.getMissiles(), eager.missile());
+
+	index.clear();
+	CHECK(!index.isLoaded());
+	CHECK(index.getOutfits().empty());
+}
+
+TEST_CASE(appearance_index_last_id_wins) {
+	// Two encodings of one appearance back to back merge into one, like protobuf does
+	Appearance first;
+	first.set_id(5);
+	Appearance second;
+	second.set_id(9);
+	const std::string merged = first.SerializeAsString() + second.SerializeAsString();
+
+	std::string data;
+	data.push_back(static_cast<char>((2 << 3) | 2)); // outfit, length delimited
+	data.push_back(static_cast<char>(merged.size()));
+	data += merged;
+
+	Appearances eager;
+	REQUIRE(eager.ParseFromString(data));
+	REQUIRE(eager.outfit_size() == 1);
+
+	AppearanceIndex index;
+	REQUIRE(index.load(data));
+	compareWithEager(index, index.getOutfits(), eager.outfit());
+	CHECK_EQ(index.getOutfits().front().id, 9u);
+}
+
+TEST_CASE(appearance_index_rejects_malformed_files) {
+	const std::string data = makeAppearances().SerializeAsString();
+	Appearances eager;
+
+	// Cut off inside the last appearance
+	const std::string truncated = data.substr(0, data.size() - 1);
+	CHECK(!eager.ParseFromString(truncated));
+	AppearanceIndex index;
+	CHECK(!index.load(truncated));
+	CHECK(!index.isLoaded());
+	CHECK(index.getObjects().empty());
+
+	// A varint that never ends
+	CHECK(!index.load(std::string(12, static_cast<char>(0xFF))));
+	CHECK(!index.isLoaded());
+
+	// A field number the index doesn't know is skipped, as protobuf does
+	std::string unknown = data;
+	unknown.push_back(static_cast<char>((15 << 3) | 0));
+	unknown.push_back(1);
+	REQUIRE(eager.ParseFromString(unknown));
+	CHECK(index.load(unknown));
+	compareWithEager(index, index.getObjects(), eager.object());
+}
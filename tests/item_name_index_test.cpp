@@ -0,0 +1,156 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "item_name_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+
+namespace {
+	constexpr uint16_t IndexedIdLimit = 3000;
+
+	struct IndexedItem {
+		std::string brushName;
+		std::string itemName;
+		// What the dialog compared the search text with
+		std::string lowerBrushName;
+		ItemNameIndex::FlagMask flags = 0;
+	};
+
+	std::string lowerName(std::string text) {
+		std::ranges::transform(text, text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return text;
+	}
+
+	int getRank(const IndexedItem &item, const std::string &query) {
+		const std::string name = lowerName(item.itemName);
+		return name == query ? 0 : name.starts_with(query) ? 1 : 2;
+	}
+
+	// Random items over a small alphabet, so that queries hit often and trigrams repeat
+	std::vector<IndexedItem> createItems(std::mt19937 &random, ItemNameIndex &index) {
+		constexpr char alphabet[] = "abcdeXY -";
+		std::vector<IndexedItem> items(IndexedIdLimit);
+		for (uint16_t id = 100; id < IndexedIdLimit; id += 1 + random() % 3) {
+			std::string name;
+			for (int length = random() % 12; length > 0; --length) {
+				name += alphabet[random() % (sizeof(alphabet) - 1)];
+			}
+			IndexedItem &item = items[id];
+			item.itemName = name;
+			item.brushName = std::to_string(id) + " - " + name;
+			item.lowerBrushName = lowerName(item.brushName);
+			item.flags = static_cast<ItemNameIndex::FlagMask>(random()) & ((ItemNameIndex::FlagMask(1) << ItemNameIndex::FlagCount) - 1);
+			index.add(id, item.brushName, item.itemName, item.flags);
+		}
+		return items;
+	}
+
+	bool hasFlags(const IndexedItem &item, ItemNameIndex::FlagMask flags) {
+		return !item.brushName.empty() && (item.flags & flags) == flags;
+	}
+
+	// Some masks that match a lot of items, some that match a few
+	ItemNameIndex::FlagMask randomMask(std::mt19937 &random) {
+		ItemNameIndex::FlagMask flags = 0;
+		for (int count = random() % 4; count > 0; --count) {
+			flags |= ItemNameIndex::mask(static_cast<ItemNameIndex::Flag>(random() % ItemNameIndex::FlagCount));
+		}
+		return flags;
+	}
+}
+
+TEST_CASE(item_name_index_find_by_name) {
+	std::mt19937 random(7);
+	ItemNameIndex index;
+	const std::vector<IndexedItem> items = createItems(random, index);
+
+	constexpr char alphabet[] = "abcdeXY -";
+	size_t matches = 0;
+	for (int query = 0; query < 20000; ++query) {
+		std::string text;
+		for (int length = 1 + random() % 6; length > 0; --length) {
+			text += alphabet[random() % (sizeof(alphabet) - 1)];
+		}
+		const ItemNameIndex::FlagMask flags = randomMask(random);
+
+		// What the find item dialog did before the index: every item, in id order
+		const std::string lower = lowerName(text);
+		std::vector<uint16_t> expected;
+		for (uint16_t id = 0; id < IndexedIdLimit; ++id) {
+			if (hasFlags(items[id], flags) && items[id].lowerBrushName.find(lower) != std::string::npos) {
+				expected.push_back(id);
+			}
+		}
+
+		const std::vector<uint16_t> found = index.findByName(text, flags);
+		std::vector<uint16_t> sorted = found;
+		std::ranges::sort(sorted);
+		CHECK(sorted == expected);
+		matches += found.size();
+
+		// Exact names first, then prefixes, the rest in id order
+		for (size_t i = 1; i < found.size(); ++i) {
+			const int previous = getRank(items[found[i - 1]], lower);
+			const int current = getRank(items[found[i]], lower);
+			CHECK(previous < current || (previous == current && found[i - 1] < found[i]));
+		}
+	}
+	CHECK(matches > 0);
+}
+
+TEST_CASE(item_name_index_flags) {
+	std::mt19937 random(29);
+	ItemNameIndex index;
+	const std::vector<IndexedItem> items = createItems(random, index);
+
+	for (int round = 0; round < 200; ++round) {
+		const ItemNameIndex::FlagMask flags = round == 0 ? 0 : randomMask(random);
+		std::vector<uint16_t> expected;
+		for (uint16_t id = 0; id < IndexedIdLimit; ++id) {
+			if (hasFlags(items[id], flags)) {
+				expected.push_back(id);
+			}
+			CHECK_EQ(index.contains(id, flags), hasFlags(items[id], flags));
+		}
+		CHECK(index.find(flags) == expected);
+	}
+
+	// Past the highest id
+	CHECK(!index.contains(IndexedIdLimit + 100, 0));
+
+	index.clear();
+	CHECK_EQ(index.size(), size_t(0));
+	CHECK(index.find(0).empty());
+	CHECK(index.findByName("abc", 0).empty());
+}
+
+BENCHMARK(item_name_index_queries) {
+	std::mt19937 random(31);
+	ItemNameIndex index;
+	const std::vector<IndexedItem> items = createItems(random, index);
+
+	size_t found = 0;
+	rme::test::measure("findByName, 20000 queries", 20000, [&]() {
+		for (int query = 0; query < 20000; ++query) {
+			found += index.findByName(query % 2 ? "abc" : "XY -", 0).size();
+		}
+	});
+	CHECK(found > 0);
+}
@@ -0,0 +1,241 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "lua_scanner.h"
+
+#include <random>
+#include <regex>
+
+namespace {
+	// A monster the way the server ships them: the outfit fields appear in comments,
+	// strings with escaped quotes and nested tables before and after the real ones
+	const std::string LuaMonsterSample = R"lua(local mType = Game.createMonsterType("Dragon Lord")
+local monster = {}
+
+monster.description = "a dragon lord" -- says "lookType = 1" \"quoted\"
+monster.experience = 2100
+--[[ the old client used
+monster.outfit = { lookType = 12, lookHead = 3 }
+]]
+monster.outfit = {
+	lookType = 39, -- lookType = 40 on older servers
+	lookHead=0,
+	lookBody = 	114,
+	lookLegs = -1,
+	lookFeet = 0,
+	lookAddons = 3,
+	lookMount = 0
+}
+
+monster.events = { { name = "lookTypeEx = 5" }, { inner = { lookFeet = 7 } } }
+monster.health = 1900
+monster.speed = -10
+monster.flags = { summonable = false, attackable = true, lookTypeExtra = 9 }
+monster.loot = {
+	{ name = "gold coin", chance = 100000, maxCount = 100 },
+	{ id = 3031, chance = 50000, maxCount = 45 }, -- gold coin
+}
+mType:register(monster)
+)lua";
+
+	// An npc naming itself through variables, with decoys in strings and comments
+	const std::string LuaNpcSample = R"lua(local internalNpcName = "Sam"
+local npcType = Game.createNpcType(internalNpcName)
+local npcConfig = {}
+-- npcConfig.name = commentedName
+local greeting = "npcConfig.name = fromString \" local fake = 1"
+	npcName = "Samuel"
+internalNpcName="Sam the \"Smith\""
+npcConfig.name = "Sam"
+npcConfig.name = internalNpcName
+npcConfig.description=internalNpcName
+
+npcConfig.outfit = {
+	lookType = 128,
+	lookHead = 17, lookBody = 54,
+	lookLegs = 114,
+	lookFeet = 0,
+	lookAddons = 0
+}
+local shop = { { itemName = "axe", clientId = 3274, buy = 20 }, { nested = { local_value = 3 } } }
+localVariable = 5
+local  spaced   =   "value"
+local a, b = 1, 2
+Game.createNpcType ( npcName )
+npcType:register(npcConfig)
+)lua";
+
+	const char* const IntegerFields[] = { "lookType", "lookItem", "lookTypeEx", "lookitem", "lookMount", "lookAddons", "lookAddon", "lookHead", "lookBody", "lookLegs", "lookFeet" };
+
+	// The regular expressions the importers used before LuaScanner
+	bool regexIntegerField(const std::string &content, size_t field, int &value) {
+		static const std::vector<std::regex> patterns = []() {
+			std::vector<std::regex> compiled;
+			for (const char* name : IntegerFields) {
+				compiled.emplace_back("\\b" + std::string(name) + "\\b\\s*=\\s*(-?\\d+)");
+			}
+			return compiled;
+		}();
+
+		std::smatch match;
+		const std::regex &pattern = patterns[field];
+		if (!std::regex_search(content, match, pattern)) {
+			return false;
+		}
+		value = std::stoi(match[1].str());
+		return true;
+	}
+
+	bool regexAssignedIdentifier(const std::string &content, std::string &identifier) {
+		static const std::regex pattern(R"(\bnpcConfig\.name\s*=\s*([A-Za-z_]\w*))");
+		std::smatch match;
+		if (!std::regex_search(content, match, pattern)) {
+			return false;
+		}
+		identifier = match[1].str();
+		return true;
+	}
+
+	bool regexCalledIdentifier(const std::string &content, std::string &identifier) {
+		static const std::regex pattern(R"(\bGame\.createNpcType\s*\(\s*([A-Za-z_]\w*)\s*\))");
+		std::smatch match;
+		if (!std::regex_search(content, match, pattern)) {
+			return false;
+		}
+		identifier = match[1].str();
+		return true;
+	}
+
+	std::vector<std::pair<std::string, size_t>> regexLocalAssignments(const std::string &content) {
+		static const std::regex pattern(R"(\blocal\s+([A-Za-z_]\w*)\s*=)");
+		std::vector<std::pair<std::string, size_t>> assignments;
+		for (std::sregex_iterator it(content.begin(), content.end(), pattern), end; it != end; ++it) {
+			assignments.emplace_back((*it)[1].str(), it->position() + it->length());
+		}
+		return assignments;
+	}
+
+	std::vector<size_t> regexLineAssignments(const std::string &content, const std::string &name) {
+		static const std::regex pattern(R"((?:^|[\r\n])\s*(internalNpcName|npcName)\s*=)");
+		std::vector<size_t> assignments;
+		for (std::sregex_iterator it(content.begin(), content.end(), pattern), end; it != end; ++it) {
+			if ((*it)[1].str() == name) {
+				assignments.push_back(it->position() + it->length());
+			}
+		}
+		return assignments;
+	}
+
+	void compareWithRegex(const std::string &content) {
+		for (size_t field = 0; field < std::size(IntegerFields); ++field) {
+			int expected = 0;
+			int found = 0;
+			const bool expectedFound = regexIntegerField(content, field, expected);
+			CHECK_EQ(LuaScanner::findIntegerField(content, IntegerFields[field], found), expectedFound);
+			if (expectedFound) {
+				CHECK_EQ(found, expected);
+			}
+		}
+
+		std::string expectedName;
+		std::string foundName;
+		bool expectedFound = regexAssignedIdentifier(content, expectedName);
+		CHECK_EQ(LuaScanner::findAssignedIdentifier(content, "npcConfig.name", foundName), expectedFound);
+		CHECK_EQ(foundName, expectedName);
+
+		expectedName.clear();
+		foundName.clear();
+		expectedFound = regexCalledIdentifier(content, expectedName);
+		CHECK_EQ(LuaScanner::findCalledIdentifier(content, "Game.createNpcType", foundName), expectedFound);
+		CHECK_EQ(foundName, expectedName);
+
+		CHECK(LuaScanner::findLocalAssignments(content) == regexLocalAssignments(content));
+		for (const char* name : { "internalNpcName", "npcName" }) {
+			CHECK(LuaScanner::findLineAssignments(content, name) == regexLineAssignments(content, name));
+		}
+	}
+}
+
+TEST_CASE(lua_scanner_monster_sample) {
+	compareWithRegex(LuaMonsterSample);
+
+	// The first match wins, even inside a string or a comment, like the regular expressions
+	int value = 0;
+	CHECK(LuaScanner::findIntegerField(LuaMonsterSample, "lookType", value));
+	CHECK_EQ(value, 1);
+	CHECK(LuaScanner::findIntegerField(LuaMonsterSample, "lookLegs", value));
+	CHECK_EQ(value, -1);
+	CHECK(LuaScanner::findIntegerField(LuaMonsterSample, "lookBody", value));
+	CHECK_EQ(value, 114);
+	// lookTypeExtra is not lookTypeEx
+	CHECK(LuaScanner::findIntegerField(LuaMonsterSample, "lookTypeEx", value));
+	CHECK_EQ(value, 5);
+	CHECK(!LuaScanner::findIntegerField(LuaMonsterSample, "lookItem", value));
+
+	// The importer only scans the outfit table
+	const size_t outfit = LuaMonsterSample.find("monster.outfit = {\n");
+	const std::string outfitBlock = LuaMonsterSample.substr(outfit, LuaMonsterSample.find('}', outfit) - outfit + 1);
+	compareWithRegex(outfitBlock);
+	CHECK(LuaScanner::findIntegerField(outfitBlock, "lookType", value));
+	CHECK_EQ(value, 39);
+	CHECK(LuaScanner::findIntegerField(outfitBlock, "lookHead", value));
+	CHECK_EQ(value, 0);
+	CHECK(LuaScanner::findIntegerField(outfitBlock, "lookAddons", value));
+	CHECK_EQ(value, 3);
+	CHECK(!LuaScanner::findIntegerField(outfitBlock, "lookAddon", value));
+}
+
+TEST_CASE(lua_scanner_npc_sample) {
+	compareWithRegex(LuaNpcSample);
+
+	std::string identifier;
+	CHECK(LuaScanner::findAssignedIdentifier(LuaNpcSample, "npcConfig.name", identifier));
+	CHECK_EQ(identifier, "commentedName");
+	CHECK(LuaScanner::findCalledIdentifier(LuaNpcSample, "Game.createNpcType", identifier));
+	CHECK_EQ(identifier, "internalNpcName");
+
+	const auto locals = LuaScanner::findLocalAssignments(LuaNpcSample);
+	std::vector<std::string> names;
+	for (const auto &[name, pos] : locals) {
+		names.push_back(name);
+	}
+	const std::vector<std::string> expected = { "internalNpcName", "npcType", "npcConfig", "greeting", "fake", "shop", "spaced" };
+	CHECK(names == expected);
+	CHECK_EQ(LuaScanner::findLineAssignments(LuaNpcSample, "npcName").size(), size_t(1));
+	CHECK_EQ(LuaScanner::findLineAssignments(LuaNpcSample, "internalNpcName").size(), size_t(1));
+}
+
+TEST_CASE(lua_scanner_random_fragments) {
+	// Pieces of the constructs above glued at random, so the edge cases of each pattern meet
+	const std::vector<std::string> fragments = {
+		"local", " ", "  ", "\t", "\n", "\r\n", "=", "==", "npcName", "internalNpcName", "lookType", "lookTypeEx",
+		"lookAddon", "lookAddons", "npcConfig.name", "npcConfig", ".name", "Game.createNpcType", "Game", "(", ")",
+		"abc", "_x1", "9y", "12", "-", "-7", "0", "\"", "\\\"", "--", "--[[", "]]", "{", "}", "x", ".", ",", "_"
+	};
+
+	std::mt19937 random(5);
+	std::uniform_int_distribution<size_t> pick(0, fragments.size() - 1);
+	std::uniform_int_distribution<int> length(1, 40);
+	for (int i = 0; i < 3000; ++i) {
+		std::string content;
+		for (int count = length(random); count > 0; --count) {
+			content += fragments[pick(random)];
+		}
+		compareWithRegex(content);
+	}
+}
@@ -0,0 +1,159 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "minimap_cache.h"
+
+#include <array>
+#include <random>
+
+namespace {
+	using Rgba = std::array<uint8_t, 4>;
+
+	Rgba getPixel(const std::vector<uint8_t> &pixels, int x, int y) {
+		const uint8_t* pixel = pixels.data() + (y * MinimapCache::BlockSize + x) * 4;
+		return { pixel[0], pixel[1], pixel[2], pixel[3] };
+	}
+
+	// One output pixel of downsample, written out the long way
+	Rgba averageSamples(const std::array<Rgba, 4> &samples) {
+		int alpha = 0;
+		std::array<int, 3> color {};
+		for (const Rgba &sample : samples) {
+			for (int channel = 0; channel < 3; ++channel) {
+				color[channel] += sample[channel] * sample[3];
+			}
+			alpha += sample[3];
+		}
+		if (alpha == 0) {
+			return { 0, 0, 0, 0 };
+		}
+		return { uint8_t(color[0] / alpha), uint8_t(color[1] / alpha), uint8_t(color[2] / alpha), uint8_t((alpha + 2) / 4) };
+	}
+
+	std::vector<uint8_t> randomBlock(std::mt19937 &random, double coverage) {
+		std::bernoulli_distribution drawn(coverage);
+		std::uniform_int_distribution<int> color(1, 255);
+		std::vector<uint8_t> pixels(MinimapCache::BlockPixels * 4, 0);
+		for (int y = 0; y < MinimapCache::BlockSize; ++y) {
+			for (int x = 0; x < MinimapCache::BlockSize; ++x) {
+				if (drawn(random)) {
+					MinimapCache::setPixel(pixels.data(), x, y, static_cast<uint8_t>(color(random)));
+				}
+			}
+		}
+		return pixels;
+	}
+}
+
+TEST_CASE(minimap_cache_palette) {
+	// Color 0 is see-through, the 6x6x6 cube follows, anything past it is drawn black
+	uint8_t rgba[4];
+	MinimapCache::getColor(0, rgba);
+	CHECK((Rgba { rgba[0], rgba[1], rgba[2], rgba[3] } == Rgba { 0, 0, 0, 0 }));
+
+	for (int color = 1; color < 256; ++color) {
+		MinimapCache::getColor(static_cast<uint8_t>(color), rgba);
+		const Rgba expected = color < 216 ? Rgba { uint8_t(color / 36 * 51), uint8_t(color / 6 % 6 * 51), uint8_t(color % 6 * 51), 255 } : Rgba { 0, 0, 0, 255 };
+		CHECK((Rgba { rgba[0], rgba[1], rgba[2], rgba[3] } == expected));
+	}
+
+	// Two entries of the cube worked out by hand
+	MinimapCache::getColor(24, rgba);
+	CHECK((Rgba { rgba[0], rgba[1], rgba[2], rgba[3] } == Rgba { 0, 204, 0, 255 }));
+	MinimapCache::getColor(40, rgba);
+	CHECK((Rgba { rgba[0], rgba[1], rgba[2], rgba[3] } == Rgba { 51, 0, 204, 255 }));
+}
+
+TEST_CASE(minimap_cache_set_pixel) {
+	std::vector<uint8_t> pixels(MinimapCache::BlockPixels * 4, 0);
+	MinimapCache::setPixel(pixels.data(), 0, 0, 24);
+	MinimapCache::setPixel(pixels.data(), MinimapCache::BlockSize - 1, 3, 40);
+	MinimapCache::setPixel(pixels.data(), 7, MinimapCache::BlockSize - 1, 215);
+
+	size_t drawn = 0;
+	for (int y = 0; y < MinimapCache::BlockSize; ++y) {
+		for (int x = 0; x < MinimapCache::BlockSize; ++x) {
+			drawn += getPixel(pixels, x, y)[3] != 0;
+		}
+	}
+	CHECK_EQ(drawn, size_t(3));
+	CHECK((getPixel(pixels, 0, 0) == Rgba { 0, 204, 0, 255 }));
+	CHECK((getPixel(pixels, MinimapCache::BlockSize - 1, 3) == Rgba { 51, 0, 204, 255 }));
+	CHECK((getPixel(pixels, 7, MinimapCache::BlockSize - 1) == Rgba { 255, 255, 255, 255 }));
+}
+
+TEST_CASE(minimap_cache_downsample) {
+	std::mt19937 random(19);
+	const std::vector<uint8_t> dense = randomBlock(random, 0.9);
+	const std::vector<uint8_t> sparse = randomBlock(random, 0.05);
+	const std::vector<uint8_t> full = randomBlock(random, 1.0);
+
+	// Top right is an empty block
+	const uint8_t* const sources[4] = { dense.data(), nullptr, sparse.data(), full.data() };
+	std::vector<uint8_t> pixels(MinimapCache::BlockPixels * 4, 0xCD);
+	CHECK(MinimapCache::downsample(sources, pixels.data()));
+
+	constexpr int half = MinimapCache::BlockSize / 2;
+	for (int quadrant = 0; quadrant < 4; ++quadrant) {
+		const uint8_t* source = sources[quadrant];
+		const int offset_x = (quadrant & 1) * half;
+		const int offset_y = (quadrant >> 1) * half;
+		for (int y = 0; y < half; ++y) {
+			for (int x = 0; x < half; ++x) {
+				Rgba expected { 0, 0, 0, 0 };
+				if (source) {
+					std::array<Rgba, 4> samples;
+					for (int i = 0; i < 4; ++i) {
+						const uint8_t* sample = source + ((y * 2 + i / 2) * MinimapCache::BlockSize + x * 2 + i % 2) * 4;
+						samples[i] = { sample[0], sample[1], sample[2], sample[3] };
+					}
+					expected = averageSamples(samples);
+				}
+				CHECK((getPixel(pixels, offset_x + x, offset_y + y) == expected));
+			}
+		}
+	}
+
+	// Nothing drawn anywhere
+	const std::vector<uint8_t> empty(MinimapCache::BlockPixels * 4, 0);
+	const uint8_t* const emptySources[4] = { nullptr, empty.data(), nullptr, nullptr };
+	CHECK(!MinimapCache::downsample(emptySources, pixels.data()));
+}
+
+TEST_CASE(minimap_cache_downsample_weights_by_coverage) {
+	// One red tile out of four keeps its color and becomes a quarter as opaque
+	std::vector<uint8_t> block(MinimapCache::BlockPixels * 4, 0);
+	MinimapCache::setPixel(block.data(), 1, 1, 180);
+	const uint8_t* const sources[4] = { block.data(), nullptr, nullptr, nullptr };
+	std::vector<uint8_t> pixels(MinimapCache::BlockPixels * 4, 0);
+	CHECK(MinimapCache::downsample(sources, pixels.data()));
+	CHECK((getPixel(pixels, 0, 0) == Rgba { 255, 0, 0, 64 }));
+	CHECK((getPixel(pixels, 1, 0) == Rgba { 0, 0, 0, 0 }));
+}
+
+BENCHMARK(minimap_cache_levels) {
+	std::mt19937 random(23);
+	const std::vector<uint8_t> block = randomBlock(random, 0.7);
+	const uint8_t* const sources[4] = { block.data(), block.data(), block.data(), block.data() };
+	std::vector<uint8_t> pixels(MinimapCache::BlockPixels * 4);
+	rme::test::measure("downsample 256 blocks", 256, [&]() {
+		for (int i = 0; i < 256; ++i) {
+			MinimapCache::downsample(sources, pixels.data());
+		}
+	});
+}
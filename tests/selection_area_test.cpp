@@ -0,0 +1,205 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "selection_area.h"
+
+#include <random>
+#include <set>
+#include <tuple>
+
+namespace {
+	using PositionKey = std::tuple<int, int, int>;
+
+	PositionKey getKey(const Position &position) {
+		return { position.z, position.y, position.x };
+	}
+
+	// The same edits on a plain set of positions
+	struct PositionSet {
+		std::set<PositionKey> positions;
+
+		void add(const SelectionRect &rect) {
+			for (int y = std::max(rect.start_y, 0); y <= std::min(rect.end_y, rme::MapMaxHeight); ++y) {
+				for (int x = std::max(rect.start_x, 0); x <= std::min(rect.end_x, rme::MapMaxWidth); ++x) {
+					positions.emplace(rect.z, y, x);
+				}
+			}
+		}
+		void subtract(const SelectionRect &rect) {
+			for (int y = rect.start_y; y <= rect.end_y; ++y) {
+				for (int x = rect.start_x; x <= rect.end_x; ++x) {
+					positions.erase({ rect.z, y, x });
+				}
+			}
+		}
+	};
+
+	SelectionRect randomRect(std::mt19937 &random, int size) {
+		std::uniform_int_distribution<int> coordinate(0, size);
+		std::uniform_int_distribution<int> extent(0, size / 3);
+		std::uniform_int_distribution<int> floor(6, 7);
+		const int x = coordinate(random);
+		const int y = coordinate(random);
+		return { x, y, x + extent(random), y + extent(random), floor(random) };
+	}
+
+	void compareWithSet(const SelectionArea &area, const PositionSet &expected, int size) {
+		CHECK_EQ(area.count(), uint64_t(expected.positions.size()));
+
+		// Every position once, nothing outside of the set
+		std::set<PositionKey> visited;
+		size_t visits = 0;
+		area.forEachPosition([&](const Position &position) {
+			visited.insert(getKey(position));
+			++visits;
+		});
+		CHECK_EQ(visits, expected.positions.size());
+		CHECK(visited == expected.positions);
+
+		for (const SelectionRect &rect : area.getRects()) {
+			CHECK(!rect.empty());
+			for (const SelectionRect &other : area.getRects()) {
+				CHECK(&rect == &other || !rect.intersects(other));
+			}
+		}
+
+		for (int z = 6; z <= 7; ++z) {
+			for (int y = -1; y <= size + size / 3 + 1; ++y) {
+				for (int x = -1; x <= size + size / 3 + 1; ++x) {
+					CHECK_EQ(area.contains(Position(x, y, z)), expected.positions.contains({ z, y, x }));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(selection_area_add_and_subtract) {
+	constexpr int size = 60;
+	std::mt19937 random(13);
+	std::bernoulli_distribution adding(0.6);
+
+	for (int round = 0; round < 20; ++round) {
+		SelectionArea area;
+		PositionSet expected;
+		for (int edit = 0; edit < 25; ++edit) {
+			const SelectionRect rect = randomRect(random, size);
+			if (adding(random)) {
+				area.add(rect);
+				expected.add(rect);
+			} else {
+				area.subtract(rect);
+				expected.subtract(rect);
+			}
+		}
+		compareWithSet(area, expected, size);
+	}
+}
+
+TEST_CASE(selection_area_from_positions) {
+	constexpr int size = 40;
+	std::mt19937 random(17);
+	std::bernoulli_distribution taken(0.35);
+
+	for (int round = 0; round < 20; ++round) {
+		// Scattered positions and a few solid boxes, with duplicates and in random order
+		std::vector<Position> positions;
+		PositionSet expected;
+		for (int z = 6; z <= 7; ++z) {
+			for (int y = 0; y < size; ++y) {
+				for (int x = 0; x < size; ++x) {
+					if (taken(random)) {
+						positions.emplace_back(x, y, z);
+						expected.positions.emplace(z, y, x);
+					}
+				}
+			}
+		}
+		for (int box = 0; box < 3; ++box) {
+			const SelectionRect rect = randomRect(random, size);
+			expected.add(rect);
+			for (int y = rect.start_y; y <= rect.end_y; ++y) {
+				for (int x = rect.start_x; x <= rect.end_x; ++x) {
+					positions.emplace_back(x, y, rect.z);
+				}
+			}
+		}
+		std::shuffle(positions.begin(), positions.end(), random);
+
+		const SelectionArea area = SelectionArea::fromPositions(positions);
+		compareWithSet(area, expected, size);
+
+		// Taking the rectangles back gives the same area
+		const SelectionArea copy = SelectionArea::fromDisjointRects(area.getRects());
+		compareWithSet(copy, expected, size);
+	}
+}
+
+TEST_CASE(selection_area_merges_boxes) {
+	// A solid box comes back as a single rectangle
+	std::vector<Position> positions;
+	for (int y = 10; y < 20; ++y) {
+		for (int x = 5; x < 30; ++x) {
+			positions.emplace_back(x, y, 7);
+		}
+	}
+	const SelectionArea area = SelectionArea::fromPositions(positions);
+	REQUIRE(area.getRects().size() == 1);
+	const SelectionRect &rect = area.getRects().front();
+	CHECK(rect.start_x == 5 && rect.start_y == 10 && rect.end_x == 29 && rect.end_y == 19 && rect.z == 7);
+}
+
+TEST_CASE(selection_area_clamps_to_the_map) {
+	SelectionArea area;
+	area.add({ -5, -5, 2, 3, 7 });
+	CHECK_EQ(area.count(), uint64_t(12));
+	CHECK(area.contains(Position(0, 0, 7)));
+	CHECK(!area.contains(Position(-1, 0, 7)));
+
+	area.add({ rme::MapMaxWidth - 1, 0, rme::MapMaxWidth + 10, 0, 7 });
+	CHECK_EQ(area.count(), uint64_t(14));
+
+	// Floors outside the map and empty rectangles are ignored
+	area.add({ 0, 0, 10, 10, rme::MapLayers });
+	area.add({ 5, 5, 4, 4, 7 });
+	CHECK_EQ(area.count(), uint64_t(14));
+
+	area.subtract({ -10, -10, rme::MapMaxWidth + 10, rme::MapMaxHeight + 10, 7 });
+	CHECK(area.empty());
+}
+
+BENCHMARK(selection_area_boxes) {
+	SelectionArea area;
+	rme::test::measure("add 1000 overlapping 512x512 boxes", 1000, [&]() {
+		for (int i = 0; i < 1000; ++i) {
+			area.add({ i * 7, i * 3, i * 7 + 511, i * 3 + 511, 7 });
+		}
+	});
+	rme::test::measure("subtract 1000 boxes", 1000, [&]() {
+		for (int i = 0; i < 1000; ++i) {
+			area.subtract({ i * 5, i * 11, i * 5 + 63, i * 11 + 63, 7 });
+		}
+	});
+
+	std::vector<Position> positions;
+	area.forEachPosition([&](const Position &position) {
+		positions.push_back(position);
+	});
+	rme::test::measure("fromPositions", positions.size(), [&]() {
+		CHECK_EQ(SelectionArea::fromPositions(positions).count(), area.count());
+	});
+}
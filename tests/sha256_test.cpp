@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "sha256.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace {
+	struct Sha256Vector {
+		std::string message;
+		std::string_view digest;
+	};
+
+	// Known answers of FIPS 180-2, appendix B and the NIST examples
+	std::vector<Sha256Vector> getSha256Vectors() {
+		return {
+			{ "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+			{ "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+			{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+			{ "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+			{ std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+		};
+	}
+
+	std::string toHex(const Sha256::Digest &digest) {
+		std::ostringstream stream;
+		for (const uint8_t byte : digest) {
+			stream << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+		}
+		return stream.str();
+	}
+
+	std::span<const uint8_t> asBytes(const std::string &text) {
+		return { reinterpret_cast<const uint8_t*>(text.data()), text.size() };
+	}
+
+	void checkSha256Vectors() {
+		for (const Sha256Vector &vector : getSha256Vectors()) {
+			CHECK_EQ(toHex(Sha256::hash(asBytes(vector.message))), vector.digest);
+
+			// Fed in uneven pieces, so the buffered and the direct block paths both run
+			Sha256 context;
+			const std::span<const uint8_t> bytes = asBytes(vector.message);
+			for (size_t offset = 0, piece = 1; offset < bytes.size(); offset += piece, piece = piece * 3 % 97 + 1) {
+				context.update(bytes.subspan(offset, std::min(piece, bytes.size() - offset)));
+			}
+			CHECK_EQ(toHex(context.finalize()), vector.digest);
+		}
+	}
+}
+
+TEST_CASE(sha256_fips_vectors_portable) {
+	Sha256::setHardwareEnabled(false);
+	checkSha256Vectors();
+	Sha256::setHardwareEnabled(true);
+}
+
+TEST_CASE(sha256_fips_vectors_hardware) {
+	if (!Sha256::hasHardwareSupport()) {
+		std::cout << "  no SHA extensions on this CPU, the hardware transform is the portable one" << std::endl;
+	}
+	Sha256::setHardwareEnabled(true);
+	checkSha256Vectors();
+}
+
+TEST_CASE(sha256_transforms_agree) {
+	std::mt19937 random(3);
+	std::vector<uint8_t> blocks(64 * 257);
+	for (uint8_t &byte : blocks) {
+		byte = static_cast<uint8_t>(random());
+	}
+
+	// Every block count up to a few, then the whole buffer at once
+	for (size_t count : { size_t(1), size_t(2), size_t(3), size_t(4), size_t(5), size_t(16), size_t(257) }) {
+		uint32_t portable[8] = { 0x6A09E667u, 0xBB67AE85u, 0x3C6EF372u, 0xA54FF53Au, 0x510E527Fu, 0x9B05688Cu, 0x1F83D9ABu, 0x5BE0CD19u };
+		uint32_t hardware[8];
+		std::copy(std::begin(portable), std::end(portable), hardware);
+
+		Sha256::transformPortable(portable, blocks.data(), count);
+		Sha256::transformHardware(hardware, blocks.data(), count);
+		CHECK(std::equal(std::begin(portable), std::end(portable), hardware));
+	}
+}
+
+BENCHMARK(sha256_throughput) {
+	const std::vector<uint8_t> data(64 << 20, 0x5A);
+	Sha256::Digest portable;
+	Sha256::Digest hardware;
+
+	Sha256::setHardwareEnabled(false);
+	rme::test::measure("portable, 64 MB", data.size(), [&]() {
+		portable = Sha256::hash(data);
+	});
+	Sha256::setHardwareEnabled(true);
+	rme::test::measure(Sha256::hasHardwareSupport() ? "hardware, 64 MB" : "hardware (not available), 64 MB", data.size(), [&]() {
+		hardware = Sha256::hash(data);
+	});
+	CHECK(portable == hardware);
+}
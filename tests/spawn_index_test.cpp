@@ -0,0 +1,139 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "spawn_index.h"
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+namespace {
+	struct SpawnArea {
+		Position center;
+		int radius;
+	};
+
+	// Every area covering the position, the way the editor counted them before the index
+	std::vector<Position> findCovering(const std::vector<SpawnArea> &areas, const Position &position) {
+		std::vector<Position> centers;
+		for (const SpawnArea &area : areas) {
+			if (area.center.z == position.z && std::abs(area.center.x - position.x) <= area.radius && std::abs(area.center.y - position.y) <= area.radius) {
+				centers.push_back(area.center);
+			}
+		}
+		return centers;
+	}
+
+	std::vector<Position> sorted(std::vector<Position> positions) {
+		std::ranges::sort(positions, [](const Position &a, const Position &b) {
+			return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x);
+		});
+		return positions;
+	}
+
+	void compareWithAreas(const SpawnIndex &index, const std::vector<SpawnArea> &areas, std::mt19937 &random) {
+		std::uniform_int_distribution<int> coordinate(0, 300);
+		std::uniform_int_distribution<int> floor(6, 8);
+		for (int i = 0; i < 20000; ++i) {
+			const Position position(coordinate(random), coordinate(random), floor(random));
+			const std::vector<Position> expected = findCovering(areas, position);
+			const std::vector<Position> found = index.find(position);
+			CHECK_EQ(index.count(position), expected.size());
+			CHECK(sorted(found) == sorted(expected));
+
+			// Closest spawn first
+			for (size_t j = 1; j < found.size(); ++j) {
+				const int previous = std::max(std::abs(found[j - 1].x - position.x), std::abs(found[j - 1].y - position.y));
+				const int current = std::max(std::abs(found[j].x - position.x), std::abs(found[j].y - position.y));
+				CHECK(previous <= current);
+			}
+		}
+	}
+}
+
+TEST_CASE(spawn_index_matches_brute_force) {
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> coordinate(0, 300);
+	std::uniform_int_distribution<int> floor(6, 8);
+	std::uniform_int_distribution<int> radius(0, 40);
+
+	SpawnIndex index;
+	std::vector<SpawnArea> areas;
+	for (int i = 0; i < 400; ++i) {
+		const SpawnArea area { Position(coordinate(random), coordinate(random), floor(random)), radius(random) };
+		index.add(area.center, area.radius);
+		areas.push_back(area);
+	}
+	// The same spawn twice, both count
+	index.add(areas.front().center, areas.front().radius);
+	areas.push_back(areas.front());
+	compareWithAreas(index, areas, random);
+
+	// Removing takes one of the copies at a time
+	std::shuffle(areas.begin(), areas.end(), random);
+	for (size_t i = 0; i < areas.size() / 2; ++i) {
+		index.remove(areas.back().center, areas.back().radius);
+		areas.pop_back();
+	}
+	compareWithAreas(index, areas, random);
+	CHECK(!index.empty());
+
+	index.clear();
+	CHECK(index.empty());
+	CHECK_EQ(index.count(areas.front().center), size_t(0));
+}
+
+TEST_CASE(spawn_index_clamps_to_the_map) {
+	SpawnIndex index;
+	index.add(Position(2, 3, 7), 10);
+	index.add(Position(rme::MapMaxWidth - 1, rme::MapMaxHeight - 1, 7), 10);
+	CHECK_EQ(index.count(Position(0, 0, 7)), size_t(1));
+	CHECK_EQ(index.count(Position(rme::MapMaxWidth, rme::MapMaxHeight, 7)), size_t(1));
+	CHECK_EQ(index.count(Position(0, 0, 6)), size_t(0));
+
+	// Floors outside the map are ignored
+	index.add(Position(10, 10, rme::MapLayers), 5);
+	CHECK_EQ(index.count(Position(10, 10, rme::MapLayers)), size_t(0));
+
+	index.remove(Position(2, 3, 7), 10);
+	CHECK_EQ(index.count(Position(0, 0, 7)), size_t(0));
+	CHECK(!index.empty());
+}
+
+BENCHMARK(spawn_index_lookups) {
+	std::mt19937 random(11);
+	std::uniform_int_distribution<int> coordinate(0, 4096);
+	std::uniform_int_distribution<int> radius(1, 10);
+
+	SpawnIndex index;
+	rme::test::measure("add", 100000, [&]() {
+		for (int i = 0; i < 100000; ++i) {
+			index.add(Position(coordinate(random), coordinate(random), 7), radius(random));
+		}
+	});
+
+	size_t covered = 0;
+	rme::test::measure("count", 4096 * 256, [&]() {
+		for (int y = 0; y < 256; ++y) {
+			for (int x = 0; x < 4096; ++x) {
+				covered += index.count(Position(x, y, 7));
+			}
+		}
+	});
+	CHECK(covered > 0);
+}
@@ -0,0 +1,146 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+#include "sprite_pixels.h"
+
+#include <random>
+
+namespace {
+	struct Planes {
+		std::vector<uint8_t> rgb;
+		std::vector<uint8_t> alpha;
+
+		bool operator==(const Planes &other) const = default;
+	};
+
+	// getWxImageBySpriteId before ConvertSpritePixels: wxImage::SetRGB and SetAlpha for every
+	// pixel, starting from magenta and reading the sprite wherever the index is inside it
+	Planes convertWithSetRgb(const std::vector<uint8_t> &pixels, int width, int height, uint8_t bgshade) {
+		constexpr uint32_t magenta = 0xFF00FF;
+		constexpr uint32_t lightMagenta = 0xD000CF;
+
+		Planes planes { std::vector<uint8_t>(width * height * 3), std::vector<uint8_t>(width * height) };
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				const size_t index = (y * width + x) * 4;
+				uint8_t a = 255;
+				uint8_t r = 255;
+				uint8_t g = 0;
+				uint8_t b = 255;
+				if (pixels.size() > index) {
+					a = pixels[index + 3];
+					r = pixels[index + 2];
+					g = pixels[index + 1];
+					b = pixels[index];
+				}
+
+				const uint32_t color = (r << 16) | (g << 8) | b;
+				if (color == magenta || color == lightMagenta) {
+					r = g = b = bgshade;
+				}
+
+				uint8_t* rgb = planes.rgb.data() + (y * width + x) * 3;
+				rgb[0] = r;
+				rgb[1] = g;
+				rgb[2] = b;
+				planes.alpha[y * width + x] = a;
+			}
+		}
+		return planes;
+	}
+
+	Planes convert(const std::vector<uint8_t> &pixels, int width, int height, uint8_t bgshade) {
+		// Filled with something neither conversion writes, so a skipped pixel shows up
+		Planes planes { std::vector<uint8_t>(width * height * 3, 0xCD), std::vector<uint8_t>(width * height, 0xCD) };
+		ConvertSpritePixels(pixels.data(), pixels.size(), width * height, bgshade, planes.rgb.data(), planes.alpha.data());
+		return planes;
+	}
+
+	// BGRA pixels, a fifth of them magenta, 0xD000CF or one step off either
+	std::vector<uint8_t> randomSprite(std::mt19937 &random, size_t count) {
+		static constexpr uint8_t keyed[][3] = {
+			{ 0xFF, 0x00, 0xFF },
+			{ 0xCF, 0x00, 0xD0 },
+			{ 0xFE, 0x00, 0xFF },
+			{ 0xCF, 0x01, 0xD0 },
+		};
+		std::uniform_int_distribution<int> byte(0, 255);
+		std::vector<uint8_t> pixels(count * 4);
+		for (size_t i = 0; i < count; ++i) {
+			uint8_t* pixel = pixels.data() + i * 4;
+			const int kind = byte(random) % 10;
+			for (int channel = 0; channel < 3; ++channel) {
+				pixel[channel] = kind < 4 ? keyed[kind][channel] : static_cast<uint8_t>(byte(random));
+			}
+			pixel[3] = static_cast<uint8_t>(byte(random));
+		}
+		return pixels;
+	}
+}
+
+TEST_CASE(sprite_pixels_image_width) {
+	// Sprites of up to one tile keep their width, anything larger gets the 64 pixel wide image
+	CHECK_EQ(GetSpriteImageWidth(32, 32), 32);
+	CHECK_EQ(GetSpriteImageWidth(16, 24), 16);
+	CHECK_EQ(GetSpriteImageWidth(64, 32), 64);
+	CHECK_EQ(GetSpriteImageWidth(48, 32), 64);
+	CHECK_EQ(GetSpriteImageWidth(32, 64), 64);
+	CHECK_EQ(GetSpriteImageWidth(64, 64), 64);
+}
+
+TEST_CASE(sprite_pixels_match_set_rgb) {
+	struct Sprite {
+		int width;
+		int height;
+		// Pixels in the sprite buffer, less than the image has for short buffers
+		size_t stored;
+	};
+	const Sprite sprites[] = {
+		{ 32, 32, 32 * 32 },
+		// Short buffers, the rest of the image is filled with the background
+		{ 32, 32, 32 * 32 / 2 + 5 },
+		{ 32, 32, 0 },
+		// Wider than a tile: a 64 pixel wide image, cropped to its right half afterwards
+		{ 64, 32, 64 * 32 },
+		{ 48, 32, 48 * 32 },
+		{ 64, 64, 64 * 64 },
+		{ 32, 64, 32 * 64 },
+	};
+
+	std::mt19937 random(38);
+	for (const Sprite &sprite : sprites) {
+		const int width = GetSpriteImageWidth(sprite.width, sprite.height);
+		const std::vector<uint8_t> pixels = randomSprite(random, sprite.stored);
+		for (const uint8_t bgshade : { uint8_t(0), uint8_t(88), uint8_t(255) }) {
+			CHECK((convert(pixels, width, sprite.height, bgshade) == convertWithSetRgb(pixels, width, sprite.height, bgshade)));
+		}
+	}
+}
+
+TEST_CASE(sprite_pixels_keying) {
+	// Magenta and 0xD000CF take the background and keep their alpha, near misses are left alone
+	const std::vector<uint8_t> pixels = {
+		0xFF, 0x00, 0xFF, 0x80,
+		0xCF, 0x00, 0xD0, 0x40,
+		0xFE, 0x00, 0xFF, 0xFF,
+		0x10, 0x20, 0x30, 0x00,
+	};
+	const Planes planes = convert(pixels, 4, 2, 88);
+	CHECK((planes.rgb == std::vector<uint8_t> { 88, 88, 88, 88, 88, 88, 0xFF, 0x00, 0xFE, 0x30, 0x20, 0x10, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88, 88 }));
+	CHECK((planes.alpha == std::vector<uint8_t> { 0x80, 0x40, 0xFF, 0x00, 255, 255, 255, 255 }));
+}
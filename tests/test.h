@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef RME_TESTS_TEST_H_
+#define RME_TESTS_TEST_H_
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal test runner for the parts of the editor that build without wx.
+// Every TEST_CASE and BENCHMARK registers itself, run rme-tests with name
+// prefixes to pick some of them, see test_main.cpp.
+namespace rme::test {
+	using Function = void (*)();
+
+	struct Case {
+		const char* name;
+		Function function;
+		bool benchmark;
+	};
+
+	std::vector<Case> &getCases();
+
+	struct Registrar {
+		Registrar(const char* name, Function function, bool benchmark) {
+			getCases().push_back({ name, function, benchmark });
+		}
+	};
+
+	// Records a failed check of the running test case
+	void fail(const char* file, int line, const std::string &message);
+
+	// Thrown by REQUIRE to stop the running test case
+	struct Abort { };
+
+	template <typename Value>
+	std::string describe(const Value &value) {
+		std::ostringstream stream;
+		if constexpr (requires { stream << value; }) {
+			stream << value;
+		} else {
+			stream << "?";
+		}
+		return stream.str();
+	}
+
+	// Prints how long the benchmark function took for count items
+	void report(const char* name, size_t count, std::chrono::steady_clock::duration elapsed);
+
+	template <typename Function>
+	void measure(const char* name, size_t count, Function &&function) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		report(name, count, std::chrono::steady_clock::now() - start);
+	}
+}
+
+#define TEST_CASE(name)                                                     \
+	static void name();                                                     \
+	static const rme::test::Registrar name##_registrar(#name, name, false); \
+	static void name()
+
+#define BENCHMARK(name)                                                    \
+	static void name();                                                    \
+	static const rme::test::Registrar name##_registrar(#name, name, true); \
+	static void name()
+
+#define CHECK(condition)                                     \
+	do {                                                     \
+		if (!(condition)) {                                  \
+			rme::test::fail(__FILE__, __LINE__, #condition); \
+		}                                                    \
+	} while (false)
+
+#define CHECK_EQ(left, right)                                                                       \
+	do {                                                                                            \
+		const auto &checkLeft = (left);                                                             \
+		const auto &checkRight = (right);                                                           \
+		if (!(checkLeft == checkRight)) {                                                           \
+			rme::test::fail(__FILE__, __LINE__, std::string(#left " == " #right " (")               \
+				+ rme::test::describe(checkLeft) + " vs " + rme::test::describe(checkRight) + ")"); \
+		}                                                                                           \
+	} while (false)
+
+#define REQUIRE(condition)                                   \
+	do {                                                     \
+		if (!(condition)) {                                  \
+			rme::test::fail(__FILE__, __LINE__, #condition); \
+			throw rme::test::Abort();                        \
+		}                                                    \
+	} while (false)
+
+#endif
@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////
+// This file is part of Remere's Map Editor
+//////////////////////////////////////////////////////////////////////
+// Remere's Map Editor is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Remere's Map Editor is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////
+
+#include "test.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+	const char* currentCase = nullptr;
+	size_t currentFailures = 0;
+
+	bool matches(const char* name, const std::vector<std::string> &filters) {
+		if (filters.empty()) {
+			return true;
+		}
+		for (const std::string &filter : filters) {
+			if (std::strncmp(name, filter.c_str(), filter.size()) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+namespace rme::test {
+	std::vector<Case> &getCases() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void fail(const char* file, int line, const std::string &message) {
+		std::cerr << file << ":" << line << ": " << currentCase << ": check failed: " << message << std::endl;
+		++currentFailures;
+	}
+
+	void report(const char* name, size_t count, std::chrono::steady_clock::duration elapsed) {
+		const double milliseconds = std::chrono::duration<double, std::milli>(elapsed).count();
+		std::cout << "  " << name << ": " << milliseconds << " ms (" << count << " items)" << std::endl;
+	}
+}
+
+// rme-tests [--benchmark] [name prefix...]
+// Runs the test cases, or the benchmarks, whose names start with one of the prefixes.
+int main(int argc, char** argv) {
+	bool benchmarks = false;
+	std::vector<std::string> filters;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--benchmark") == 0) {
+			benchmarks = true;
+		} else {
+			filters.emplace_back(argv[i]);
+		}
+	}
+
+	size_t run = 0;
+	size_t failed = 0;
+	for (const rme::test::Case &testCase : rme::test::getCases()) {
+		if (testCase.benchmark != benchmarks || !matches(testCase.name, filters)) {
+			continue;
+		}
+
+		currentCase = testCase.name;
+		currentFailures = 0;
+		std::cout << testCase.name << std::endl;
+		try {
+			testCase.function();
+		} catch (const rme::test::Abort &) {
+			// Already reported by REQUIRE
+		} catch (const std::exception &exception) {
+			rme::test::fail(__FILE__, __LINE__, std::string("unexpected exception: ") + exception.what());
+		}
+
+		++run;
+		if (currentFailures > 0) {
+			++failed;
+		}
+	}
+
+	std::cout << run - failed << " of " << run << (benchmarks ? " benchmarks" : " test cases") << " passed" << std::endl;
+	return run == 0 || failed > 0 ? 1 : 0;
+}